@@ -0,0 +1,35 @@
+#include "common/fifo_queue.h"
+#include <gtest/gtest.h>
+
+using TestQueue = InlineFIFOQueue<u32, 8>;
+
+TEST(FIFOQueue, RemoveWrapsAround)
+{
+  TestQueue queue;
+  for (u32 i = 0; i < 6; i++)
+    queue.Push(i);
+  queue.Remove(5);
+  for (u32 i = 6; i < 12; i++)
+    queue.Push(i);
+
+  ASSERT_EQ(queue.GetSize(), 7u);
+  ASSERT_EQ(queue.GetContiguousSize(), 3u);
+
+  queue.Remove(4);
+  ASSERT_EQ(queue.GetSize(), 3u);
+  ASSERT_EQ(queue.Peek(), 9u);
+  ASSERT_EQ(queue.Peek(2), 11u);
+}
+
+TEST(FIFOQueue, RemoveAllLeavesEmpty)
+{
+  TestQueue queue;
+  for (u32 i = 0; i < 8; i++)
+    queue.Push(i);
+  ASSERT_TRUE(queue.IsFull());
+
+  queue.Remove(8);
+  ASSERT_TRUE(queue.IsEmpty());
+  queue.Push(42);
+  ASSERT_EQ(queue.Pop(), 42u);
+}
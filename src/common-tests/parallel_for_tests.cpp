@@ -0,0 +1,21 @@
+#include "common/parallel_for.h"
+#include "gtest/gtest.h"
+#include <atomic>
+#include <vector>
+
+TEST(ParallelFor, ZeroCount)
+{
+  bool called = false;
+  Common::ParallelFor(0, [&called](u32) { called = true; });
+  ASSERT_FALSE(called);
+}
+
+TEST(ParallelFor, EveryIndexCalledOnce)
+{
+  static constexpr u32 COUNT = 1000;
+  std::vector<std::atomic<u32>> calls(COUNT);
+  Common::ParallelFor(COUNT, [&calls](u32 index) { calls[index].fetch_add(1); });
+
+  for (u32 i = 0; i < COUNT; i++)
+    ASSERT_EQ(calls[i].load(), 1u);
+}
@@ -1,6 +1,7 @@
 #include "audio_stream.h"
 #include "assert.h"
 #include "log.h"
+#include "trace_recorder.h"
 #include <algorithm>
 #include <cstring>
 Log_SetChannel(AudioStream);
@@ -132,6 +133,16 @@ u32 AudioStream::GetSamplesAvailableLocked() const
 
 void AudioStream::ReadFrames(SampleType* samples, u32 num_frames, bool apply_volume)
 {
+  // Called from the backend's audio thread, which we don't create, so it is named on the first callback. This is
+  // before its first trace event, so the trace recorder only stores the name and doesn't lock.
+  static thread_local bool t_thread_named = false;
+  if (!t_thread_named)
+  {
+    TraceRecorder::SetThreadName("Audio");
+    t_thread_named = true;
+  }
+  TraceRecorder::ScopedSpan trace_span("Audio Read Frames");
+
   const u32 total_samples = num_frames * m_channels;
   u32 samples_copied = 0;
   {
@@ -209,9 +209,13 @@ ShaderCache::CacheIndexKey ShaderCache::GetCacheKey(ShaderCompiler::Type type, c
 ShaderCache::ComPtr<ID3DBlob> ShaderCache::GetShaderBlob(ShaderCompiler::Type type, std::string_view shader_code)
 {
   const auto key = GetCacheKey(type, shader_code);
+  std::unique_lock lock(m_mutex);
   auto iter = m_index.find(key);
   if (iter == m_index.end())
+  {
+    lock.unlock();
     return CompileAndAddShaderBlob(key, shader_code);
+  }
 
   ComPtr<ID3DBlob> blob;
   HRESULT hr = D3DCreateBlob(iter->second.blob_size, blob.GetAddressOf());
@@ -270,7 +274,9 @@ ShaderCache::ComPtr<ID3DBlob> ShaderCache::CompileAndAddShaderBlob(const CacheIn
   if (!blob)
     return {};
 
-  if (!m_blob_file || std::fseek(m_blob_file, 0, SEEK_END) != 0)
+  // Another thread may have compiled the same shader while we weren't holding the lock.
+  std::unique_lock lock(m_mutex);
+  if (!m_blob_file || m_index.find(key) != m_index.end() || std::fseek(m_blob_file, 0, SEEK_END) != 0)
     return blob;
 
   CacheIndexData data;
@@ -5,6 +5,7 @@
 #include "shader_compiler.h"
 #include <cstdio>
 #include <d3d11.h>
+#include <mutex>
 #include <string_view>
 #include <unordered_map>
 #include <vector>
@@ -23,6 +24,7 @@ public:
 
   void Open(std::string_view base_path, D3D_FEATURE_LEVEL feature_level, bool debug);
 
+  /// Shader lookups are safe to call from multiple threads at once, cache misses are compiled in parallel.
   ComPtr<ID3DBlob> GetShaderBlob(ShaderCompiler::Type type, std::string_view shader_code);
 
   ComPtr<ID3D11VertexShader> GetVertexShader(ID3D11Device* device, std::string_view shader_code);
@@ -75,6 +77,7 @@ private:
   std::FILE* m_blob_file = nullptr;
 
   CacheIndex m_index;
+  std::mutex m_mutex;
 
   D3D_FEATURE_LEVEL m_feature_level = D3D_FEATURE_LEVEL_11_0;
   bool m_debug = false;
@@ -2,13 +2,14 @@
 #include "../log.h"
 #include "../string_util.h"
 #include <array>
+#include <atomic>
 #include <d3dcompiler.h>
 #include <fstream>
 Log_SetChannel(D3D11);
 
 namespace D3D11::ShaderCompiler {
 
-static unsigned s_next_bad_shader_id = 1;
+static std::atomic<unsigned> s_next_bad_shader_id{1};
 
 ComPtr<ID3DBlob> CompileShader(Type type, D3D_FEATURE_LEVEL feature_level, std::string_view code, bool debug)
 {
@@ -65,7 +66,7 @@ ComPtr<ID3DBlob> CompileShader(Type type, D3D_FEATURE_LEVEL feature_level, std::
   {
     Log_ErrorPrintf("Failed to compile '%s':\n%s", target, error_string.c_str());
 
-    std::ofstream ofs(StringUtil::StdStringFromFormat("bad_shader_%u.txt", s_next_bad_shader_id++).c_str(),
+    std::ofstream ofs(StringUtil::StdStringFromFormat("bad_shader_%u.txt", s_next_bad_shader_id.fetch_add(1)).c_str(),
                       std::ofstream::out | std::ofstream::binary);
     if (ofs.is_open())
     {
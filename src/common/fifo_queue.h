@@ -96,6 +96,15 @@ public:
   const T& Peek() const { return m_ptr[m_head]; }
   const T& Peek(u32 offset) { return m_ptr[(m_head + offset) % CAPACITY]; }
 
+  template<class Y = T, std::enable_if_t<std::is_pod_v<Y>, int> = 0>
+  void Remove(u32 count)
+  {
+    DebugAssert(m_size >= count);
+    m_head = (m_head + count) % CAPACITY;
+    m_size -= count;
+  }
+
+  template<class Y = T, std::enable_if_t<!std::is_pod_v<Y>, int> = 0>
   void Remove(u32 count)
   {
     DebugAssert(m_size >= count);
@@ -151,7 +160,7 @@ public:
 
   void AdvanceTail(u32 count)
   {
-    DebugAssert((m_size + count) < CAPACITY);
+    DebugAssert((m_size + count) <= CAPACITY);
     DebugAssert((m_tail + count) <= CAPACITY);
     m_tail = (m_tail + count) % CAPACITY;
     m_size += count;
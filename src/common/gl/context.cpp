@@ -102,6 +102,12 @@ std::unique_ptr<GL::Context> Context::Create(const WindowInfo& wi, const Version
     context = ContextEGLWayland::Create(wi, versions_to_try, num_versions_to_try);
 #endif
 
+#if defined(USE_EGL) && !defined(ANDROID)
+  // Offscreen contexts, e.g. for replaying GPU dumps.
+  if (wi.type == WindowInfo::Type::Surfaceless)
+    context = ContextEGL::Create(wi, versions_to_try, num_versions_to_try);
+#endif
+
   if (!context)
     return nullptr;
 
@@ -0,0 +1,33 @@
+#include "parallel_for.h"
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace Common {
+
+void ParallelFor(u32 count, const std::function<void(u32)>& func)
+{
+  if (count == 0)
+    return;
+
+  std::atomic<u32> next_index{0};
+  auto worker = [&next_index, &func, count]() {
+    for (u32 index = next_index.fetch_add(1); index < count; index = next_index.fetch_add(1))
+      func(index);
+  };
+
+  // hardware_concurrency() is allowed to return zero, in which case everything runs on this thread.
+  const u32 num_threads = std::min(count, std::max(std::thread::hardware_concurrency(), 1u));
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads - 1);
+  for (u32 i = 1; i < num_threads; i++)
+    threads.emplace_back(worker);
+
+  worker();
+
+  for (std::thread& thread : threads)
+    thread.join();
+}
+
+} // namespace Common
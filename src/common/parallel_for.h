@@ -0,0 +1,12 @@
+#pragma once
+#include "types.h"
+#include <functional>
+
+namespace Common {
+
+/// Calls func for every index in [0, count), spread across the host's hardware threads. The calling thread takes
+/// part too, and the function returns once every call has completed. Indices are handed out one at a time, so jobs
+/// of uneven length (e.g. shader compiles) still balance out.
+void ParallelFor(u32 count, const std::function<void(u32)>& func);
+
+} // namespace Common
@@ -0,0 +1,245 @@
+#include "trace_recorder.h"
+#include "file_system.h"
+#include "log.h"
+#include "timer.h"
+#include <algorithm>
+#include <cstdio>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+Log_SetChannel(TraceRecorder);
+
+namespace TraceRecorder {
+
+enum : u32
+{
+  EVENTS_PER_THREAD = 256 * 1024,
+  EVENT_INDEX_MASK = EVENTS_PER_THREAD - 1,
+
+  // Events which may still be overwritten by a writer that was mid-record when recording stopped.
+  UNSAFE_EVENTS = 64
+};
+
+enum class Phase : u32
+{
+  Begin,
+  End
+};
+
+struct Event
+{
+  const char* name;
+  Common::Timer::Value timestamp;
+  Phase phase;
+};
+
+struct ThreadBuffer
+{
+  std::unique_ptr<Event[]> events;
+  std::atomic<u64> write_position{0};
+  u64 start_position = 0;
+  std::string name;
+  u32 id = 0;
+  bool in_use = true;
+};
+
+/// Hands the calling thread's buffer back when the thread exits, so threads which are recreated (e.g. on settings
+/// changes) reuse buffers instead of allocating new ones.
+struct ThreadBufferReleaser
+{
+  ThreadBuffer* buffer = nullptr;
+
+  ~ThreadBufferReleaser();
+};
+
+std::atomic_bool g_recording{false};
+
+static std::mutex s_mutex;
+static std::vector<std::unique_ptr<ThreadBuffer>> s_buffers;
+static std::deque<std::string> s_interned_names;
+static Common::Timer::Value s_start_time = 0;
+static u32 s_last_thread_id = 0;
+
+static thread_local ThreadBuffer* t_buffer = nullptr;
+static thread_local const char* t_thread_name = nullptr;
+static thread_local ThreadBufferReleaser t_buffer_releaser;
+
+const char* InternName(std::string_view name)
+{
+  std::unique_lock<std::mutex> lock(s_mutex);
+  for (const std::string& it : s_interned_names)
+  {
+    if (it == name)
+      return it.c_str();
+  }
+
+  return s_interned_names.emplace_back(name).c_str();
+}
+
+void SetThreadName(const char* name)
+{
+  t_thread_name = name;
+  if (t_buffer)
+  {
+    std::unique_lock<std::mutex> lock(s_mutex);
+    t_buffer->name = name;
+  }
+}
+
+static ThreadBuffer* GetThreadBuffer()
+{
+  if (t_buffer)
+    return t_buffer;
+
+  std::unique_lock<std::mutex> lock(s_mutex);
+  // Buffers of exited threads are reused, unless they hold events for the current recording.
+  auto iter = std::find_if(s_buffers.begin(), s_buffers.end(), [](const auto& buffer) {
+    return !buffer->in_use && (!g_recording.load(std::memory_order_relaxed) ||
+                               buffer->write_position.load(std::memory_order_relaxed) == buffer->start_position);
+  });
+  if (iter != s_buffers.end())
+  {
+    // Older events would be attributed to this thread otherwise.
+    t_buffer = iter->get();
+    t_buffer->start_position = t_buffer->write_position.load(std::memory_order_relaxed);
+    t_buffer->in_use = true;
+  }
+  else
+  {
+    std::unique_ptr<ThreadBuffer> buffer = std::make_unique<ThreadBuffer>();
+    buffer->events = std::make_unique<Event[]>(EVENTS_PER_THREAD);
+    t_buffer = buffer.get();
+    s_buffers.push_back(std::move(buffer));
+  }
+
+  t_buffer->id = ++s_last_thread_id;
+  t_buffer->name = t_thread_name ? std::string(t_thread_name) : ("Thread " + std::to_string(t_buffer->id));
+
+  t_buffer_releaser.buffer = t_buffer;
+  return t_buffer;
+}
+
+ThreadBufferReleaser::~ThreadBufferReleaser()
+{
+  if (!buffer)
+    return;
+
+  std::unique_lock<std::mutex> lock(s_mutex);
+  buffer->in_use = false;
+  t_buffer = nullptr;
+}
+
+ALWAYS_INLINE static void AddEvent(const char* name, Phase phase)
+{
+  ThreadBuffer* buffer = GetThreadBuffer();
+  const u64 position = buffer->write_position.load(std::memory_order_relaxed);
+  Event& event = buffer->events[position & EVENT_INDEX_MASK];
+  event.name = name;
+  event.timestamp = Common::Timer::GetValue();
+  event.phase = phase;
+  buffer->write_position.store(position + 1, std::memory_order_release);
+}
+
+void BeginSpan(const char* name)
+{
+  AddEvent(name, Phase::Begin);
+}
+
+void EndSpan(const char* name)
+{
+  AddEvent(name, Phase::End);
+}
+
+void Start()
+{
+  std::unique_lock<std::mutex> lock(s_mutex);
+  for (const auto& buffer : s_buffers)
+    buffer->start_position = buffer->write_position.load(std::memory_order_acquire);
+
+  s_start_time = Common::Timer::GetValue();
+  g_recording.store(true);
+  Log_InfoPrintf("Started trace recording");
+}
+
+static void WriteEscapedString(std::FILE* fp, const char* str)
+{
+  std::fputc('"', fp);
+  for (; *str != '\0'; str++)
+  {
+    if (*str == '"' || *str == '\\')
+      std::fputc('\\', fp);
+    std::fputc(*str, fp);
+  }
+  std::fputc('"', fp);
+}
+
+bool StopAndWrite(const char* filename)
+{
+  if (!g_recording.exchange(false))
+    return false;
+
+  std::unique_lock<std::mutex> lock(s_mutex);
+  std::FILE* fp = FileSystem::OpenCFile(filename, "wb");
+  if (!fp)
+  {
+    Log_ErrorPrintf("Failed to open '%s' for writing", filename);
+    return false;
+  }
+
+  std::fprintf(fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+
+  u32 num_events = 0;
+  bool first = true;
+  for (const auto& buffer : s_buffers)
+  {
+    const u64 end_position = buffer->write_position.load(std::memory_order_acquire);
+    u64 start_position = buffer->start_position;
+    if ((end_position - start_position) > (EVENTS_PER_THREAD - UNSAFE_EVENTS))
+      start_position = end_position - (EVENTS_PER_THREAD - UNSAFE_EVENTS);
+    if (start_position == end_position)
+      continue;
+
+    std::fprintf(fp, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":",
+                 first ? "" : ",\n", buffer->id);
+    WriteEscapedString(fp, buffer->name.c_str());
+    std::fprintf(fp, "}}");
+    first = false;
+
+    // Drop end events whose begin has been overwritten in the ring.
+    u32 depth = 0;
+    for (u64 position = start_position; position != end_position; position++)
+    {
+      const Event& event = buffer->events[position & EVENT_INDEX_MASK];
+      if (event.timestamp < s_start_time)
+        continue;
+
+      if (event.phase == Phase::End)
+      {
+        if (depth == 0)
+          continue;
+        depth--;
+      }
+      else
+      {
+        depth++;
+      }
+
+      const double timestamp_us = Common::Timer::ConvertValueToNanoseconds(event.timestamp - s_start_time) / 1000.0;
+      std::fprintf(fp, ",\n{\"name\":");
+      WriteEscapedString(fp, event.name);
+      std::fprintf(fp, ",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%u}", (event.phase == Phase::Begin) ? 'B' : 'E',
+                   timestamp_us, buffer->id);
+      num_events++;
+    }
+  }
+
+  std::fprintf(fp, "\n]}\n");
+  std::fclose(fp);
+
+  Log_InfoPrintf("Wrote %u trace events to '%s'", num_events, filename);
+  return true;
+}
+
+} // namespace TraceRecorder
@@ -0,0 +1,52 @@
+#pragma once
+#include "types.h"
+#include <atomic>
+#include <string_view>
+
+/// Records begin/end spans from any thread into per-thread ring buffers, which can be written out in the Chrome trace
+/// event format (chrome://tracing, Perfetto). Only the most recent events of each thread are kept.
+namespace TraceRecorder {
+
+extern std::atomic_bool g_recording;
+
+ALWAYS_INLINE bool IsRecording()
+{
+  return g_recording.load(std::memory_order_relaxed);
+}
+
+/// Returns a pointer to a copy of the name which lives until the program exits. Span names must remain valid until
+/// the trace is written, so dynamic names should be passed through this.
+const char* InternName(std::string_view name);
+
+/// Names the calling thread in the trace.
+void SetThreadName(const char* name);
+
+void Start();
+bool StopAndWrite(const char* filename);
+
+void BeginSpan(const char* name);
+void EndSpan(const char* name);
+
+class ScopedSpan
+{
+public:
+  ALWAYS_INLINE ScopedSpan(const char* name) : m_name(IsRecording() ? name : nullptr)
+  {
+    if (m_name)
+      BeginSpan(m_name);
+  }
+
+  ALWAYS_INLINE ~ScopedSpan()
+  {
+    if (m_name)
+      EndSpan(m_name);
+  }
+
+  ScopedSpan(const ScopedSpan&) = delete;
+  ScopedSpan& operator=(const ScopedSpan&) = delete;
+
+private:
+  const char* m_name;
+};
+
+} // namespace TraceRecorder
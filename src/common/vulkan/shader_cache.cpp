@@ -426,15 +426,20 @@ std::optional<ShaderCompiler::SPIRVCodeVector> ShaderCache::GetShaderSPV(ShaderC
                                                                          std::string_view shader_code)
 {
   const auto key = GetCacheKey(type, shader_code);
+  std::unique_lock lock(m_mutex);
   auto iter = m_index.find(key);
   if (iter == m_index.end())
+  {
+    lock.unlock();
     return CompileAndAddShaderSPV(key, shader_code);
+  }
 
   SPIRVCodeVector spv(iter->second.blob_size);
   if (std::fseek(m_blob_file, iter->second.file_offset, SEEK_SET) != 0 ||
       std::fread(spv.data(), sizeof(SPIRVCodeType), iter->second.blob_size, m_blob_file) != iter->second.blob_size)
   {
     Log_ErrorPrintf("Read blob from file failed, recompiling");
+    lock.unlock();
     return ShaderCompiler::CompileShader(type, shader_code, m_debug);
   }
 
@@ -488,7 +493,9 @@ std::optional<ShaderCompiler::SPIRVCodeVector> ShaderCache::CompileAndAddShaderS
   if (!spv.has_value())
     return {};
 
-  if (!m_blob_file || std::fseek(m_blob_file, 0, SEEK_END) != 0)
+  // Another thread may have compiled the same shader while we weren't holding the lock.
+  std::unique_lock lock(m_mutex);
+  if (!m_blob_file || m_index.find(key) != m_index.end() || std::fseek(m_blob_file, 0, SEEK_END) != 0)
     return spv;
 
   CacheIndexData data;
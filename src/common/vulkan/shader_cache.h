@@ -5,6 +5,7 @@
 #include "vulkan_loader.h"
 #include <cstdio>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
 #include <string_view>
@@ -27,6 +28,7 @@ public:
   /// Writes pipeline cache to file, saving all newly compiled pipelines.
   bool FlushPipelineCache();
 
+  /// Shader lookups are safe to call from multiple threads at once, cache misses are compiled in parallel.
   std::optional<ShaderCompiler::SPIRVCodeVector> GetShaderSPV(ShaderCompiler::Type type, std::string_view shader_code);
   VkShaderModule GetShaderModule(ShaderCompiler::Type type, std::string_view shader_code);
 
@@ -91,6 +93,7 @@ private:
   std::string m_pipeline_cache_filename;
 
   CacheIndex m_index;
+  std::mutex m_mutex;
 
   VkPipelineCache m_pipeline_cache = VK_NULL_HANDLE;
   bool m_debug = false;
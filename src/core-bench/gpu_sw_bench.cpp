@@ -0,0 +1,205 @@
+#include "common/timer.h"
+#include "core/gpu_sw_backend.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <vector>
+
+// Draws synthetic scenes with the software rasterizer, with scalar shading (with and without the texture cache) and
+// then vector shading at several thread counts, and reports the speedup relative to the uncached scalar
+// single-threaded run. The output of every run is checked against the first. The "quads" scene is large polygons with
+// lots of different textures, the "sprites" scene is small rectangles from a few palette textures, like 2D games.
+static constexpr u32 SCENE_WIDTH = 640;
+static constexpr u32 SCENE_HEIGHT = 480;
+
+static void FillDrawCommand(GPUBackendDrawCommand* cmd, std::mt19937& rng, bool textured)
+{
+  cmd->params.bits = 0;
+  cmd->rc.bits = 0;
+  cmd->rc.primitive = GPU::Primitive::Polygon;
+  cmd->rc.shading_enable = true;
+  cmd->rc.texture_enable = textured;
+  cmd->rc.transparency_enable = (rng() % 4) == 0;
+  cmd->texture_mode = static_cast<GPU::TextureMode>(rng() % 3);
+  cmd->transparency_mode = static_cast<GPU::TransparencyMode>(rng() % 4);
+  cmd->dithering_enable = true;
+
+  // Textures live to the right of the framebuffer, as they do in most games.
+  cmd->texture_page_x = static_cast<u16>(SCENE_WIDTH + (rng() % 6) * 64);
+  cmd->texture_page_y = static_cast<u16>((rng() % 2) * 256);
+  cmd->texture_palette_x = static_cast<u16>(SCENE_WIDTH);
+  cmd->texture_palette_y = static_cast<u16>(SCENE_HEIGHT + (rng() % 32));
+  cmd->texture_window_and_x = 0xFF;
+  cmd->texture_window_and_y = 0xFF;
+  cmd->texture_window_or_x = 0;
+  cmd->texture_window_or_y = 0;
+}
+
+/// Fills the textures and palettes to the right of the framebuffer with noise.
+static void UploadTextures(GPU_SW_Backend& backend)
+{
+  std::mt19937 rng(5678);
+
+  const u32 width = GPU::VRAM_WIDTH - SCENE_WIDTH;
+  GPUBackendUpdateVRAMCommand* cmd = backend.NewUpdateVRAMCommand(width * GPU::VRAM_HEIGHT);
+  cmd->params.bits = 0;
+  cmd->x = static_cast<u16>(SCENE_WIDTH);
+  cmd->y = 0;
+  cmd->width = static_cast<u16>(width);
+  cmd->height = static_cast<u16>(GPU::VRAM_HEIGHT);
+  for (u32 i = 0; i < width * GPU::VRAM_HEIGHT; i++)
+    cmd->GetData()[i] = static_cast<u16>(rng());
+  backend.PushCommand(cmd);
+
+  backend.Sync();
+}
+
+static void DrawSprites(GPU_SW_Backend& backend, std::mt19937& rng, u32 num_sprites)
+{
+  for (u32 i = 0; i < num_sprites; i++)
+  {
+    GPUBackendDrawRectangleCommand* cmd = backend.NewDrawRectangleCommand();
+    FillDrawCommand(cmd, rng, true);
+    cmd->rc.primitive = GPU::Primitive::Rectangle;
+    cmd->rc.shading_enable = false;
+    cmd->texture_mode = static_cast<GPU::TextureMode>(rng() % 2);
+    cmd->texture_page_x = static_cast<u16>(SCENE_WIDTH + (rng() % 2) * 64);
+    cmd->texture_page_y = 0;
+    cmd->texture_palette_y = static_cast<u16>(SCENE_HEIGHT + (rng() % 4));
+    cmd->dithering_enable = false;
+
+    cmd->width = static_cast<u16>(16 << (rng() % 3));
+    cmd->height = cmd->width;
+    cmd->x = static_cast<s32>(rng() % (SCENE_WIDTH - cmd->width));
+    cmd->y = static_cast<s32>(rng() % (SCENE_HEIGHT - cmd->height));
+    cmd->texcoord_x = static_cast<u8>((rng() % 4) * 64);
+    cmd->texcoord_y = static_cast<u8>((rng() % 4) * 64);
+    cmd->color_r = cmd->color_g = cmd->color_b = 128;
+    backend.PushCommand(cmd);
+  }
+}
+
+static void DrawScene(GPU_SW_Backend& backend, u32 num_quads, bool sprites)
+{
+  std::mt19937 rng(1234);
+
+  GPUBackendSetDrawingAreaCommand* area_cmd = backend.NewSetDrawingAreaCommand();
+  area_cmd->params.bits = 0;
+  area_cmd->new_area = Common::Rectangle<u32>(0, 0, SCENE_WIDTH - 1, SCENE_HEIGHT - 1);
+  backend.PushCommand(area_cmd);
+
+  if (sprites)
+  {
+    DrawSprites(backend, rng, num_quads * 8);
+    backend.Sync();
+    return;
+  }
+
+  for (u32 i = 0; i < num_quads; i++)
+  {
+    GPUBackendDrawPolygonCommand* cmd = backend.NewDrawPolygonCommand();
+    FillDrawCommand(cmd, rng, (i % 8) != 0);
+
+    const s32 width = 32 + static_cast<s32>(rng() % 192);
+    const s32 height = 32 + static_cast<s32>(rng() % 192);
+    const s32 x = static_cast<s32>(rng() % (SCENE_WIDTH - 32)) - 16;
+    const s32 y = static_cast<s32>(rng() % (SCENE_HEIGHT - 32)) - 16;
+    const s32 positions[4][2] = {{x, y}, {x + width, y}, {x, y + height}, {x + width, y + height}};
+    const u8 texcoords[4][2] = {{0, 0}, {255, 0}, {0, 255}, {255, 255}};
+    cmd->num_vertices = 4;
+    for (u32 j = 0; j < 4; j++)
+    {
+      GPUBackendVertex& vert = cmd->vertices[j];
+      vert.SetPosition(positions[j][0], positions[j][1]);
+      vert.SetColorRGB24(rng() & 0xFFFFFFu);
+      vert.texcoord_x = texcoords[j][0];
+      vert.texcoord_y = texcoords[j][1];
+    }
+
+    backend.PushCommand(cmd);
+  }
+
+  backend.Sync();
+}
+
+struct Config
+{
+  const char* name;
+  u32 num_threads;
+  bool vector_shading;
+  bool texture_cache;
+};
+
+static bool RunScene(const Config* configs, u32 num_configs, u32 num_quads, u32 iterations, bool sprites)
+{
+  std::vector<u16> reference_vram;
+  double reference_time = 0.0;
+  for (u32 config_index = 0; config_index < num_configs; config_index++)
+  {
+    const Config& config = configs[config_index];
+    std::unique_ptr<GPU_SW_Backend> backend = std::make_unique<GPU_SW_Backend>();
+    backend->SetUseThread(true);
+    backend->SetRasterizerThreadCount(config.num_threads);
+    backend->SetUseVectorShading(config.vector_shading);
+    backend->SetUseTextureCache(config.texture_cache);
+
+    double best_time = 0.0;
+    for (u32 i = 0; i < iterations; i++)
+    {
+      backend->Reset();
+      UploadTextures(*backend);
+
+      Common::Timer timer;
+      DrawScene(*backend, num_quads, sprites);
+      const double time = timer.GetTimeMilliseconds();
+      best_time = (i == 0) ? time : std::min(best_time, time);
+    }
+
+    const u16* vram = backend->GetVRAM();
+    bool matches = true;
+    if (reference_vram.empty())
+    {
+      reference_vram.assign(vram, vram + GPU::VRAM_WIDTH * GPU::VRAM_HEIGHT);
+      reference_time = best_time;
+    }
+    else
+    {
+      matches = (std::memcmp(reference_vram.data(), vram, GPU::VRAM_SIZE) == 0);
+    }
+
+    std::printf("%-27s best %.2f ms, %.2fx%s\n", config.name, best_time, reference_time / best_time,
+                matches ? "" : " (OUTPUT MISMATCH)");
+    if (!matches)
+      return false;
+  }
+
+  return true;
+}
+
+int main(int argc, char* argv[])
+{
+  const u32 num_quads = (argc > 1) ? static_cast<u32>(std::max(std::atoi(argv[1]), 1)) : 20000;
+  const u32 iterations = (argc > 2) ? static_cast<u32>(std::max(std::atoi(argv[2]), 1)) : 3;
+
+  static constexpr Config configs[] = {
+    {"scalar, 1 thread, uncached", 1, false, false},
+    {"scalar, 1 thread", 1, false, true},
+    {"vector, 1 thread", 1, true, true},
+    {"vector, 2 threads", 2, true, true},
+    {"vector, 4 threads", 4, true, true},
+    {"vector, 8 threads", 8, true, true},
+  };
+
+  for (const bool sprites : {false, true})
+  {
+    std::printf("%s:\n", sprites ? "sprites" : "quads");
+    if (!RunScene(configs, std::size(configs), num_quads, iterations, sprites))
+      return EXIT_FAILURE;
+  }
+
+  return EXIT_SUCCESS;
+}
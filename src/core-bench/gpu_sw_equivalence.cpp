@@ -0,0 +1,199 @@
+#include "core/gpu_sw_backend.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <vector>
+
+// Checks that the fast paths of the software rasterizer give exactly the same VRAM as the original ones. Each stream
+// of random commands is drawn once as a reference, on one thread without the texture cache, testing every pixel of
+// each triangle's bounding box and shading one pixel at a time. It is then drawn again with the edge walk, vector
+// shading, the texture cache and several rasterizer threads. The streams cover every blend and texture mode, raw
+// textures, texture windows, mask checks and set-mask, interlacing, dithering, lines, and primitives which sample from
+// the area they draw to, since textures and the drawing area are placed anywhere in VRAM.
+struct Config
+{
+  const char* name;
+  u32 num_threads;
+  bool edge_walking;
+  bool vector_shading;
+  bool texture_cache;
+};
+
+static void FillDrawCommand(GPUBackendDrawCommand* cmd, std::mt19937& rng, GPU::Primitive primitive)
+{
+  cmd->params.bits = static_cast<u8>(rng() % 16);
+  cmd->rc.bits = 0;
+  cmd->rc.primitive = primitive;
+  cmd->rc.shading_enable = (primitive != GPU::Primitive::Rectangle) && (rng() % 2) != 0;
+  cmd->rc.texture_enable = (primitive != GPU::Primitive::Line) && (rng() % 4) != 0;
+  cmd->rc.raw_texture_enable = cmd->rc.texture_enable && (rng() % 3) == 0;
+  cmd->rc.transparency_enable = (rng() % 2) != 0;
+  cmd->texture_mode = static_cast<GPU::TextureMode>(rng() % 4);
+  cmd->transparency_mode = static_cast<GPU::TransparencyMode>(rng() % 4);
+  cmd->dithering_enable =
+    (primitive != GPU::Primitive::Rectangle) && cmd->rc.IsDitheringEnabled() && (rng() % 2) != 0;
+
+  cmd->texture_page_x = static_cast<u16>((rng() % 16) * 64);
+  cmd->texture_page_y = static_cast<u16>((rng() % 2) * 256);
+  cmd->texture_palette_x = static_cast<u16>((rng() % 64) * 16);
+  cmd->texture_palette_y = static_cast<u16>(rng() % GPU::VRAM_HEIGHT);
+
+  // Half of the draws use a texture window, set up the same way as the GP0(E2h) command does.
+  const u8 mask_x = (rng() % 2) ? static_cast<u8>(rng() % 32) : 0;
+  const u8 mask_y = (rng() % 2) ? static_cast<u8>(rng() % 32) : 0;
+  cmd->texture_window_and_x = static_cast<u8>(~(mask_x * 8));
+  cmd->texture_window_and_y = static_cast<u8>(~(mask_y * 8));
+  cmd->texture_window_or_x = static_cast<u8>(((rng() % 32) & mask_x) * 8);
+  cmd->texture_window_or_y = static_cast<u8>(((rng() % 32) & mask_y) * 8);
+}
+
+static void SetVertex(GPUBackendVertex* vert, std::mt19937& rng, s32 center_x, s32 center_y, s32 size)
+{
+  vert->SetPosition(center_x + static_cast<s32>(rng() % static_cast<u32>(size * 2 + 1)) - size,
+                    center_y + static_cast<s32>(rng() % static_cast<u32>(size * 2 + 1)) - size);
+  vert->SetColorRGB24(rng() & 0xFFFFFFu);
+  vert->texcoord_x = static_cast<u8>(rng());
+  vert->texcoord_y = static_cast<u8>(rng());
+}
+
+static void DrawStream(GPU_SW_Backend& backend, u32 seed, u32 num_commands)
+{
+  std::mt19937 rng(seed);
+
+  // Noise everywhere, so that textures, palettes and mask bits are all random.
+  GPUBackendUpdateVRAMCommand* vram_cmd = backend.NewUpdateVRAMCommand(GPU::VRAM_WIDTH * GPU::VRAM_HEIGHT);
+  vram_cmd->params.bits = 0;
+  vram_cmd->x = 0;
+  vram_cmd->y = 0;
+  vram_cmd->width = static_cast<u16>(GPU::VRAM_WIDTH);
+  vram_cmd->height = static_cast<u16>(GPU::VRAM_HEIGHT);
+  for (u32 i = 0; i < GPU::VRAM_WIDTH * GPU::VRAM_HEIGHT; i++)
+    vram_cmd->GetData()[i] = static_cast<u16>(rng());
+  backend.PushCommand(vram_cmd);
+
+  Common::Rectangle<u32> area;
+  for (u32 i = 0; i < num_commands; i++)
+  {
+    if ((i % 64) == 0)
+    {
+      const u32 left = rng() % GPU::VRAM_WIDTH;
+      const u32 top = rng() % GPU::VRAM_HEIGHT;
+      area = Common::Rectangle<u32>(left, top, left + rng() % (GPU::VRAM_WIDTH - left),
+                                    top + rng() % (GPU::VRAM_HEIGHT - top));
+
+      GPUBackendSetDrawingAreaCommand* area_cmd = backend.NewSetDrawingAreaCommand();
+      area_cmd->params.bits = 0;
+      area_cmd->new_area = area;
+      backend.PushCommand(area_cmd);
+    }
+
+    // Mostly small primitives, with the occasional one which is too large to draw.
+    const s32 center_x = static_cast<s32>(area.left + rng() % (area.GetWidth() + 1));
+    const s32 center_y = static_cast<s32>(area.top + rng() % (area.GetHeight() + 1));
+    const s32 size = 1 << (rng() % 10);
+
+    const u32 type = rng() % 8;
+    if (type < 5)
+    {
+      GPUBackendDrawPolygonCommand* cmd = backend.NewDrawPolygonCommand();
+      FillDrawCommand(cmd, rng, GPU::Primitive::Polygon);
+      cmd->num_vertices = (type < 2) ? 4 : 3;
+      cmd->rc.quad_polygon = (cmd->num_vertices == 4);
+      for (u32 j = 0; j < cmd->num_vertices; j++)
+        SetVertex(&cmd->vertices[j], rng, center_x, center_y, size);
+      backend.PushCommand(cmd);
+    }
+    else if (type < 7)
+    {
+      GPUBackendDrawRectangleCommand* cmd = backend.NewDrawRectangleCommand();
+      FillDrawCommand(cmd, rng, GPU::Primitive::Rectangle);
+      cmd->x = center_x - size / 2;
+      cmd->y = center_y - size / 2;
+      cmd->width = static_cast<u16>(1 + rng() % static_cast<u32>(size * 2));
+      cmd->height = static_cast<u16>(1 + rng() % static_cast<u32>(size));
+      cmd->color_r = static_cast<u8>(rng());
+      cmd->color_g = static_cast<u8>(rng());
+      cmd->color_b = static_cast<u8>(rng());
+      cmd->texcoord_x = static_cast<u8>(rng());
+      cmd->texcoord_y = static_cast<u8>(rng());
+      backend.PushCommand(cmd);
+    }
+    else
+    {
+      const u32 num_vertices = 2 + rng() % 4;
+      GPUBackendDrawLineCommand* cmd = backend.NewDrawLineCommand(num_vertices);
+      FillDrawCommand(cmd, rng, GPU::Primitive::Line);
+      cmd->rc.polyline = (num_vertices > 2);
+      cmd->num_vertices = num_vertices;
+      for (u32 j = 0; j < num_vertices; j++)
+        SetVertex(&cmd->GetVertices()[j], rng, center_x, center_y, size);
+      backend.PushCommand(cmd);
+    }
+  }
+
+  backend.Sync();
+}
+
+static void DrawStreamWithConfig(GPU_SW_Backend& backend, const Config& config, u32 seed, u32 num_commands)
+{
+  backend.SetRasterizerThreadCount(config.num_threads);
+  backend.SetUseEdgeWalking(config.edge_walking);
+  backend.SetUseVectorShading(config.vector_shading);
+  backend.SetUseTextureCache(config.texture_cache);
+  backend.Reset();
+  DrawStream(backend, seed, num_commands);
+}
+
+int main(int argc, char* argv[])
+{
+  const u32 num_streams = (argc > 1) ? static_cast<u32>(std::max(std::atoi(argv[1]), 1)) : 20;
+  const u32 num_commands = (argc > 2) ? static_cast<u32>(std::max(std::atoi(argv[2]), 1)) : 5000;
+
+  static constexpr Config reference_config = {"reference", 1, false, false, false};
+  static constexpr Config configs[] = {
+    {"scalar, 1 thread", 1, true, false, false},
+    {"scalar, 1 thread, cached", 1, true, false, true},
+    {"vector, 1 thread", 1, true, true, false},
+    {"vector, 1 thread, cached", 1, true, true, true},
+    {"vector, 2 threads, cached", 2, true, true, true},
+    {"vector, 4 threads, cached", 4, true, true, true},
+    {"vector, 8 threads, cached", 8, true, true, true},
+  };
+
+  std::unique_ptr<GPU_SW_Backend> backend = std::make_unique<GPU_SW_Backend>();
+  backend->SetUseThread(true);
+
+  std::vector<u16> reference_vram;
+  u32 num_mismatches = 0;
+  for (u32 seed = 1; seed <= num_streams; seed++)
+  {
+    DrawStreamWithConfig(*backend, reference_config, seed, num_commands);
+    reference_vram.assign(backend->GetVRAM(), backend->GetVRAM() + GPU::VRAM_WIDTH * GPU::VRAM_HEIGHT);
+
+    for (const Config& config : configs)
+    {
+      DrawStreamWithConfig(*backend, config, seed, num_commands);
+
+      const u16* vram = backend->GetVRAM();
+      u32 first_index = 0;
+      u32 num_pixels = 0;
+      for (u32 i = 0; i < GPU::VRAM_WIDTH * GPU::VRAM_HEIGHT; i++)
+      {
+        if (vram[i] != reference_vram[i])
+          first_index = (num_pixels++ == 0) ? i : first_index;
+      }
+      if (num_pixels == 0)
+        continue;
+
+      std::printf("stream %u, %s: %u pixels differ, first at (%u, %u) is %04X, expected %04X\n", seed, config.name,
+                  num_pixels, first_index % GPU::VRAM_WIDTH, first_index / GPU::VRAM_WIDTH, vram[first_index],
+                  reference_vram[first_index]);
+      num_mismatches++;
+    }
+  }
+
+  std::printf("%u streams of %u commands, %u mismatches\n", num_streams, num_commands, num_mismatches);
+  return (num_mismatches == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
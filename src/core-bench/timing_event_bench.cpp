@@ -0,0 +1,57 @@
+#include "common/file_system.h"
+#include "common/log.h"
+#include "common/timer.h"
+#include "core/timing_event.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+// Replays a timing event trace recorded with the "Toggle Timing Event Trace" hotkey, and reports the scheduling cost.
+int main(int argc, char* argv[])
+{
+  if (argc < 2)
+  {
+    std::fprintf(stderr, "Usage: %s <trace file> [iterations]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  const u32 iterations = (argc > 2) ? static_cast<u32>(std::max(std::atoi(argv[2]), 1)) : 10;
+
+  std::optional<std::vector<u8>> data = FileSystem::ReadBinaryFile(argv[1]);
+  if (!data.has_value())
+  {
+    std::fprintf(stderr, "Failed to read '%s'\n", argv[1]);
+    return EXIT_FAILURE;
+  }
+
+  TimingEvents::TraceReplayStats stats;
+  if (!TimingEvents::ReplayTrace(data->data(), static_cast<u32>(data->size()), &stats))
+  {
+    std::fprintf(stderr, "'%s' is not a valid timing event trace\n", argv[1]);
+    return EXIT_FAILURE;
+  }
+
+  std::printf("%u operations, %u RunEvents() calls, %u callbacks\n", stats.num_operations, stats.num_run_events,
+              stats.num_callbacks);
+  if (stats.diverged)
+    std::printf("WARNING: Replay diverged from the recording, timings only cover the matching part.\n");
+
+  double best_time = 0.0;
+  double total_time = 0.0;
+  for (u32 i = 0; i < iterations; i++)
+  {
+    Common::Timer timer;
+    TimingEvents::ReplayTrace(data->data(), static_cast<u32>(data->size()), &stats);
+    const double time = timer.GetTimeNanoseconds();
+    best_time = (i == 0) ? time : std::min(best_time, time);
+    total_time += time;
+  }
+
+  const double num_run_events = static_cast<double>(std::max<u32>(stats.num_run_events, 1));
+  const double num_operations = static_cast<double>(std::max<u32>(stats.num_operations, 1));
+  std::printf("%u iterations: best %.3f ms, average %.3f ms\n", iterations, best_time / 1000000.0,
+              total_time / iterations / 1000000.0);
+  std::printf("%.1f ns per RunEvents(), %.1f ns per operation\n", best_time / num_run_events,
+              best_time / num_operations);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,435 @@
+#include "bios_hle.h"
+#include "bus.h"
+#include "common/log.h"
+#include "common/string_util.h"
+#include "cpu_core.h"
+#include "settings.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+Log_SetChannel(BIOS::HLE);
+
+namespace BIOS::HLE {
+
+using Handler = bool (*)();
+
+struct FunctionInfo
+{
+  Table table;
+  u8 index;
+  const char* name;
+  Handler handler;
+};
+
+// Approximate cost of the jump table dispatch and function prologue/epilogue in the BIOS.
+static constexpr TickCount CALL_OVERHEAD_TICKS = 20;
+
+// Approximate cost per byte of the BIOS byte-wise loops (load, store, increment, branch, plus ROM fetches).
+static constexpr TickCount TICKS_PER_BYTE = 8;
+
+// The kernel keeps the rand() seed at a fixed location in RAM.
+static constexpr PhysicalMemoryAddress RAND_SEED_ADDRESS = 0x9010;
+
+// The A table is at a fixed location, the kernel keeps pointers to the B and C tables in RAM.
+static constexpr PhysicalMemoryAddress A_TABLE_ADDRESS = 0x200;
+static constexpr PhysicalMemoryAddress B_TABLE_POINTER_ADDRESS = 0x874;
+static constexpr PhysicalMemoryAddress C_TABLE_POINTER_ADDRESS = 0x674;
+
+static bool IsTableEntryInBIOS(u32 table_index, u32 function_index);
+
+static bool HLE_strcmp();
+static bool HLE_strcpy();
+static bool HLE_strlen();
+static bool HLE_toupper();
+static bool HLE_tolower();
+static bool HLE_bzero();
+static bool HLE_memcpy();
+static bool HLE_memset();
+static bool HLE_rand();
+static bool HLE_srand();
+
+static constexpr std::array<FunctionInfo, 10> s_functions = {{
+  {Table::A0, 0x17, "strcmp", HLE_strcmp},
+  {Table::A0, 0x19, "strcpy", HLE_strcpy},
+  {Table::A0, 0x1B, "strlen", HLE_strlen},
+  {Table::A0, 0x25, "toupper", HLE_toupper},
+  {Table::A0, 0x26, "tolower", HLE_tolower},
+  {Table::A0, 0x28, "bzero", HLE_bzero},
+  {Table::A0, 0x2A, "memcpy", HLE_memcpy},
+  {Table::A0, 0x2B, "memset", HLE_memset},
+  {Table::A0, 0x2F, "rand", HLE_rand},
+  {Table::A0, 0x30, "srand", HLE_srand},
+}};
+
+static std::array<std::array<Handler, FUNCTIONS_PER_TABLE>, static_cast<u32>(Table::Count)> s_handlers = {};
+static std::array<std::array<FunctionStats, FUNCTIONS_PER_TABLE>, static_cast<u32>(Table::Count)> s_stats = {};
+static bool s_enabled = false;
+
+void Initialize()
+{
+  ResetStatistics();
+  UpdateSettings();
+}
+
+void Shutdown()
+{
+  if (s_enabled)
+    LogStatistics();
+
+  for (auto& table : s_handlers)
+    table.fill(nullptr);
+  s_enabled = false;
+}
+
+void UpdateSettings()
+{
+  for (auto& table : s_handlers)
+    table.fill(nullptr);
+  s_enabled = false;
+
+  if (!g_settings.cpu_bios_hle)
+    return;
+
+  const std::string& list = g_settings.cpu_bios_hle_functions;
+  std::string::size_type pos = 0;
+  while (pos < list.size())
+  {
+    std::string::size_type end = list.find(',', pos);
+    if (end == std::string::npos)
+      end = list.size();
+
+    std::string name(list, pos, end - pos);
+    pos = end + 1;
+
+    // trim whitespace
+    name.erase(0, name.find_first_not_of(" \t"));
+    name.erase(name.find_last_not_of(" \t") + 1);
+    if (name.empty())
+      continue;
+
+    bool found = false;
+    for (const FunctionInfo& fi : s_functions)
+    {
+      if (StringUtil::Strcasecmp(fi.name, name.c_str()) == 0)
+      {
+        s_handlers[static_cast<u32>(fi.table)][fi.index] = fi.handler;
+        s_enabled = true;
+        found = true;
+        break;
+      }
+    }
+
+    if (!found)
+      Log_WarningPrintf("Unknown or unsupported BIOS HLE function '%s'", name.c_str());
+  }
+}
+
+bool IsEnabled()
+{
+  return s_enabled;
+}
+
+bool Dispatch()
+{
+  const u32 table_index = ((CPU::g_state.regs.pc & UINT32_C(0xFF)) - 0xA0) >> 4;
+  const u32 function_index = CPU::g_state.regs.t1;
+  if (function_index >= FUNCTIONS_PER_TABLE)
+    return false;
+
+  FunctionStats& stats = s_stats[table_index][function_index];
+  stats.calls++;
+
+  // Can't safely skip the BIOS code if there is an outstanding load delay, or writes wouldn't reach memory.
+  const Handler handler = s_handlers[table_index][function_index];
+  if (!handler || CPU::g_state.load_delay_reg != CPU::Reg::count ||
+      CPU::g_state.next_load_delay_reg != CPU::Reg::count || CPU::g_state.cop0_regs.sr.Isc)
+  {
+    return false;
+  }
+
+  // Leave functions which the game or a kernel patch has replaced to the replacement.
+  if (!IsTableEntryInBIOS(table_index, function_index))
+    return false;
+
+  if (!handler())
+    return false;
+
+  stats.intercepted++;
+  CPU::g_state.regs.pc = CPU::g_state.regs.ra;
+  return true;
+}
+
+const char* GetFunctionName(Table table, u32 index)
+{
+  for (const FunctionInfo& fi : s_functions)
+  {
+    if (fi.table == table && fi.index == index)
+      return fi.name;
+  }
+
+  return nullptr;
+}
+
+const FunctionStats& GetFunctionStats(Table table, u32 index)
+{
+  return s_stats[static_cast<u32>(table)][index];
+}
+
+void ResetStatistics()
+{
+  for (auto& table : s_stats)
+    table.fill(FunctionStats{});
+}
+
+void LogStatistics()
+{
+  static constexpr std::array<char, static_cast<u32>(Table::Count)> table_names = {{'A', 'B', 'C'}};
+
+  for (u32 table = 0; table < static_cast<u32>(Table::Count); table++)
+  {
+    for (u32 index = 0; index < FUNCTIONS_PER_TABLE; index++)
+    {
+      const FunctionStats& stats = s_stats[table][index];
+      if (stats.calls == 0)
+        continue;
+
+      const char* name = GetFunctionName(static_cast<Table>(table), index);
+      Log_InfoPrintf("%c(%02Xh) %-8s: %u calls, %u intercepted", table_names[table], index, name ? name : "",
+                     stats.calls, stats.intercepted);
+    }
+  }
+}
+
+/// Translates a guest pointer to a RAM offset. Returns false if the range is outside of RAM or crosses a mirror.
+static bool GetRAMRange(VirtualMemoryAddress address, u32 length, u32* offset)
+{
+  const PhysicalMemoryAddress phys_addr = address & CPU::PHYSICAL_MEMORY_ADDRESS_MASK;
+  if (address == 0 || !Bus::IsRAMAddress(phys_addr))
+    return false;
+
+  const u32 ram_offset = phys_addr & Bus::RAM_MASK;
+  if (length > (Bus::RAM_SIZE - ram_offset))
+    return false;
+
+  *offset = ram_offset;
+  return true;
+}
+
+/// Returns true if the jump table entry for the function still points at the BIOS ROM.
+static bool IsTableEntryInBIOS(u32 table_index, u32 function_index)
+{
+  u32 table_address = A_TABLE_ADDRESS;
+  if (table_index != static_cast<u32>(Table::A0))
+  {
+    std::memcpy(&table_address,
+                &Bus::g_ram[(table_index == static_cast<u32>(Table::B0)) ? B_TABLE_POINTER_ADDRESS :
+                                                                           C_TABLE_POINTER_ADDRESS],
+                sizeof(table_address));
+  }
+
+  u32 offset;
+  if (!GetRAMRange(table_address + function_index * sizeof(u32), sizeof(u32), &offset))
+    return false;
+
+  u32 entry;
+  std::memcpy(&entry, &Bus::g_ram[offset], sizeof(entry));
+  const PhysicalMemoryAddress phys_addr = entry & CPU::PHYSICAL_MEMORY_ADDRESS_MASK;
+  return (phys_addr >= Bus::BIOS_BASE && phys_addr < (Bus::BIOS_BASE + Bus::BIOS_SIZE));
+}
+
+/// Finds the length of a NUL-terminated string in RAM. Returns false if the string runs off the end of RAM.
+static bool GetRAMStringLength(VirtualMemoryAddress address, u32* offset, u32* length)
+{
+  if (!GetRAMRange(address, 0, offset))
+    return false;
+
+  const void* terminator = std::memchr(&Bus::g_ram[*offset], 0, Bus::RAM_SIZE - *offset);
+  if (!terminator)
+    return false;
+
+  *length = static_cast<u32>(static_cast<const u8*>(terminator) - &Bus::g_ram[*offset]);
+  return true;
+}
+
+/// Invalidates any compiled blocks in the range being written.
+static void InvalidateRAMRange(u32 offset, u32 length)
+{
+  if (length == 0)
+    return;
+
+  const u32 start_page = offset / CPU_CODE_CACHE_PAGE_SIZE;
+  const u32 end_page = (offset + length - 1) / CPU_CODE_CACHE_PAGE_SIZE;
+  for (u32 page = start_page; page <= end_page; page++)
+  {
+    if (Bus::m_ram_code_bits[page])
+      CPU::CodeCache::InvalidateBlocksWithPageIndex(page);
+  }
+}
+
+static void ChargeTicks(u32 bytes)
+{
+  CPU::AddPendingTicks(CALL_OVERHEAD_TICKS + static_cast<TickCount>(bytes) * TICKS_PER_BYTE);
+}
+
+bool HLE_strcmp()
+{
+  auto& regs = CPU::g_state.regs;
+  u32 offset1, offset2, length1, length2;
+  if (!GetRAMStringLength(regs.a0, &offset1, &length1) || !GetRAMStringLength(regs.a1, &offset2, &length2))
+    return false;
+
+  const u32 length = std::min(length1, length2) + 1;
+  u32 pos = 0;
+  while (pos < length && Bus::g_ram[offset1 + pos] == Bus::g_ram[offset2 + pos])
+    pos++;
+
+  s32 result = 0;
+  if (pos < length)
+  {
+    // The sign of bytes >= 0x80 depends on how the BIOS loads them, so leave those to the real thing.
+    const u8 c1 = Bus::g_ram[offset1 + pos];
+    const u8 c2 = Bus::g_ram[offset2 + pos];
+    if (c1 >= 0x80 || c2 >= 0x80)
+      return false;
+
+    result = static_cast<s32>(c1) - static_cast<s32>(c2);
+  }
+
+  regs.v0 = static_cast<u32>(result);
+  ChargeTicks(std::min(pos + 1, length));
+  return true;
+}
+
+bool HLE_strcpy()
+{
+  auto& regs = CPU::g_state.regs;
+  u32 src_offset, length, dst_offset;
+  if (!GetRAMStringLength(regs.a1, &src_offset, &length) || !GetRAMRange(regs.a0, length + 1, &dst_offset))
+    return false;
+
+  // Overlapping copies depend on the copy direction.
+  if (dst_offset < (src_offset + length + 1) && src_offset < (dst_offset + length + 1))
+    return false;
+
+  InvalidateRAMRange(dst_offset, length + 1);
+  std::memcpy(&Bus::g_ram[dst_offset], &Bus::g_ram[src_offset], length + 1);
+  regs.v0 = regs.a0;
+  ChargeTicks(length + 1);
+  return true;
+}
+
+bool HLE_strlen()
+{
+  auto& regs = CPU::g_state.regs;
+  u32 offset, length;
+  if (!GetRAMStringLength(regs.a0, &offset, &length))
+    return false;
+
+  regs.v0 = length;
+  ChargeTicks(length);
+  return true;
+}
+
+bool HLE_toupper()
+{
+  auto& regs = CPU::g_state.regs;
+  if (regs.a0 >= 0x80)
+    return false;
+
+  regs.v0 = (regs.a0 >= 'a' && regs.a0 <= 'z') ? (regs.a0 - 0x20) : regs.a0;
+  ChargeTicks(0);
+  return true;
+}
+
+bool HLE_tolower()
+{
+  auto& regs = CPU::g_state.regs;
+  if (regs.a0 >= 0x80)
+    return false;
+
+  regs.v0 = (regs.a0 >= 'A' && regs.a0 <= 'Z') ? (regs.a0 + 0x20) : regs.a0;
+  ChargeTicks(0);
+  return true;
+}
+
+bool HLE_bzero()
+{
+  auto& regs = CPU::g_state.regs;
+  const u32 length = regs.a1;
+  u32 offset;
+  if (static_cast<s32>(length) <= 0 || !GetRAMRange(regs.a0, length, &offset))
+    return false;
+
+  InvalidateRAMRange(offset, length);
+  std::memset(&Bus::g_ram[offset], 0, length);
+  regs.v0 = regs.a0;
+  ChargeTicks(length);
+  return true;
+}
+
+bool HLE_memcpy()
+{
+  auto& regs = CPU::g_state.regs;
+  const u32 length = regs.a2;
+  u32 dst_offset, src_offset;
+  if (static_cast<s32>(length) <= 0 || !GetRAMRange(regs.a0, length, &dst_offset) ||
+      !GetRAMRange(regs.a1, length, &src_offset))
+  {
+    return false;
+  }
+
+  InvalidateRAMRange(dst_offset, length);
+  if (dst_offset > src_offset && dst_offset < (src_offset + length))
+  {
+    // The BIOS copies forwards a byte at a time, so overlapping copies replicate the source.
+    for (u32 i = 0; i < length; i++)
+      Bus::g_ram[dst_offset + i] = Bus::g_ram[src_offset + i];
+  }
+  else
+  {
+    std::memmove(&Bus::g_ram[dst_offset], &Bus::g_ram[src_offset], length);
+  }
+
+  regs.v0 = regs.a0;
+  ChargeTicks(length);
+  return true;
+}
+
+bool HLE_memset()
+{
+  auto& regs = CPU::g_state.regs;
+  const u32 length = regs.a2;
+  u32 offset;
+  if (static_cast<s32>(length) <= 0 || !GetRAMRange(regs.a0, length, &offset))
+    return false;
+
+  InvalidateRAMRange(offset, length);
+  std::memset(&Bus::g_ram[offset], static_cast<u8>(regs.a1), length);
+  regs.v0 = regs.a0;
+  ChargeTicks(length);
+  return true;
+}
+
+bool HLE_rand()
+{
+  u32 seed;
+  std::memcpy(&seed, &Bus::g_ram[RAND_SEED_ADDRESS], sizeof(seed));
+  seed = seed * UINT32_C(0x41C64E6D) + UINT32_C(0x3039);
+  InvalidateRAMRange(RAND_SEED_ADDRESS, sizeof(seed));
+  std::memcpy(&Bus::g_ram[RAND_SEED_ADDRESS], &seed, sizeof(seed));
+
+  CPU::g_state.regs.v0 = (seed >> 16) & UINT32_C(0x7FFF);
+  ChargeTicks(0);
+  return true;
+}
+
+bool HLE_srand()
+{
+  const u32 seed = CPU::g_state.regs.a0;
+  InvalidateRAMRange(RAND_SEED_ADDRESS, sizeof(seed));
+  std::memcpy(&Bus::g_ram[RAND_SEED_ADDRESS], &seed, sizeof(seed));
+  ChargeTicks(0);
+  return true;
+}
+
+} // namespace BIOS::HLE
@@ -0,0 +1,51 @@
+#pragma once
+#include "types.h"
+
+namespace BIOS::HLE {
+
+enum class Table : u8
+{
+  A0,
+  B0,
+  C0,
+  Count
+};
+
+enum : u32
+{
+  FUNCTIONS_PER_TABLE = 256
+};
+
+struct FunctionStats
+{
+  u32 calls;        // number of times the function was called through the jump table
+  u32 intercepted;  // number of times the call was handled natively
+};
+
+void Initialize();
+void Shutdown();
+
+/// Rebuilds the allowlist from the current settings.
+void UpdateSettings();
+
+/// Returns true if any function is intercepted, i.e. the dispatch check is needed.
+bool IsEnabled();
+
+/// Returns true if the specified address is one of the kernel jump table entry points.
+ALWAYS_INLINE bool IsDispatchAddress(VirtualMemoryAddress pc)
+{
+  const u32 masked = pc & UINT32_C(0x1FFFFFFF);
+  return (masked == 0xA0 || masked == 0xB0 || masked == 0xC0);
+}
+
+/// Tries to execute the BIOS call at the current PC natively. Returns false if it should fall through to the BIOS.
+bool Dispatch();
+
+/// Returns the name of the function, or nullptr if it is unknown.
+const char* GetFunctionName(Table table, u32 index);
+
+const FunctionStats& GetFunctionStats(Table table, u32 index);
+void ResetStatistics();
+void LogStatistics();
+
+} // namespace BIOS::HLE
@@ -2,6 +2,7 @@
 #include "cdrom.h"
 #include "common/align.h"
 #include "common/assert.h"
+#include "common/file_system.h"
 #include "common/log.h"
 #include "common/state_wrapper.h"
 #include "cpu_code_cache.h"
@@ -9,13 +10,16 @@
 #include "cpu_disasm.h"
 #include "dma.h"
 #include "gpu.h"
+#include "host_interface.h"
 #include "interrupt_controller.h"
 #include "mdec.h"
 #include "pad.h"
 #include "sio.h"
 #include "spu.h"
 #include "timers.h"
+#include <cinttypes>
 #include <cstdio>
+#include <imgui.h>
 #include <tuple>
 Log_SetChannel(Bus);
 
@@ -84,6 +88,12 @@ static u32 m_ram_size_reg = 0;
 
 static std::string m_tty_line_buffer;
 
+enum : u32
+{
+  IO_STATS_BASE = MEMCTRL_BASE,
+  IO_STATS_SIZE = EXP2_BASE - MEMCTRL_BASE
+};
+
 static std::tuple<TickCount, TickCount, TickCount> CalculateMemoryTiming(MEMDELAY mem_delay, COMDELAY common_delay);
 static void RecalculateMemoryTimings();
 
@@ -737,6 +747,277 @@ ALWAYS_INLINE static TickCount DoDMAAccess(u32 offset, u32& value)
   }
 }
 
+static std::array<u32, IO_STATS_SIZE> s_io_frame_reads = {};
+static std::array<u32, IO_STATS_SIZE> s_io_frame_writes = {};
+static std::array<u32, IO_STATS_SIZE> s_io_last_frame_reads = {};
+static std::array<u32, IO_STATS_SIZE> s_io_last_frame_writes = {};
+static std::array<u64, IO_STATS_SIZE> s_io_total_reads = {};
+static std::array<u64, IO_STATS_SIZE> s_io_total_writes = {};
+static std::array<u32, IO_STATS_SIZE> s_io_last_read_pc = {};
+static std::array<u32, IO_STATS_SIZE> s_io_last_write_pc = {};
+static u32 s_io_stats_frames = 0;
+
+template<MemoryAccessType type>
+ALWAYS_INLINE static void RecordIOAccess(PhysicalMemoryAddress address)
+{
+  const u32 offset = address - IO_STATS_BASE;
+  if (offset >= IO_STATS_SIZE)
+    return;
+
+  if constexpr (type == MemoryAccessType::Read)
+  {
+    s_io_frame_reads[offset]++;
+    s_io_last_read_pc[offset] = CPU::g_state.current_instruction_pc;
+  }
+  else
+  {
+    s_io_frame_writes[offset]++;
+    s_io_last_write_pc[offset] = CPU::g_state.current_instruction_pc;
+  }
+}
+
+static void GetIORegisterName(u32 offset, char* buf, u32 buf_size)
+{
+  static constexpr std::array<const char*, MEMCTRL_REG_COUNT> memctrl_names = {
+    {"EXP1_BASE", "EXP2_BASE", "EXP1_DELAY", "EXP3_DELAY", "BIOS_DELAY", "SPU_DELAY", "CDROM_DELAY", "EXP2_DELAY",
+     "COM_DELAY"}};
+  static constexpr std::array<const char*, 7> dma_channel_names = {
+    {"MDECin", "MDECout", "GPU", "CDROM", "SPU", "PIO", "OTC"}};
+  static constexpr std::array<const char*, 8> spu_voice_reg_names = {
+    {"VOL_L", "VOL_R", "PITCH", "START", "ADSR_LO", "ADSR_HI", "ADSR_VOL", "REPEAT"}};
+  static constexpr std::array<const char*, 32> spu_control_reg_names = {
+    {"MAIN_VOL_L", "MAIN_VOL_R", "REVERB_VOL_L", "REVERB_VOL_R", "KON_LO",       "KON_HI",        "KOFF_LO",
+     "KOFF_HI",    "PMON_LO",    "PMON_HI",      "NON_LO",       "NON_HI",       "EON_LO",        "EON_HI",
+     "ENDX_LO",    "ENDX_HI",    "UNKNOWN_DA0",  "REVERB_BASE",  "IRQ_ADDR",     "TRANSFER_ADDR", "TRANSFER_FIFO",
+     "SPUCNT",     "TRANSFER_CTRL", "SPUSTAT",   "CD_VOL_L",     "CD_VOL_R",     "EXT_VOL_L",     "EXT_VOL_R",
+     "CUR_VOL_L",  "CUR_VOL_R",  "UNKNOWN_DBC",  "UNKNOWN_DBE"}};
+
+  const u32 address = IO_STATS_BASE + offset;
+  if (address < (MEMCTRL_BASE + MEMCTRL_SIZE))
+  {
+    const u32 index = (address - MEMCTRL_BASE) / 4;
+    std::snprintf(buf, buf_size, "%s", (index < MEMCTRL_REG_COUNT) ? memctrl_names[index] : "MEMCTRL");
+  }
+  else if (address < (SIO_BASE + SIO_SIZE))
+  {
+    static constexpr std::array<const char*, 16> sio_reg_names = {
+      {"DATA", "DATA", "DATA", "DATA", "STAT", "STAT", "STAT", "STAT", "MODE", "MODE", "CTRL", "CTRL", "MISC", "MISC",
+       "BAUD", "BAUD"}};
+    std::snprintf(buf, buf_size, "%s_%s", (address < SIO_BASE) ? "JOY" : "SIO", sio_reg_names[address & 0xF]);
+  }
+  else if (address < (MEMCTRL2_BASE + MEMCTRL2_SIZE))
+  {
+    std::snprintf(buf, buf_size, "RAM_SIZE");
+  }
+  else if (address < (INTERRUPT_CONTROLLER_BASE + INTERRUPT_CONTROLLER_SIZE))
+  {
+    std::snprintf(buf, buf_size, "%s", ((address & 0xF) < 4) ? "I_STAT" : "I_MASK");
+  }
+  else if (address < (DMA_BASE + DMA_SIZE))
+  {
+    const u32 channel = (address - DMA_BASE) / 0x10;
+    const u32 reg = (address & 0xF) / 4;
+    if (channel < dma_channel_names.size())
+    {
+      static constexpr std::array<const char*, 4> reg_names = {{"MADR", "BCR", "CHCR", "UNKNOWN"}};
+      std::snprintf(buf, buf_size, "DMA_%s_%s", dma_channel_names[channel], reg_names[reg]);
+    }
+    else
+    {
+      static constexpr std::array<const char*, 4> reg_names = {{"DPCR", "DICR", "UNKNOWN_F8", "UNKNOWN_FC"}};
+      std::snprintf(buf, buf_size, "DMA_%s", reg_names[reg]);
+    }
+  }
+  else if (address < (TIMERS_BASE + TIMERS_SIZE))
+  {
+    static constexpr std::array<const char*, 4> reg_names = {{"COUNT", "MODE", "TARGET", "UNKNOWN"}};
+    std::snprintf(buf, buf_size, "TIMER%u_%s", (address - TIMERS_BASE) / 0x10, reg_names[(address & 0xF) / 4]);
+  }
+  else if (address >= CDROM_BASE && address < (CDROM_BASE + CDROM_SIZE))
+  {
+    // Registers 1-3 depend on the index.
+    if ((address & 3) == 0)
+      std::snprintf(buf, buf_size, "CDROM_INDEX/STATUS");
+    else
+      std::snprintf(buf, buf_size, "CDROM_REG%u", address & 3);
+  }
+  else if (address >= GPU_BASE && address < (GPU_BASE + GPU_SIZE))
+  {
+    std::snprintf(buf, buf_size, "%s", ((address & 0xF) < 4) ? "GP0/GPUREAD" : "GP1/GPUSTAT");
+  }
+  else if (address >= MDEC_BASE && address < (MDEC_BASE + MDEC_SIZE))
+  {
+    std::snprintf(buf, buf_size, "%s", ((address & 0xF) < 4) ? "MDEC_DATA" : "MDEC_CONTROL/STATUS");
+  }
+  else if (address >= SPU_BASE && address < (SPU_BASE + 0x180))
+  {
+    const u32 spu_offset = address - SPU_BASE;
+    std::snprintf(buf, buf_size, "SPU_VOICE%u_%s", spu_offset / 0x10, spu_voice_reg_names[(spu_offset & 0xF) / 2]);
+  }
+  else if (address >= (SPU_BASE + 0x180) && address < (SPU_BASE + 0x1C0))
+  {
+    std::snprintf(buf, buf_size, "SPU_%s", spu_control_reg_names[(address - (SPU_BASE + 0x180)) / 2]);
+  }
+  else if (address >= (SPU_BASE + 0x1C0) && address < (SPU_BASE + 0x200))
+  {
+    std::snprintf(buf, buf_size, "SPU_REVERB_%u", (address - (SPU_BASE + 0x1C0)) / 2);
+  }
+  else if (address >= SPU_BASE && address < (SPU_BASE + SPU_SIZE))
+  {
+    std::snprintf(buf, buf_size, "SPU_INTERNAL_%03X", address - SPU_BASE);
+  }
+  else
+  {
+    std::snprintf(buf, buf_size, "UNKNOWN");
+  }
+}
+
+void UpdateIOAccessStatistics()
+{
+  s_io_last_frame_reads = s_io_frame_reads;
+  s_io_last_frame_writes = s_io_frame_writes;
+  for (u32 i = 0; i < IO_STATS_SIZE; i++)
+  {
+    s_io_total_reads[i] += s_io_frame_reads[i];
+    s_io_total_writes[i] += s_io_frame_writes[i];
+  }
+
+  s_io_frame_reads.fill(0);
+  s_io_frame_writes.fill(0);
+  s_io_stats_frames++;
+}
+
+void ResetIOAccessStatistics()
+{
+  s_io_frame_reads.fill(0);
+  s_io_frame_writes.fill(0);
+  s_io_last_frame_reads.fill(0);
+  s_io_last_frame_writes.fill(0);
+  s_io_total_reads.fill(0);
+  s_io_total_writes.fill(0);
+  s_io_last_read_pc.fill(0);
+  s_io_last_write_pc.fill(0);
+  s_io_stats_frames = 0;
+}
+
+bool ExportIOAccessStatistics(const char* filename)
+{
+  std::FILE* fp = FileSystem::OpenCFile(filename, "wb");
+  if (!fp)
+  {
+    Log_ErrorPrintf("Failed to open '%s' for writing", filename);
+    return false;
+  }
+
+  std::fprintf(fp, "Address,Register,Reads,Writes,ReadsPerFrame,WritesPerFrame,LastReadPC,LastWritePC\n");
+
+  const double frames = static_cast<double>(std::max<u32>(s_io_stats_frames, 1));
+  char name[64];
+  for (u32 i = 0; i < IO_STATS_SIZE; i++)
+  {
+    if (s_io_total_reads[i] == 0 && s_io_total_writes[i] == 0)
+      continue;
+
+    GetIORegisterName(i, name, sizeof(name));
+    std::fprintf(fp, "%08X,%s,%" PRIu64 ",%" PRIu64 ",%.2f,%.2f,%08X,%08X\n", IO_STATS_BASE + i, name,
+                 s_io_total_reads[i], s_io_total_writes[i], static_cast<double>(s_io_total_reads[i]) / frames,
+                 static_cast<double>(s_io_total_writes[i]) / frames, s_io_last_read_pc[i], s_io_last_write_pc[i]);
+  }
+
+  std::fclose(fp);
+  Log_InfoPrintf("Wrote I/O access statistics for %u frames to '%s'", s_io_stats_frames, filename);
+  return true;
+}
+
+void DrawIOAccessStatisticsWindow()
+{
+  static constexpr u32 MAX_ROWS = 128;
+
+  const float framebuffer_scale = ImGui::GetIO().DisplayFramebufferScale.x;
+
+  ImGui::SetNextWindowSize(ImVec2(700.0f * framebuffer_scale, 500.0f * framebuffer_scale), ImGuiCond_FirstUseEver);
+  if (!ImGui::Begin("I/O Access Statistics", &g_settings.debugging.show_io_access_statistics))
+  {
+    ImGui::End();
+    return;
+  }
+
+  ImGui::Text("Frames: %u", s_io_stats_frames);
+  ImGui::SameLine();
+  if (ImGui::Button("Reset"))
+    ResetIOAccessStatistics();
+  ImGui::SameLine();
+  if (ImGui::Button("Export CSV"))
+  {
+    const std::string filename = g_host_interface->GetUserDirectoryRelativePath(
+      "dump/io_access_%s.csv", HostInterface::GetTimestampStringForFileName().GetCharArray());
+    if (ExportIOAccessStatistics(filename.c_str()))
+      g_host_interface->AddFormattedOSDMessage(5.0f, "Exported I/O access statistics to '%s'.", filename.c_str());
+  }
+
+  // Sort registers by accesses in the last frame, then by total accesses.
+  std::vector<u32> offsets;
+  for (u32 i = 0; i < IO_STATS_SIZE; i++)
+  {
+    if (s_io_total_reads[i] != 0 || s_io_total_writes[i] != 0)
+      offsets.push_back(i);
+  }
+  std::sort(offsets.begin(), offsets.end(), [](u32 lhs, u32 rhs) {
+    const u32 lhs_frame = s_io_last_frame_reads[lhs] + s_io_last_frame_writes[lhs];
+    const u32 rhs_frame = s_io_last_frame_reads[rhs] + s_io_last_frame_writes[rhs];
+    if (lhs_frame != rhs_frame)
+      return lhs_frame > rhs_frame;
+
+    return (s_io_total_reads[lhs] + s_io_total_writes[lhs]) > (s_io_total_reads[rhs] + s_io_total_writes[rhs]);
+  });
+  if (offsets.size() > MAX_ROWS)
+    offsets.resize(MAX_ROWS);
+
+  ImGui::Separator();
+  ImGui::Columns(7);
+  ImGui::SetColumnWidth(0, 80.0f * framebuffer_scale);
+  ImGui::SetColumnWidth(1, 180.0f * framebuffer_scale);
+  ImGui::TextUnformatted("Address");
+  ImGui::NextColumn();
+  ImGui::TextUnformatted("Register");
+  ImGui::NextColumn();
+  ImGui::TextUnformatted("Reads");
+  ImGui::NextColumn();
+  ImGui::TextUnformatted("Writes");
+  ImGui::NextColumn();
+  ImGui::TextUnformatted("Total");
+  ImGui::NextColumn();
+  ImGui::TextUnformatted("Read PC");
+  ImGui::NextColumn();
+  ImGui::TextUnformatted("Write PC");
+  ImGui::NextColumn();
+
+  char name[64];
+  for (const u32 offset : offsets)
+  {
+    GetIORegisterName(offset, name, sizeof(name));
+    ImGui::Text("%08X", IO_STATS_BASE + offset);
+    ImGui::NextColumn();
+    ImGui::TextUnformatted(name);
+    ImGui::NextColumn();
+    ImGui::Text("%u", s_io_last_frame_reads[offset]);
+    ImGui::NextColumn();
+    ImGui::Text("%u", s_io_last_frame_writes[offset]);
+    ImGui::NextColumn();
+    ImGui::Text("%" PRIu64, s_io_total_reads[offset] + s_io_total_writes[offset]);
+    ImGui::NextColumn();
+    if (s_io_total_reads[offset] != 0)
+      ImGui::Text("%08X", s_io_last_read_pc[offset]);
+    ImGui::NextColumn();
+    if (s_io_total_writes[offset] != 0)
+      ImGui::Text("%08X", s_io_last_write_pc[offset]);
+    ImGui::NextColumn();
+  }
+
+  ImGui::Columns(1);
+  ImGui::End();
+}
+
 } // namespace Bus
 
 namespace CPU {
@@ -846,7 +1127,11 @@ static ALWAYS_INLINE TickCount DoMemoryAccess(VirtualMemoryAddress address, u32&
   {
     return DoRAMAccess<type, size>(address, value);
   }
-  else if (address < EXP1_BASE)
+
+  if (g_settings.debugging.show_io_access_statistics)
+    RecordIOAccess<type>(address);
+
+  if (address < EXP1_BASE)
   {
     return DoInvalidAccess(type, size, address, value);
   }
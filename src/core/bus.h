@@ -74,6 +74,12 @@ bool DoState(StateWrapper& sw);
 void SetExpansionROM(std::vector<u8> data);
 void SetBIOS(const std::vector<u8>& image);
 
+/// I/O register access statistics, collected while the statistics window is open.
+void UpdateIOAccessStatistics();
+void ResetIOAccessStatistics();
+bool ExportIOAccessStatistics(const char* filename);
+void DrawIOAccessStatisticsWindow();
+
 extern std::bitset<CPU_CODE_CACHE_PAGE_COUNT> m_ram_code_bits;
 extern u8 g_ram[RAM_SIZE];   // 2MB RAM
 extern u8 g_bios[BIOS_SIZE]; // 512K BIOS ROM
@@ -1,6 +1,7 @@
 #include "cdrom_async_reader.h"
 #include "common/assert.h"
 #include "common/log.h"
+#include "common/trace_recorder.h"
 #include "common/timer.h"
 Log_SetChannel(CDROMAsyncReader);
 
@@ -137,6 +138,7 @@ bool CDROMAsyncReader::WaitForReadToComplete()
 
 void CDROMAsyncReader::DoSectorRead()
 {
+  TraceRecorder::ScopedSpan trace_span("CDROM Sector Read");
   Common::Timer timer;
 
   if (m_next_position_set.load())
@@ -167,6 +169,8 @@ void CDROMAsyncReader::DoSectorRead()
 
 void CDROMAsyncReader::WorkerThreadEntryPoint()
 {
+  TraceRecorder::SetThreadName("CDROM Reader");
+
   std::unique_lock lock(m_mutex);
 
   while (!m_shutdown_flag.load())
@@ -1,11 +1,18 @@
 #include "cpu_code_cache.h"
+#include "bios_hle.h"
 #include "bus.h"
 #include "common/assert.h"
+#include "common/file_system.h"
 #include "common/log.h"
+#include "common/trace_recorder.h"
 #include "cpu_core.h"
 #include "cpu_disasm.h"
+#include "cpu_validator.h"
+#include "host_interface.h"
+#include "settings.h"
 #include "system.h"
 #include "timing_event.h"
+#include <algorithm>
 Log_SetChannel(CPU::CodeCache);
 
 #ifdef WITH_RECOMPILER
@@ -50,10 +57,52 @@ static void LinkBlock(CodeBlock* from, CodeBlock* to);
 /// Unlink all blocks which point to this block, and any that this block links to.
 static void UnlinkBlock(CodeBlock* block);
 
+/// Adds the execution count of the block to the profile for the running game.
+static void AddBlockToProfile(const CodeBlock* block);
+
+/// Hashes the instruction words of a block for the profile.
+static u64 GetBlockCodeHash(const CodeBlock* block);
+static u64 GetMemoryCodeHash(u32 pc, u32 num_instructions);
+
+struct ProfileEntry
+{
+  u32 key;
+  u32 num_instructions;
+  u64 code_hash;
+  u64 weight;
+};
+
+static constexpr u32 PROFILE_MAGIC = 0x46504244; // DBPF
+static constexpr u32 PROFILE_VERSION = 1;
+static constexpr u32 MAX_PROFILE_ENTRIES = 16384;
+static constexpr u32 MAX_PRECOMPILED_BLOCKS_PER_FRAME = 64;
+static constexpr u32 MAX_PRECOMPILE_CHECKS_PER_FRAME = 1024;
+
 static bool s_use_recompiler = false;
+static bool s_interpret_only = false;
 static BlockMap s_blocks;
 static std::array<std::vector<CodeBlock*>, CPU_CODE_CACHE_PAGE_COUNT> m_ram_block_map;
 
+static std::string s_profile_game_code;
+static std::unordered_map<u32, ProfileEntry> s_profile;
+enum class PrecompileState : u8
+{
+  Pending,
+  Done,
+  Failed
+};
+
+static std::vector<ProfileEntry> s_precompile_queue;
+static std::vector<PrecompileState> s_precompile_state;
+static u32 s_precompile_queue_pos = 0;
+static u32 s_precompile_pending = 0;
+
+/// Indices of the precompile queue entries in each RAM page, so they can be checked again when the page is modified.
+static std::array<std::vector<u32>, CPU_CODE_CACHE_PAGE_COUNT> s_precompile_page_map;
+
+/// Marks every entry in the precompile queue as pending, and restarts from the hottest block.
+static void ResetPrecompileQueue();
+
 void Initialize(bool use_recompiler)
 {
   Assert(s_blocks.empty());
@@ -73,6 +122,10 @@ void Initialize(bool use_recompiler)
 void Shutdown()
 {
   Flush();
+  s_profile_game_code.clear();
+  s_profile.clear();
+  s_precompile_queue.clear();
+  ResetPrecompileQueue();
 #ifdef WITH_RECOMPILER
   s_code_buffer.Destroy();
 #endif
@@ -81,6 +134,9 @@ void Shutdown()
 void Execute()
 {
   CodeBlockKey next_block_key;
+  const bool use_bios_hle = BIOS::HLE::IsEnabled();
+  const bool use_recompiler = s_use_recompiler && !s_interpret_only;
+  const bool validating = Validator::IsActive();
 
   g_state.frame_done = false;
   while (!g_state.frame_done)
@@ -98,6 +154,12 @@ void Execute()
         next_block_key = GetNextBlockKey();
       }
 
+      if (use_bios_hle && BIOS::HLE::IsDispatchAddress(g_state.regs.pc) && BIOS::HLE::Dispatch())
+      {
+        next_block_key = GetNextBlockKey();
+        continue;
+      }
+
       CodeBlock* block = LookupBlock(next_block_key);
       if (!block)
       {
@@ -107,6 +169,7 @@ void Execute()
       }
 
     reexecute_block:
+      block->execution_count++;
 
 #if 0
       const u32 tick = g_system->GetGlobalTickCounter() + m_core->GetPendingTicks();
@@ -118,17 +181,23 @@ void Execute()
       LogCurrentState();
 #endif
 
-      if (s_use_recompiler)
+      if (use_recompiler)
         block->host_code();
       else
         InterpretCachedBlock(*block);
 
+      if (validating)
+        Validator::OnBlockExecuted(*block);
+
       if (g_state.pending_ticks >= g_state.downcount)
         break;
       else if (HasPendingInterrupt() || !USE_BLOCK_LINKING)
         continue;
 
       next_block_key = GetNextBlockKey();
+      if (use_bios_hle && BIOS::HLE::IsDispatchAddress(g_state.regs.pc))
+        continue;
+
       if (next_block_key.bits == block->key.bits)
       {
         // we can jump straight to it if there's no pending interrupts
@@ -186,6 +255,11 @@ void SetUseRecompiler(bool enable)
 #endif
 }
 
+void SetInterpretOnly(bool enable)
+{
+  s_interpret_only = enable;
+}
+
 void Flush()
 {
   Bus::ClearRAMCodePageFlags();
@@ -193,8 +267,15 @@ void Flush()
     it.clear();
 
   for (const auto& it : s_blocks)
+  {
+    if (it.second)
+      AddBlockToProfile(it.second);
     delete it.second;
+  }
   s_blocks.clear();
+
+  // everything needs to be compiled again
+  ResetPrecompileQueue();
 #ifdef WITH_RECOMPILER
   s_code_buffer.Reset();
 #endif
@@ -287,6 +368,8 @@ recompile:
 
 bool CompileBlock(CodeBlock* block)
 {
+  TraceRecorder::ScopedSpan trace_span("Compile Block");
+
   u32 pc = block->GetPC();
   bool is_branch_delay_slot = false;
   bool is_load_delay_slot = false;
@@ -397,6 +480,16 @@ void InvalidateBlocksWithPageIndex(u32 page_index)
   // Block will be re-added next execution.
   blocks.clear();
   Bus::ClearRAMCodePage(page_index);
+
+  // New code may have been loaded over profiled blocks, e.g. on a level change, so they need to be checked again.
+  for (const u32 index : s_precompile_page_map[page_index])
+  {
+    if (s_precompile_state[index] == PrecompileState::Done)
+    {
+      s_precompile_state[index] = PrecompileState::Pending;
+      s_precompile_pending++;
+    }
+  }
 }
 
 void FlushBlock(CodeBlock* block)
@@ -410,6 +503,7 @@ void FlushBlock(CodeBlock* block)
     RemoveBlockFromPageMap(block);
 
   UnlinkBlock(block);
+  AddBlockToProfile(block);
 
   s_blocks.erase(iter);
   delete block;
@@ -471,4 +565,226 @@ void UnlinkBlock(CodeBlock* block)
   block->link_successors.clear();
 }
 
+static std::string GetProfilePath(const std::string& game_code)
+{
+  return g_host_interface->GetUserDirectoryRelativePath("cache/%s.blockprofile", game_code.c_str());
+}
+
+u64 GetBlockCodeHash(const CodeBlock* block)
+{
+  u64 hash = UINT64_C(0xCBF29CE484222325);
+  for (const CodeBlockInstruction& cbi : block->instructions)
+    hash = (hash ^ cbi.instruction.bits) * UINT64_C(0x100000001B3);
+  return hash;
+}
+
+u64 GetMemoryCodeHash(u32 pc, u32 num_instructions)
+{
+  u64 hash = UINT64_C(0xCBF29CE484222325);
+  for (u32 i = 0; i < num_instructions; i++)
+  {
+    const PhysicalMemoryAddress phys_addr = (pc + i * sizeof(u32)) & PHYSICAL_MEMORY_ADDRESS_MASK;
+    if (!Bus::IsCacheableAddress(phys_addr))
+      return 0;
+
+    hash = (hash ^ Bus::ReadCacheableAddress(phys_addr)) * UINT64_C(0x100000001B3);
+  }
+
+  return hash;
+}
+
+void AddBlockToProfile(const CodeBlock* block)
+{
+  if (s_profile_game_code.empty() || block->execution_count == 0 || block->instructions.empty())
+    return;
+
+  const u64 code_hash = GetBlockCodeHash(block);
+  auto iter = s_profile.find(block->key.bits);
+  if (iter == s_profile.end())
+  {
+    s_profile.emplace(block->key.bits, ProfileEntry{block->key.bits, static_cast<u32>(block->instructions.size()),
+                                                    code_hash, block->execution_count});
+  }
+  else if (iter->second.code_hash == code_hash)
+  {
+    iter->second.weight += block->execution_count;
+  }
+  else if (iter->second.weight < block->execution_count)
+  {
+    // overlay code, keep whichever version is hotter
+    iter->second = ProfileEntry{block->key.bits, static_cast<u32>(block->instructions.size()), code_hash,
+                                block->execution_count};
+  }
+}
+
+void LoadProfile(const std::string& game_code)
+{
+  s_profile_game_code = game_code;
+  s_profile.clear();
+  s_precompile_queue.clear();
+  ResetPrecompileQueue();
+  if (game_code.empty() || !g_settings.cpu_precompile_profiled_blocks)
+    return;
+
+  const std::string path = GetProfilePath(game_code);
+  std::optional<std::vector<u8>> data = FileSystem::ReadBinaryFile(path.c_str());
+  if (!data.has_value())
+    return;
+
+  u32 header[3];
+  if (data->size() < sizeof(header))
+    return;
+
+  std::memcpy(header, data->data(), sizeof(header));
+  if (header[0] != PROFILE_MAGIC || header[1] != PROFILE_VERSION ||
+      data->size() != (sizeof(header) + header[2] * sizeof(ProfileEntry)))
+  {
+    Log_WarningPrintf("Block profile '%s' is invalid or from an older version, ignoring.", path.c_str());
+    return;
+  }
+
+  s_precompile_queue.resize(header[2]);
+  std::memcpy(s_precompile_queue.data(), data->data() + sizeof(header), header[2] * sizeof(ProfileEntry));
+  ResetPrecompileQueue();
+
+  // Older runs count for less, so the profile follows the game's current hot spots.
+  for (const ProfileEntry& entry : s_precompile_queue)
+    s_profile.emplace(entry.key, ProfileEntry{entry.key, entry.num_instructions, entry.code_hash, entry.weight / 2});
+
+  Log_InfoPrintf("Loaded block profile for '%s' with %u blocks", game_code.c_str(),
+                 static_cast<u32>(s_precompile_queue.size()));
+}
+
+void SaveProfile()
+{
+  if (s_profile_game_code.empty() || !g_settings.cpu_precompile_profiled_blocks)
+    return;
+
+  for (const auto& it : s_blocks)
+  {
+    if (!it.second)
+      continue;
+
+    AddBlockToProfile(it.second);
+    it.second->execution_count = 0;
+  }
+
+  std::vector<ProfileEntry> entries;
+  entries.reserve(s_profile.size());
+  for (const auto& it : s_profile)
+  {
+    if (it.second.weight > 0)
+      entries.push_back(it.second);
+  }
+  if (entries.empty())
+    return;
+
+  std::sort(entries.begin(), entries.end(),
+            [](const ProfileEntry& lhs, const ProfileEntry& rhs) { return lhs.weight > rhs.weight; });
+  if (entries.size() > MAX_PROFILE_ENTRIES)
+    entries.resize(MAX_PROFILE_ENTRIES);
+
+  const u32 header[3] = {PROFILE_MAGIC, PROFILE_VERSION, static_cast<u32>(entries.size())};
+  std::vector<u8> data(sizeof(header) + entries.size() * sizeof(ProfileEntry));
+  std::memcpy(data.data(), header, sizeof(header));
+  std::memcpy(data.data() + sizeof(header), entries.data(), entries.size() * sizeof(ProfileEntry));
+
+  const std::string path = GetProfilePath(s_profile_game_code);
+  if (!FileSystem::WriteBinaryFile(path.c_str(), data.data(), data.size()))
+  {
+    Log_WarningPrintf("Failed to write block profile to '%s'", path.c_str());
+    return;
+  }
+
+  Log_InfoPrintf("Saved block profile for '%s' with %u blocks", s_profile_game_code.c_str(),
+                 static_cast<u32>(entries.size()));
+}
+
+void ResetPrecompileQueue()
+{
+  s_precompile_state.assign(s_precompile_queue.size(), PrecompileState::Pending);
+  s_precompile_queue_pos = 0;
+  s_precompile_pending = static_cast<u32>(s_precompile_queue.size());
+
+  for (std::vector<u32>& page_entries : s_precompile_page_map)
+    page_entries.clear();
+
+  for (u32 i = 0; i < static_cast<u32>(s_precompile_queue.size()); i++)
+  {
+    CodeBlockKey key;
+    key.bits = s_precompile_queue[i].key;
+    const u32 address = key.GetPCPhysicalAddress();
+    if (address >= Bus::RAM_SIZE)
+      continue;
+
+    const u32 start_page = address / CPU_CODE_CACHE_PAGE_SIZE;
+    const u32 end_page =
+      std::min<u32>((address + s_precompile_queue[i].num_instructions * sizeof(Instruction)) / CPU_CODE_CACHE_PAGE_SIZE,
+                    CPU_CODE_CACHE_PAGE_COUNT - 1);
+    for (u32 page = start_page; page <= end_page; page++)
+      s_precompile_page_map[page].push_back(i);
+  }
+}
+
+void PrecompileProfiledBlocks()
+{
+  if (s_precompile_pending == 0)
+    return;
+
+  // The queue is sorted by weight, so the hottest blocks are compiled first. Blocks whose code isn't loaded yet stay
+  // pending, and each frame continues from where the last one stopped, so they can't hold up the rest of the queue.
+  // Hashing the code is the expensive part, so the number of hashes per frame is limited.
+  const u32 queue_size = static_cast<u32>(s_precompile_queue.size());
+  u32 num_compiled = 0;
+  u32 num_checked = 0;
+  for (u32 num_visited = 0; num_visited < queue_size && num_compiled < MAX_PRECOMPILED_BLOCKS_PER_FRAME &&
+                            num_checked < MAX_PRECOMPILE_CHECKS_PER_FRAME;
+       num_visited++)
+  {
+    const u32 i = s_precompile_queue_pos;
+    s_precompile_queue_pos = (s_precompile_queue_pos + 1) % queue_size;
+    if (s_precompile_state[i] != PrecompileState::Pending)
+      continue;
+
+    const ProfileEntry& entry = s_precompile_queue[i];
+    CodeBlockKey key;
+    key.bits = entry.key;
+
+    // invalidated blocks are checked against the profile again, as their code may have changed
+    const BlockMap::iterator iter = s_blocks.find(key.bits);
+    if (iter != s_blocks.end() && (!iter->second || !iter->second->invalidated))
+    {
+      s_precompile_state[i] = PrecompileState::Done;
+      s_precompile_pending--;
+      continue;
+    }
+
+    // can_trap depends on the mode the block is compiled in
+    if (key.user_mode != InUserMode())
+      continue;
+
+    num_checked++;
+    if (GetMemoryCodeHash(key.GetPC(), entry.num_instructions) != entry.code_hash)
+      continue;
+
+    // don't retry blocks which failed to compile, or compiled differently to the profile
+    CodeBlock* block = LookupBlock(key);
+    if (!block || block->instructions.size() != entry.num_instructions)
+    {
+      Log_DevPrintf("Precompiled block at 0x%08X does not match profile", key.GetPC());
+      s_precompile_state[i] = PrecompileState::Failed;
+    }
+    else
+    {
+      s_precompile_state[i] = PrecompileState::Done;
+    }
+
+    s_precompile_pending--;
+    num_compiled++;
+  }
+
+  if (num_compiled > 0)
+    Log_DevPrintf("Precompiled %u profiled blocks", num_compiled);
+}
+
 } // namespace CPU::CodeCache
@@ -4,6 +4,7 @@
 #include "cpu_types.h"
 #include <array>
 #include <memory>
+#include <string>
 #include <unordered_map>
 #include <vector>
 
@@ -61,6 +62,8 @@ struct CodeBlock
   std::vector<CodeBlock*> link_predecessors;
   std::vector<CodeBlock*> link_successors;
 
+  u64 execution_count = 0;
+
   bool invalidated = false;
 
   const u32 GetPC() const { return key.GetPC(); }
@@ -89,9 +92,22 @@ void Flush();
 /// Changes whether the recompiler is enabled.
 void SetUseRecompiler(bool enable);
 
+/// Interprets blocks even when the recompiler is enabled, without flushing. Used by the validator.
+void SetInterpretOnly(bool enable);
+
 /// Invalidates all blocks which are in the range of the specified code page.
 void InvalidateBlocksWithPageIndex(u32 page_index);
 
+/// Loads the block profile for the specified game. Profiled blocks are compiled ahead of time once their code is
+/// present in memory, and execution counts are accumulated into the profile until the next save.
+void LoadProfile(const std::string& game_code);
+
+/// Writes the block profile for the running game, ordered by execution count.
+void SaveProfile();
+
+/// Compiles a limited number of blocks from the profile whose code matches memory. Called once per frame.
+void PrecompileProfiledBlocks();
+
 void InterpretCachedBlock(const CodeBlock& block);
 void InterpretUncachedBlock();
 
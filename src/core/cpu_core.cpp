@@ -1,4 +1,5 @@
 #include "cpu_core.h"
+#include "bios_hle.h"
 #include "common/align.h"
 #include "common/file_system.h"
 #include "common/log.h"
@@ -501,6 +502,8 @@ void DisassembleAndPrint(u32 addr, u32 instructions_before /* = 0 */, u32 instru
 
 void Execute()
 {
+  const bool use_bios_hle = BIOS::HLE::IsEnabled();
+
   g_state.frame_done = false;
   while (!g_state.frame_done)
   {
@@ -511,6 +514,16 @@ void Execute()
       if (HasPendingInterrupt())
         DispatchInterrupt();
 
+      // the instruction at the jump table entry has been prefetched, but not executed yet
+      if (use_bios_hle && BIOS::HLE::IsDispatchAddress(g_state.regs.pc) &&
+          !g_state.next_instruction_is_branch_delay_slot && BIOS::HLE::Dispatch())
+      {
+        // discard it, and continue from the return address
+        g_state.regs.npc = g_state.regs.pc;
+        FetchInstruction();
+        continue;
+      }
+
       g_state.pending_ticks++;
 
       // now executing the instruction we previously fetched
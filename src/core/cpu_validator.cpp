@@ -0,0 +1,395 @@
+#include "cpu_validator.h"
+#include "bus.h"
+#include "common/byte_stream.h"
+#include "common/log.h"
+#include "common/string.h"
+#include "cpu_code_cache.h"
+#include "cpu_core.h"
+#include "cpu_disasm.h"
+#include "host_interface.h"
+#include "system.h"
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+Log_SetChannel(CPU::Validator);
+
+namespace CPU::Validator {
+
+enum class Pass : u8
+{
+  None,
+  Reference,
+  Compare
+};
+
+enum : u32
+{
+  NO_CAPTURE = 0xFFFFFFFFu,
+  NUM_COP0_REGS = sizeof(Cop0Registers) / sizeof(u32)
+};
+
+struct BlockRecord
+{
+  u32 pc;
+  u64 digest;
+};
+
+struct Snapshot
+{
+  bool valid;
+  Registers regs;
+  std::array<u32, NUM_COP0_REGS> cop0_regs;
+  std::array<u32, GTE::NUM_REGS> gte_regs;
+  TickCount pending_ticks;
+  Reg load_delay_reg;
+  u32 load_delay_value;
+  std::vector<std::pair<u32, u32>> instructions; // pc, bits
+  std::vector<u8> ram;
+};
+
+static bool SaveFrameState();
+static bool LoadFrameState();
+static void RunPass(Pass pass);
+static void LocateDivergence(bool ram_only);
+static void ReportDivergence(u32 index, bool ram_only);
+static void Capture(Snapshot& snapshot, const CodeBlock& block);
+static u64 GetStateDigest(bool include_ram);
+static u64 GetRAMDigest();
+
+static std::unique_ptr<GrowableMemoryByteStream> s_frame_state;
+static std::vector<u8> s_ram_before_load;
+static std::vector<BlockRecord> s_reference_blocks;
+static std::array<Snapshot, 2> s_snapshots;
+static std::optional<u32> s_mismatch_index;
+
+static Pass s_pass = Pass::None;
+static u32 s_block_index = 0;
+static u32 s_capture_index = NO_CAPTURE;
+static u32 s_frame_count = 0;
+static bool s_capture_ram = false;
+static bool s_hash_ram_per_block = false;
+static bool s_diverged = false;
+
+static constexpr std::array<const char*, NUM_COP0_REGS> s_cop0_reg_names = {
+  {"BPC", "BDA", "TAR", "BadVaddr", "BDAM", "BPCM", "EPC", "PRID", "SR", "CAUSE", "DCIC"}};
+static_assert(sizeof(Cop0Registers) == NUM_COP0_REGS * sizeof(u32));
+
+void Initialize()
+{
+  s_reference_blocks.clear();
+  s_pass = Pass::None;
+  s_frame_count = 0;
+  s_diverged = false;
+}
+
+void Shutdown()
+{
+  if (s_frame_count > 0 && !s_diverged)
+    Log_InfoPrintf("Validated %u frames with no divergences.", s_frame_count);
+
+  s_frame_state.reset();
+  s_ram_before_load = {};
+  s_reference_blocks = {};
+  for (Snapshot& snapshot : s_snapshots)
+    snapshot = {};
+  s_pass = Pass::None;
+}
+
+bool IsActive()
+{
+  return s_pass != Pass::None;
+}
+
+bool HasDiverged()
+{
+  return s_diverged;
+}
+
+void RunFrame()
+{
+  if (s_diverged || !SaveFrameState())
+  {
+    CodeCache::Execute();
+    return;
+  }
+
+  RunPass(Pass::Reference);
+  const u64 reference_ram_digest = GetRAMDigest();
+  if (!LoadFrameState())
+  {
+    Log_ErrorPrintf("Failed to rewind frame, validation disabled.");
+    s_diverged = true;
+    return;
+  }
+
+  RunPass(Pass::Compare);
+  s_frame_count++;
+
+  if (s_mismatch_index.has_value())
+    LocateDivergence(false);
+  else if (GetRAMDigest() != reference_ram_digest)
+    LocateDivergence(true);
+}
+
+void OnBlockExecuted(const CodeBlock& block)
+{
+  const u32 index = s_block_index++;
+  if (index == s_capture_index)
+    Capture(s_snapshots[(s_pass == Pass::Reference) ? 0 : 1], block);
+
+  const u64 digest = GetStateDigest(s_hash_ram_per_block);
+  if (s_pass == Pass::Reference)
+  {
+    s_reference_blocks.push_back(BlockRecord{block.GetPC(), digest});
+    return;
+  }
+
+  if (s_mismatch_index.has_value())
+    return;
+
+  if (index >= s_reference_blocks.size() || s_reference_blocks[index].pc != block.GetPC() ||
+      s_reference_blocks[index].digest != digest)
+  {
+    s_mismatch_index = index;
+  }
+}
+
+bool SaveFrameState()
+{
+  if (!s_frame_state)
+    s_frame_state = ByteStream_CreateGrowableMemoryStream();
+
+  s_frame_state->SeekAbsolute(0);
+  return System::SaveRawState(s_frame_state.get());
+}
+
+bool LoadFrameState()
+{
+  s_ram_before_load.resize(Bus::RAM_SIZE);
+  std::memcpy(s_ram_before_load.data(), Bus::g_ram, Bus::RAM_SIZE);
+
+  s_frame_state->SeekAbsolute(0);
+  if (!System::LoadRawState(s_frame_state.get()))
+    return false;
+
+  // The code cache is kept across the rewind, so any code which was modified during the frame has to be invalidated.
+  for (u32 page = 0; page < (Bus::RAM_SIZE / CPU_CODE_CACHE_PAGE_SIZE); page++)
+  {
+    const u32 offset = page * CPU_CODE_CACHE_PAGE_SIZE;
+    if (Bus::m_ram_code_bits[page] &&
+        std::memcmp(&s_ram_before_load[offset], &Bus::g_ram[offset], CPU_CODE_CACHE_PAGE_SIZE) != 0)
+    {
+      CodeCache::InvalidateBlocksWithPageIndex(page);
+    }
+  }
+
+  return true;
+}
+
+void RunPass(Pass pass)
+{
+  s_pass = pass;
+  s_block_index = 0;
+  if (pass == Pass::Reference)
+    s_reference_blocks.clear();
+  else
+    s_mismatch_index.reset();
+
+  CodeCache::SetInterpretOnly(pass == Pass::Reference);
+  CodeCache::Execute();
+  CodeCache::SetInterpretOnly(false);
+
+  // The recompiler executing fewer blocks than the interpreter is also a divergence.
+  if (pass == Pass::Compare && !s_mismatch_index.has_value() && s_block_index != s_reference_blocks.size())
+    s_mismatch_index = s_block_index;
+
+  s_pass = Pass::None;
+}
+
+void LocateDivergence(bool ram_only)
+{
+  s_diverged = true;
+
+  // Only registers are compared per-block normally, so re-run the frame hashing RAM after every block.
+  if (ram_only)
+  {
+    s_hash_ram_per_block = true;
+    if (LoadFrameState())
+      RunPass(Pass::Reference);
+    if (LoadFrameState())
+      RunPass(Pass::Compare);
+    s_hash_ram_per_block = false;
+
+    if (!s_mismatch_index.has_value())
+    {
+      Log_ErrorPrintf("RAM diverged in frame %u, but the diverging block could not be located.", s_frame_count);
+      return;
+    }
+  }
+
+  // Run the frame again in both modes, grabbing the full state after the diverging block.
+  const u32 index = s_mismatch_index.value();
+  for (Snapshot& snapshot : s_snapshots)
+    snapshot.valid = false;
+
+  s_capture_index = index;
+  s_capture_ram = ram_only;
+  if (LoadFrameState())
+    RunPass(Pass::Reference);
+  if (LoadFrameState())
+    RunPass(Pass::Compare);
+  s_capture_index = NO_CAPTURE;
+
+  ReportDivergence(index, ram_only);
+}
+
+void ReportDivergence(u32 index, bool ram_only)
+{
+  const Snapshot& ref = s_snapshots[0];
+  const Snapshot& cmp = s_snapshots[1];
+  const u32 block_pc = (index < s_reference_blocks.size()) ? s_reference_blocks[index].pc : 0;
+
+  Log_ErrorPrintf("Recompiler diverged from interpreter in frame %u, block %u at PC 0x%08X (%s)", s_frame_count,
+                  index, block_pc, ram_only ? "RAM" : "CPU state");
+  g_host_interface->AddFormattedOSDMessage(10.0f, "Recompiler diverged at PC 0x%08X in frame %u, see log.",
+                                           block_pc, s_frame_count);
+
+  if (!ref.valid || !cmp.valid)
+  {
+    Log_ErrorPrintf("  Block count differs: interpreter executed %u blocks",
+                    static_cast<u32>(s_reference_blocks.size()));
+    return;
+  }
+
+  SmallString disasm;
+  for (const auto& [pc, bits] : ref.instructions)
+  {
+    DisassembleInstruction(&disasm, pc, bits, nullptr);
+    Log_ErrorPrintf("  %08X: %08X %s", pc, bits, disasm.GetCharArray());
+  }
+
+  // npc isn't maintained by the recompiler
+  for (u32 i = 0; i < static_cast<u32>(Reg::npc); i++)
+  {
+    if (ref.regs.r[i] != cmp.regs.r[i])
+    {
+      Log_ErrorPrintf("  %-8s interpreter=%08X recompiler=%08X", GetRegName(static_cast<Reg>(i)), ref.regs.r[i],
+                      cmp.regs.r[i]);
+    }
+  }
+
+  for (u32 i = 0; i < NUM_COP0_REGS; i++)
+  {
+    if (ref.cop0_regs[i] != cmp.cop0_regs[i])
+    {
+      Log_ErrorPrintf("  %-8s interpreter=%08X recompiler=%08X", s_cop0_reg_names[i], ref.cop0_regs[i],
+                      cmp.cop0_regs[i]);
+    }
+  }
+
+  for (u32 i = 0; i < GTE::NUM_REGS; i++)
+  {
+    if (ref.gte_regs[i] != cmp.gte_regs[i])
+    {
+      Log_ErrorPrintf("  GTE %s%-3u interpreter=%08X recompiler=%08X", (i < GTE::NUM_DATA_REGS) ? "data" : "ctrl",
+                      i % GTE::NUM_DATA_REGS, ref.gte_regs[i], cmp.gte_regs[i]);
+    }
+  }
+
+  if (ref.pending_ticks != cmp.pending_ticks)
+    Log_ErrorPrintf("  ticks    interpreter=%d recompiler=%d", ref.pending_ticks, cmp.pending_ticks);
+
+  if (ref.load_delay_reg != cmp.load_delay_reg || ref.load_delay_value != cmp.load_delay_value)
+  {
+    Log_ErrorPrintf("  load delay interpreter=%u/%08X recompiler=%u/%08X", static_cast<u32>(ref.load_delay_reg),
+                    ref.load_delay_value, static_cast<u32>(cmp.load_delay_reg), cmp.load_delay_value);
+  }
+
+  if (!ref.ram.empty() && !cmp.ram.empty())
+  {
+    u32 first_address = Bus::RAM_SIZE;
+    u32 num_bytes = 0;
+    for (u32 i = 0; i < Bus::RAM_SIZE; i++)
+    {
+      if (ref.ram[i] != cmp.ram[i])
+      {
+        first_address = std::min(first_address, i);
+        num_bytes++;
+      }
+    }
+
+    if (num_bytes > 0)
+    {
+      Log_ErrorPrintf("  RAM      %u bytes differ, first at 0x%08X interpreter=%02X recompiler=%02X", num_bytes,
+                      first_address, ref.ram[first_address], cmp.ram[first_address]);
+    }
+  }
+}
+
+void Capture(Snapshot& snapshot, const CodeBlock& block)
+{
+  snapshot.valid = true;
+  snapshot.regs = g_state.regs;
+  std::memcpy(snapshot.cop0_regs.data(), &g_state.cop0_regs, sizeof(snapshot.cop0_regs));
+  std::memcpy(snapshot.gte_regs.data(), &g_state.gte_regs, sizeof(snapshot.gte_regs));
+  snapshot.pending_ticks = g_state.pending_ticks;
+  snapshot.load_delay_reg = g_state.load_delay_reg;
+  snapshot.load_delay_value = g_state.load_delay_value;
+  snapshot.instructions.clear();
+  for (const CodeBlockInstruction& cbi : block.instructions)
+    snapshot.instructions.emplace_back(cbi.pc, cbi.instruction.bits);
+  if (s_capture_ram)
+    snapshot.ram.assign(Bus::g_ram, Bus::g_ram + Bus::RAM_SIZE);
+  else
+    snapshot.ram.clear();
+}
+
+static ALWAYS_INLINE u64 HashWords(u64 hash, const u32* words, u32 count)
+{
+  // FNV-1a over words, good enough to detect differences
+  for (u32 i = 0; i < count; i++)
+    hash = (hash ^ words[i]) * UINT64_C(0x100000001B3);
+  return hash;
+}
+
+u64 GetStateDigest(bool include_ram)
+{
+  u64 hash = UINT64_C(0xCBF29CE484222325);
+  hash = HashWords(hash, g_state.regs.r, static_cast<u32>(Reg::npc));
+
+  u32 cop0[NUM_COP0_REGS];
+  std::memcpy(cop0, &g_state.cop0_regs, sizeof(cop0));
+  hash = HashWords(hash, cop0, NUM_COP0_REGS);
+  hash = HashWords(hash, g_state.gte_regs.dr32, GTE::NUM_DATA_REGS);
+  hash = HashWords(hash, g_state.gte_regs.cr32, GTE::NUM_CONTROL_REGS);
+
+  const u32 extra[] = {static_cast<u32>(g_state.pending_ticks), static_cast<u32>(g_state.load_delay_reg),
+                       g_state.load_delay_value};
+  hash = HashWords(hash, extra, countof(extra));
+
+  if (include_ram)
+    hash ^= GetRAMDigest();
+
+  return hash;
+}
+
+u64 GetRAMDigest()
+{
+  u64 hash = UINT64_C(0xCBF29CE484222325);
+  for (u32 offset = 0; offset < Bus::RAM_SIZE; offset += sizeof(u64))
+  {
+    u64 value;
+    std::memcpy(&value, &Bus::g_ram[offset], sizeof(value));
+    hash = (hash ^ value) * UINT64_C(0x100000001B3);
+  }
+
+  u32 dcache[DCACHE_SIZE / sizeof(u32)];
+  std::memcpy(dcache, g_state.dcache.data(), sizeof(dcache));
+  return HashWords(hash, dcache, countof(dcache));
+}
+
+} // namespace CPU::Validator
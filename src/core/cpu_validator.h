@@ -0,0 +1,30 @@
+#pragma once
+#include "types.h"
+
+namespace CPU {
+
+struct CodeBlock;
+
+/// Runs each frame twice, once with the cached interpreter and once with the recompiler, starting from the same
+/// machine state. The CPU state is compared after every block and RAM at the end of every frame, and the first
+/// diverging block is logged along with its disassembly. Host-side effects (audio) are produced by both passes.
+namespace Validator {
+
+void Initialize();
+void Shutdown();
+
+/// Returns true if per-block comparison is currently taking place.
+bool IsActive();
+
+/// Returns true if a divergence has been detected. Validation stops after the first divergence.
+bool HasDiverged();
+
+/// Executes one frame in both modes. Falls back to plain recompiler execution after a divergence.
+void RunFrame();
+
+/// Called by the code cache after each block is executed.
+void OnBlockExecuted(const CodeBlock& block);
+
+} // namespace Validator
+
+} // namespace CPU
@@ -4,6 +4,7 @@
 #include "common/log.h"
 #include "common/state_wrapper.h"
 #include "common/string_util.h"
+#include "common/trace_recorder.h"
 #include "cpu_core.h"
 #include "gpu.h"
 #include "interrupt_controller.h"
@@ -24,8 +25,10 @@ void DMA::Initialize()
   m_halt_ticks = g_settings.dma_halt_ticks;
 
   m_transfer_buffer.resize(32);
-  m_unhalt_event = TimingEvents::CreateTimingEvent("DMA Transfer Unhalt", 1, m_max_slice_ticks,
-                                                   std::bind(&DMA::UnhaltTransfer, this, std::placeholders::_1), false);
+  m_unhalt_event = TimingEvents::CreateTimingEvent(
+    "DMA Transfer Unhalt", 1, m_max_slice_ticks,
+    [](void* param, TickCount ticks, TickCount ticks_late) { static_cast<DMA*>(param)->UnhaltTransfer(ticks); },
+    this, false);
 
   Reset();
 }
@@ -245,6 +248,10 @@ void DMA::UpdateIRQ()
 
 bool DMA::TransferChannel(Channel channel)
 {
+  static constexpr std::array<const char*, NUM_CHANNELS> span_names = {
+    {"DMA MDECin", "DMA MDECout", "DMA GPU", "DMA CDROM", "DMA SPU", "DMA PIO", "DMA OTC"}};
+  TraceRecorder::ScopedSpan trace_span(span_names[static_cast<u32>(channel)]);
+
   ChannelState& cs = m_state[static_cast<u32>(channel)];
 
   const bool copy_to_device = cs.channel_control.copy_to_device;
@@ -429,8 +436,9 @@ void DMA::UnhaltTransfer(TickCount ticks)
 TickCount DMA::TransferMemoryToDevice(Channel channel, u32 address, u32 increment, u32 word_count)
 {
   const u32* src_pointer = reinterpret_cast<u32*>(Bus::g_ram + address);
-  if (channel != Channel::GPU &&
-      (static_cast<s32>(increment) < 0 || ((address + (increment * word_count)) & ADDRESS_MASK) <= address))
+  const bool wraps_around =
+    (static_cast<s32>(increment) < 0 || ((address + (increment * word_count)) & ADDRESS_MASK) <= address);
+  if (channel != Channel::GPU && wraps_around)
   {
     // Use temp buffer if it's wrapping around
     if (m_transfer_buffer.size() < word_count)
@@ -451,13 +459,22 @@ TickCount DMA::TransferMemoryToDevice(Channel channel, u32 address, u32 incremen
     {
       if (g_gpu->BeginDMAWrite())
       {
-        u8* ram_pointer = Bus::g_ram;
-        for (u32 i = 0; i < word_count; i++)
+        if (!wraps_around)
+        {
+          // whole block, or a linked list node's payload, in one go
+          g_gpu->DMAWrite(address, src_pointer, word_count);
+        }
+        else
         {
-          u32 value;
-          std::memcpy(&value, &ram_pointer[address], sizeof(u32));
-          g_gpu->DMAWrite(address, value);
-          address = (address + increment) & ADDRESS_MASK;
+          // the GPU needs each word's address, so it can't use the temp buffer
+          u8* ram_pointer = Bus::g_ram;
+          for (u32 i = 0; i < word_count; i++)
+          {
+            u32 value;
+            std::memcpy(&value, &ram_pointer[address], sizeof(u32));
+            g_gpu->DMAWrite(address, value);
+            address = (address + increment) & ADDRESS_MASK;
+          }
         }
         g_gpu->EndDMAWrite();
       }
@@ -488,17 +505,30 @@ TickCount DMA::TransferDeviceToMemory(Channel channel, u32 address, u32 incremen
   if (channel == Channel::OTC)
   {
     // clear ordering table
-    u8* ram_pointer = Bus::g_ram;
     const u32 word_count_less_1 = word_count - 1;
-    for (u32 i = 0; i < word_count_less_1; i++)
+    const u32 table_size = word_count_less_1 * sizeof(u32);
+    if (address >= table_size)
     {
-      u32 value = ((address - 4) & ADDRESS_MASK);
-      std::memcpy(&ram_pointer[address], &value, sizeof(value));
-      address = (address - 4) & ADDRESS_MASK;
+      // each entry points to the one below it, so fill upwards from the terminator at the bottom
+      address -= table_size;
+      u32* table = reinterpret_cast<u32*>(&Bus::g_ram[address]);
+      table[0] = UINT32_C(0xFFFFFF);
+      for (u32 i = 1; i < word_count; i++)
+        table[i] = address + ((i - 1) * sizeof(u32));
     }
+    else
+    {
+      u8* ram_pointer = Bus::g_ram;
+      for (u32 i = 0; i < word_count_less_1; i++)
+      {
+        u32 value = ((address - 4) & ADDRESS_MASK);
+        std::memcpy(&ram_pointer[address], &value, sizeof(value));
+        address = (address - 4) & ADDRESS_MASK;
+      }
 
-    const u32 terminator = UINT32_C(0xFFFFFF);
-    std::memcpy(&ram_pointer[address], &terminator, sizeof(terminator));
+      const u32 terminator = UINT32_C(0xFFFFFF);
+      std::memcpy(&ram_pointer[address], &terminator, sizeof(terminator));
+    }
     Bus::InvalidateCodePages(address, word_count);
     return Bus::GetDMARAMTickCount(word_count);
   }
@@ -0,0 +1,257 @@
+#include "frame_profiler.h"
+#include "common/file_system.h"
+#include "common/log.h"
+#include "common/timer.h"
+#include "settings.h"
+#include <algorithm>
+#include <cstdio>
+#include <imgui.h>
+#include <string>
+#include <vector>
+Log_SetChannel(FrameProfiler);
+
+namespace FrameProfiler {
+
+struct Slot
+{
+  std::string name;
+  Common::Timer::Value frame_time;
+  Common::Timer::Value window_time;
+  Common::Timer::Value window_worst_time;
+  float average_ms;
+  float worst_ms;
+};
+
+static constexpr double WINDOW_SECONDS = 1.0;
+
+bool g_enabled = false;
+
+static std::vector<Slot> s_slots = {{"Other"},        {"CPU Execution"}, {"GPU Commands"},
+                                    {"SPU Synthesis"}, {"Presentation"},  {"Throttle"}};
+static u32 s_current_slot = SLOT_OTHER;
+static Common::Timer::Value s_last_switch_time = 0;
+static Common::Timer::Value s_frame_start_time = 0;
+
+static Common::Timer s_window_timer;
+static u32 s_window_frames = 0;
+static Common::Timer::Value s_window_frame_time = 0;
+static Common::Timer::Value s_window_worst_frame_time = 0;
+static float s_average_frame_ms = 0.0f;
+static float s_worst_frame_ms = 0.0f;
+
+static std::FILE* s_csv_file = nullptr;
+static u32 s_csv_num_slots = 0;
+static u32 s_csv_frame_number = 0;
+
+u32 RegisterSlot(const char* name)
+{
+  for (u32 i = 0; i < static_cast<u32>(s_slots.size()); i++)
+  {
+    if (s_slots[i].name == name)
+      return i;
+  }
+
+  s_slots.push_back(Slot{name});
+  return static_cast<u32>(s_slots.size() - 1);
+}
+
+u32 EnterSlot(u32 slot)
+{
+  const Common::Timer::Value now = Common::Timer::GetValue();
+  s_slots[s_current_slot].frame_time += now - s_last_switch_time;
+  s_last_switch_time = now;
+
+  const u32 previous_slot = s_current_slot;
+  s_current_slot = slot;
+  return previous_slot;
+}
+
+void LeaveSlot(u32 previous_slot)
+{
+  const Common::Timer::Value now = Common::Timer::GetValue();
+  s_slots[s_current_slot].frame_time += now - s_last_switch_time;
+  s_last_switch_time = now;
+  s_current_slot = previous_slot;
+}
+
+static void ResetStatistics()
+{
+  for (Slot& slot : s_slots)
+  {
+    slot.frame_time = 0;
+    slot.window_time = 0;
+    slot.window_worst_time = 0;
+    slot.average_ms = 0.0f;
+    slot.worst_ms = 0.0f;
+  }
+
+  s_window_timer.Reset();
+  s_window_frames = 0;
+  s_window_frame_time = 0;
+  s_window_worst_frame_time = 0;
+  s_average_frame_ms = 0.0f;
+  s_worst_frame_ms = 0.0f;
+}
+
+static void WriteCSVRow(Common::Timer::Value frame_time)
+{
+  std::fprintf(s_csv_file, "%u,%.4f", s_csv_frame_number++, Common::Timer::ConvertValueToMilliseconds(frame_time));
+  for (u32 i = 0; i < s_csv_num_slots; i++)
+    std::fprintf(s_csv_file, ",%.4f", Common::Timer::ConvertValueToMilliseconds(s_slots[i].frame_time));
+  std::fputc('\n', s_csv_file);
+}
+
+void EndFrame()
+{
+  const bool enable = (g_settings.debugging.show_frame_profiler || s_csv_file);
+  if (!g_enabled)
+  {
+    if (enable)
+    {
+      ResetStatistics();
+      s_current_slot = SLOT_OTHER;
+      s_last_switch_time = Common::Timer::GetValue();
+      s_frame_start_time = s_last_switch_time;
+      g_enabled = true;
+    }
+
+    return;
+  }
+
+  const Common::Timer::Value now = Common::Timer::GetValue();
+  s_slots[s_current_slot].frame_time += now - s_last_switch_time;
+  s_last_switch_time = now;
+
+  const Common::Timer::Value frame_time = now - s_frame_start_time;
+  s_frame_start_time = now;
+
+  if (s_csv_file)
+    WriteCSVRow(frame_time);
+
+  for (Slot& slot : s_slots)
+  {
+    slot.window_time += slot.frame_time;
+    slot.window_worst_time = std::max(slot.window_worst_time, slot.frame_time);
+    slot.frame_time = 0;
+  }
+
+  s_window_frames++;
+  s_window_frame_time += frame_time;
+  s_window_worst_frame_time = std::max(s_window_worst_frame_time, frame_time);
+
+  if (s_window_timer.GetTimeSeconds() >= WINDOW_SECONDS)
+  {
+    const double frames = static_cast<double>(s_window_frames);
+    for (Slot& slot : s_slots)
+    {
+      slot.average_ms = static_cast<float>(Common::Timer::ConvertValueToMilliseconds(slot.window_time) / frames);
+      slot.worst_ms = static_cast<float>(Common::Timer::ConvertValueToMilliseconds(slot.window_worst_time));
+      slot.window_time = 0;
+      slot.window_worst_time = 0;
+    }
+
+    s_average_frame_ms = static_cast<float>(Common::Timer::ConvertValueToMilliseconds(s_window_frame_time) / frames);
+    s_worst_frame_ms = static_cast<float>(Common::Timer::ConvertValueToMilliseconds(s_window_worst_frame_time));
+    s_window_frames = 0;
+    s_window_frame_time = 0;
+    s_window_worst_frame_time = 0;
+    s_window_timer.Reset();
+  }
+
+  g_enabled = enable;
+}
+
+bool IsLoggingCSV()
+{
+  return (s_csv_file != nullptr);
+}
+
+bool StartCSVLog(const char* filename)
+{
+  StopCSVLog();
+
+  s_csv_file = FileSystem::OpenCFile(filename, "wb");
+  if (!s_csv_file)
+  {
+    Log_ErrorPrintf("Failed to open '%s' for writing", filename);
+    return false;
+  }
+
+  // Slots registered after this point (new timing events) are not logged, so the columns stay consistent.
+  s_csv_num_slots = static_cast<u32>(s_slots.size());
+  s_csv_frame_number = 0;
+
+  std::fprintf(s_csv_file, "Frame,Total");
+  for (u32 i = 0; i < s_csv_num_slots; i++)
+    std::fprintf(s_csv_file, ",%s", s_slots[i].name.c_str());
+  std::fputc('\n', s_csv_file);
+
+  Log_InfoPrintf("Logging frame times to '%s'", filename);
+  return true;
+}
+
+void StopCSVLog()
+{
+  if (!s_csv_file)
+    return;
+
+  std::fclose(s_csv_file);
+  s_csv_file = nullptr;
+  Log_InfoPrintf("Wrote %u frames to frame time log", s_csv_frame_number);
+}
+
+void DrawWindow()
+{
+  const float framebuffer_scale = ImGui::GetIO().DisplayFramebufferScale.x;
+
+  ImGui::SetNextWindowSize(ImVec2(400.0f * framebuffer_scale, 350.0f * framebuffer_scale), ImGuiCond_FirstUseEver);
+  if (!ImGui::Begin("Frame Profiler", &g_settings.debugging.show_frame_profiler))
+  {
+    ImGui::End();
+    return;
+  }
+
+  ImGui::Text("Frame Time: %.3f ms average, %.3f ms worst", s_average_frame_ms, s_worst_frame_ms);
+  if (s_csv_file)
+    ImGui::TextColored(ImVec4(1.0f, 0.4f, 0.4f, 1.0f), "Logging to CSV (%u frames)", s_csv_frame_number);
+
+  ImGui::Separator();
+
+  std::vector<const Slot*> sorted_slots;
+  sorted_slots.reserve(s_slots.size());
+  for (const Slot& slot : s_slots)
+  {
+    if (slot.worst_ms > 0.0f)
+      sorted_slots.push_back(&slot);
+  }
+  std::sort(sorted_slots.begin(), sorted_slots.end(),
+            [](const Slot* lhs, const Slot* rhs) { return lhs->average_ms > rhs->average_ms; });
+
+  ImGui::Columns(4);
+  ImGui::SetColumnWidth(0, 200.0f * framebuffer_scale);
+  ImGui::TextUnformatted("Subsystem");
+  ImGui::NextColumn();
+  ImGui::TextUnformatted("Average");
+  ImGui::NextColumn();
+  ImGui::TextUnformatted("Worst");
+  ImGui::NextColumn();
+  ImGui::TextUnformatted("Frame %");
+  ImGui::NextColumn();
+
+  for (const Slot* slot : sorted_slots)
+  {
+    ImGui::TextUnformatted(slot->name.c_str());
+    ImGui::NextColumn();
+    ImGui::Text("%.3f ms", slot->average_ms);
+    ImGui::NextColumn();
+    ImGui::Text("%.3f ms", slot->worst_ms);
+    ImGui::NextColumn();
+    ImGui::Text("%.1f%%", (s_average_frame_ms > 0.0f) ? (slot->average_ms * 100.0f / s_average_frame_ms) : 0.0f);
+    ImGui::NextColumn();
+  }
+
+  ImGui::Columns(1);
+  ImGui::End();
+}
+
+} // namespace FrameProfiler
@@ -0,0 +1,56 @@
+#pragma once
+#include "types.h"
+
+/// Per-frame accounting of where host time is spent. Time is charged exclusively to the innermost active scope, so
+/// nested scopes (e.g. SPU synthesis inside a timing event inside CPU execution) are not counted twice.
+namespace FrameProfiler {
+
+enum : u32
+{
+  SLOT_OTHER,
+  SLOT_CPU,
+  SLOT_GPU_COMMANDS,
+  SLOT_SPU,
+  SLOT_PRESENT,
+  SLOT_THROTTLE,
+  NUM_FIXED_SLOTS,
+
+  INVALID_SLOT = 0xFFFFFFFFu
+};
+
+extern bool g_enabled;
+
+/// Returns the slot for the specified name, creating it if it does not exist.
+u32 RegisterSlot(const char* name);
+
+/// Switches the slot time is charged to, returning the previous slot.
+u32 EnterSlot(u32 slot);
+void LeaveSlot(u32 previous_slot);
+
+/// Called once per presented frame. Also enables/disables the profiler based on the settings.
+void EndFrame();
+
+bool IsLoggingCSV();
+bool StartCSVLog(const char* filename);
+void StopCSVLog();
+
+void DrawWindow();
+
+class ScopedTimer
+{
+public:
+  ALWAYS_INLINE ScopedTimer(u32 slot) : m_previous_slot(g_enabled ? EnterSlot(slot) : INVALID_SLOT) {}
+  ALWAYS_INLINE ~ScopedTimer()
+  {
+    if (m_previous_slot != INVALID_SLOT)
+      LeaveSlot(m_previous_slot);
+  }
+
+  ScopedTimer(const ScopedTimer&) = delete;
+  ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+  u32 m_previous_slot;
+};
+
+} // namespace FrameProfiler
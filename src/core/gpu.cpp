@@ -3,6 +3,7 @@
 #include "common/log.h"
 #include "common/state_wrapper.h"
 #include "dma.h"
+#include "gpu_dump.h"
 #include "host_display.h"
 #include "host_interface.h"
 #include "interrupt_controller.h"
@@ -16,6 +17,7 @@ Log_SetChannel(GPU);
 std::unique_ptr<GPU> g_gpu;
 
 const GPU::GP0CommandHandlerTable GPU::s_GP0_command_handler_table = GPU::GenerateGP0CommandHandlerTable();
+const GPU::GP0CommandSizeTable GPU::s_GP0_command_size_table = GPU::GenerateGP0CommandSizeTable();
 
 GPU::GPU() = default;
 
@@ -28,9 +30,13 @@ bool GPU::Initialize(HostDisplay* host_display)
   m_force_ntsc_timings = g_settings.gpu_force_ntsc_timings;
   m_crtc_state.display_aspect_ratio = Settings::GetDisplayAspectRatioValue(g_settings.display_aspect_ratio);
   m_crtc_tick_event = TimingEvents::CreateTimingEvent(
-    "GPU CRTC Tick", 1, 1, std::bind(&GPU::CRTCTickEvent, this, std::placeholders::_1), true);
+    "GPU CRTC Tick", 1, 1,
+    [](void* param, TickCount ticks, TickCount ticks_late) { static_cast<GPU*>(param)->CRTCTickEvent(ticks); },
+    this, true);
   m_command_tick_event = TimingEvents::CreateTimingEvent(
-    "GPU Command Tick", 1, 1, std::bind(&GPU::CommandTickEvent, this, std::placeholders::_1), true);
+    "GPU Command Tick", 1, 1,
+    [](void* param, TickCount ticks, TickCount ticks_late) { static_cast<GPU*>(param)->CommandTickEvent(ticks); },
+    this, true);
   m_fifo_size = g_settings.gpu_fifo_size;
   m_max_run_ahead = g_settings.gpu_max_run_ahead;
   m_console_is_pal = System::IsPALRegion();
@@ -64,6 +70,11 @@ void GPU::Reset()
   SoftReset();
   m_set_texture_disable_mask = false;
   m_GPUREAD_latch = 0;
+
+  // VRAM is complete again, but keep frame skipping disabled if the game was seen reading its framebuffers.
+  m_skippable_framebuffers = {};
+  m_skipped_framebuffer_frames = 0;
+  m_skip_rendering = false;
 }
 
 void GPU::SoftReset()
@@ -103,6 +114,13 @@ bool GPU::DoState(StateWrapper& sw)
 {
   if (sw.IsReading())
   {
+    if (m_dump_recorder)
+    {
+      // The dump can't represent the jump in state.
+      Log_WarningPrintf("Loading state, GPU dump will end here.");
+      StopDumpRecording();
+    }
+
     // perform a reset to discard all pending draws/fb state
     Reset();
   }
@@ -298,15 +316,27 @@ u32 GPU::ReadRegister(u32 offset)
   switch (offset)
   {
     case 0x00:
+    {
+      if (m_dump_recorder)
+        m_dump_recorder->ReadGPUREAD();
+
       return ReadGPUREAD();
+    }
 
     case 0x04:
     {
       // code can be dependent on the odd/even bit, so update the GPU state when reading.
       // we can mitigate this slightly by only updating when the raster is actually hitting a new line
-      if (IsCRTCScanlinePending())
+      const bool scanline_pending = IsCRTCScanlinePending();
+      const bool command_completion_pending = IsCommandCompletionPending();
+
+      // reads without side effects aren't worth recording, games poll this a lot
+      if (m_dump_recorder && (scanline_pending || command_completion_pending))
+        m_dump_recorder->ReadGPUSTAT();
+
+      if (scanline_pending)
         SynchronizeCRTC();
-      if (IsCommandCompletionPending())
+      if (command_completion_pending)
         m_command_tick_event->InvokeEarly();
 
       return m_GPUSTAT.bits;
@@ -323,12 +353,18 @@ void GPU::WriteRegister(u32 offset, u32 value)
   switch (offset)
   {
     case 0x00:
+      if (m_dump_recorder)
+        m_dump_recorder->WriteGP0(value);
+
       m_fifo.Push(value);
       ExecuteCommands();
       UpdateCommandTickEvent();
       return;
 
     case 0x04:
+      if (m_dump_recorder)
+        m_dump_recorder->WriteGP1(value);
+
       WriteGP1(value);
       return;
 
@@ -347,12 +383,42 @@ void GPU::DMARead(u32* words, u32 word_count)
     return;
   }
 
+  if (m_dump_recorder)
+    m_dump_recorder->DMARead(word_count);
+
   for (u32 i = 0; i < word_count; i++)
     words[i] = ReadGPUREAD();
 }
 
+void GPU::DMAWrite(u32 address, const u32* words, u32 word_count)
+{
+  // the source addresses go in the FIFO alongside the words, for PGXP
+  DebugAssert(word_count <= m_fifo.GetSpace());
+  while (word_count > 0)
+  {
+    const u32 run = std::min(word_count, m_fifo.GetContiguousSpace());
+    u64* fifo_words = m_fifo.GetWritePointer();
+    for (u32 i = 0; i < run; i++)
+      fifo_words[i] = (ZeroExtend64(address + (i * sizeof(u32))) << 32) | ZeroExtend64(words[i]);
+
+    m_fifo.AdvanceTail(run);
+    address += run * sizeof(u32);
+    words += run;
+    word_count -= run;
+  }
+}
+
 void GPU::EndDMAWrite()
 {
+  if (m_dump_recorder)
+  {
+    // nothing is popped from the FIFO during the transfer, so the words are still there
+    const u32 word_count = m_fifo.GetSize() - m_dma_write_start;
+    m_dump_recorder->BeginDMAWrite(word_count);
+    for (u32 i = 0; i < word_count; i++)
+      m_dump_recorder->WriteDMAWord(FifoPeek(m_dma_write_start + i));
+  }
+
   m_fifo_pushed = true;
   if (!m_syncing)
   {
@@ -365,6 +431,96 @@ void GPU::EndDMAWrite()
   }
 }
 
+bool GPU::StartDumpRecording(const char* filename)
+{
+  StopDumpRecording();
+
+  // bring the CRTC and command timing up to date, so the snapshot matches the current tick
+  SynchronizeCRTC();
+  m_command_tick_event->InvokeEarly();
+
+  m_dump_recorder = GPUDump::Recorder::Create(filename, this);
+  return static_cast<bool>(m_dump_recorder);
+}
+
+void GPU::StopDumpRecording()
+{
+  m_dump_recorder.reset();
+}
+
+const u16* GPU::ReadbackVRAM()
+{
+  FlushRender();
+  ReadVRAM(0, 0, VRAM_WIDTH, VRAM_HEIGHT);
+  return m_vram_ptr;
+}
+
+Common::Rectangle<u32> GPU::GetDisplayVRAMArea() const
+{
+  const CRTCState& cs = m_crtc_state;
+  const u32 width = m_GPUSTAT.display_area_color_depth_24 ? ((ZeroExtend32(cs.display_vram_width) * 3) + 1) / 2 :
+                                                            ZeroExtend32(cs.display_vram_width);
+  return Common::Rectangle<u32>::FromExtents(cs.display_vram_left, cs.display_vram_top, width,
+                                             cs.display_vram_height);
+}
+
+void GPU::SetSkipRendering(bool enabled)
+{
+  m_skip_rendering = enabled && !m_frame_skip_disabled;
+}
+
+bool GPU::IsInSkippableFramebuffer(const Common::Rectangle<u32>& rect) const
+{
+  for (const Common::Rectangle<u32>& fb : m_skippable_framebuffers)
+  {
+    if (rect.left >= fb.left && rect.right <= fb.right && rect.top >= fb.top && rect.bottom <= fb.bottom)
+      return true;
+  }
+
+  return false;
+}
+
+void GPU::CheckSkippedFramebufferRead(const Common::Rectangle<u32>& rect)
+{
+  // Framebuffers stay incomplete until both have been redrawn after the last skipped frame.
+  if (!m_skip_rendering && m_skipped_framebuffer_frames == 0)
+    return;
+
+  for (const Common::Rectangle<u32>& fb : m_skippable_framebuffers)
+  {
+    if (!fb.Intersects(rect))
+      continue;
+
+    Log_WarningPrintf("Framebuffer read at (%u,%u)-(%u,%u), disabling frame skipping", rect.left, rect.top, rect.right,
+                      rect.bottom);
+    m_frame_skip_disabled = true;
+    m_skip_rendering = false;
+    return;
+  }
+}
+
+void GPU::CheckSkippedTextureRead()
+{
+  CheckSkippedFramebufferRead(m_draw_mode.GetTexturePageRectangle());
+  if (m_draw_mode.IsUsingPalette())
+    CheckSkippedFramebufferRead(m_draw_mode.GetTexturePaletteRectangle());
+}
+
+void GPU::UpdateSkippableFramebuffers()
+{
+  if (m_skip_rendering)
+    m_skipped_framebuffer_frames = static_cast<u32>(m_skippable_framebuffers.size());
+  else if (m_skipped_framebuffer_frames > 0)
+    m_skipped_framebuffer_frames--;
+
+  const Common::Rectangle<u32> area = GetDisplayVRAMArea();
+  if (area == m_skippable_framebuffers[0] || !area.HasExtents())
+    return;
+
+  m_skippable_framebuffers[1] = m_skippable_framebuffers[0];
+  m_skippable_framebuffers[0] = area;
+}
+
 /**
  * NTSC GPU clock 53.693175 MHz
  * PAL GPU clock 53.203425 MHz
@@ -730,9 +886,14 @@ void GPU::CRTCTickEvent(TickCount ticks)
 
         // flush any pending draws and "scan out" the image
         FlushRender();
-        UpdateDisplay();
+        if (!m_skip_rendering)
+          UpdateDisplay();
+        UpdateSkippableFramebuffers();
         System::FrameDone();
 
+        if (m_dump_recorder)
+          m_dump_recorder->VBlank();
+
         // switch fields early. this is needed so we draw to the correct one.
         if (m_GPUSTAT.vertical_interlace)
           m_crtc_state.interlaced_field ^= 1u;
@@ -1286,8 +1447,6 @@ void GPU::SetTextureWindow(u32 value)
   if (m_draw_mode.texture_window_value == value)
     return;
 
-  FlushRender();
-
   m_draw_mode.texture_window_mask_x = value & UINT32_C(0x1F);
   m_draw_mode.texture_window_mask_y = (value >> 5) & UINT32_C(0x1F);
   m_draw_mode.texture_window_offset_x = (value >> 10) & UINT32_C(0x1F);
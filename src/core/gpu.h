@@ -18,6 +18,10 @@ class HostDisplay;
 class TimingEvent;
 class Timers;
 
+namespace GPUDump {
+class Recorder;
+}
+
 class GPU
 {
 public:
@@ -137,11 +141,18 @@ public:
   // DMA access
   void DMARead(u32* words, u32 word_count);
 
-  ALWAYS_INLINE bool BeginDMAWrite() const { return (m_GPUSTAT.dma_direction == DMADirection::CPUtoGP0); }
+  ALWAYS_INLINE bool BeginDMAWrite()
+  {
+    m_dma_write_start = m_fifo.GetSize();
+    return (m_GPUSTAT.dma_direction == DMADirection::CPUtoGP0);
+  }
   ALWAYS_INLINE void DMAWrite(u32 address, u32 value)
   {
     m_fifo.Push((ZeroExtend64(address) << 32) | ZeroExtend64(value));
   }
+
+  /// Writes a run of words which are contiguous in RAM starting at address.
+  void DMAWrite(u32 address, const u32* words, u32 word_count);
   void EndDMAWrite();
 
   /// Returns the number of pending GPU ticks.
@@ -175,12 +186,31 @@ public:
   // gpu_sw.cpp
   static std::unique_ptr<GPU> CreateSoftwareRenderer();
 
+  // gpu_null.cpp
+  static std::unique_ptr<GPU> CreateNullRenderer();
+
   // Converts window coordinates into horizontal ticks and scanlines. Returns false if out of range. Used for lightguns.
   bool ConvertScreenCoordinatesToBeamTicksAndLines(s32 window_x, s32 window_y, u32* out_tick, u32* out_line) const;
 
   // Returns the video clock frequency.
   TickCount GetCRTCFrequency() const;
 
+  /// Records everything sent to the GPU from now on to a dump file, which can be replayed with duckstation-gpu-replay.
+  bool IsRecordingDump() const { return static_cast<bool>(m_dump_recorder); }
+  bool StartDumpRecording(const char* filename);
+  void StopDumpRecording();
+
+  /// Reads VRAM back from the renderer at native resolution, after any pending drawing.
+  const u16* ReadbackVRAM();
+
+  /// Returns the area of VRAM being displayed, in 16-bit pixels. 24-bit modes cover 1.5 pixels per displayed pixel.
+  Common::Rectangle<u32> GetDisplayVRAMArea() const;
+
+  /// Frame skipping. While enabled, draws which stay inside the recently displayed framebuffers are timed but not
+  /// rendered, and the display isn't updated. Requests are ignored once the game has been seen reading a framebuffer.
+  bool IsSkippingRendering() const { return m_skip_rendering; }
+  void SetSkipRendering(bool enabled);
+
 protected:
   TickCount CRTCTicksToSystemTicks(TickCount crtc_ticks, TickCount fractional_ticks) const;
   TickCount SystemTicksToCRTCTicks(TickCount sysclk_ticks, TickCount* fractional_ticks) const;
@@ -192,6 +222,7 @@ protected:
   }
   ALWAYS_INLINE static constexpr TickCount SystemTicksToGPUTicks(TickCount sysclk_ticks) { return sysclk_ticks << 1; }
 
+public:
   // Helper/format conversion functions.
   static constexpr u8 Convert5To8(u8 x5) { return (x5 << 3) | (x5 & 7); }
   static constexpr u8 Convert8To5(u8 x8) { return (x8 >> 3); }
@@ -347,6 +378,7 @@ protected:
     }
   };
 
+protected:
   void SoftReset();
 
   // Sets dots per scanline
@@ -413,6 +445,35 @@ protected:
   /// Returns true if the drawing area is valid (i.e. left <= right, top <= bottom).
   ALWAYS_INLINE bool IsDrawingAreaIsValid() const { return m_drawing_area.Valid(); }
 
+  /// Sends the current render command to the backend, unless it can be dropped because the frame is being skipped.
+  ALWAYS_INLINE void DispatchOrSkipRenderCommand()
+  {
+    if (m_skip_rendering && SkipRenderCommand(false))
+      return;
+
+    // This draw is kept, so it had better not sample from a framebuffer which is missing draws. That includes the
+    // frames after skipping stops, until every framebuffer has been redrawn.
+    if (m_render_command.texture_enable && (m_skip_rendering || m_skipped_framebuffer_frames > 0))
+      CheckSkippedTextureRead();
+
+    DispatchRenderCommand();
+  }
+
+  /// Consumes the current render command and adds its drawing time without drawing it. Unless forced, the command is
+  /// left in place and false is returned when it draws outside the skippable framebuffers.
+  bool SkipRenderCommand(bool force);
+
+  /// Returns true if the area lies within one of the framebuffers which draws can be skipped in.
+  bool IsInSkippableFramebuffer(const Common::Rectangle<u32>& rect) const;
+
+  /// Disables frame skipping if the area overlaps a framebuffer which may be missing skipped draws.
+  void CheckSkippedFramebufferRead(const Common::Rectangle<u32>& rect);
+
+  /// Checks the texture page and palette of the current render command with CheckSkippedFramebufferRead().
+  void CheckSkippedTextureRead();
+
+  void UpdateSkippableFramebuffers();
+
   void AddCommandTicks(TickCount ticks);
 
   void WriteGP1(u32 value);
@@ -719,6 +780,7 @@ protected:
   } m_vram_transfer = {};
 
   HeapFIFOQueue<u64, MAX_FIFO_SIZE> m_fifo;
+  u32 m_dma_write_start = 0;
   std::vector<u32> m_blit_buffer;
   u32 m_blit_remaining_words;
   RenderCommand m_render_command{};
@@ -727,9 +789,24 @@ protected:
   ALWAYS_INLINE u32 FifoPeek() { return Truncate32(m_fifo.Peek()); }
   ALWAYS_INLINE u32 FifoPeek(u32 i) { return Truncate32(m_fifo.Peek(i)); }
 
+  /// Pops words from the FIFO a contiguous run at a time, dropping the DMA addresses.
+  void FifoPopRange(u32* words, u32 count);
+
+  /// Returns the index of the poly-line terminator in the FIFO, starting at index and stepping by stride, or the FIFO
+  /// size if it hasn't arrived yet.
+  u32 FindPolyLineTerminator(u32 index, u32 stride) const;
+
   TickCount m_max_run_ahead = 128;
   u32 m_fifo_size = 128;
 
+  std::unique_ptr<GPUDump::Recorder> m_dump_recorder;
+
+  // The last two distinct displayed areas, i.e. the front and back buffer when double buffering.
+  std::array<Common::Rectangle<u32>, 2> m_skippable_framebuffers{};
+  u32 m_skipped_framebuffer_frames = 0;
+  bool m_skip_rendering = false;
+  bool m_frame_skip_disabled = false;
+
   struct Stats
   {
     u32 num_vram_reads;
@@ -747,6 +824,11 @@ private:
   using GP0CommandHandlerTable = std::array<GP0CommandHandler, 256>;
   static GP0CommandHandlerTable GenerateGP0CommandHandlerTable();
 
+  /// Number of words which must be in the FIFO before each command's handler is called. Poly-lines only need their
+  /// first two vertices, the rest are collected as they arrive.
+  using GP0CommandSizeTable = std::array<u8, 256>;
+  static GP0CommandSizeTable GenerateGP0CommandSizeTable();
+
   // Rendering commands, returns false if not enough data is provided
   bool HandleUnknownGP0Command();
   bool HandleNOPCommand();
@@ -768,6 +850,7 @@ private:
   bool HandleCopyRectangleVRAMToVRAMCommand();
 
   static const GP0CommandHandlerTable s_GP0_command_handler_table;
+  static const GP0CommandSizeTable s_GP0_command_size_table;
 };
 
 IMPLEMENT_ENUM_CLASS_BITWISE_OPERATORS(GPU::TextureMode);
@@ -0,0 +1,270 @@
+#include "gpu_backend.h"
+#include "common/align.h"
+#include "common/assert.h"
+#include "common/log.h"
+#include "common/trace_recorder.h"
+Log_SetChannel(GPUBackend);
+
+GPUBackend::GPUBackend() = default;
+
+GPUBackend::~GPUBackend()
+{
+  StopThread();
+}
+
+void GPUBackend::SetUseThread(bool enable)
+{
+  if (enable)
+    StartThread();
+  else
+    StopThread();
+}
+
+void GPUBackend::Reset()
+{
+  Sync();
+}
+
+void GPUBackend::FlushRender() {}
+
+GPUBackendFillVRAMCommand* GPUBackend::NewFillVRAMCommand()
+{
+  return static_cast<GPUBackendFillVRAMCommand*>(
+    AllocateCommand(GPUBackendCommandType::FillVRAM, sizeof(GPUBackendFillVRAMCommand)));
+}
+
+GPUBackendUpdateVRAMCommand* GPUBackend::NewUpdateVRAMCommand(u32 num_pixels)
+{
+  const u32 size = sizeof(GPUBackendUpdateVRAMCommand) + (num_pixels * sizeof(u16));
+  return static_cast<GPUBackendUpdateVRAMCommand*>(AllocateCommand(GPUBackendCommandType::UpdateVRAM, size));
+}
+
+GPUBackendCopyVRAMCommand* GPUBackend::NewCopyVRAMCommand()
+{
+  return static_cast<GPUBackendCopyVRAMCommand*>(
+    AllocateCommand(GPUBackendCommandType::CopyVRAM, sizeof(GPUBackendCopyVRAMCommand)));
+}
+
+GPUBackendSetDrawingAreaCommand* GPUBackend::NewSetDrawingAreaCommand()
+{
+  return static_cast<GPUBackendSetDrawingAreaCommand*>(
+    AllocateCommand(GPUBackendCommandType::SetDrawingArea, sizeof(GPUBackendSetDrawingAreaCommand)));
+}
+
+GPUBackendDrawPolygonCommand* GPUBackend::NewDrawPolygonCommand()
+{
+  return static_cast<GPUBackendDrawPolygonCommand*>(
+    AllocateCommand(GPUBackendCommandType::DrawPolygon, sizeof(GPUBackendDrawPolygonCommand)));
+}
+
+GPUBackendDrawRectangleCommand* GPUBackend::NewDrawRectangleCommand()
+{
+  return static_cast<GPUBackendDrawRectangleCommand*>(
+    AllocateCommand(GPUBackendCommandType::DrawRectangle, sizeof(GPUBackendDrawRectangleCommand)));
+}
+
+GPUBackendDrawLineCommand* GPUBackend::NewDrawLineCommand(u32 num_vertices)
+{
+  const u32 size = sizeof(GPUBackendDrawLineCommand) + (num_vertices * sizeof(GPUBackendVertex));
+  return static_cast<GPUBackendDrawLineCommand*>(AllocateCommand(GPUBackendCommandType::DrawLine, size));
+}
+
+GPUBackendCommand* GPUBackend::AllocateCommand(GPUBackendCommandType type, u32 size)
+{
+  // Keep everything in the queue 4-byte aligned.
+  size = Common::AlignUpPow2(size, 4);
+  DebugAssert((size + sizeof(GPUBackendCommand)) < COMMAND_QUEUE_SIZE);
+
+  // Single-threaded mode executes each command as soon as it is pushed, so the start of the buffer can be reused.
+  if (!IsUsingThread())
+  {
+    GPUBackendCommand* cmd = reinterpret_cast<GPUBackendCommand*>(m_command_fifo_data.data());
+    cmd->type = type;
+    cmd->size = size;
+    return cmd;
+  }
+
+  for (;;)
+  {
+    const u32 read_ptr = m_command_fifo_read_ptr.load(std::memory_order_acquire);
+    const u32 write_ptr = m_command_fifo_write_ptr.load(std::memory_order_relaxed);
+    if (read_ptr > write_ptr)
+    {
+      // The write pointer must never catch up to the read pointer, otherwise the queue would appear empty.
+      if ((read_ptr - write_ptr) <= size)
+      {
+        WakeGPUThread();
+        std::this_thread::yield();
+        continue;
+      }
+    }
+    else
+    {
+      // Always leave room at the end of the buffer for a wraparound command.
+      const u32 available_to_end = COMMAND_QUEUE_SIZE - write_ptr;
+      if ((size + sizeof(GPUBackendCommand)) > available_to_end)
+      {
+        // Can't wrap until the worker has moved off the start of the buffer.
+        if (read_ptr == 0)
+        {
+          WakeGPUThread();
+          std::this_thread::yield();
+          continue;
+        }
+
+        GPUBackendCommand* wraparound_cmd = reinterpret_cast<GPUBackendCommand*>(&m_command_fifo_data[write_ptr]);
+        wraparound_cmd->type = GPUBackendCommandType::Wraparound;
+        wraparound_cmd->size = available_to_end;
+        m_command_fifo_write_ptr.store(0);
+        continue;
+      }
+    }
+
+    GPUBackendCommand* cmd = reinterpret_cast<GPUBackendCommand*>(&m_command_fifo_data[write_ptr]);
+    cmd->type = type;
+    cmd->size = size;
+    return cmd;
+  }
+}
+
+u32 GPUBackend::GetPendingCommandSize() const
+{
+  const u32 read_ptr = m_command_fifo_read_ptr.load(std::memory_order_relaxed);
+  const u32 write_ptr = m_command_fifo_write_ptr.load(std::memory_order_relaxed);
+  return (write_ptr >= read_ptr) ? (write_ptr - read_ptr) : (COMMAND_QUEUE_SIZE - read_ptr + write_ptr);
+}
+
+void GPUBackend::PushCommand(GPUBackendCommand* cmd)
+{
+  if (!IsUsingThread())
+  {
+    HandleCommand(cmd);
+    return;
+  }
+
+  const u32 new_write_ptr = m_command_fifo_write_ptr.load(std::memory_order_relaxed) + cmd->size;
+  DebugAssert(new_write_ptr <= COMMAND_QUEUE_SIZE);
+  m_command_fifo_write_ptr.store(new_write_ptr);
+
+  if (GetPendingCommandSize() >= THRESHOLD_TO_WAKE_GPU)
+    WakeGPUThread();
+}
+
+void GPUBackend::WakeGPUThread()
+{
+  // Both this and the worker's store to the sleeping flag are sequentially consistent with the write pointer, so if
+  // we see the worker awake, it will see our commands before going to sleep.
+  if (!m_gpu_thread_sleeping.load())
+    return;
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_wake_gpu_thread_cv.notify_one();
+}
+
+void GPUBackend::Sync()
+{
+  if (!IsUsingThread())
+  {
+    FlushRender();
+    return;
+  }
+
+  TraceRecorder::ScopedSpan trace_span("GPUBackend::Sync");
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_wake_gpu_thread_cv.notify_one();
+
+  // The worker only goes to sleep after flushing, so an empty queue alone does not mean the work is complete.
+  m_sync_cv.wait(lock, [this]() {
+    return m_gpu_thread_sleeping.load() &&
+           m_command_fifo_read_ptr.load(std::memory_order_acquire) == m_command_fifo_write_ptr.load();
+  });
+}
+
+void GPUBackend::StartThread()
+{
+  if (IsUsingThread())
+    return;
+
+  m_command_fifo_read_ptr.store(0);
+  m_command_fifo_write_ptr.store(0);
+  m_shutdown_flag.store(false);
+  m_gpu_thread = std::thread(&GPUBackend::RunGPULoop, this);
+  Log_InfoPrintf("GPU worker thread started");
+}
+
+void GPUBackend::StopThread()
+{
+  if (!IsUsingThread())
+    return;
+
+  Sync();
+
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_shutdown_flag.store(true);
+    m_wake_gpu_thread_cv.notify_one();
+  }
+
+  m_gpu_thread.join();
+  m_command_fifo_read_ptr.store(0);
+  m_command_fifo_write_ptr.store(0);
+  Log_InfoPrintf("GPU worker thread stopped");
+}
+
+void GPUBackend::ProcessGPUCommands()
+{
+  TraceRecorder::ScopedSpan trace_span("ProcessGPUCommands");
+
+  for (;;)
+  {
+    const u32 write_ptr = m_command_fifo_write_ptr.load(std::memory_order_acquire);
+    u32 read_ptr = m_command_fifo_read_ptr.load(std::memory_order_relaxed);
+    if (read_ptr == write_ptr)
+      return;
+
+    while (read_ptr != write_ptr)
+    {
+      const GPUBackendCommand* cmd = reinterpret_cast<const GPUBackendCommand*>(&m_command_fifo_data[read_ptr]);
+      if (cmd->type == GPUBackendCommandType::Wraparound)
+      {
+        read_ptr = 0;
+      }
+      else
+      {
+        HandleCommand(cmd);
+        read_ptr += cmd->size;
+      }
+
+      m_command_fifo_read_ptr.store(read_ptr, std::memory_order_release);
+    }
+  }
+}
+
+void GPUBackend::RunGPULoop()
+{
+  TraceRecorder::SetThreadName("GPU Worker");
+
+  for (;;)
+  {
+    ProcessGPUCommands();
+    FlushRender();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_gpu_thread_sleeping.store(true);
+
+    bool empty;
+    while ((empty = (m_command_fifo_read_ptr.load(std::memory_order_relaxed) == m_command_fifo_write_ptr.load())) &&
+           !m_shutdown_flag.load())
+    {
+      m_sync_cv.notify_all();
+      m_wake_gpu_thread_cv.wait(lock);
+    }
+
+    m_gpu_thread_sleeping.store(false);
+    if (empty)
+    {
+      m_sync_cv.notify_all();
+      break;
+    }
+  }
+}
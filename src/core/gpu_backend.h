@@ -0,0 +1,202 @@
+#pragma once
+#include "common/bitfield.h"
+#include "common/heap_array.h"
+#include "common/rectangle.h"
+#include "gpu.h"
+#include "types.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <tuple>
+
+enum class GPUBackendCommandType : u8
+{
+  Wraparound,
+  FillVRAM,
+  UpdateVRAM,
+  CopyVRAM,
+  SetDrawingArea,
+  DrawPolygon,
+  DrawRectangle,
+  DrawLine
+};
+
+/// GPUSTAT/CRTC state captured when the command was issued, since the backend may execute it later.
+union GPUBackendCommandParameters
+{
+  u8 bits;
+
+  BitField<u8, bool, 0, 1> interlaced_rendering;
+  BitField<u8, u8, 1, 1> active_line_lsb;
+  BitField<u8, bool, 2, 1> set_mask_while_drawing;
+  BitField<u8, bool, 3, 1> check_mask_before_draw;
+
+  u16 GetMaskAND() const { return Truncate16((ZeroExtend32(bits) << 12) & 0x8000u); }
+  u16 GetMaskOR() const { return Truncate16((ZeroExtend32(bits) << 13) & 0x8000u); }
+};
+
+struct GPUBackendCommand
+{
+  u32 size;
+  GPUBackendCommandType type;
+  GPUBackendCommandParameters params;
+};
+
+struct GPUBackendFillVRAMCommand : public GPUBackendCommand
+{
+  u16 x;
+  u16 y;
+  u16 width;
+  u16 height;
+  u32 color;
+};
+
+struct GPUBackendUpdateVRAMCommand : public GPUBackendCommand
+{
+  u16 x;
+  u16 y;
+  u16 width;
+  u16 height;
+
+  /// The pixel data directly follows the command in the queue.
+  const u16* GetData() const { return reinterpret_cast<const u16*>(this + 1); }
+  u16* GetData() { return reinterpret_cast<u16*>(this + 1); }
+};
+
+struct GPUBackendCopyVRAMCommand : public GPUBackendCommand
+{
+  u16 src_x;
+  u16 src_y;
+  u16 dst_x;
+  u16 dst_y;
+  u16 width;
+  u16 height;
+};
+
+struct GPUBackendSetDrawingAreaCommand : public GPUBackendCommand
+{
+  Common::Rectangle<u32> new_area;
+};
+
+/// Vertex positions include the drawing offset.
+struct GPUBackendVertex
+{
+  s32 x, y;
+  u8 color_r, color_g, color_b;
+  u8 texcoord_x, texcoord_y;
+
+  ALWAYS_INLINE void SetPosition(s32 x_, s32 y_)
+  {
+    x = x_;
+    y = y_;
+  }
+
+  ALWAYS_INLINE void SetColorRGB24(u32 color) { std::tie(color_r, color_g, color_b) = GPU::UnpackColorRGB24(color); }
+  ALWAYS_INLINE void SetTexcoord(u16 value) { std::tie(texcoord_x, texcoord_y) = GPU::UnpackTexcoord(value); }
+};
+
+/// Draw state is decoded on the CPU thread, so the backend does not need access to the GPU registers.
+struct GPUBackendDrawCommand : public GPUBackendCommand
+{
+  GPU::RenderCommand rc;
+  GPU::TextureMode texture_mode;
+  GPU::TransparencyMode transparency_mode;
+  bool dithering_enable;
+  u16 texture_page_x;
+  u16 texture_page_y;
+  u16 texture_palette_x;
+  u16 texture_palette_y;
+
+  // texcoord = (texcoord & and) | or
+  u8 texture_window_and_x;
+  u8 texture_window_and_y;
+  u8 texture_window_or_x;
+  u8 texture_window_or_y;
+};
+
+struct GPUBackendDrawPolygonCommand : public GPUBackendDrawCommand
+{
+  u32 num_vertices;
+  GPUBackendVertex vertices[4];
+};
+
+struct GPUBackendDrawRectangleCommand : public GPUBackendDrawCommand
+{
+  s32 x;
+  s32 y;
+  u16 width;
+  u16 height;
+  u8 color_r, color_g, color_b;
+  u8 texcoord_x, texcoord_y;
+};
+
+struct GPUBackendDrawLineCommand : public GPUBackendDrawCommand
+{
+  u32 num_vertices;
+
+  /// Poly-lines have a variable number of vertices, which directly follow the command in the queue.
+  const GPUBackendVertex* GetVertices() const { return reinterpret_cast<const GPUBackendVertex*>(this + 1); }
+  GPUBackendVertex* GetVertices() { return reinterpret_cast<GPUBackendVertex*>(this + 1); }
+};
+
+/// Executes pre-decoded GPU commands, optionally on a worker thread. The CPU thread allocates a command in the queue,
+/// fills it in and pushes it, and only waits for the worker when it needs to observe the results (e.g. VRAM reads).
+class GPUBackend
+{
+public:
+  GPUBackend();
+  virtual ~GPUBackend();
+
+  bool IsUsingThread() const { return m_gpu_thread.joinable(); }
+  void SetUseThread(bool enable);
+
+  virtual void Reset();
+
+  GPUBackendFillVRAMCommand* NewFillVRAMCommand();
+  GPUBackendUpdateVRAMCommand* NewUpdateVRAMCommand(u32 num_pixels);
+  GPUBackendCopyVRAMCommand* NewCopyVRAMCommand();
+  GPUBackendSetDrawingAreaCommand* NewSetDrawingAreaCommand();
+  GPUBackendDrawPolygonCommand* NewDrawPolygonCommand();
+  GPUBackendDrawRectangleCommand* NewDrawRectangleCommand();
+  GPUBackendDrawLineCommand* NewDrawLineCommand(u32 num_vertices);
+
+  /// Commits the most recently allocated command. Only one command can be allocated at a time.
+  void PushCommand(GPUBackendCommand* cmd);
+
+  /// Blocks until all pushed commands have been executed.
+  void Sync();
+
+protected:
+  virtual void HandleCommand(const GPUBackendCommand* cmd) = 0;
+
+  /// Called once the queue has drained, before the backend reports itself as idle to Sync().
+  virtual void FlushRender();
+
+private:
+  enum : u32
+  {
+    COMMAND_QUEUE_SIZE = 4 * 1024 * 1024,
+    THRESHOLD_TO_WAKE_GPU = 1024
+  };
+
+  GPUBackendCommand* AllocateCommand(GPUBackendCommandType type, u32 size);
+  u32 GetPendingCommandSize() const;
+  void WakeGPUThread();
+
+  void StartThread();
+  void StopThread();
+  void ProcessGPUCommands();
+  void RunGPULoop();
+
+  HeapArray<u8, COMMAND_QUEUE_SIZE> m_command_fifo_data;
+  std::atomic<u32> m_command_fifo_read_ptr{0};
+  std::atomic<u32> m_command_fifo_write_ptr{0};
+
+  std::mutex m_mutex;
+  std::thread m_gpu_thread;
+  std::condition_variable m_wake_gpu_thread_cv;
+  std::condition_variable m_sync_cv;
+  std::atomic_bool m_gpu_thread_sleeping{false};
+  std::atomic_bool m_shutdown_flag{true};
+};
@@ -1,18 +1,12 @@
 #include "common/assert.h"
 #include "common/log.h"
 #include "common/string_util.h"
+#include "frame_profiler.h"
 #include "gpu.h"
 #include "interrupt_controller.h"
 #include "system.h"
 Log_SetChannel(GPU);
 
-#define CHECK_COMMAND_SIZE(num_words)                                                                                  \
-  if (m_fifo.GetSize() < num_words)                                                                                    \
-  {                                                                                                                    \
-    m_command_total_words = num_words;                                                                                 \
-    return false;                                                                                                      \
-  }
-
 static u32 s_cpu_to_vram_dump_id = 1;
 static u32 s_vram_to_cpu_dump_id = 1;
 
@@ -23,6 +17,7 @@ static constexpr u32 ReplaceZero(u32 value, u32 value_for_zero)
 
 void GPU::ExecuteCommands()
 {
+  FrameProfiler::ScopedTimer profile_timer(FrameProfiler::SLOT_GPU_COMMANDS);
   m_syncing = true;
 
   for (;;)
@@ -33,7 +28,15 @@ void GPU::ExecuteCommands()
       {
         case BlitterState::Idle:
         {
+          // handlers can assume the whole packet is there
           const u32 command = FifoPeek(0) >> 24;
+          const u32 command_words = s_GP0_command_size_table[command];
+          if (m_fifo.GetSize() < command_words)
+          {
+            m_command_total_words = command_words;
+            goto batch_done;
+          }
+
           if ((this->*s_GP0_command_handler_table[command])())
             continue;
           else
@@ -45,11 +48,8 @@ void GPU::ExecuteCommands()
           DebugAssert(m_blit_remaining_words > 0);
           const u32 words_to_copy = std::min(m_blit_remaining_words, m_fifo.GetSize());
           const size_t old_size = m_blit_buffer.size();
-          // m_blit_buffer.resize(m_blit_buffer.size() + words_to_copy);
-          // FifoPopRange(&m_blit_buffer[old_size], words_to_copy);
-          m_blit_buffer.reserve(m_blit_buffer.size() + words_to_copy);
-          for (u32 i = 0; i < words_to_copy; i++)
-            m_blit_buffer.push_back(FifoPop());
+          m_blit_buffer.resize(old_size + words_to_copy);
+          FifoPopRange(&m_blit_buffer[old_size], words_to_copy);
           m_blit_remaining_words -= words_to_copy;
           AddCommandTicks(words_to_copy);
 
@@ -68,27 +68,19 @@ void GPU::ExecuteCommands()
 
         case BlitterState::DrawingPolyLine:
         {
+          // terminator is on the first word for the vertex
           const u32 words_per_vertex = m_render_command.shading_enable ? 2 : 1;
-          u32 terminator_index =
-            m_render_command.shading_enable ? ((static_cast<u32>(m_blit_buffer.size()) & 1u) ^ 1u) : 0u;
-          for (; terminator_index < m_fifo.GetSize(); terminator_index += words_per_vertex)
-          {
-            // polyline must have at least two vertices, and the terminator is (word & 0xf000f000) == 0x50005000.
-            // terminator is on the first word for the vertex
-            if ((FifoPeek(terminator_index) & UINT32_C(0xF000F000)) == UINT32_C(0x50005000))
-              break;
-          }
+          const u32 terminator_index = FindPolyLineTerminator(
+            m_render_command.shading_enable ? ((static_cast<u32>(m_blit_buffer.size()) & 1u) ^ 1u) : 0u,
+            words_per_vertex);
 
           const bool found_terminator = (terminator_index < m_fifo.GetSize());
           const u32 words_to_copy = std::min(terminator_index, m_fifo.GetSize());
           if (words_to_copy > 0)
           {
             const size_t old_size = m_blit_buffer.size();
-            // m_blit_buffer.resize(m_blit_buffer.size() + words_to_copy);
-            // FifoPopRange(&m_blit_buffer[old_size], words_to_copy);
-            m_blit_buffer.reserve(m_blit_buffer.size() + words_to_copy);
-            for (u32 i = 0; i < words_to_copy; i++)
-              m_blit_buffer.push_back(FifoPop());
+            m_blit_buffer.resize(old_size + words_to_copy);
+            FifoPopRange(&m_blit_buffer[old_size], words_to_copy);
           }
 
           Log_DebugPrintf("Added %u words to polyline", words_to_copy);
@@ -97,7 +89,7 @@ void GPU::ExecuteCommands()
             // drop terminator
             m_fifo.RemoveOne();
             Log_DebugPrintf("Drawing poly-line with %u vertices", GetPolyLineVertexCount());
-            DispatchRenderCommand();
+            DispatchOrSkipRenderCommand();
             m_blit_buffer.clear();
             EndCommand();
             continue;
@@ -118,6 +110,45 @@ void GPU::ExecuteCommands()
   m_syncing = false;
 }
 
+void GPU::FifoPopRange(u32* words, u32 count)
+{
+  DebugAssert(count <= m_fifo.GetSize());
+  while (count > 0)
+  {
+    const u32 run = std::min(count, m_fifo.GetContiguousSize());
+    const u64* fifo_words = m_fifo.GetReadPointer();
+    for (u32 i = 0; i < run; i++)
+      words[i] = Truncate32(fifo_words[i]);
+
+    m_fifo.Remove(run);
+    words += run;
+    count -= run;
+  }
+}
+
+u32 GPU::FindPolyLineTerminator(u32 index, u32 stride) const
+{
+  // polyline must have at least two vertices, and the terminator is (word & 0xf000f000) == 0x50005000.
+  // the FIFO is searched in place, as at most two contiguous runs
+  const u32 size = m_fifo.GetSize();
+  const u32 first_run = m_fifo.GetContiguousSize();
+  const u64* fifo_words = m_fifo.GetReadPointer();
+  for (; index < first_run; index += stride)
+  {
+    if ((Truncate32(fifo_words[index]) & UINT32_C(0xF000F000)) == UINT32_C(0x50005000))
+      return index;
+  }
+
+  fifo_words = m_fifo.GetDataPointer();
+  for (; index < size; index += stride)
+  {
+    if ((Truncate32(fifo_words[index - first_run]) & UINT32_C(0xF000F000)) == UINT32_C(0x50005000))
+      return index;
+  }
+
+  return size;
+}
+
 void GPU::EndCommand()
 {
   m_blitter_state = BlitterState::Idle;
@@ -174,6 +205,50 @@ GPU::GP0CommandHandlerTable GPU::GenerateGP0CommandHandlerTable()
   return table;
 }
 
+GPU::GP0CommandSizeTable GPU::GenerateGP0CommandSizeTable()
+{
+  GP0CommandSizeTable table = {};
+  for (u32 i = 0; i < static_cast<u32>(table.size()); i++)
+    table[i] = 1;
+  table[0x02] = 3;
+  for (u32 i = 0x20; i <= 0x7F; i++)
+  {
+    const RenderCommand rc{i << 24};
+    switch (rc.primitive)
+    {
+      case Primitive::Polygon:
+      {
+        // shaded vertices use the colour from the first word for the first vertex
+        const u32 words_per_vertex = 1 + BoolToUInt32(rc.texture_enable) + BoolToUInt32(rc.shading_enable);
+        const u32 num_vertices = rc.quad_polygon ? 4 : 3;
+        table[i] = static_cast<u8>(words_per_vertex * num_vertices + BoolToUInt32(!rc.shading_enable));
+      }
+      break;
+      case Primitive::Line:
+      {
+        // always read the first two vertices of poly-lines, we test for the terminator after that
+        if (rc.polyline)
+          table[i] = rc.shading_enable ? 3 : 4;
+        else
+          table[i] = rc.shading_enable ? 4 : 3;
+      }
+      break;
+      case Primitive::Rectangle:
+        table[i] = static_cast<u8>(2 + BoolToUInt32(rc.texture_enable) +
+                                   BoolToUInt32(rc.rectangle_size == DrawRectangleSize::Variable));
+        break;
+      default:
+        break;
+    }
+  }
+  for (u32 i = 0x80; i <= 0x9F; i++)
+    table[i] = 4;
+  for (u32 i = 0xA0; i <= 0xDF; i++)
+    table[i] = 3;
+
+  return table;
+}
+
 bool GPU::HandleUnknownGP0Command()
 {
   const u32 command = FifoPeek() >> 24;
@@ -290,13 +365,8 @@ bool GPU::HandleSetDrawingOffsetCommand()
   const s32 x = SignExtendN<11, s32>(param & 0x7FFu);
   const s32 y = SignExtendN<11, s32>((param >> 11) & 0x7FFu);
   Log_DebugPrintf("Set drawing offset (%d, %d)", m_drawing_offset.x, m_drawing_offset.y);
-  if (m_drawing_offset.x != x || m_drawing_offset.y != y)
-  {
-    FlushRender();
-
-    m_drawing_offset.x = x;
-    m_drawing_offset.y = y;
-  }
+  m_drawing_offset.x = x;
+  m_drawing_offset.y = y;
 
   AddCommandTicks(1);
   EndCommand();
@@ -309,11 +379,7 @@ bool GPU::HandleSetMaskBitCommand()
 
   constexpr u32 gpustat_mask = (1 << 11) | (1 << 12);
   const u32 gpustat_bits = (param & 0x03) << 11;
-  if ((m_GPUSTAT.bits & gpustat_mask) != gpustat_bits)
-  {
-    FlushRender();
-    m_GPUSTAT.bits = (m_GPUSTAT.bits & ~gpustat_mask) | gpustat_bits;
-  }
+  m_GPUSTAT.bits = (m_GPUSTAT.bits & ~gpustat_mask) | gpustat_bits;
   Log_DebugPrintf("Set mask bit %u %u", BoolToUInt32(m_GPUSTAT.set_mask_while_drawing),
                   BoolToUInt32(m_GPUSTAT.check_mask_before_draw));
 
@@ -325,12 +391,7 @@ bool GPU::HandleSetMaskBitCommand()
 bool GPU::HandleRenderPolygonCommand()
 {
   const RenderCommand rc{FifoPeek(0)};
-
-  // shaded vertices use the colour from the first word for the first vertex
-  const u32 words_per_vertex = 1 + BoolToUInt32(rc.texture_enable) + BoolToUInt32(rc.shading_enable);
   const u32 num_vertices = rc.quad_polygon ? 4 : 3;
-  const u32 total_words = words_per_vertex * num_vertices + BoolToUInt32(!rc.shading_enable);
-  CHECK_COMMAND_SIZE(total_words);
 
   if (IsInterlacedRenderingEnabled() && IsCRTCScanlinePending())
     SynchronizeCRTC();
@@ -341,11 +402,11 @@ bool GPU::HandleRenderPolygonCommand()
     s_setup_time[BoolToUInt8(rc.quad_polygon)][BoolToUInt8(rc.shading_enable)][BoolToUInt8(rc.texture_enable)]));
   AddCommandTicks(setup_ticks);
 
-  Log_TracePrintf("Render %s %s %s %s polygon (%u verts, %u words per vert), %d setup ticks",
+  Log_TracePrintf("Render %s %s %s %s polygon (%u verts, %u total words), %d setup ticks",
                   rc.quad_polygon ? "four-point" : "three-point",
                   rc.transparency_enable ? "semi-transparent" : "opaque",
                   rc.texture_enable ? "textured" : "non-textured", rc.shading_enable ? "shaded" : "monochrome",
-                  ZeroExtend32(num_vertices), ZeroExtend32(words_per_vertex), setup_ticks);
+                  ZeroExtend32(num_vertices), ZeroExtend32(s_GP0_command_size_table[rc.bits >> 24]), setup_ticks);
 
   // set draw state up
   if (rc.texture_enable)
@@ -361,7 +422,7 @@ bool GPU::HandleRenderPolygonCommand()
   m_render_command.bits = rc.bits;
   m_fifo.RemoveOne();
 
-  DispatchRenderCommand();
+  DispatchOrSkipRenderCommand();
   EndCommand();
   return true;
 }
@@ -369,10 +430,6 @@ bool GPU::HandleRenderPolygonCommand()
 bool GPU::HandleRenderRectangleCommand()
 {
   const RenderCommand rc{FifoPeek(0)};
-  const u32 total_words =
-    2 + BoolToUInt32(rc.texture_enable) + BoolToUInt32(rc.rectangle_size == DrawRectangleSize::Variable);
-
-  CHECK_COMMAND_SIZE(total_words);
 
   if (IsInterlacedRenderingEnabled() && IsCRTCScanlinePending())
     SynchronizeCRTC();
@@ -386,14 +443,14 @@ bool GPU::HandleRenderRectangleCommand()
   Log_TracePrintf("Render %s %s %s rectangle (%u words), %d setup ticks",
                   rc.transparency_enable ? "semi-transparent" : "opaque",
                   rc.texture_enable ? "textured" : "non-textured", rc.shading_enable ? "shaded" : "monochrome",
-                  total_words, setup_ticks);
+                  ZeroExtend32(s_GP0_command_size_table[rc.bits >> 24]), setup_ticks);
 
   m_stats.num_vertices++;
   m_stats.num_polygons++;
   m_render_command.bits = rc.bits;
   m_fifo.RemoveOne();
 
-  DispatchRenderCommand();
+  DispatchOrSkipRenderCommand();
   EndCommand();
   return true;
 }
@@ -401,21 +458,18 @@ bool GPU::HandleRenderRectangleCommand()
 bool GPU::HandleRenderLineCommand()
 {
   const RenderCommand rc{FifoPeek(0)};
-  const u32 total_words = rc.shading_enable ? 4 : 3;
-  CHECK_COMMAND_SIZE(total_words);
-
   if (IsInterlacedRenderingEnabled() && IsCRTCScanlinePending())
     SynchronizeCRTC();
 
   Log_TracePrintf("Render %s %s line (%u total words)", rc.transparency_enable ? "semi-transparent" : "opaque",
-                  rc.shading_enable ? "shaded" : "monochrome", total_words);
+                  rc.shading_enable ? "shaded" : "monochrome", ZeroExtend32(s_GP0_command_size_table[rc.bits >> 24]));
 
   m_stats.num_vertices += 2;
   m_stats.num_polygons++;
   m_render_command.bits = rc.bits;
   m_fifo.RemoveOne();
 
-  DispatchRenderCommand();
+  DispatchOrSkipRenderCommand();
   EndCommand();
   return true;
 }
@@ -425,8 +479,6 @@ bool GPU::HandleRenderPolyLineCommand()
   // always read the first two vertices, we test for the terminator after that
   const RenderCommand rc{FifoPeek(0)};
   const u32 min_words = rc.shading_enable ? 3 : 4;
-  CHECK_COMMAND_SIZE(min_words);
-
   if (IsInterlacedRenderingEnabled() && IsCRTCScanlinePending())
     SynchronizeCRTC();
 
@@ -452,10 +504,171 @@ bool GPU::HandleRenderPolyLineCommand()
   return true;
 }
 
-bool GPU::HandleFillRectangleCommand()
+bool GPU::SkipRenderCommand(bool force)
 {
-  CHECK_COMMAND_SIZE(3);
+  const RenderCommand rc{m_render_command.bits};
+
+  // Calls the visitor with the clipped area of each primitive in the command, skipping those which aren't drawn.
+  // Polylines have been collected in the blit buffer, everything else is still in the FIFO.
+  const auto visit_primitives = [this, rc](const auto& visitor) {
+    const auto visit = [this, &visitor](s32 min_x, s32 min_y, s32 max_x, s32 max_y) {
+      if ((max_x - min_x) >= static_cast<s32>(MAX_PRIMITIVE_WIDTH) ||
+          (max_y - min_y) >= static_cast<s32>(MAX_PRIMITIVE_HEIGHT))
+        return;
+
+      const u32 clip_left = static_cast<u32>(std::clamp<s32>(min_x, m_drawing_area.left, m_drawing_area.right));
+      const u32 clip_right = static_cast<u32>(std::clamp<s32>(max_x, m_drawing_area.left, m_drawing_area.right)) + 1u;
+      const u32 clip_top = static_cast<u32>(std::clamp<s32>(min_y, m_drawing_area.top, m_drawing_area.bottom));
+      const u32 clip_bottom =
+        static_cast<u32>(std::clamp<s32>(max_y, m_drawing_area.top, m_drawing_area.bottom)) + 1u;
+      visitor(Common::Rectangle<u32>(clip_left, clip_top, clip_right, clip_bottom));
+    };
+
+    switch (rc.primitive)
+    {
+      case Primitive::Polygon:
+      {
+        const u32 num_vertices = rc.quad_polygon ? 4 : 3;
+        // The first vertex's colour is in the command word.
+        const u32 vertex_words = 1u + BoolToUInt32(rc.texture_enable) + BoolToUInt32(rc.shading_enable);
+        s32 x[4], y[4];
+        for (u32 i = 0; i < num_vertices; i++)
+        {
+          const VertexPosition vp{FifoPeek(i * vertex_words)};
+          x[i] = m_drawing_offset.x + vp.x;
+          y[i] = m_drawing_offset.y + vp.y;
+        }
+
+        visit(std::min({x[0], x[1], x[2]}), std::min({y[0], y[1], y[2]}), std::max({x[0], x[1], x[2]}),
+              std::max({y[0], y[1], y[2]}));
+        if (rc.quad_polygon)
+        {
+          visit(std::min({x[1], x[2], x[3]}), std::min({y[1], y[2], y[3]}), std::max({x[1], x[2], x[3]}),
+                std::max({y[1], y[2], y[3]}));
+        }
+      }
+      break;
+
+      case Primitive::Rectangle:
+      {
+        const VertexPosition vp{FifoPeek(0)};
+        s32 width;
+        s32 height;
+        switch (rc.rectangle_size)
+        {
+          case DrawRectangleSize::R1x1:
+            width = 1;
+            height = 1;
+            break;
+          case DrawRectangleSize::R8x8:
+            width = 8;
+            height = 8;
+            break;
+          case DrawRectangleSize::R16x16:
+            width = 16;
+            height = 16;
+            break;
+          default:
+          {
+            const u32 width_and_height = FifoPeek(1u + BoolToUInt32(rc.texture_enable));
+            width = static_cast<s32>(width_and_height & VRAM_WIDTH_MASK);
+            height = static_cast<s32>((width_and_height >> 16) & VRAM_HEIGHT_MASK);
+          }
+          break;
+        }
+
+        const s32 start_x = TruncateVertexPosition(m_drawing_offset.x + vp.x);
+        const s32 start_y = TruncateVertexPosition(m_drawing_offset.y + vp.y);
+        visit(start_x, start_y, start_x + width, start_y + height);
+      }
+      break;
+
+      case Primitive::Line:
+      {
+        const bool polyline = rc.polyline;
+        const u32 num_vertices = polyline ? GetPolyLineVertexCount() : 2;
+        const u32 vertex_words = 1u + BoolToUInt32(rc.shading_enable);
+        s32 last_x = 0;
+        s32 last_y = 0;
+        for (u32 i = 0; i < num_vertices; i++)
+        {
+          const u32 index = i * vertex_words;
+          const VertexPosition vp{polyline ? m_blit_buffer[index] : FifoPeek(index)};
+          const s32 x = m_drawing_offset.x + vp.x;
+          const s32 y = m_drawing_offset.y + vp.y;
+          if (i > 0)
+            visit(std::min(last_x, x), std::min(last_y, y), std::max(last_x, x), std::max(last_y, y));
+
+          last_x = x;
+          last_y = y;
+        }
+      }
+      break;
 
+      default:
+        UnreachableCode();
+        break;
+    }
+  };
+
+  if (!force && IsDrawingAreaIsValid())
+  {
+    bool skippable = true;
+    visit_primitives([this, &skippable](const Common::Rectangle<u32>& rect) {
+      skippable = skippable && IsInSkippableFramebuffer(rect);
+    });
+
+    if (!skippable)
+      return false;
+  }
+
+  if (IsDrawingAreaIsValid())
+  {
+    visit_primitives([this, rc](const Common::Rectangle<u32>& rect) {
+      switch (rc.primitive)
+      {
+        case Primitive::Polygon:
+          AddDrawTriangleTicks(rect.GetWidth(), rect.GetHeight(), rc.shading_enable, rc.texture_enable,
+                               rc.transparency_enable);
+          break;
+        case Primitive::Rectangle:
+          AddDrawRectangleTicks(rect.GetWidth(), rect.GetHeight(), rc.texture_enable, rc.transparency_enable);
+          break;
+        default:
+          AddDrawLineTicks(rect.GetWidth(), rect.GetHeight(), rc.shading_enable);
+          break;
+      }
+    });
+  }
+
+  // Drop the command's words, as the backend would have.
+  switch (rc.primitive)
+  {
+    case Primitive::Polygon:
+    {
+      const u32 num_vertices = rc.quad_polygon ? 4 : 3;
+      m_fifo.Remove(num_vertices * (1u + BoolToUInt32(rc.texture_enable)) +
+                    (rc.shading_enable ? (num_vertices - 1u) : 0u));
+    }
+    break;
+
+    case Primitive::Rectangle:
+      m_fifo.Remove(1u + BoolToUInt32(rc.texture_enable) +
+                    BoolToUInt32(rc.rectangle_size == DrawRectangleSize::Variable));
+      break;
+
+    case Primitive::Line:
+    default:
+      if (!rc.polyline)
+        m_fifo.Remove(2u + BoolToUInt32(rc.shading_enable));
+      break;
+  }
+
+  return true;
+}
+
+bool GPU::HandleFillRectangleCommand()
+{
   if (IsInterlacedRenderingEnabled() && IsCRTCScanlinePending())
     SynchronizeCRTC();
 
@@ -478,7 +691,6 @@ bool GPU::HandleFillRectangleCommand()
 
 bool GPU::HandleCopyRectangleCPUToVRAMCommand()
 {
-  CHECK_COMMAND_SIZE(3);
   m_fifo.RemoveOne();
 
   const u32 dst_x = FifoPeek() & VRAM_COORD_MASK;
@@ -526,7 +738,6 @@ void GPU::FinishVRAMWrite()
 
 bool GPU::HandleCopyRectangleVRAMToCPUCommand()
 {
-  CHECK_COMMAND_SIZE(3);
   m_fifo.RemoveOne();
 
   m_vram_transfer.x = Truncate16(FifoPeek() & VRAM_COORD_MASK);
@@ -538,6 +749,9 @@ bool GPU::HandleCopyRectangleVRAMToCPUCommand()
                   m_vram_transfer.width, m_vram_transfer.height);
   DebugAssert(m_vram_transfer.col == 0 && m_vram_transfer.row == 0);
 
+  CheckSkippedFramebufferRead(Common::Rectangle<u32>::FromExtents(m_vram_transfer.x, m_vram_transfer.y,
+                                                                   m_vram_transfer.width, m_vram_transfer.height));
+
   // all rendering should be done first...
   FlushRender();
 
@@ -560,7 +774,6 @@ bool GPU::HandleCopyRectangleVRAMToCPUCommand()
 
 bool GPU::HandleCopyRectangleVRAMToVRAMCommand()
 {
-  CHECK_COMMAND_SIZE(4);
   m_fifo.RemoveOne();
 
   const u32 src_x = FifoPeek() & VRAM_COORD_MASK;
@@ -573,6 +786,10 @@ bool GPU::HandleCopyRectangleVRAMToVRAMCommand()
   Log_DebugPrintf("Copy rectangle from VRAM to VRAM src=(%u,%u), dst=(%u,%u), size=(%u,%u)", src_x, src_y, dst_x, dst_y,
                   width, height);
 
+  // Copies between framebuffers are fine, copying out of one is treated as a read.
+  if (!IsInSkippableFramebuffer(Common::Rectangle<u32>::FromExtents(dst_x, dst_y, width, height)))
+    CheckSkippedFramebufferRead(Common::Rectangle<u32>::FromExtents(src_x, src_y, width, height));
+
   FlushRender();
   CopyVRAM(src_x, src_y, dst_x, dst_y, width, height);
   m_stats.num_vram_copies++;
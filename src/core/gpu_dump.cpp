@@ -0,0 +1,399 @@
+#include "gpu_dump.h"
+#include "common/byte_stream.h"
+#include "common/log.h"
+#include "common/state_wrapper.h"
+#include "cpu_core.h"
+#include "gpu.h"
+#include "save_state_version.h"
+#include "timing_event.h"
+#include "zlib.h"
+#include <cstring>
+Log_SetChannel(GPUDump);
+
+namespace GPUDump {
+
+struct FileHeader
+{
+  u32 magic;
+  u32 version;
+  u32 state_version;
+  u32 state_size;
+};
+
+static constexpr u32 FILE_MAGIC = 0x44555047; // GPUD
+static constexpr u32 FILE_VERSION = 1;
+
+// Frames larger than this are assumed to be corrupted.
+static constexpr u32 MAX_FRAME_SIZE = 256 * 1024 * 1024;
+
+static u32 GetCurrentTick()
+{
+  return TimingEvents::GetGlobalTickCounter() + static_cast<u32>(CPU::GetPendingTicks());
+}
+
+Recorder::Recorder(std::string filename, gzFile_s* file)
+  : m_filename(std::move(filename)), m_file(file), m_last_tick(GetCurrentTick())
+{
+  m_frame_data.reserve(1024 * 1024);
+}
+
+Recorder::~Recorder()
+{
+  // Lets the replay run up to the point where recording stopped.
+  BeginPacket(PacketType::End);
+  FlushFrame();
+  if (gzclose(m_file) != Z_OK)
+    m_write_error = true;
+
+  if (m_write_error)
+    Log_ErrorPrintf("Failed to write GPU dump '%s', it will be truncated", m_filename.c_str());
+  else
+    Log_InfoPrintf("Wrote %u frames to GPU dump '%s'", m_num_frames, m_filename.c_str());
+}
+
+std::unique_ptr<Recorder> Recorder::Create(const char* filename, GPU* gpu)
+{
+  std::unique_ptr<GrowableMemoryByteStream> state_stream = ByteStream_CreateGrowableMemoryStream();
+  StateWrapper sw(state_stream.get(), StateWrapper::Mode::Write);
+  if (!gpu->DoState(sw))
+  {
+    Log_ErrorPrintf("Failed to save GPU state for dump");
+    return {};
+  }
+
+  // Use the fastest compression level, since this runs on the emulation thread.
+  gzFile file = gzopen(filename, "wb1");
+  if (!file)
+  {
+    Log_ErrorPrintf("Failed to open GPU dump '%s' for writing", filename);
+    return {};
+  }
+
+  std::unique_ptr<Recorder> recorder(new Recorder(filename, file));
+
+  const FileHeader header = {FILE_MAGIC, FILE_VERSION, SAVE_STATE_VERSION,
+                             static_cast<u32>(state_stream->GetMemorySize())};
+  if (!recorder->WriteFile(&header, sizeof(header)) ||
+      !recorder->WriteFile(state_stream->GetMemoryPointer(), header.state_size))
+  {
+    return {};
+  }
+
+  Log_InfoPrintf("Started recording GPU dump to '%s'", filename);
+  return recorder;
+}
+
+bool Recorder::WriteFile(const void* data, u32 size)
+{
+  if (m_write_error)
+    return false;
+
+  if (size > 0 && gzwrite(m_file, data, size) != static_cast<int>(size))
+  {
+    m_write_error = true;
+    return false;
+  }
+
+  return true;
+}
+
+void Recorder::BeginPacket(PacketType type)
+{
+  const u32 tick = GetCurrentTick();
+  m_frame_data.push_back(static_cast<u8>(type));
+  WriteVarUInt(tick - m_last_tick);
+  m_last_tick = tick;
+}
+
+void Recorder::WriteU32(u32 value)
+{
+  const size_t pos = m_frame_data.size();
+  m_frame_data.resize(pos + sizeof(value));
+  std::memcpy(&m_frame_data[pos], &value, sizeof(value));
+}
+
+void Recorder::WriteVarUInt(u32 value)
+{
+  while (value >= 0x80)
+  {
+    m_frame_data.push_back(static_cast<u8>(value | 0x80));
+    value >>= 7;
+  }
+  m_frame_data.push_back(static_cast<u8>(value));
+}
+
+void Recorder::WriteGP0(u32 value)
+{
+  BeginPacket(PacketType::GP0Write);
+  WriteU32(value);
+}
+
+void Recorder::WriteGP1(u32 value)
+{
+  BeginPacket(PacketType::GP1Write);
+  WriteU32(value);
+}
+
+void Recorder::BeginDMAWrite(u32 word_count)
+{
+  BeginPacket(PacketType::DMAWrite);
+  WriteVarUInt(word_count);
+  m_frame_data.reserve(m_frame_data.size() + word_count * sizeof(u32));
+}
+
+void Recorder::DMARead(u32 word_count)
+{
+  BeginPacket(PacketType::DMARead);
+  WriteVarUInt(word_count);
+}
+
+void Recorder::ReadGPUREAD()
+{
+  BeginPacket(PacketType::GPUREADRead);
+}
+
+void Recorder::ReadGPUSTAT()
+{
+  BeginPacket(PacketType::GPUSTATRead);
+}
+
+void Recorder::VBlank()
+{
+  BeginPacket(PacketType::VBlank);
+  FlushFrame();
+  m_num_frames++;
+}
+
+void Recorder::FlushFrame()
+{
+  if (m_frame_data.empty())
+    return;
+
+  const u32 size = static_cast<u32>(m_frame_data.size());
+  WriteFile(&size, sizeof(size));
+  WriteFile(m_frame_data.data(), size);
+  m_frame_data.clear();
+}
+
+Player::Player(gzFile_s* file) : m_file(file) {}
+
+Player::~Player()
+{
+  gzclose(m_file);
+}
+
+std::unique_ptr<Player> Player::Open(const char* filename)
+{
+  gzFile file = gzopen(filename, "rb");
+  if (!file)
+  {
+    Log_ErrorPrintf("Failed to open GPU dump '%s'", filename);
+    return {};
+  }
+
+  std::unique_ptr<Player> player(new Player(file));
+
+  FileHeader header;
+  if (gzread(file, &header, sizeof(header)) != static_cast<int>(sizeof(header)) || header.magic != FILE_MAGIC)
+  {
+    Log_ErrorPrintf("'%s' is not a GPU dump", filename);
+    return {};
+  }
+  if (header.version != FILE_VERSION || header.state_version != SAVE_STATE_VERSION)
+  {
+    Log_ErrorPrintf("GPU dump '%s' is version %u/%u, only version %u/%u is supported", filename, header.version,
+                    header.state_version, FILE_VERSION, SAVE_STATE_VERSION);
+    return {};
+  }
+
+  player->m_initial_state.resize(header.state_size);
+  if (gzread(file, player->m_initial_state.data(), header.state_size) != static_cast<int>(header.state_size))
+  {
+    Log_ErrorPrintf("GPU dump '%s' is truncated", filename);
+    return {};
+  }
+
+  return player;
+}
+
+bool Player::LoadInitialState(GPU* gpu)
+{
+  std::unique_ptr<ReadOnlyMemoryByteStream> stream = ByteStream_CreateReadOnlyMemoryStream(
+    m_initial_state.data(), static_cast<u32>(m_initial_state.size()));
+  StateWrapper sw(stream.get(), StateWrapper::Mode::Read);
+  return gpu->DoState(sw);
+}
+
+bool Player::ReadFrame()
+{
+  u32 size;
+  const int size_read = gzread(m_file, &size, sizeof(size));
+  if (size_read == 0)
+    return false;
+
+  if (size_read != static_cast<int>(sizeof(size)) || size > MAX_FRAME_SIZE)
+  {
+    Log_ErrorPrintf("GPU dump is corrupted at frame %u", m_frame_number);
+    return false;
+  }
+
+  m_frame_data.resize(size);
+  if (gzread(m_file, m_frame_data.data(), size) != static_cast<int>(size))
+  {
+    Log_ErrorPrintf("GPU dump is truncated at frame %u", m_frame_number);
+    return false;
+  }
+
+  if (!ValidateFrame())
+  {
+    Log_ErrorPrintf("GPU dump is corrupted at frame %u", m_frame_number);
+    return false;
+  }
+
+  m_frame_number++;
+  return true;
+}
+
+static bool ReadVarUInt(const u8*& ptr, const u8* end, u32* value)
+{
+  u32 result = 0;
+  for (u32 shift = 0; shift < 32; shift += 7)
+  {
+    if (ptr == end)
+      return false;
+
+    const u8 byte = *(ptr++);
+    result |= static_cast<u32>(byte & 0x7F) << shift;
+    if (!(byte & 0x80))
+    {
+      *value = result;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+static u32 ReadU32(const u8*& ptr)
+{
+  u32 value;
+  std::memcpy(&value, ptr, sizeof(value));
+  ptr += sizeof(value);
+  return value;
+}
+
+bool Player::ValidateFrame()
+{
+  const u8* ptr = m_frame_data.data();
+  const u8* end = ptr + m_frame_data.size();
+  m_frame_packet_count = 0;
+  while (ptr != end)
+  {
+    const u8 type = *(ptr++);
+    u32 ticks, count;
+    if (type >= static_cast<u8>(PacketType::Count) || !ReadVarUInt(ptr, end, &ticks))
+      return false;
+
+    u32 payload_size = 0;
+    switch (static_cast<PacketType>(type))
+    {
+      case PacketType::GP0Write:
+      case PacketType::GP1Write:
+        payload_size = sizeof(u32);
+        break;
+
+      case PacketType::DMAWrite:
+        if (!ReadVarUInt(ptr, end, &count) || count > (MAX_FRAME_SIZE / sizeof(u32)))
+          return false;
+        payload_size = count * sizeof(u32);
+        break;
+
+      case PacketType::DMARead:
+        if (!ReadVarUInt(ptr, end, &count) || count > (MAX_FRAME_SIZE / sizeof(u32)))
+          return false;
+        break;
+
+      default:
+        break;
+    }
+
+    if (static_cast<size_t>(end - ptr) < payload_size)
+      return false;
+
+    ptr += payload_size;
+    m_frame_packet_count++;
+  }
+
+  return true;
+}
+
+void Player::ExecuteFrame(GPU* gpu)
+{
+  const u8* ptr = m_frame_data.data();
+  const u8* end = ptr + m_frame_data.size();
+  while (ptr != end)
+  {
+    const PacketType type = static_cast<PacketType>(*(ptr++));
+    // ValidateFrame() has already checked that every value can be read.
+    u32 ticks = 0;
+    ReadVarUInt(ptr, end, &ticks);
+
+    // Same as the CPU, run the events which would have fired before the packet was recorded.
+    CPU::AddPendingTicks(static_cast<TickCount>(ticks));
+    if (CPU::GetPendingTicks() >= CPU::g_state.downcount)
+      TimingEvents::RunEvents();
+
+    switch (type)
+    {
+      case PacketType::GP0Write:
+        gpu->WriteRegister(0x00, ReadU32(ptr));
+        break;
+
+      case PacketType::GP1Write:
+        gpu->WriteRegister(0x04, ReadU32(ptr));
+        break;
+
+      case PacketType::DMAWrite:
+      {
+        u32 count = 0;
+        ReadVarUInt(ptr, end, &count);
+        if (gpu->BeginDMAWrite())
+        {
+          for (u32 i = 0; i < count; i++)
+            gpu->DMAWrite(0, ReadU32(ptr));
+          gpu->EndDMAWrite();
+        }
+        else
+        {
+          Log_WarningPrintf("Dropping DMA write of %u words, the replay has diverged", count);
+          ptr += count * sizeof(u32);
+        }
+      }
+      break;
+
+      case PacketType::DMARead:
+      {
+        u32 count = 0;
+        ReadVarUInt(ptr, end, &count);
+        m_read_buffer.resize(count);
+        gpu->DMARead(m_read_buffer.data(), count);
+      }
+      break;
+
+      case PacketType::GPUREADRead:
+        gpu->ReadRegister(0x00);
+        break;
+
+      case PacketType::GPUSTATRead:
+        gpu->ReadRegister(0x04);
+        break;
+
+      case PacketType::VBlank:
+      case PacketType::End:
+      default:
+        break;
+    }
+  }
+}
+
+} // namespace GPUDump
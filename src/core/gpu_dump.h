@@ -0,0 +1,98 @@
+#pragma once
+#include "types.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+class GPU;
+struct gzFile_s;
+
+// A GPU dump records everything the rest of the system sends to the GPU, starting from a snapshot of the GPU state,
+// so the same workload can be replayed through any renderer without emulating the CPU. Each packet stores the number
+// of ticks since the previous one, and the packets are grouped by frame in a gzip-compressed file.
+namespace GPUDump {
+
+enum class PacketType : u8
+{
+  GP0Write,
+  GP1Write,
+  DMAWrite,
+  DMARead,
+  GPUREADRead,
+  GPUSTATRead,
+  VBlank,
+  End,
+  Count
+};
+
+class Recorder
+{
+public:
+  ~Recorder();
+
+  /// Creates a dump file, starting from the current state of the GPU.
+  static std::unique_ptr<Recorder> Create(const char* filename, GPU* gpu);
+
+  const std::string& GetFileName() const { return m_filename; }
+
+  void WriteGP0(u32 value);
+  void WriteGP1(u32 value);
+  void BeginDMAWrite(u32 word_count);
+  ALWAYS_INLINE void WriteDMAWord(u32 value) { WriteU32(value); }
+  void DMARead(u32 word_count);
+  void ReadGPUREAD();
+  void ReadGPUSTAT();
+
+  /// Ends the current frame, and writes it to the file.
+  void VBlank();
+
+private:
+  Recorder(std::string filename, gzFile_s* file);
+
+  void BeginPacket(PacketType type);
+  void WriteU32(u32 value);
+  void WriteVarUInt(u32 value);
+  bool WriteFile(const void* data, u32 size);
+  void FlushFrame();
+
+  std::string m_filename;
+  gzFile_s* m_file;
+  std::vector<u8> m_frame_data;
+  u32 m_last_tick;
+  u32 m_num_frames = 0;
+  bool m_write_error = false;
+};
+
+class Player
+{
+public:
+  ~Player();
+
+  static std::unique_ptr<Player> Open(const char* filename);
+
+  /// Restores the GPU state which the dump starts from.
+  bool LoadInitialState(GPU* gpu);
+
+  /// Reads the packets for the next frame. Returns false at the end of the dump, or if it is corrupted.
+  bool ReadFrame();
+
+  /// Sends the packets of the last frame read to the GPU, running the timing events in between.
+  void ExecuteFrame(GPU* gpu);
+
+  u32 GetFrameNumber() const { return m_frame_number; }
+  u32 GetFramePacketCount() const { return m_frame_packet_count; }
+
+private:
+  Player(gzFile_s* file);
+
+  bool ValidateFrame();
+
+  gzFile_s* m_file;
+  std::vector<u8> m_initial_state;
+  std::vector<u8> m_frame_data;
+  std::vector<u32> m_read_buffer;
+  u32 m_frame_number = 0;
+  u32 m_frame_packet_count = 0;
+};
+
+} // namespace GPUDump
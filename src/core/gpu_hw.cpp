@@ -1,7 +1,9 @@
 #include "gpu_hw.h"
 #include "common/assert.h"
+#include "common/bitutils.h"
 #include "common/log.h"
 #include "common/state_wrapper.h"
+#include "common/trace_recorder.h"
 #include "cpu_core.h"
 #include "imgui.h"
 #include "pgxp.h"
@@ -24,6 +26,9 @@ ALWAYS_INLINE static constexpr std::tuple<T, T> MinMax(T v1, T v2)
 GPU_HW::GPU_HW() : GPU()
 {
   m_vram_ptr = m_vram_shadow.data();
+  m_pending_vram_writes.reserve(MAX_PENDING_VRAM_WRITES);
+  m_pending_vram_write_data.reserve(MAX_PENDING_VRAM_WRITE_PIXELS);
+  m_texture_cache_pending_decodes.reserve(MAX_TEXTURE_CACHE_ENTRIES);
 }
 
 GPU_HW::~GPU_HW() = default;
@@ -43,6 +48,7 @@ bool GPU_HW::Initialize(HostDisplay* host_display)
   m_true_color = g_settings.gpu_true_color;
   m_scaled_dithering = g_settings.gpu_scaled_dithering;
   m_texture_filtering = g_settings.gpu_texture_filtering;
+  m_texture_cache = g_settings.gpu_texture_cache;
   PrintSettingsToLog();
   return true;
 }
@@ -56,10 +62,18 @@ void GPU_HW::Reset()
   m_vram_shadow.fill(0);
 
   m_batch = {};
+  m_batch_vertex_params = 0;
+  m_batch_vertex_texpage = 0;
   m_batch_ubo_data = {};
   m_batch_ubo_dirty = true;
   m_current_depth = 1;
 
+  m_vram_readback_prediction_rect.SetInvalid();
+  m_vram_readback_prediction_frames = 0;
+  m_vram_readback_pending_rect.SetInvalid();
+  m_pending_vram_writes.clear();
+  m_pending_vram_write_data.clear();
+  ResetTextureCache();
   SetFullVRAMDirtyRectangle();
 }
 
@@ -72,6 +86,8 @@ bool GPU_HW::DoState(StateWrapper& sw)
   if (sw.IsReading())
   {
     m_batch_current_vertex_ptr = m_batch_start_vertex_ptr;
+    m_vram_readback_pending_rect.SetInvalid();
+    ResetTextureCache();
     SetFullVRAMDirtyRectangle();
     ResetBatchVertexDepth();
   }
@@ -83,10 +99,16 @@ void GPU_HW::UpdateSettings()
 {
   GPU::UpdateSettings();
 
+  // the VRAM textures and readback buffers may be recreated
+  FlushPendingVRAMWrites();
+  CompletePendingVRAMReadback();
+
   m_resolution_scale = CalculateResolutionScale();
   m_true_color = g_settings.gpu_true_color;
   m_scaled_dithering = g_settings.gpu_scaled_dithering;
   m_texture_filtering = g_settings.gpu_texture_filtering;
+  m_texture_cache = g_settings.gpu_texture_cache;
+  ResetTextureCache();
   PrintSettingsToLog();
 }
 
@@ -119,6 +141,7 @@ void GPU_HW::PrintSettingsToLog()
   Log_InfoPrintf("Dithering: %s%s", m_true_color ? "Disabled" : "Enabled",
                  (!m_true_color && m_scaled_dithering) ? " (Scaled)" : "");
   Log_InfoPrintf("Texture Filtering: %s", m_texture_filtering ? "Enabled" : "Disabled");
+  Log_InfoPrintf("Palette Texture Cache: %s", m_texture_cache ? "Enabled" : "Disabled");
   Log_InfoPrintf("Dual-source blending: %s", m_supports_dual_source_blend ? "Supported" : "Not supported");
 }
 
@@ -128,6 +151,55 @@ void GPU_HW::UpdateVRAMReadTexture()
   ClearVRAMDirtyRectangle();
 }
 
+void GPU_HW::UpdateDepthBufferFromMaskBit()
+{
+  m_vram_depth_dirty_tiles.Clear();
+}
+
+void GPU_HW::VRAMDirtyTiles::GetRectangles(std::vector<Common::Rectangle<u32>>* rects) const
+{
+  rects->clear();
+
+  // rectangles which end on the previous row, and can be extended downwards
+  size_t open_start = 0;
+  for (u32 row = 0; row < VRAM_DIRTY_TILE_ROWS; row++)
+  {
+    const u32 top = row * VRAM_DIRTY_TILE_HEIGHT;
+    const u32 bottom = top + VRAM_DIRTY_TILE_HEIGHT;
+    const size_t open_end = rects->size();
+
+    u32 bits = rows[row];
+    while (bits != 0)
+    {
+      const u32 first_column = CountTrailingZeros(bits);
+      const u32 run_length = CountTrailingZeros(~(bits >> first_column));
+      bits &= ~(((UINT32_C(1) << run_length) - 1) << first_column);
+
+      const u32 left = first_column * VRAM_DIRTY_TILE_WIDTH;
+      const u32 right = left + run_length * VRAM_DIRTY_TILE_WIDTH;
+
+      bool merged = false;
+      for (size_t i = open_start; i < open_end; i++)
+      {
+        Common::Rectangle<u32>& rect = (*rects)[i];
+        if (rect.left == left && rect.right == right && rect.bottom == top)
+        {
+          rect.bottom = bottom;
+          merged = true;
+          break;
+        }
+      }
+
+      if (!merged)
+        rects->emplace_back(left, top, right, bottom);
+    }
+
+    // skip over rectangles which ended before this row, they can't be extended any further
+    while (open_start < rects->size() && (*rects)[open_start].bottom != bottom)
+      open_start++;
+  }
+}
+
 void GPU_HW::HandleFlippedQuadTextureCoordinates(BatchVertex* vertices)
 {
   // Taken from beetle-psx gpu_polygon.cpp
@@ -223,10 +295,10 @@ void GPU_HW::DrawLine(float x0, float y0, u32 col0, float x1, float y1, u32 col1
   if (dx == 0.0f && dy == 0.0f)
   {
     // Degenerate, render a point.
-    output[0].Set(x0, y0, depth, 1.0f, col0, 0, 0);
-    output[1].Set(x0 + 1.0f, y0, depth, 1.0f, col0, 0, 0);
-    output[2].Set(x1, y1 + 1.0f, depth, 1.0f, col0, 0, 0);
-    output[3].Set(x1 + 1.0f, y1 + 1.0f, depth, 1.0f, col0, 0, 0);
+    output[0].Set(x0, y0, depth, 1.0f, col0, m_batch_vertex_params, 0, 0);
+    output[1].Set(x0 + 1.0f, y0, depth, 1.0f, col0, m_batch_vertex_params, 0, 0);
+    output[2].Set(x1, y1 + 1.0f, depth, 1.0f, col0, m_batch_vertex_params, 0, 0);
+    output[3].Set(x1 + 1.0f, y1 + 1.0f, depth, 1.0f, col0, m_batch_vertex_params, 0, 0);
   }
   else
   {
@@ -290,10 +362,10 @@ void GPU_HW::DrawLine(float x0, float y0, u32 col0, float x1, float y1, u32 col1
     const float ox1 = x1 + pad_x1;
     const float oy1 = y1 + pad_y1;
 
-    output[0].Set(ox0, oy0, depth, 1.0f, col0, 0, 0);
-    output[1].Set(ox0 + fill_dx, oy0 + fill_dy, depth, 1.0f, col0, 0, 0);
-    output[2].Set(ox1, oy1, depth, 1.0f, col1, 0, 0);
-    output[3].Set(ox1 + fill_dx, oy1 + fill_dy, depth, 1.0f, col1, 0, 0);
+    output[0].Set(ox0, oy0, depth, 1.0f, col0, m_batch_vertex_params, 0, 0);
+    output[1].Set(ox0 + fill_dx, oy0 + fill_dy, depth, 1.0f, col0, m_batch_vertex_params, 0, 0);
+    output[2].Set(ox1, oy1, depth, 1.0f, col1, m_batch_vertex_params, 0, 0);
+    output[3].Set(ox1 + fill_dx, oy1 + fill_dy, depth, 1.0f, col1, m_batch_vertex_params, 0, 0);
   }
 
   AddVertex(output[0]);
@@ -310,7 +382,8 @@ void GPU_HW::LoadVertices()
     m_current_depth++;
 
   const RenderCommand rc{m_render_command.bits};
-  const u32 texpage = ZeroExtend32(m_draw_mode.mode_reg.bits) | (ZeroExtend32(m_draw_mode.palette_reg) << 16);
+  const u32 texpage = m_batch_vertex_texpage;
+  const u32 params = m_batch_vertex_params;
   const float depth = GetCurrentNormalizedVertexDepth();
 
   switch (rc.primitive)
@@ -338,8 +411,8 @@ void GPU_HW::LoadVertices()
         const s32 native_y = m_drawing_offset.y + vp.y;
         native_vertex_positions[i][0] = native_x;
         native_vertex_positions[i][1] = native_y;
-        vertices[i].Set(static_cast<float>(native_x), static_cast<float>(native_y), depth, 1.0f, color, texpage,
-                        texcoord);
+        vertices[i].Set(static_cast<float>(native_x), static_cast<float>(native_y), depth, 1.0f, color, params,
+                        texpage, texcoord);
 
         if (pgxp)
         {
@@ -382,7 +455,7 @@ void GPU_HW::LoadVertices()
         const u32 clip_bottom =
           static_cast<u32>(std::clamp<s32>(max_y, m_drawing_area.top, m_drawing_area.bottom)) + 1u;
 
-        m_vram_dirty_rect.Include(clip_left, clip_right, clip_top, clip_bottom);
+        IncludeDrawnVRAMRectangle(clip_left, clip_right, clip_top, clip_bottom);
         AddDrawTriangleTicks(clip_right - clip_left, clip_bottom - clip_top, rc.shading_enable, rc.texture_enable,
                              rc.transparency_enable);
 
@@ -414,7 +487,7 @@ void GPU_HW::LoadVertices()
           const u32 clip_bottom =
             static_cast<u32>(std::clamp<s32>(max_y_123, m_drawing_area.top, m_drawing_area.bottom)) + 1u;
 
-          m_vram_dirty_rect.Include(clip_left, clip_right, clip_top, clip_bottom);
+          IncludeDrawnVRAMRectangle(clip_left, clip_right, clip_top, clip_bottom);
           AddDrawTriangleTicks(clip_right - clip_left, clip_bottom - clip_top, rc.shading_enable, rc.texture_enable,
                                rc.transparency_enable);
 
@@ -491,13 +564,13 @@ void GPU_HW::LoadVertices()
           const float quad_end_x = quad_start_x + static_cast<float>(quad_width);
           const u16 tex_right = tex_left + static_cast<u16>(quad_width);
 
-          AddNewVertex(quad_start_x, quad_start_y, depth, 1.0f, color, texpage, tex_left, tex_top);
-          AddNewVertex(quad_end_x, quad_start_y, depth, 1.0f, color, texpage, tex_right, tex_top);
-          AddNewVertex(quad_start_x, quad_end_y, depth, 1.0f, color, texpage, tex_left, tex_bottom);
+          AddNewVertex(quad_start_x, quad_start_y, depth, 1.0f, color, params, texpage, tex_left, tex_top);
+          AddNewVertex(quad_end_x, quad_start_y, depth, 1.0f, color, params, texpage, tex_right, tex_top);
+          AddNewVertex(quad_start_x, quad_end_y, depth, 1.0f, color, params, texpage, tex_left, tex_bottom);
 
-          AddNewVertex(quad_start_x, quad_end_y, depth, 1.0f, color, texpage, tex_left, tex_bottom);
-          AddNewVertex(quad_end_x, quad_start_y, depth, 1.0f, color, texpage, tex_right, tex_top);
-          AddNewVertex(quad_end_x, quad_end_y, depth, 1.0f, color, texpage, tex_right, tex_bottom);
+          AddNewVertex(quad_start_x, quad_end_y, depth, 1.0f, color, params, texpage, tex_left, tex_bottom);
+          AddNewVertex(quad_end_x, quad_start_y, depth, 1.0f, color, params, texpage, tex_right, tex_top);
+          AddNewVertex(quad_end_x, quad_end_y, depth, 1.0f, color, params, texpage, tex_right, tex_bottom);
 
           x_offset += quad_width;
           tex_left = 0;
@@ -514,7 +587,7 @@ void GPU_HW::LoadVertices()
       const u32 clip_bottom =
         static_cast<u32>(std::clamp<s32>(pos_y + rectangle_height, m_drawing_area.top, m_drawing_area.bottom)) + 1u;
 
-      m_vram_dirty_rect.Include(clip_left, clip_right, clip_top, clip_bottom);
+      IncludeDrawnVRAMRectangle(clip_left, clip_right, clip_top, clip_bottom);
       AddDrawRectangleTicks(clip_right - clip_left, clip_bottom - clip_top, rc.texture_enable, rc.transparency_enable);
     }
     break;
@@ -562,7 +635,7 @@ void GPU_HW::LoadVertices()
         const u32 clip_bottom =
           static_cast<u32>(std::clamp<s32>(max_y, m_drawing_area.top, m_drawing_area.bottom)) + 1u;
 
-        m_vram_dirty_rect.Include(clip_left, clip_right, clip_top, clip_bottom);
+        IncludeDrawnVRAMRectangle(clip_left, clip_right, clip_top, clip_bottom);
         AddDrawLineTicks(clip_right - clip_left, clip_bottom - clip_top, rc.shading_enable);
 
         // TODO: Should we do a PGXP lookup here? Most lines are 2D.
@@ -608,7 +681,7 @@ void GPU_HW::LoadVertices()
             const u32 clip_bottom =
               static_cast<u32>(std::clamp<s32>(max_y, m_drawing_area.top, m_drawing_area.bottom)) + 1u;
 
-            m_vram_dirty_rect.Include(clip_left, clip_right, clip_top, clip_bottom);
+            IncludeDrawnVRAMRectangle(clip_left, clip_right, clip_top, clip_bottom);
             AddDrawLineTicks(clip_right - clip_left, clip_bottom - clip_top, rc.shading_enable);
 
             // TODO: Should we do a PGXP lookup here? Most lines are 2D.
@@ -667,20 +740,6 @@ Common::Rectangle<u32> GPU_HW::GetVRAMTransferBounds(u32 x, u32 y, u32 width, u3
   return out_rc;
 }
 
-GPU_HW::VRAMWriteUBOData GPU_HW::GetVRAMWriteUBOData(u32 x, u32 y, u32 width, u32 height, u32 buffer_offset) const
-{
-  const VRAMWriteUBOData uniforms = {(x % VRAM_WIDTH),
-                                     (y % VRAM_HEIGHT),
-                                     ((x + width) % VRAM_WIDTH),
-                                     ((y + height) % VRAM_HEIGHT),
-                                     width,
-                                     height,
-                                     buffer_offset,
-                                     m_GPUSTAT.set_mask_while_drawing ? 0x8000u : 0x00,
-                                     GetCurrentNormalizedVertexDepth()};
-  return uniforms;
-}
-
 bool GPU_HW::UseVRAMCopyShader(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 width, u32 height) const
 {
   // masking enabled, oversized, or overlapping
@@ -710,7 +769,9 @@ GPU_HW::VRAMCopyUBOData GPU_HW::GetVRAMCopyUBOData(u32 src_x, u32 src_y, u32 dst
 
 void GPU_HW::IncludeVRAMDityRectangle(const Common::Rectangle<u32>& rect)
 {
-  m_vram_dirty_rect.Include(rect);
+  m_vram_dirty_tiles.Include(rect);
+  m_vram_depth_dirty_tiles.Include(rect);
+  m_vram_shadow_dirty_rect.Include(rect);
 
   // the vram area can include the texture page, but the game can leave it as-is. in this case, set it as dirty so the
   // shadow texture is updated
@@ -720,6 +781,129 @@ void GPU_HW::IncludeVRAMDityRectangle(const Common::Rectangle<u32>& rect)
   {
     m_draw_mode.SetTexturePageChanged();
   }
+
+  if (m_texture_cache_vram_pages & GetVRAMPageMask(rect.left, rect.right, rect.top, rect.bottom))
+    InvalidateTextureCache(rect);
+}
+
+void GPU_HW::InvalidateTextureCache(const Common::Rectangle<u32>& rect)
+{
+  for (u32 slot = 0; slot < MAX_TEXTURE_CACHE_ENTRIES; slot++)
+  {
+    TextureCacheEntry& entry = m_texture_cache_entries[slot];
+    if (!entry.valid || (!entry.texture_page_rect.Intersects(rect) && !entry.palette_rect.Intersects(rect)))
+      continue;
+
+    // the page is being drawn to, so stop caching it until the game switches to another page or palette
+    entry.valid = false;
+    if (m_texture_cache_current_entry == slot)
+      m_texture_cache_current_entry = TEXTURE_CACHE_ENTRY_UNCACHED;
+  }
+
+  UpdateTextureCacheVRAMPages();
+}
+
+void GPU_HW::ResetTextureCache()
+{
+  m_texture_cache_entries = {};
+  m_texture_cache_seen_keys.fill(TEXTURE_CACHE_ENTRY_NONE);
+  m_texture_cache_pending_decodes.clear();
+  m_texture_cache_vram_pages = 0;
+  m_texture_cache_batch = 1;
+  m_texture_cache_current_key = TEXTURE_CACHE_ENTRY_NONE;
+  m_texture_cache_current_entry = TEXTURE_CACHE_ENTRY_UNCACHED;
+}
+
+u32 GPU_HW::LookupTextureCache()
+{
+  const u32 key = GetTextureCacheKey();
+  for (u32 slot = 0; slot < MAX_TEXTURE_CACHE_ENTRIES; slot++)
+  {
+    if (m_texture_cache_entries[slot].valid && m_texture_cache_entries[slot].key == key)
+    {
+      m_renderer_stats.num_texture_cache_hits++;
+      return slot;
+    }
+  }
+
+  // Pages used only once are cheaper to sample through the palette than to decode, so wait for a second use.
+  u32& seen_key = m_texture_cache_seen_keys[(key ^ (key >> 8) ^ (key >> 16)) % TEXTURE_CACHE_SEEN_KEY_COUNT];
+  if (seen_key != key)
+  {
+    seen_key = key;
+    return TEXTURE_CACHE_ENTRY_UNCACHED;
+  }
+
+  u32 slot = FindTextureCacheSlot();
+  if (slot == TEXTURE_CACHE_ENTRY_NONE)
+  {
+    // every entry is used by the current batch
+    FlushRender();
+    slot = FindTextureCacheSlot();
+    Assert(slot != TEXTURE_CACHE_ENTRY_NONE);
+  }
+
+  TextureCacheEntry& entry = m_texture_cache_entries[slot];
+  entry.key = key;
+  entry.last_used_batch = m_texture_cache_batch;
+  entry.texture_page_rect = m_draw_mode.GetTexturePageRectangle();
+  entry.palette_rect = m_draw_mode.GetTexturePaletteRectangle();
+  entry.vram_pages = GetVRAMPageMask(entry.texture_page_rect.left, entry.texture_page_rect.right,
+                                     entry.texture_page_rect.top, entry.texture_page_rect.bottom) |
+                     GetVRAMPageMask(entry.palette_rect.left, entry.palette_rect.right, entry.palette_rect.top,
+                                     entry.palette_rect.bottom);
+  entry.valid = true;
+  UpdateTextureCacheVRAMPages();
+
+  m_texture_cache_pending_decodes.push_back(slot);
+  m_renderer_stats.num_texture_cache_decodes++;
+  return slot;
+}
+
+u32 GPU_HW::FindTextureCacheSlot() const
+{
+  // prefer empty slots, then the least recently used
+  u32 best_slot = TEXTURE_CACHE_ENTRY_NONE;
+  for (u32 slot = 0; slot < MAX_TEXTURE_CACHE_ENTRIES; slot++)
+  {
+    const TextureCacheEntry& entry = m_texture_cache_entries[slot];
+    if (entry.last_used_batch == m_texture_cache_batch)
+      continue;
+
+    if (!entry.valid)
+      return slot;
+
+    if (best_slot == TEXTURE_CACHE_ENTRY_NONE ||
+        entry.last_used_batch < m_texture_cache_entries[best_slot].last_used_batch)
+    {
+      best_slot = slot;
+    }
+  }
+
+  return best_slot;
+}
+
+void GPU_HW::UpdateTextureCacheVRAMPages()
+{
+  m_texture_cache_vram_pages = 0;
+  for (const TextureCacheEntry& entry : m_texture_cache_entries)
+  {
+    if (entry.valid)
+      m_texture_cache_vram_pages |= entry.vram_pages;
+  }
+}
+
+GPU_HW::TextureCacheUBOData GPU_HW::GetTextureCacheUBOData(u32 slot) const
+{
+  const TextureCacheEntry& entry = m_texture_cache_entries[slot];
+  const TextureCacheUBOData uniforms = {(slot % TEXTURE_CACHE_PAGES_PER_ROW) * TEXTURE_PAGE_WIDTH,
+                                        (slot / TEXTURE_CACHE_PAGES_PER_ROW) * TEXTURE_PAGE_HEIGHT,
+                                        entry.texture_page_rect.left * m_resolution_scale,
+                                        entry.texture_page_rect.top * m_resolution_scale,
+                                        entry.palette_rect.left * m_resolution_scale,
+                                        entry.palette_rect.top * m_resolution_scale,
+                                        (entry.key >> 20) & 1u};
+  return uniforms;
 }
 
 void GPU_HW::EnsureVertexBufferSpace(u32 required_vertices)
@@ -778,6 +962,88 @@ void GPU_HW::ResetBatchVertexDepth()
   m_current_depth = 1;
 }
 
+void GPU_HW::UpdateDisplay()
+{
+  FlushPendingVRAMWrites();
+  GPU::UpdateDisplay();
+  BeginPredictedVRAMReadback();
+}
+
+void GPU_HW::ReadVRAM(u32 x, u32 y, u32 width, u32 height)
+{
+  // Get bounds with wrap-around handled.
+  const Common::Rectangle<u32> copy_rect = GetVRAMTransferBounds(x, y, width, height);
+
+  CompletePendingVRAMReadback();
+  if (!m_vram_shadow_dirty_rect.Intersects(copy_rect))
+  {
+    // nothing has been drawn here since the last readback, so the shadow copy is current
+    m_renderer_stats.num_vram_readbacks_avoided++;
+    return;
+  }
+
+  // Whole-VRAM reads come from save states and oversized fills/copies, which don't tell us anything about what the
+  // game reads.
+  if (copy_rect.GetWidth() != VRAM_WIDTH || copy_rect.GetHeight() != VRAM_HEIGHT)
+  {
+    m_vram_readback_prediction_rect.Include(copy_rect);
+    m_vram_readback_prediction_frames = VRAM_READBACK_PREDICTION_FRAMES;
+  }
+
+  FlushPendingVRAMWrites();
+  m_renderer_stats.num_vram_readbacks++;
+  BeginVRAMReadback(copy_rect);
+  EndVRAMReadback(copy_rect);
+
+  if (copy_rect.left <= m_vram_shadow_dirty_rect.left && copy_rect.right >= m_vram_shadow_dirty_rect.right &&
+      copy_rect.top <= m_vram_shadow_dirty_rect.top && copy_rect.bottom >= m_vram_shadow_dirty_rect.bottom)
+  {
+    m_vram_shadow_dirty_rect.SetInvalid();
+  }
+}
+
+Common::Rectangle<u32> GPU_HW::GetAlignedVRAMReadbackRect(const Common::Rectangle<u32>& rect)
+{
+  return Common::Rectangle<u32>(rect.left & ~1u, std::min<u32>(rect.top, VRAM_HEIGHT),
+                                std::min<u32>((rect.right + 1u) & ~1u, VRAM_WIDTH),
+                                std::min<u32>(rect.bottom, VRAM_HEIGHT));
+}
+
+void GPU_HW::CompletePendingVRAMReadback()
+{
+  if (!m_vram_readback_pending_rect.Valid())
+    return;
+
+  EndVRAMReadback(m_vram_readback_pending_rect);
+  m_vram_readback_pending_rect.SetInvalid();
+}
+
+void GPU_HW::BeginPredictedVRAMReadback()
+{
+  if (m_vram_readback_prediction_frames == 0)
+    return;
+
+  if (--m_vram_readback_prediction_frames == 0)
+  {
+    // the game has stopped reading, don't keep paying for the transfers
+    m_vram_readback_prediction_rect.SetInvalid();
+    return;
+  }
+
+  if (m_vram_readback_pending_rect.Valid() || !m_vram_shadow_dirty_rect.Intersects(m_vram_readback_prediction_rect))
+    return;
+
+  // Read back everything which is dirty rather than only the predicted area, otherwise the rest of the dirty area
+  // would keep the predicted area from being considered up to date. The transfer overlaps with the next frame, so
+  // the extra size costs bandwidth but no stall.
+  FlushRender();
+  FlushPendingVRAMWrites();
+  m_vram_readback_pending_rect = m_vram_shadow_dirty_rect;
+  m_vram_shadow_dirty_rect.SetInvalid();
+  m_renderer_stats.num_vram_readbacks++;
+  BeginVRAMReadback(m_vram_readback_pending_rect);
+}
+
 void GPU_HW::FillVRAM(u32 x, u32 y, u32 width, u32 height, u32 color)
 {
   IncludeVRAMDityRectangle(
@@ -796,6 +1062,70 @@ void GPU_HW::UpdateVRAM(u32 x, u32 y, u32 width, u32 height, const void* data)
   }
 }
 
+void GPU_HW::QueueVRAMWrite(u32 x, u32 y, u32 width, u32 height, const void* data)
+{
+  const u32 num_pixels = width * height;
+  if (!m_pending_vram_writes.empty() &&
+      (m_pending_vram_writes_check_mask != m_GPUSTAT.check_mask_before_draw ||
+       m_pending_vram_writes.size() == MAX_PENDING_VRAM_WRITES ||
+       (m_pending_vram_write_data.size() + num_pixels) > MAX_PENDING_VRAM_WRITE_PIXELS))
+  {
+    FlushPendingVRAMWrites();
+  }
+
+  const u32 data_offset = static_cast<u32>(m_pending_vram_write_data.size());
+  m_pending_vram_write_data.resize(data_offset + num_pixels);
+  std::memcpy(&m_pending_vram_write_data[data_offset], data, num_pixels * sizeof(u16));
+
+  m_pending_vram_writes.push_back({x, y, width, height, data_offset,
+                                   m_GPUSTAT.set_mask_while_drawing ? 0x8000u : 0x00u,
+                                   GetCurrentNormalizedVertexDepth()});
+  m_pending_vram_writes_check_mask = m_GPUSTAT.check_mask_before_draw;
+  m_renderer_stats.num_vram_writes++;
+
+  // large transfers such as FMV frames don't gain anything from waiting
+  if (m_pending_vram_write_data.size() >= MAX_PENDING_VRAM_WRITE_PIXELS)
+    FlushPendingVRAMWrites();
+}
+
+void GPU_HW::FlushPendingVRAMWrites()
+{
+  if (m_pending_vram_writes.empty())
+    return;
+
+  DrawPendingVRAMWrites();
+  m_pending_vram_writes.clear();
+  m_pending_vram_write_data.clear();
+  m_renderer_stats.num_vram_write_batches++;
+}
+
+void GPU_HW::GetPendingVRAMWriteVertices(VRAMWriteVertex* vertices, u32 buffer_base_offset) const
+{
+  for (const PendingVRAMWrite& write : m_pending_vram_writes)
+  {
+    // the quad covers the transfer bounds, wrap-around is handled in the fragment shader
+    const Common::Rectangle<u32> bounds = GetVRAMTransferBounds(write.x, write.y, write.width, write.height);
+    const float left = static_cast<float>(bounds.left);
+    const float top = static_cast<float>(bounds.top);
+    const float right = static_cast<float>(bounds.right);
+    const float bottom = static_cast<float>(bounds.bottom);
+    const u32 base_coords = (write.x % VRAM_WIDTH) | ((write.y % VRAM_HEIGHT) << 16);
+    const u32 end_coords = ((write.x + write.width) % VRAM_WIDTH) | (((write.y + write.height) % VRAM_HEIGHT) << 16);
+    const u32 size = write.width | (write.height << 16);
+    const u32 offset = buffer_base_offset + write.data_offset;
+
+    const auto vertex = [&](float x, float y) {
+      return VRAMWriteVertex{x, y, base_coords, end_coords, size, offset, write.mask_or_bits, write.depth_value};
+    };
+    *(vertices++) = vertex(left, top);
+    *(vertices++) = vertex(right, top);
+    *(vertices++) = vertex(left, bottom);
+    *(vertices++) = vertex(right, top);
+    *(vertices++) = vertex(right, bottom);
+    *(vertices++) = vertex(left, bottom);
+  }
+}
+
 void GPU_HW::CopyVRAM(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 width, u32 height)
 {
   IncludeVRAMDityRectangle(
@@ -812,6 +1142,9 @@ void GPU_HW::DispatchRenderCommand()
 {
   const RenderCommand rc{m_render_command.bits};
 
+  // queued transfers come before this primitive, and may be sampled by it
+  FlushPendingVRAMWrites();
+
   TextureMode texture_mode;
   if (rc.IsTexturingEnabled())
   {
@@ -819,9 +1152,8 @@ void GPU_HW::DispatchRenderCommand()
     if (m_draw_mode.IsTexturePageChanged())
     {
       m_draw_mode.ClearTexturePageChangedFlag();
-      if (m_vram_dirty_rect.Valid() &&
-          (m_draw_mode.GetTexturePageRectangle().Intersects(m_vram_dirty_rect) ||
-           (m_draw_mode.IsUsingPalette() && m_draw_mode.GetTexturePaletteRectangle().Intersects(m_vram_dirty_rect))))
+      if (m_vram_dirty_tiles.Intersects(m_draw_mode.GetTexturePageRectangle()) ||
+          (m_draw_mode.IsUsingPalette() && m_vram_dirty_tiles.Intersects(m_draw_mode.GetTexturePaletteRectangle())))
       {
         // Log_DevPrintf("Invalidating VRAM read cache due to drawing area overlap");
         if (!IsFlushed())
@@ -847,30 +1179,41 @@ void GPU_HW::DispatchRenderCommand()
   const TransparencyMode transparency_mode =
     rc.transparency_enable ? m_draw_mode.GetTransparencyMode() : TransparencyMode::Disabled;
   const bool dithering_enable = (!m_true_color && rc.IsDitheringEnabled()) ? m_GPUSTAT.dither_enable : false;
-  if (m_batch.texture_mode != texture_mode || m_batch.transparency_mode != transparency_mode ||
-      dithering_enable != m_batch.dithering)
+  if (m_batch.texture_mode != texture_mode || !m_batch.IsCompatibleTransparencyMode(transparency_mode) ||
+      dithering_enable != m_batch.dithering || m_batch.check_mask_before_draw != m_GPUSTAT.check_mask_before_draw)
   {
     FlushRender();
   }
 
-  EnsureVertexBufferSpaceForCurrentCommand();
+  // texture window, blend factors and set mask are per-vertex, so they can change within a batch
+  const u32 vertex_params = BatchVertex::PackParams(m_draw_mode.texture_window_value, transparency_mode,
+                                                    m_GPUSTAT.set_mask_while_drawing);
+  if (m_batch_vertex_params != vertex_params)
+  {
+    if (!IsFlushed())
+      m_renderer_stats.num_merged_state_changes++;
+
+    m_batch_vertex_params = vertex_params;
+  }
 
-  // transparency mode change
-  if (m_batch.transparency_mode != transparency_mode && transparency_mode != TransparencyMode::Disabled)
+  const bool use_texture_cache = m_texture_cache && rc.IsTexturingEnabled() && m_draw_mode.IsUsingPalette();
+  if (use_texture_cache && m_texture_cache_current_key != GetTextureCacheKey())
   {
-    static constexpr float transparent_alpha[4][2] = {{0.5f, 0.5f}, {1.0f, 1.0f}, {1.0f, 1.0f}, {0.25f, 1.0f}};
-    m_batch_ubo_data.u_src_alpha_factor = transparent_alpha[static_cast<u32>(transparency_mode)][0];
-    m_batch_ubo_data.u_dst_alpha_factor = transparent_alpha[static_cast<u32>(transparency_mode)][1];
-    m_batch_ubo_dirty = true;
+    m_texture_cache_current_key = GetTextureCacheKey();
+    m_texture_cache_current_entry = LookupTextureCache();
   }
 
-  if (m_batch.check_mask_before_draw != m_GPUSTAT.check_mask_before_draw ||
-      m_batch.set_mask_while_drawing != m_GPUSTAT.set_mask_while_drawing)
+  EnsureVertexBufferSpaceForCurrentCommand();
+
+  // cached pages are sampled from their atlas slot instead of through the palette
+  if (use_texture_cache && m_texture_cache_current_entry < MAX_TEXTURE_CACHE_ENTRIES)
   {
-    m_batch.check_mask_before_draw = m_GPUSTAT.check_mask_before_draw;
-    m_batch.set_mask_while_drawing = m_GPUSTAT.set_mask_while_drawing;
-    m_batch_ubo_data.u_set_mask_while_drawing = BoolToUInt32(m_batch.set_mask_while_drawing);
-    m_batch_ubo_dirty = true;
+    m_texture_cache_entries[m_texture_cache_current_entry].last_used_batch = m_texture_cache_batch;
+    m_batch_vertex_texpage = TEXTURE_CACHE_VERTEX_BIT | (m_texture_cache_current_entry << 16);
+  }
+  else
+  {
+    m_batch_vertex_texpage = ZeroExtend32(m_draw_mode.mode_reg.bits) | (ZeroExtend32(m_draw_mode.palette_reg) << 16);
   }
 
   m_batch.interlacing = IsInterlacedRenderingEnabled();
@@ -885,17 +1228,7 @@ void GPU_HW::DispatchRenderCommand()
   m_batch.texture_mode = texture_mode;
   m_batch.transparency_mode = transparency_mode;
   m_batch.dithering = dithering_enable;
-
-  if (m_draw_mode.IsTextureWindowChanged())
-  {
-    m_draw_mode.ClearTextureWindowChangedFlag();
-
-    m_batch_ubo_data.u_texture_window_mask[0] = ZeroExtend32(m_draw_mode.texture_window_mask_x);
-    m_batch_ubo_data.u_texture_window_mask[1] = ZeroExtend32(m_draw_mode.texture_window_mask_y);
-    m_batch_ubo_data.u_texture_window_offset[0] = ZeroExtend32(m_draw_mode.texture_window_offset_x);
-    m_batch_ubo_data.u_texture_window_offset[1] = ZeroExtend32(m_draw_mode.texture_window_offset_y);
-    m_batch_ubo_dirty = true;
-  }
+  m_batch.check_mask_before_draw = m_GPUSTAT.check_mask_before_draw;
 
   LoadVertices();
 }
@@ -908,9 +1241,19 @@ void GPU_HW::FlushRender()
   const u32 vertex_count = GetBatchVertexCount();
   UnmapBatchVertexPointer(vertex_count);
 
+  // Pages queued by this batch are decoded before it's drawn, after which their slots can be replaced.
+  if (!m_texture_cache_pending_decodes.empty())
+  {
+    DecodeTextureCacheEntries();
+    m_texture_cache_pending_decodes.clear();
+  }
+  m_texture_cache_batch++;
+
   if (vertex_count == 0)
     return;
 
+  TraceRecorder::ScopedSpan trace_span("GPU Flush Render");
+
   if (m_drawing_area_changed)
   {
     m_drawing_area_changed = false;
@@ -1000,6 +1343,27 @@ void GPU_HW::DrawRendererStats(bool is_idle_frame)
     ImGui::Text("%u", stats.num_batches);
     ImGui::NextColumn();
 
+    ImGui::TextUnformatted("Merged State Changes:");
+    ImGui::NextColumn();
+    ImGui::Text("%u", stats.num_merged_state_changes);
+    ImGui::NextColumn();
+
+    ImGui::TextUnformatted("VRAM Readbacks:");
+    ImGui::NextColumn();
+    ImGui::Text("%u (%u avoided)", stats.num_vram_readbacks, stats.num_vram_readbacks_avoided);
+    ImGui::NextColumn();
+
+    ImGui::TextUnformatted("VRAM Writes:");
+    ImGui::NextColumn();
+    ImGui::Text("%u (%u batches)", stats.num_vram_writes, stats.num_vram_write_batches);
+    ImGui::NextColumn();
+
+    ImGui::TextUnformatted("Texture Cache:");
+    ImGui::NextColumn();
+    ImGui::TextColored(m_texture_cache ? active_color : inactive_color, "%u hits (%u decodes)",
+                       stats.num_texture_cache_hits, stats.num_texture_cache_decodes);
+    ImGui::NextColumn();
+
     ImGui::TextUnformatted("VRAM Read Texture Updates:");
     ImGui::NextColumn();
     ImGui::Text("%u", stats.num_vram_read_texture_updates);
@@ -26,6 +26,14 @@ public:
     SeparateFields
   };
 
+  enum : u32
+  {
+    // Decoded palette texture pages are packed into a square atlas, at native resolution.
+    TEXTURE_CACHE_PAGES_PER_ROW = 8,
+    TEXTURE_CACHE_SIZE = TEXTURE_CACHE_PAGES_PER_ROW * TEXTURE_PAGE_WIDTH,
+    MAX_TEXTURE_CACHE_ENTRIES = TEXTURE_CACHE_PAGES_PER_ROW * TEXTURE_CACHE_PAGES_PER_ROW
+  };
+
   GPU_HW();
   virtual ~GPU_HW();
 
@@ -44,6 +52,17 @@ protected:
     VERTEX_BUFFER_SIZE = 1 * 1024 * 1024,
     UNIFORM_BUFFER_SIZE = 512 * 1024,
     MAX_BATCH_VERTEX_COUNTER_IDS = 65536 - 2,
+    VRAM_READBACK_PREDICTION_FRAMES = 30,
+    MAX_PENDING_VRAM_WRITES = 128,
+    MAX_PENDING_VRAM_WRITE_PIXELS = 64 * 1024,
+    VRAM_PAGE_WIDTH = 64,
+    TEXTURE_CACHE_SEEN_KEY_COUNT = 256,
+    TEXTURE_CACHE_ENTRY_NONE = 0xFFFFFFFFu,     // no slot available, or no key looked up
+    TEXTURE_CACHE_ENTRY_UNCACHED = 0xFFFFFFFEu, // sampled through the palette from VRAM
+    TEXTURE_CACHE_VERTEX_BIT = 0x80000000u,     // vertex texpage holds an atlas slot instead of a texture page
+    VRAM_DIRTY_TILE_WIDTH = 64,
+    VRAM_DIRTY_TILE_HEIGHT = 32,
+    VRAM_DIRTY_TILE_ROWS = VRAM_HEIGHT / VRAM_DIRTY_TILE_HEIGHT,
     MAX_VERTICES_FOR_RECTANGLE = 6 * (((MAX_PRIMITIVE_WIDTH + (TEXTURE_PAGE_WIDTH - 1)) / TEXTURE_PAGE_WIDTH) + 1u) *
                                  (((MAX_PRIMITIVE_HEIGHT + (TEXTURE_PAGE_HEIGHT - 1)) / TEXTURE_PAGE_HEIGHT) + 1u)
   };
@@ -55,26 +74,40 @@ protected:
     float z;
     float w;
     u32 color;
+    u32 params; // see PackParams()
     u32 texpage;
     u16 u; // 16-bit texcoords are needed for 256 extent rectangles
     u16 v;
 
-    ALWAYS_INLINE void Set(float x_, float y_, float z_, float w_, u32 color_, u32 texpage_, u16 packed_texcoord)
+    ALWAYS_INLINE void Set(float x_, float y_, float z_, float w_, u32 color_, u32 params_, u32 texpage_,
+                           u16 packed_texcoord)
     {
-      Set(x_, y_, z_, w_, color_, texpage_, packed_texcoord & 0xFF, (packed_texcoord >> 8));
+      Set(x_, y_, z_, w_, color_, params_, texpage_, packed_texcoord & 0xFF, (packed_texcoord >> 8));
     }
 
-    ALWAYS_INLINE void Set(float x_, float y_, float z_, float w_, u32 color_, u32 texpage_, u16 u_, u16 v_)
+    ALWAYS_INLINE void Set(float x_, float y_, float z_, float w_, u32 color_, u32 params_, u32 texpage_, u16 u_,
+                           u16 v_)
     {
       x = x_;
       y = y_;
       z = z_;
       w = w_;
       color = color_;
+      params = params_;
       texpage = texpage_;
       u = u_;
       v = v_;
     }
+
+    // State which only changes uniforms in the shader is carried with each vertex, so it doesn't need a new batch.
+    // Bits 0-19 are the texture window (same layout as GP0(E2h)), 20-21 the semi-transparency mode, and 22 the
+    // set-mask-while-drawing bit.
+    static constexpr u32 PackParams(u32 texture_window, TransparencyMode transparency_mode, bool set_mask_while_drawing)
+    {
+      return (texture_window & DrawMode::TEXTURE_WINDOW_MASK) |
+             ((static_cast<u32>(transparency_mode) & UINT32_C(3)) << 20) |
+             (static_cast<u32>(set_mask_while_drawing) << 22);
+    }
   };
 
   struct BatchConfig
@@ -83,7 +116,6 @@ protected:
     TransparencyMode transparency_mode;
     bool dithering;
     bool interlacing;
-    bool set_mask_while_drawing;
     bool check_mask_before_draw;
 
     // We need two-pass rendering when using BG-FG blending and texturing, as the transparency can be enabled
@@ -100,16 +132,23 @@ protected:
       return transparency_mode == TransparencyMode::Disabled ? BatchRenderMode::TransparencyDisabled :
                                                                BatchRenderMode::TransparentAndOpaque;
     }
+
+    // The additive modes share blend state and only differ in their factors, which are taken from the vertices.
+    bool IsCompatibleTransparencyMode(TransparencyMode mode) const
+    {
+      return transparency_mode == mode ||
+             (IsAdditiveTransparencyMode(transparency_mode) && IsAdditiveTransparencyMode(mode));
+    }
+
+    static bool IsAdditiveTransparencyMode(TransparencyMode mode)
+    {
+      return mode != TransparencyMode::Disabled && mode != TransparencyMode::BackgroundMinusForeground;
+    }
   };
 
   struct BatchUBOData
   {
-    u32 u_texture_window_mask[2];
-    u32 u_texture_window_offset[2];
-    float u_src_alpha_factor;
-    float u_dst_alpha_factor;
     u32 u_interlaced_displayed_field;
-    u32 u_set_mask_while_drawing;
   };
 
   struct VRAMFillUBOData
@@ -118,17 +157,28 @@ protected:
     u32 u_interlaced_displayed_field;
   };
 
-  struct VRAMWriteUBOData
+  // VRAM writes are drawn as one quad each, so the parameters of every write in a batch are carried by its vertices.
+  struct VRAMWriteVertex
   {
-    u32 u_dst_x;
-    u32 u_dst_y;
-    u32 u_end_x;
-    u32 u_end_y;
-    u32 u_width;
-    u32 u_height;
-    u32 u_buffer_base_offset;
-    u32 u_mask_or_bits;
-    float u_depth_value;
+    float x;
+    float y;
+    u32 base_coords; // x | (y << 16)
+    u32 end_coords;  // x | (y << 16), wrapped
+    u32 size;        // width | (height << 16)
+    u32 buffer_base_offset;
+    u32 mask_or_bits;
+    float depth_value;
+  };
+
+  struct PendingVRAMWrite
+  {
+    u32 x;
+    u32 y;
+    u32 width;
+    u32 height;
+    u32 data_offset; // in pixels, into m_pending_vram_write_data
+    u32 mask_or_bits;
+    float depth_value;
   };
 
   struct VRAMCopyUBOData
@@ -145,11 +195,101 @@ protected:
     float u_depth_value;
   };
 
+  struct TextureCacheUBOData
+  {
+    u32 u_dst_x;
+    u32 u_dst_y;
+    u32 u_texpage_x;
+    u32 u_texpage_y;
+    u32 u_palette_x;
+    u32 u_palette_y;
+    u32 u_palette_8bit;
+  };
+
+  struct TextureCacheEntry
+  {
+    u32 key; // see GetTextureCacheKey()
+    u32 last_used_batch;
+    u32 vram_pages; // see GetVRAMPageMask()
+    Common::Rectangle<u32> texture_page_rect;
+    Common::Rectangle<u32> palette_rect;
+    bool valid;
+  };
+
+  /// Areas of VRAM which have changed, at 64x32 pixel granularity. Each row of 16 tiles is stored as a bitmask.
+  struct VRAMDirtyTiles
+  {
+    std::array<u16, VRAM_DIRTY_TILE_ROWS> rows;
+
+    ALWAYS_INLINE void Clear() { rows.fill(0); }
+    ALWAYS_INLINE void SetAll() { rows.fill(0xFFFFu); }
+
+    ALWAYS_INLINE bool IsEmpty() const
+    {
+      u16 bits = 0;
+      for (u16 row : rows)
+        bits |= row;
+      return (bits == 0);
+    }
+
+    ALWAYS_INLINE void Include(u32 left, u32 right, u32 top, u32 bottom)
+    {
+      u32 first_row, last_row;
+      const u16 columns = GetColumnMask(left, right, top, bottom, &first_row, &last_row);
+      for (u32 row = first_row; row <= last_row; row++)
+        rows[row] |= columns;
+    }
+    ALWAYS_INLINE void Include(const Common::Rectangle<u32>& rect)
+    {
+      Include(rect.left, rect.right, rect.top, rect.bottom);
+    }
+
+    ALWAYS_INLINE bool Intersects(const Common::Rectangle<u32>& rect) const
+    {
+      u32 first_row, last_row;
+      const u16 columns = GetColumnMask(rect.left, rect.right, rect.top, rect.bottom, &first_row, &last_row);
+      for (u32 row = first_row; row <= last_row; row++)
+      {
+        if (rows[row] & columns)
+          return true;
+      }
+
+      return false;
+    }
+
+    /// Builds a list of rectangles covering the dirty tiles. Runs of tiles in a row are joined, and runs which span
+    /// the same columns in consecutive rows are merged, keeping the number of copies/draws low.
+    void GetRectangles(std::vector<Common::Rectangle<u32>>* rects) const;
+
+  private:
+    static ALWAYS_INLINE u16 GetColumnMask(u32 left, u32 right, u32 top, u32 bottom, u32* first_row, u32* last_row)
+    {
+      left = std::min<u32>(left, VRAM_WIDTH - 1);
+      top = std::min<u32>(top, VRAM_HEIGHT - 1);
+      right = std::min<u32>(std::max(right, left + 1), VRAM_WIDTH);
+      bottom = std::min<u32>(std::max(bottom, top + 1), VRAM_HEIGHT);
+
+      *first_row = top / VRAM_DIRTY_TILE_HEIGHT;
+      *last_row = (bottom - 1) / VRAM_DIRTY_TILE_HEIGHT;
+
+      const u32 first_column = left / VRAM_DIRTY_TILE_WIDTH;
+      const u32 last_column = (right - 1) / VRAM_DIRTY_TILE_WIDTH;
+      return static_cast<u16>(((UINT32_C(2) << last_column) - 1) & ~((UINT32_C(1) << first_column) - 1));
+    }
+  };
+
   struct RendererStats
   {
     u32 num_batches;
+    u32 num_merged_state_changes;
     u32 num_vram_read_texture_updates;
     u32 num_uniform_buffer_updates;
+    u32 num_vram_readbacks;
+    u32 num_vram_readbacks_avoided;
+    u32 num_vram_writes;
+    u32 num_vram_write_batches;
+    u32 num_texture_cache_hits;
+    u32 num_texture_cache_decodes;
   };
 
   static constexpr std::tuple<float, float, float, float> RGBA8ToFloat(u32 rgba)
@@ -161,23 +301,100 @@ protected:
   }
 
   virtual void UpdateVRAMReadTexture();
-  virtual void UpdateDepthBufferFromMaskBit() = 0;
+  virtual void UpdateDepthBufferFromMaskBit();
   virtual void SetScissorFromDrawingArea() = 0;
   virtual void MapBatchVertexPointer(u32 required_vertices) = 0;
   virtual void UnmapBatchVertexPointer(u32 used_vertices) = 0;
   virtual void UploadUniformBuffer(const void* uniforms, u32 uniforms_size) = 0;
   virtual void DrawBatchVertices(BatchRenderMode render_mode, u32 base_vertex, u32 num_vertices) = 0;
 
+  /// Returns the area which a readback of rect writes to the VRAM shadow. Two pixels are encoded per texel, so it is
+  /// widened to whole pairs, without going past the edge of VRAM.
+  static Common::Rectangle<u32> GetAlignedVRAMReadbackRect(const Common::Rectangle<u32>& rect);
+
+  /// Encodes the area and starts copying it to CPU-accessible memory, without waiting for the copy to finish.
+  virtual void BeginVRAMReadback(const Common::Rectangle<u32>& rect) = 0;
+
+  /// Waits for the copy started by BeginVRAMReadback(), and writes the area to the VRAM shadow.
+  virtual void EndVRAMReadback(const Common::Rectangle<u32>& rect) = 0;
+
+  /// Uploads the queued VRAM write data, and draws every write in a single pass.
+  virtual void DrawPendingVRAMWrites() = 0;
+
+  /// Decodes the queued texture cache entries into the atlas. Called before each batch is drawn.
+  virtual void DecodeTextureCacheEntries() = 0;
+
   u32 CalculateResolutionScale() const;
 
   void SetFullVRAMDirtyRectangle()
   {
-    m_vram_dirty_rect.Set(0, 0, VRAM_WIDTH, VRAM_HEIGHT);
+    m_vram_dirty_tiles.SetAll();
+    m_vram_depth_dirty_tiles.SetAll();
+    m_vram_shadow_dirty_rect.Set(0, 0, VRAM_WIDTH, VRAM_HEIGHT);
     m_draw_mode.SetTexturePageChanged();
   }
-  void ClearVRAMDirtyRectangle() { m_vram_dirty_rect.SetInvalid(); }
+  void ClearVRAMDirtyRectangle() { m_vram_dirty_tiles.Clear(); }
   void IncludeVRAMDityRectangle(const Common::Rectangle<u32>& rect);
 
+  /// Marks an area which has been drawn into, and is now out of date in the read texture and VRAM shadow.
+  ALWAYS_INLINE void IncludeDrawnVRAMRectangle(u32 left, u32 right, u32 top, u32 bottom)
+  {
+    m_vram_dirty_tiles.Include(left, right, top, bottom);
+    m_vram_depth_dirty_tiles.Include(left, right, top, bottom);
+    m_vram_shadow_dirty_rect.Include(left, right, top, bottom);
+    if (m_texture_cache_vram_pages & GetVRAMPageMask(left, right, top, bottom))
+      InvalidateTextureCache(Common::Rectangle<u32>(left, top, right, bottom));
+  }
+
+  /// Returns a bit for each 64x256 area of VRAM which the rectangle touches.
+  static constexpr u32 GetVRAMPageMask(u32 left, u32 right, u32 top, u32 bottom)
+  {
+    left = std::min<u32>(left, VRAM_WIDTH - 1);
+    top = std::min<u32>(top, VRAM_HEIGHT - 1);
+    right = std::min<u32>(std::max(right, left + 1), VRAM_WIDTH);
+    bottom = std::min<u32>(std::max(bottom, top + 1), VRAM_HEIGHT);
+
+    const u32 first_column = left / VRAM_PAGE_WIDTH;
+    const u32 last_column = (right - 1) / VRAM_PAGE_WIDTH;
+    const u32 columns = ((UINT32_C(2) << last_column) - 1) & ~((UINT32_C(1) << first_column) - 1);
+    return ((top < TEXTURE_PAGE_HEIGHT) ? columns : 0) | ((bottom > TEXTURE_PAGE_HEIGHT) ? (columns << 16) : 0);
+  }
+
+  /// Drops cached texture pages which overlap an area of VRAM which has changed.
+  void InvalidateTextureCache(const Common::Rectangle<u32>& rect);
+  void ResetTextureCache();
+
+  /// Returns the atlas slot holding the current texture page and palette, or TEXTURE_CACHE_ENTRY_UNCACHED.
+  u32 LookupTextureCache();
+  u32 FindTextureCacheSlot() const;
+  void UpdateTextureCacheVRAMPages();
+
+  /// Returns the current palette texture mode, page and palette, packed into a single value.
+  u32 GetTextureCacheKey() const
+  {
+    return (static_cast<u32>(m_draw_mode.GetTextureMode() & TextureMode::Palette8Bit) << 20) |
+           ((ZeroExtend32(m_draw_mode.mode_reg.bits) & 0x1Fu) << 15) | ZeroExtend32(m_draw_mode.palette_reg);
+  }
+
+  TextureCacheUBOData GetTextureCacheUBOData(u32 slot) const;
+
+  /// Finishes any readback started at the end of the previous frame, copying it to the VRAM shadow.
+  void CompletePendingVRAMReadback();
+
+  /// Starts an asynchronous readback of areas the game is expected to read, based on recent reads.
+  void BeginPredictedVRAMReadback();
+
+  /// Queues a CPU->VRAM transfer, to be drawn together with the following transfers.
+  void QueueVRAMWrite(u32 x, u32 y, u32 width, u32 height, const void* data);
+
+  /// Draws any queued VRAM writes. Must be called before anything else draws to, or reads from, VRAM on the GPU.
+  void FlushPendingVRAMWrites();
+
+  /// Fills in two triangles for each queued write. buffer_base_offset is the position of the write data in the
+  /// texture buffer, in pixels.
+  void GetPendingVRAMWriteVertices(VRAMWriteVertex* vertices, u32 buffer_base_offset) const;
+  u32 GetPendingVRAMWriteVertexCount() const { return static_cast<u32>(m_pending_vram_writes.size()) * 6; }
+
   bool IsFlushed() const { return m_batch_current_vertex_ptr == m_batch_start_vertex_ptr; }
 
   u32 GetBatchVertexSpace() const { return static_cast<u32>(m_batch_end_vertex_ptr - m_batch_current_vertex_ptr); }
@@ -206,6 +423,8 @@ protected:
     }
   }
 
+  void UpdateDisplay() override;
+  void ReadVRAM(u32 x, u32 y, u32 width, u32 height) override;
   void FillVRAM(u32 x, u32 y, u32 width, u32 height, u32 color) override;
   void UpdateVRAM(u32 x, u32 y, u32 width, u32 height, const void* data) override;
   void CopyVRAM(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 width, u32 height) override;
@@ -227,7 +446,6 @@ protected:
   bool UseVRAMCopyShader(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 width, u32 height) const;
 
   VRAMFillUBOData GetVRAMFillUBOData(u32 x, u32 y, u32 width, u32 height, u32 color) const;
-  VRAMWriteUBOData GetVRAMWriteUBOData(u32 x, u32 y, u32 width, u32 height, u32 buffer_offset) const;
   VRAMCopyUBOData GetVRAMCopyUBOData(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 width, u32 height) const;
 
   /// Expands a line into two triangles.
@@ -242,6 +460,8 @@ protected:
   BatchVertex* m_batch_end_vertex_ptr = nullptr;
   BatchVertex* m_batch_current_vertex_ptr = nullptr;
   u32 m_batch_base_vertex = 0;
+  u32 m_batch_vertex_params = 0;
+  u32 m_batch_vertex_texpage = 0;
   s32 m_current_depth = 0;
 
   u32 m_resolution_scale = 1;
@@ -250,13 +470,45 @@ protected:
   bool m_true_color = true;
   bool m_scaled_dithering = false;
   bool m_texture_filtering = false;
+  bool m_texture_cache = false;
   bool m_supports_dual_source_blend = false;
 
   BatchConfig m_batch = {};
   BatchUBOData m_batch_ubo_data = {};
 
-  // Bounding box of VRAM area that the GPU has drawn into.
-  Common::Rectangle<u32> m_vram_dirty_rect;
+  // VRAM tiles that the GPU has drawn into since the read texture was last updated.
+  VRAMDirtyTiles m_vram_dirty_tiles = {};
+
+  // VRAM tiles that have been written since the depth buffer was last updated from the mask bit.
+  VRAMDirtyTiles m_vram_depth_dirty_tiles = {};
+
+  // Scratch list of dirty tile rectangles, reused by the copies/draws which only touch the dirty areas.
+  std::vector<Common::Rectangle<u32>> m_vram_dirty_tile_rects;
+
+  // Bounding box of VRAM area which has changed on the GPU since it was last copied to the VRAM shadow.
+  Common::Rectangle<u32> m_vram_shadow_dirty_rect;
+
+  // Area recently read by the game, which is read back ahead of time at the end of each frame while it's being used.
+  Common::Rectangle<u32> m_vram_readback_prediction_rect;
+  u32 m_vram_readback_prediction_frames = 0;
+
+  // Area of a readback which has been started but not yet written to the VRAM shadow, invalid when none is pending.
+  Common::Rectangle<u32> m_vram_readback_pending_rect;
+
+  // CPU->VRAM transfers which haven't been drawn yet. They all share the same mask check state.
+  std::vector<PendingVRAMWrite> m_pending_vram_writes;
+  std::vector<u16> m_pending_vram_write_data;
+  bool m_pending_vram_writes_check_mask = false;
+
+  // Palette texture pages which have been decoded to the atlas, indexed by atlas slot. Entries which are used by the
+  // current batch (last_used_batch == m_texture_cache_batch) can't be replaced until it is drawn.
+  std::array<TextureCacheEntry, MAX_TEXTURE_CACHE_ENTRIES> m_texture_cache_entries = {};
+  std::array<u32, TEXTURE_CACHE_SEEN_KEY_COUNT> m_texture_cache_seen_keys = {};
+  std::vector<u32> m_texture_cache_pending_decodes;
+  u32 m_texture_cache_vram_pages = 0;
+  u32 m_texture_cache_batch = 1;
+  u32 m_texture_cache_current_key = TEXTURE_CACHE_ENTRY_NONE;
+  u32 m_texture_cache_current_entry = TEXTURE_CACHE_ENTRY_UNCACHED;
 
   // Statistics
   RendererStats m_renderer_stats = {};
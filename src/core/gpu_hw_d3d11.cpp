@@ -2,10 +2,12 @@
 #include "common/assert.h"
 #include "common/d3d11/shader_compiler.h"
 #include "common/log.h"
+#include "common/parallel_for.h"
 #include "gpu_hw_shadergen.h"
 #include "host_display.h"
 #include "host_interface.h"
 #include "system.h"
+#include <atomic>
 Log_SetChannel(GPU_HW_D3D11);
 
 GPU_HW_D3D11::GPU_HW_D3D11() = default;
@@ -76,6 +78,12 @@ bool GPU_HW_D3D11::Initialize(HostDisplay* host_display)
     return false;
   }
 
+  if (!CreateVRAMWriteInputLayout())
+  {
+    Log_ErrorPrintf("Failed to create VRAM write input layout");
+    return false;
+  }
+
   if (!CompileShaders())
   {
     Log_ErrorPrintf("Failed to compile shaders");
@@ -111,6 +119,8 @@ void GPU_HW_D3D11::RestoreGraphicsAPIState()
   m_context->IASetInputLayout(m_batch_input_layout.Get());
   m_context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
   m_context->PSSetShaderResources(0, 1, m_vram_read_texture.GetD3DSRVArray());
+  if (m_texture_cache)
+    m_context->PSSetShaderResources(1, 1, m_texture_cache_texture.GetD3DSRVArray());
   m_context->OMSetRenderTargets(1, m_vram_texture.GetD3DRTVArray(), m_vram_depth_view.Get());
   m_context->RSSetState(m_cull_none_rasterizer_state.Get());
   SetViewport(0, 0, m_vram_texture.GetWidth(), m_vram_texture.GetHeight());
@@ -182,7 +192,10 @@ bool GPU_HW_D3D11::CreateFramebuffer()
                                 D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET) ||
       !m_vram_encoding_texture.Create(m_device.Get(), VRAM_WIDTH, VRAM_HEIGHT, texture_format,
                                       D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET) ||
-      !m_vram_readback_texture.Create(m_device.Get(), VRAM_WIDTH, VRAM_HEIGHT, texture_format, false))
+      !m_vram_readback_texture.Create(m_device.Get(), VRAM_WIDTH, VRAM_HEIGHT, texture_format, false) ||
+      (m_texture_cache &&
+       !m_texture_cache_texture.Create(m_device.Get(), TEXTURE_CACHE_SIZE, TEXTURE_CACHE_SIZE, texture_format,
+                                       D3D11_BIND_SHADER_RESOURCE | D3D11_BIND_RENDER_TARGET)))
   {
     return false;
   }
@@ -193,6 +206,8 @@ bool GPU_HW_D3D11::CreateFramebuffer()
   if (FAILED(hr))
     return false;
 
+  SetFullVRAMDirtyRectangle();
+
   // do we need to restore the framebuffer after a size change?
   if (old_vram_texture)
   {
@@ -208,7 +223,6 @@ bool GPU_HW_D3D11::CreateFramebuffer()
   }
 
   m_context->OMSetRenderTargets(1, m_vram_texture.GetD3DRTVArray(), nullptr);
-  SetFullVRAMDirtyRectangle();
   RestoreGraphicsAPIState();
   return true;
 }
@@ -231,6 +245,7 @@ void GPU_HW_D3D11::DestroyFramebuffer()
   m_vram_encoding_texture.Destroy();
   m_display_texture.Destroy();
   m_vram_readback_texture.Destroy();
+  m_texture_cache_texture.Destroy();
 }
 
 bool GPU_HW_D3D11::CreateVertexBuffer()
@@ -263,15 +278,16 @@ bool GPU_HW_D3D11::CreateTextureBuffer()
 
 bool GPU_HW_D3D11::CreateBatchInputLayout()
 {
-  static constexpr std::array<D3D11_INPUT_ELEMENT_DESC, 4> attributes = {
+  static constexpr std::array<D3D11_INPUT_ELEMENT_DESC, 5> attributes = {
     {{"ATTR", 0, DXGI_FORMAT_R32G32B32A32_FLOAT, 0, offsetof(BatchVertex, x), D3D11_INPUT_PER_VERTEX_DATA, 0},
      {"ATTR", 1, DXGI_FORMAT_R8G8B8A8_UNORM, 0, offsetof(BatchVertex, color), D3D11_INPUT_PER_VERTEX_DATA, 0},
-     {"ATTR", 2, DXGI_FORMAT_R32_UINT, 0, offsetof(BatchVertex, u), D3D11_INPUT_PER_VERTEX_DATA, 0},
-     {"ATTR", 3, DXGI_FORMAT_R32_UINT, 0, offsetof(BatchVertex, texpage), D3D11_INPUT_PER_VERTEX_DATA, 0}}};
+     {"ATTR", 2, DXGI_FORMAT_R32_UINT, 0, offsetof(BatchVertex, params), D3D11_INPUT_PER_VERTEX_DATA, 0},
+     {"ATTR", 3, DXGI_FORMAT_R32_UINT, 0, offsetof(BatchVertex, u), D3D11_INPUT_PER_VERTEX_DATA, 0},
+     {"ATTR", 4, DXGI_FORMAT_R32_UINT, 0, offsetof(BatchVertex, texpage), D3D11_INPUT_PER_VERTEX_DATA, 0}}};
 
   // we need a vertex shader...
   GPU_HW_ShaderGen shadergen(m_host_display->GetRenderAPI(), m_resolution_scale, m_true_color, m_scaled_dithering,
-                             m_texture_filtering, m_supports_dual_source_blend);
+                             m_texture_filtering, m_texture_cache, m_supports_dual_source_blend);
   ComPtr<ID3DBlob> vs_bytecode =
     m_shader_cache.GetShaderBlob(D3D11::ShaderCompiler::Type::Vertex, shadergen.GenerateBatchVertexShader(true, false));
   if (!vs_bytecode)
@@ -289,6 +305,34 @@ bool GPU_HW_D3D11::CreateBatchInputLayout()
   return true;
 }
 
+bool GPU_HW_D3D11::CreateVRAMWriteInputLayout()
+{
+  static constexpr std::array<D3D11_INPUT_ELEMENT_DESC, 4> attributes = {
+    {{"ATTR", 0, DXGI_FORMAT_R32G32_FLOAT, 0, offsetof(VRAMWriteVertex, x), D3D11_INPUT_PER_VERTEX_DATA, 0},
+     {"ATTR", 1, DXGI_FORMAT_R32G32B32A32_UINT, 0, offsetof(VRAMWriteVertex, base_coords),
+      D3D11_INPUT_PER_VERTEX_DATA, 0},
+     {"ATTR", 2, DXGI_FORMAT_R32_UINT, 0, offsetof(VRAMWriteVertex, mask_or_bits), D3D11_INPUT_PER_VERTEX_DATA, 0},
+     {"ATTR", 3, DXGI_FORMAT_R32_FLOAT, 0, offsetof(VRAMWriteVertex, depth_value), D3D11_INPUT_PER_VERTEX_DATA, 0}}};
+
+  GPU_HW_ShaderGen shadergen(m_host_display->GetRenderAPI(), m_resolution_scale, m_true_color, m_scaled_dithering,
+                             m_texture_filtering, m_texture_cache, m_supports_dual_source_blend);
+  ComPtr<ID3DBlob> vs_bytecode =
+    m_shader_cache.GetShaderBlob(D3D11::ShaderCompiler::Type::Vertex, shadergen.GenerateVRAMWriteVertexShader());
+  if (!vs_bytecode)
+    return false;
+
+  const HRESULT hr = m_device->CreateInputLayout(attributes.data(), static_cast<UINT>(attributes.size()),
+                                                 vs_bytecode->GetBufferPointer(), vs_bytecode->GetBufferSize(),
+                                                 m_vram_write_input_layout.GetAddressOf());
+  if (FAILED(hr))
+  {
+    Log_ErrorPrintf("CreateInputLayout failed: 0x%08X", hr);
+    return false;
+  }
+
+  return true;
+}
+
 bool GPU_HW_D3D11::CreateStateObjects()
 {
   HRESULT hr;
@@ -368,7 +412,7 @@ bool GPU_HW_D3D11::CreateStateObjects()
 bool GPU_HW_D3D11::CompileShaders()
 {
   GPU_HW_ShaderGen shadergen(m_host_display->GetRenderAPI(), m_resolution_scale, m_true_color, m_scaled_dithering,
-                             m_texture_filtering, m_supports_dual_source_blend);
+                             m_texture_filtering, m_texture_cache, m_supports_dual_source_blend);
 
   g_host_interface->DisplayLoadingScreen("Compiling shaders...");
 
@@ -385,6 +429,20 @@ bool GPU_HW_D3D11::CompileShaders()
       return false;
   }
 
+  m_vram_write_vertex_shader =
+    m_shader_cache.GetVertexShader(m_device.Get(), shadergen.GenerateVRAMWriteVertexShader());
+  if (!m_vram_write_vertex_shader)
+    return false;
+
+  // The pixel shaders make up the bulk of the startup cost. Sources are generated here, then compiled (on a shader
+  // cache miss) across all host threads.
+  struct PendingShader
+  {
+    std::string source;
+    ComPtr<ID3D11PixelShader>* shader;
+  };
+  std::vector<PendingShader> pending_shaders;
+
   for (u8 render_mode = 0; render_mode < 4; render_mode++)
   {
     for (u8 texture_mode = 0; texture_mode < 9; texture_mode++)
@@ -393,63 +451,48 @@ bool GPU_HW_D3D11::CompileShaders()
       {
         for (u8 interlacing = 0; interlacing < 2; interlacing++)
         {
-          const std::string ps = shadergen.GenerateBatchFragmentShader(
-            static_cast<BatchRenderMode>(render_mode), static_cast<TextureMode>(texture_mode),
-            ConvertToBoolUnchecked(dithering), ConvertToBoolUnchecked(interlacing));
-
-          m_batch_pixel_shaders[render_mode][texture_mode][dithering][interlacing] =
-            m_shader_cache.GetPixelShader(m_device.Get(), ps);
-          if (!m_batch_pixel_shaders[render_mode][texture_mode][dithering][interlacing])
-            return false;
+          pending_shaders.push_back({shadergen.GenerateBatchFragmentShader(
+                                       static_cast<BatchRenderMode>(render_mode),
+                                       static_cast<TextureMode>(texture_mode), ConvertToBoolUnchecked(dithering),
+                                       ConvertToBoolUnchecked(interlacing)),
+                                     &m_batch_pixel_shaders[render_mode][texture_mode][dithering][interlacing]});
         }
       }
     }
   }
 
-  m_copy_pixel_shader = m_shader_cache.GetPixelShader(m_device.Get(), shadergen.GenerateCopyFragmentShader());
-  if (!m_copy_pixel_shader)
-    return false;
-
-  m_vram_fill_pixel_shader = m_shader_cache.GetPixelShader(m_device.Get(), shadergen.GenerateFillFragmentShader());
-  if (!m_vram_fill_pixel_shader)
-    return false;
-
-  m_vram_interlaced_fill_pixel_shader =
-    m_shader_cache.GetPixelShader(m_device.Get(), shadergen.GenerateInterlacedFillFragmentShader());
-  if (!m_vram_interlaced_fill_pixel_shader)
-    return false;
-
-  m_vram_read_pixel_shader = m_shader_cache.GetPixelShader(m_device.Get(), shadergen.GenerateVRAMReadFragmentShader());
-  if (!m_vram_read_pixel_shader)
-    return false;
-
-  m_vram_write_pixel_shader =
-    m_shader_cache.GetPixelShader(m_device.Get(), shadergen.GenerateVRAMWriteFragmentShader(false));
-  if (!m_vram_write_pixel_shader)
-    return false;
-
-  m_vram_copy_pixel_shader = m_shader_cache.GetPixelShader(m_device.Get(), shadergen.GenerateVRAMCopyFragmentShader());
-  if (!m_vram_copy_pixel_shader)
-    return false;
-
-  m_vram_update_depth_pixel_shader =
-    m_shader_cache.GetPixelShader(m_device.Get(), shadergen.GenerateVRAMUpdateDepthFragmentShader());
-  if (!m_vram_update_depth_pixel_shader)
-    return false;
+  pending_shaders.push_back({shadergen.GenerateCopyFragmentShader(), &m_copy_pixel_shader});
+  pending_shaders.push_back({shadergen.GenerateFillFragmentShader(), &m_vram_fill_pixel_shader});
+  pending_shaders.push_back({shadergen.GenerateInterlacedFillFragmentShader(), &m_vram_interlaced_fill_pixel_shader});
+  pending_shaders.push_back({shadergen.GenerateVRAMReadFragmentShader(), &m_vram_read_pixel_shader});
+  pending_shaders.push_back({shadergen.GenerateVRAMWriteFragmentShader(false), &m_vram_write_pixel_shader});
+  pending_shaders.push_back({shadergen.GenerateVRAMCopyFragmentShader(), &m_vram_copy_pixel_shader});
+  pending_shaders.push_back({shadergen.GenerateVRAMUpdateDepthFragmentShader(), &m_vram_update_depth_pixel_shader});
+  if (m_texture_cache)
+  {
+    pending_shaders.push_back(
+      {shadergen.GenerateTextureCacheDecodeFragmentShader(), &m_texture_cache_decode_pixel_shader});
+  }
 
   for (u8 depth_24bit = 0; depth_24bit < 2; depth_24bit++)
   {
     for (u8 interlacing = 0; interlacing < 3; interlacing++)
     {
-      const std::string ps = shadergen.GenerateDisplayFragmentShader(ConvertToBoolUnchecked(depth_24bit),
-                                                                     static_cast<InterlacedRenderMode>(interlacing));
-      m_display_pixel_shaders[depth_24bit][interlacing] = m_shader_cache.GetPixelShader(m_device.Get(), ps);
-      if (!m_display_pixel_shaders[depth_24bit][interlacing])
-        return false;
+      pending_shaders.push_back({shadergen.GenerateDisplayFragmentShader(
+                                   ConvertToBoolUnchecked(depth_24bit), static_cast<InterlacedRenderMode>(interlacing)),
+                                 &m_display_pixel_shaders[depth_24bit][interlacing]});
     }
   }
 
-  return true;
+  std::atomic_bool compile_failed{false};
+  Common::ParallelFor(static_cast<u32>(pending_shaders.size()), [this, &pending_shaders, &compile_failed](u32 index) {
+    PendingShader& ps = pending_shaders[index];
+    *ps.shader = m_shader_cache.GetPixelShader(m_device.Get(), ps.source);
+    if (!*ps.shader)
+      compile_failed.store(true);
+  });
+
+  return !compile_failed.load();
 }
 
 void GPU_HW_D3D11::UploadUniformBuffer(const void* data, u32 data_size)
@@ -623,15 +666,14 @@ void GPU_HW_D3D11::UpdateDisplay()
   }
 }
 
-void GPU_HW_D3D11::ReadVRAM(u32 x, u32 y, u32 width, u32 height)
+void GPU_HW_D3D11::BeginVRAMReadback(const Common::Rectangle<u32>& copy_rect)
 {
-  // Get bounds with wrap-around handled.
-  const Common::Rectangle<u32> copy_rect = GetVRAMTransferBounds(x, y, width, height);
-  const u32 encoded_width = (copy_rect.GetWidth() + 1) / 2;
-  const u32 encoded_height = copy_rect.GetHeight();
+  const Common::Rectangle<u32> aligned_rect = GetAlignedVRAMReadbackRect(copy_rect);
+  const u32 encoded_width = aligned_rect.GetWidth() / 2;
+  const u32 encoded_height = aligned_rect.GetHeight();
 
   // Encode the 24-bit texture as 16-bit.
-  const u32 uniforms[4] = {copy_rect.left, copy_rect.top, copy_rect.GetWidth(), copy_rect.GetHeight()};
+  const u32 uniforms[4] = {aligned_rect.left, aligned_rect.top, aligned_rect.GetWidth(), encoded_height};
   m_context->OMSetRenderTargets(1, m_vram_encoding_texture.GetD3DRTVArray(), nullptr);
   m_context->OMSetDepthStencilState(m_depth_disabled_state.Get(), 0);
   m_context->PSSetShaderResources(0, 1, m_vram_texture.GetD3DSRVArray());
@@ -641,19 +683,27 @@ void GPU_HW_D3D11::ReadVRAM(u32 x, u32 y, u32 width, u32 height)
   // Stage the readback.
   m_vram_readback_texture.CopyFromTexture(m_context.Get(), m_vram_encoding_texture.GetD3DTexture(), 0, 0, 0, 0, 0,
                                           encoded_width, encoded_height);
-  // And copy it into our shadow buffer.
+
+  RestoreGraphicsAPIState();
+}
+
+void GPU_HW_D3D11::EndVRAMReadback(const Common::Rectangle<u32>& copy_rect)
+{
+  const Common::Rectangle<u32> aligned_rect = GetAlignedVRAMReadbackRect(copy_rect);
+  const u32 encoded_width = aligned_rect.GetWidth() / 2;
+  const u32 encoded_height = aligned_rect.GetHeight();
+
+  // And copy it into our shadow buffer. Mapping waits for the copy if it hasn't finished yet.
   if (m_vram_readback_texture.Map(m_context.Get(), false))
   {
     m_vram_readback_texture.ReadPixels(0, 0, encoded_width * 2, encoded_height, VRAM_WIDTH,
-                                       &m_vram_shadow[copy_rect.top * VRAM_WIDTH + copy_rect.left]);
+                                       &m_vram_shadow[aligned_rect.top * VRAM_WIDTH + aligned_rect.left]);
     m_vram_readback_texture.Unmap(m_context.Get());
   }
   else
   {
     Log_ErrorPrintf("Failed to map VRAM readback texture");
   }
-
-  RestoreGraphicsAPIState();
 }
 
 void GPU_HW_D3D11::FillVRAM(u32 x, u32 y, u32 width, u32 height, u32 color)
@@ -668,6 +718,7 @@ void GPU_HW_D3D11::FillVRAM(u32 x, u32 y, u32 width, u32 height, u32 color)
     return;
   }
 
+  FlushPendingVRAMWrites();
   GPU_HW::FillVRAM(x, y, width, height, color);
 
   const VRAMFillUBOData uniforms = GetVRAMFillUBOData(x, y, width, height, color);
@@ -687,33 +738,71 @@ void GPU_HW_D3D11::UpdateVRAM(u32 x, u32 y, u32 width, u32 height, const void* d
 {
   const Common::Rectangle<u32> bounds = GetVRAMTransferBounds(x, y, width, height);
   GPU_HW::UpdateVRAM(bounds.left, bounds.top, bounds.GetWidth(), bounds.GetHeight(), data);
+  QueueVRAMWrite(x, y, width, height, data);
+}
 
-  const u32 num_pixels = width * height;
-  const auto map_result = m_texture_stream_buffer.Map(m_context.Get(), sizeof(u16), num_pixels * sizeof(u16));
-  std::memcpy(map_result.pointer, data, num_pixels * sizeof(u16));
-  m_texture_stream_buffer.Unmap(m_context.Get(), num_pixels * sizeof(u16));
+void GPU_HW_D3D11::DrawPendingVRAMWrites()
+{
+  const u32 data_size = static_cast<u32>(m_pending_vram_write_data.size() * sizeof(u16));
+  const auto data_map_result = m_texture_stream_buffer.Map(m_context.Get(), sizeof(u16), data_size);
+  std::memcpy(data_map_result.pointer, m_pending_vram_write_data.data(), data_size);
+  m_texture_stream_buffer.Unmap(m_context.Get(), data_size);
+
+  // the batch vertices are unmapped at this point, so the writes can share the stream buffer
+  const u32 num_vertices = GetPendingVRAMWriteVertexCount();
+  const u32 vertices_size = num_vertices * sizeof(VRAMWriteVertex);
+  const auto vertex_map_result = m_vertex_stream_buffer.Map(m_context.Get(), sizeof(VRAMWriteVertex), vertices_size);
+  GetPendingVRAMWriteVertices(static_cast<VRAMWriteVertex*>(vertex_map_result.pointer),
+                              data_map_result.index_aligned);
+  m_vertex_stream_buffer.Unmap(m_context.Get(), vertices_size);
 
-  const VRAMWriteUBOData uniforms = GetVRAMWriteUBOData(x, y, width, height, map_result.index_aligned);
+  const UINT stride = sizeof(VRAMWriteVertex);
+  const UINT offset = 0;
+  m_context->IASetVertexBuffers(0, 1, m_vertex_stream_buffer.GetD3DBufferArray(), &stride, &offset);
+  m_context->IASetInputLayout(m_vram_write_input_layout.Get());
   m_context->OMSetDepthStencilState(
-    m_GPUSTAT.check_mask_before_draw ? m_depth_test_less_state.Get() : m_depth_test_always_state.Get(), 0);
+    m_pending_vram_writes_check_mask ? m_depth_test_less_state.Get() : m_depth_test_always_state.Get(), 0);
+  m_context->OMSetBlendState(m_blend_disabled_state.Get(), nullptr, 0xFFFFFFFFu);
   m_context->PSSetShaderResources(0, 1, m_texture_stream_buffer_srv_r16ui.GetAddressOf());
+  m_context->VSSetShader(m_vram_write_vertex_shader.Get(), nullptr, 0);
+  m_context->GSSetShader(nullptr, nullptr, 0);
+  m_context->PSSetShader(m_vram_write_pixel_shader.Get(), nullptr, 0);
+
+  // the viewport should already be set to the full vram, and the quads cover exactly the written area
+  SetScissor(0, 0, m_vram_texture.GetWidth(), m_vram_texture.GetHeight());
+  m_context->Draw(num_vertices, vertex_map_result.index_aligned);
+
+  RestoreGraphicsAPIState();
+}
 
-  // the viewport should already be set to the full vram, so just adjust the scissor
-  const Common::Rectangle<u32> scaled_bounds = bounds * m_resolution_scale;
-  SetScissor(scaled_bounds.left, scaled_bounds.top, scaled_bounds.GetWidth(), scaled_bounds.GetHeight());
+void GPU_HW_D3D11::DecodeTextureCacheEntries()
+{
+  // the atlas can't be sampled by the batch shaders while it's being rendered to
+  ID3D11ShaderResourceView* const null_srv = nullptr;
+  m_context->PSSetShaderResources(1, 1, &null_srv);
+  m_context->OMSetRenderTargets(1, m_texture_cache_texture.GetD3DRTVArray(), nullptr);
+  m_context->OMSetDepthStencilState(m_depth_disabled_state.Get(), 0);
+  m_context->PSSetShaderResources(0, 1, m_vram_read_texture.GetD3DSRVArray());
 
-  DrawUtilityShader(m_vram_write_pixel_shader.Get(), &uniforms, sizeof(uniforms));
+  for (const u32 slot : m_texture_cache_pending_decodes)
+  {
+    const TextureCacheUBOData uniforms = GetTextureCacheUBOData(slot);
+    SetViewportAndScissor(uniforms.u_dst_x, uniforms.u_dst_y, TEXTURE_PAGE_WIDTH, TEXTURE_PAGE_HEIGHT);
+    DrawUtilityShader(m_texture_cache_decode_pixel_shader.Get(), &uniforms, sizeof(uniforms));
+  }
 
   RestoreGraphicsAPIState();
 }
 
 void GPU_HW_D3D11::CopyVRAM(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 width, u32 height)
 {
+  FlushPendingVRAMWrites();
+
   if (UseVRAMCopyShader(src_x, src_y, dst_x, dst_y, width, height))
   {
     const Common::Rectangle<u32> src_bounds = GetVRAMTransferBounds(src_x, src_y, width, height);
     const Common::Rectangle<u32> dst_bounds = GetVRAMTransferBounds(dst_x, dst_y, width, height);
-    if (m_vram_dirty_rect.Intersects(src_bounds))
+    if (m_vram_dirty_tiles.Intersects(src_bounds))
       UpdateVRAMReadTexture();
     IncludeVRAMDityRectangle(dst_bounds);
 
@@ -737,7 +826,7 @@ void GPU_HW_D3D11::CopyVRAM(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 widt
   // We can't CopySubresourceRegion to the same resource. So use the shadow texture if we can, but that may need to be
   // updated first. Copying to the same resource seemed to work on Windows 10, but breaks on Windows 7. But, it's
   // against the API spec, so better to be safe than sorry.
-  if (m_vram_dirty_rect.Intersects(Common::Rectangle<u32>::FromExtents(src_x, src_y, width, height)))
+  if (m_vram_dirty_tiles.Intersects(Common::Rectangle<u32>::FromExtents(src_x, src_y, width, height)))
     UpdateVRAMReadTexture();
 
   GPU_HW::CopyVRAM(src_x, src_y, dst_x, dst_y, width, height);
@@ -755,27 +844,45 @@ void GPU_HW_D3D11::CopyVRAM(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 widt
 
 void GPU_HW_D3D11::UpdateVRAMReadTexture()
 {
-  const auto scaled_rect = m_vram_dirty_rect * m_resolution_scale;
-  const CD3D11_BOX src_box(scaled_rect.left, scaled_rect.top, 0, scaled_rect.right, scaled_rect.bottom, 1);
-  m_context->CopySubresourceRegion(m_vram_read_texture, 0, scaled_rect.left, scaled_rect.top, 0, m_vram_texture, 0,
-                                   &src_box);
+  m_vram_dirty_tiles.GetRectangles(&m_vram_dirty_tile_rects);
+  for (const Common::Rectangle<u32>& rect : m_vram_dirty_tile_rects)
+  {
+    const auto scaled_rect = rect * m_resolution_scale;
+    const CD3D11_BOX src_box(scaled_rect.left, scaled_rect.top, 0, scaled_rect.right, scaled_rect.bottom, 1);
+    m_context->CopySubresourceRegion(m_vram_read_texture, 0, scaled_rect.left, scaled_rect.top, 0, m_vram_texture, 0,
+                                     &src_box);
+  }
 
   GPU_HW::UpdateVRAMReadTexture();
 }
 
 void GPU_HW_D3D11::UpdateDepthBufferFromMaskBit()
 {
-  SetViewportAndScissor(0, 0, m_vram_texture.GetWidth(), m_vram_texture.GetHeight());
+  FlushPendingVRAMWrites();
+
+  // only the areas which have been written since the last update can have a stale depth value
+  m_vram_depth_dirty_tiles.GetRectangles(&m_vram_dirty_tile_rects);
+  if (m_vram_dirty_tile_rects.empty())
+    return;
+
+  SetViewport(0, 0, m_vram_texture.GetWidth(), m_vram_texture.GetHeight());
 
   m_context->OMSetRenderTargets(0, nullptr, m_vram_depth_view.Get());
   m_context->OMSetDepthStencilState(m_depth_test_always_state.Get(), 0);
   m_context->OMSetBlendState(m_blend_no_color_writes_state.Get(), nullptr, 0xFFFFFFFFu);
 
   m_context->PSSetShaderResources(0, 1, m_vram_texture.GetD3DSRVArray());
-  DrawUtilityShader(m_vram_update_depth_pixel_shader.Get(), nullptr, 0);
+  for (const Common::Rectangle<u32>& rect : m_vram_dirty_tile_rects)
+  {
+    const auto scaled_rect = rect * m_resolution_scale;
+    SetScissor(scaled_rect.left, scaled_rect.top, scaled_rect.GetWidth(), scaled_rect.GetHeight());
+    DrawUtilityShader(m_vram_update_depth_pixel_shader.Get(), nullptr, 0);
+  }
 
   m_context->PSSetShaderResources(0, 1, m_vram_read_texture.GetD3DSRVArray());
   RestoreGraphicsAPIState();
+
+  GPU_HW::UpdateDepthBufferFromMaskBit();
 }
 
 std::unique_ptr<GPU> GPU::CreateHardwareD3D11Renderer() { return std::make_unique<GPU_HW_D3D11>(); }
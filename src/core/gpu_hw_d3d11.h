@@ -29,7 +29,6 @@ public:
 protected:
   void ClearDisplay() override;
   void UpdateDisplay() override;
-  void ReadVRAM(u32 x, u32 y, u32 width, u32 height) override;
   void FillVRAM(u32 x, u32 y, u32 width, u32 height, u32 color) override;
   void UpdateVRAM(u32 x, u32 y, u32 width, u32 height, const void* data) override;
   void CopyVRAM(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 width, u32 height) override;
@@ -40,6 +39,10 @@ protected:
   void UnmapBatchVertexPointer(u32 used_vertices) override;
   void UploadUniformBuffer(const void* data, u32 data_size) override;
   void DrawBatchVertices(BatchRenderMode render_mode, u32 base_vertex, u32 num_vertices) override;
+  void BeginVRAMReadback(const Common::Rectangle<u32>& rect) override;
+  void EndVRAMReadback(const Common::Rectangle<u32>& rect) override;
+  void DrawPendingVRAMWrites() override;
+  void DecodeTextureCacheEntries() override;
 
 private:
   enum : u32
@@ -57,6 +60,7 @@ private:
   bool CreateUniformBuffer();
   bool CreateTextureBuffer();
   bool CreateBatchInputLayout();
+  bool CreateVRAMWriteInputLayout();
   bool CreateStateObjects();
 
   bool CompileShaders();
@@ -83,6 +87,7 @@ private:
   D3D11::Texture m_vram_read_texture;
   D3D11::Texture m_vram_encoding_texture;
   D3D11::Texture m_display_texture;
+  D3D11::Texture m_texture_cache_texture;
 
   D3D11::StreamBuffer m_vertex_stream_buffer;
 
@@ -108,6 +113,7 @@ private:
 
   std::array<ComPtr<ID3D11BlendState>, 5> m_batch_blend_states; // [transparency_mode]
   ComPtr<ID3D11InputLayout> m_batch_input_layout;
+  ComPtr<ID3D11InputLayout> m_vram_write_input_layout;
   std::array<ComPtr<ID3D11VertexShader>, 2> m_batch_vertex_shaders; // [textured]
   std::array<std::array<std::array<std::array<ComPtr<ID3D11PixelShader>, 2>, 2>, 9>, 4>
     m_batch_pixel_shaders; // [render_mode][texture_mode][dithering][interlacing]
@@ -117,8 +123,10 @@ private:
   ComPtr<ID3D11PixelShader> m_vram_fill_pixel_shader;
   ComPtr<ID3D11PixelShader> m_vram_interlaced_fill_pixel_shader;
   ComPtr<ID3D11PixelShader> m_vram_read_pixel_shader;
+  ComPtr<ID3D11VertexShader> m_vram_write_vertex_shader;
   ComPtr<ID3D11PixelShader> m_vram_write_pixel_shader;
   ComPtr<ID3D11PixelShader> m_vram_copy_pixel_shader;
   ComPtr<ID3D11PixelShader> m_vram_update_depth_pixel_shader;
+  ComPtr<ID3D11PixelShader> m_texture_cache_decode_pixel_shader;
   std::array<std::array<ComPtr<ID3D11PixelShader>, 3>, 2> m_display_pixel_shaders; // [depth_24][interlaced]
 };
@@ -17,8 +17,12 @@ GPU_HW_OpenGL::~GPU_HW_OpenGL()
     glDeleteVertexArrays(1, &m_vao_id);
   if (m_attributeless_vao_id != 0)
     glDeleteVertexArrays(1, &m_attributeless_vao_id);
+  if (m_vram_write_vao_id != 0)
+    glDeleteVertexArrays(1, &m_vram_write_vao_id);
   if (m_texture_buffer_r16ui_texture != 0)
     glDeleteTextures(1, &m_texture_buffer_r16ui_texture);
+  if (m_vram_readback_buffer_id != 0)
+    glDeleteBuffers(1, &m_vram_readback_buffer_id);
 
   if (m_host_display)
   {
@@ -241,12 +245,37 @@ bool GPU_HW_OpenGL::CreateFramebuffer()
     return false;
   }
 
+  if (m_texture_cache)
+  {
+    if (!m_texture_cache_texture.Create(TEXTURE_CACHE_SIZE, TEXTURE_CACHE_SIZE, GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE,
+                                        nullptr, false) ||
+        !m_texture_cache_texture.CreateFramebuffer())
+    {
+      return false;
+    }
+  }
+  else
+  {
+    m_texture_cache_texture.Destroy();
+  }
+
+  if (m_vram_readback_buffer_id == 0)
+  {
+    // Readbacks go through a buffer so they can be started at the end of a frame and picked up later.
+    glGenBuffers(1, &m_vram_readback_buffer_id);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, m_vram_readback_buffer_id);
+    glBufferData(GL_PIXEL_PACK_BUFFER, VRAM_READBACK_BUFFER_SIZE, nullptr, GL_STREAM_READ);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  }
+
   glGenFramebuffers(1, &m_vram_fbo_id);
   glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_vram_fbo_id);
   glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, m_vram_texture.GetGLId(), 0);
   glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_vram_depth_texture.GetGLId(), 0);
   Assert(glCheckFramebufferStatus(GL_DRAW_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
 
+  SetFullVRAMDirtyRectangle();
+
   // do we need to restore the framebuffer after a size change?
   if (old_vram_fbo != 0)
   {
@@ -267,7 +296,6 @@ bool GPU_HW_OpenGL::CreateFramebuffer()
     UpdateDepthBufferFromMaskBit();
   }
 
-  SetFullVRAMDirtyRectangle();
   return true;
 }
 
@@ -295,14 +323,33 @@ bool GPU_HW_OpenGL::CreateVertexBuffer()
   glEnableVertexAttribArray(1);
   glEnableVertexAttribArray(2);
   glEnableVertexAttribArray(3);
+  glEnableVertexAttribArray(4);
   glVertexAttribPointer(0, 4, GL_FLOAT, false, sizeof(BatchVertex), reinterpret_cast<void*>(offsetof(BatchVertex, x)));
   glVertexAttribPointer(1, 4, GL_UNSIGNED_BYTE, true, sizeof(BatchVertex),
                         reinterpret_cast<void*>(offsetof(BatchVertex, color)));
-  glVertexAttribIPointer(2, 1, GL_UNSIGNED_INT, sizeof(BatchVertex), reinterpret_cast<void*>(offsetof(BatchVertex, u)));
-  glVertexAttribIPointer(3, 1, GL_UNSIGNED_INT, sizeof(BatchVertex),
+  glVertexAttribIPointer(2, 1, GL_UNSIGNED_INT, sizeof(BatchVertex),
+                         reinterpret_cast<void*>(offsetof(BatchVertex, params)));
+  glVertexAttribIPointer(3, 1, GL_UNSIGNED_INT, sizeof(BatchVertex), reinterpret_cast<void*>(offsetof(BatchVertex, u)));
+  glVertexAttribIPointer(4, 1, GL_UNSIGNED_INT, sizeof(BatchVertex),
                          reinterpret_cast<void*>(offsetof(BatchVertex, texpage)));
   glBindVertexArray(0);
 
+  glGenVertexArrays(1, &m_vram_write_vao_id);
+  glBindVertexArray(m_vram_write_vao_id);
+  glEnableVertexAttribArray(0);
+  glEnableVertexAttribArray(1);
+  glEnableVertexAttribArray(2);
+  glEnableVertexAttribArray(3);
+  glVertexAttribPointer(0, 2, GL_FLOAT, false, sizeof(VRAMWriteVertex),
+                        reinterpret_cast<void*>(offsetof(VRAMWriteVertex, x)));
+  glVertexAttribIPointer(1, 4, GL_UNSIGNED_INT, sizeof(VRAMWriteVertex),
+                         reinterpret_cast<void*>(offsetof(VRAMWriteVertex, base_coords)));
+  glVertexAttribIPointer(2, 1, GL_UNSIGNED_INT, sizeof(VRAMWriteVertex),
+                         reinterpret_cast<void*>(offsetof(VRAMWriteVertex, mask_or_bits)));
+  glVertexAttribPointer(3, 1, GL_FLOAT, false, sizeof(VRAMWriteVertex),
+                        reinterpret_cast<void*>(offsetof(VRAMWriteVertex, depth_value)));
+  glBindVertexArray(0);
+
   glGenVertexArrays(1, &m_attributeless_vao_id);
   return true;
 }
@@ -338,7 +385,7 @@ bool GPU_HW_OpenGL::CompilePrograms()
 {
   const bool use_binding_layout = GPU_HW_ShaderGen::UseGLSLBindingLayout();
   GPU_HW_ShaderGen shadergen(m_host_display->GetRenderAPI(), m_resolution_scale, m_true_color, m_scaled_dithering,
-                             m_texture_filtering, m_supports_dual_source_blend);
+                             m_texture_filtering, m_texture_cache, m_supports_dual_source_blend);
 
   g_host_interface->DisplayLoadingScreen("Compiling Shaders...");
 
@@ -361,10 +408,11 @@ bool GPU_HW_OpenGL::CompilePrograms()
             {
               prog.BindAttribute(0, "a_pos");
               prog.BindAttribute(1, "a_col0");
+              prog.BindAttribute(2, "a_params");
               if (textured)
               {
-                prog.BindAttribute(2, "a_texcoord");
-                prog.BindAttribute(3, "a_texpage");
+                prog.BindAttribute(3, "a_texcoord");
+                prog.BindAttribute(4, "a_texpage");
               }
 
               if (!IsGLES() || m_supports_dual_source_blend)
@@ -393,6 +441,8 @@ bool GPU_HW_OpenGL::CompilePrograms()
             {
               prog->Bind();
               prog->Uniform1i("samp0", 0);
+              if (m_texture_cache)
+                prog->Uniform1i("samp1", 1);
             }
           }
 
@@ -485,10 +535,10 @@ bool GPU_HW_OpenGL::CompilePrograms()
   prog->Uniform1i("samp0", 0);
   m_vram_update_depth_program = std::move(*prog);
 
-  if (m_supports_texture_buffer || m_use_ssbo_for_vram_writes)
+  if (m_texture_cache)
   {
     prog = m_shader_cache.GetProgram(shadergen.GenerateScreenQuadVertexShader(), {},
-                                     shadergen.GenerateVRAMWriteFragmentShader(m_use_ssbo_for_vram_writes),
+                                     shadergen.GenerateTextureCacheDecodeFragmentShader(),
                                      [this, use_binding_layout](GL::Program& prog) {
                                        if (!IsGLES() && !use_binding_layout)
                                          prog.BindFragData(0, "o_col0");
@@ -502,6 +552,33 @@ bool GPU_HW_OpenGL::CompilePrograms()
       prog->Bind();
       prog->Uniform1i("samp0", 0);
     }
+    m_texture_cache_decode_program = std::move(*prog);
+  }
+
+  if (m_supports_texture_buffer || m_use_ssbo_for_vram_writes)
+  {
+    prog = m_shader_cache.GetProgram(shadergen.GenerateVRAMWriteVertexShader(), {},
+                                     shadergen.GenerateVRAMWriteFragmentShader(m_use_ssbo_for_vram_writes),
+                                     [this, use_binding_layout](GL::Program& prog) {
+                                       if (!use_binding_layout)
+                                       {
+                                         prog.BindAttribute(0, "a_pos");
+                                         prog.BindAttribute(1, "a_coords");
+                                         prog.BindAttribute(2, "a_mask_or_bits");
+                                         prog.BindAttribute(3, "a_depth_value");
+                                       }
+
+                                       if (!IsGLES() && !use_binding_layout)
+                                         prog.BindFragData(0, "o_col0");
+                                     });
+    if (!prog)
+      return false;
+
+    if (!use_binding_layout)
+    {
+      prog->Bind();
+      prog->Uniform1i("samp0", 0);
+    }
     m_vram_write_program = std::move(*prog);
   }
 
@@ -515,7 +592,16 @@ void GPU_HW_OpenGL::DrawBatchVertices(BatchRenderMode render_mode, u32 base_vert
   prog.Bind();
 
   if (m_batch.texture_mode != TextureMode::Disabled)
+  {
+    if (m_texture_cache && (m_batch.texture_mode & ~TextureMode::RawTextureBit) <= TextureMode::Palette8Bit)
+    {
+      glActiveTexture(GL_TEXTURE1);
+      m_texture_cache_texture.Bind();
+      glActiveTexture(GL_TEXTURE0);
+    }
+
     m_vram_read_texture.Bind();
+  }
 
   if (m_batch.transparency_mode == TransparencyMode::Disabled || render_mode == BatchRenderMode::OnlyOpaque)
   {
@@ -530,7 +616,7 @@ void GPU_HW_OpenGL::DrawBatchVertices(BatchRenderMode render_mode, u32 base_vert
     glBlendFuncSeparate(GL_ONE, m_supports_dual_source_blend ? GL_SRC1_ALPHA : GL_SRC_ALPHA, GL_ONE, GL_ZERO);
   }
 
-  glDepthFunc(m_GPUSTAT.check_mask_before_draw ? GL_GEQUAL : GL_ALWAYS);
+  glDepthFunc(m_batch.check_mask_before_draw ? GL_GEQUAL : GL_ALWAYS);
 
   glDrawArrays(GL_TRIANGLES, m_batch_base_vertex, num_vertices);
 }
@@ -655,16 +741,15 @@ void GPU_HW_OpenGL::UpdateDisplay()
   }
 }
 
-void GPU_HW_OpenGL::ReadVRAM(u32 x, u32 y, u32 width, u32 height)
+void GPU_HW_OpenGL::BeginVRAMReadback(const Common::Rectangle<u32>& copy_rect)
 {
-  // Get bounds with wrap-around handled.
-  const Common::Rectangle<u32> copy_rect = GetVRAMTransferBounds(x, y, width, height);
-  const u32 encoded_width = (copy_rect.GetWidth() + 1) / 2;
-  const u32 encoded_height = copy_rect.GetHeight();
+  const Common::Rectangle<u32> aligned_rect = GetAlignedVRAMReadbackRect(copy_rect);
+  const u32 encoded_width = aligned_rect.GetWidth() / 2;
+  const u32 encoded_height = aligned_rect.GetHeight();
 
   // Encode the 24-bit texture as 16-bit.
-  const u32 uniforms[4] = {copy_rect.left, VRAM_HEIGHT - copy_rect.top - copy_rect.GetHeight(), copy_rect.GetWidth(),
-                           copy_rect.GetHeight()};
+  const u32 uniforms[4] = {aligned_rect.left, VRAM_HEIGHT - aligned_rect.top - encoded_height, aligned_rect.GetWidth(),
+                           encoded_height};
   m_vram_encoding_texture.BindFramebuffer(GL_DRAW_FRAMEBUFFER);
   m_vram_texture.Bind();
   m_vram_read_program.Bind();
@@ -675,17 +760,50 @@ void GPU_HW_OpenGL::ReadVRAM(u32 x, u32 y, u32 width, u32 height)
   glBindVertexArray(m_attributeless_vao_id);
   glDrawArrays(GL_TRIANGLES, 0, 3);
 
-  // Readback encoded texture.
+  // Readback encoded texture, laid out the same as the VRAM shadow.
+  const u32 buffer_offset = (aligned_rect.top * VRAM_WIDTH + aligned_rect.left) * sizeof(u16);
   m_vram_encoding_texture.BindFramebuffer(GL_READ_FRAMEBUFFER);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, m_vram_readback_buffer_id);
   glPixelStorei(GL_PACK_ALIGNMENT, 2);
   glPixelStorei(GL_PACK_ROW_LENGTH, VRAM_WIDTH / 2);
   glReadPixels(0, 0, encoded_width, encoded_height, GL_RGBA, GL_UNSIGNED_BYTE,
-               &m_vram_shadow[copy_rect.top * VRAM_WIDTH + copy_rect.left]);
+               reinterpret_cast<void*>(static_cast<uintptr_t>(buffer_offset)));
   glPixelStorei(GL_PACK_ALIGNMENT, 4);
   glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
   RestoreGraphicsAPIState();
 }
 
+void GPU_HW_OpenGL::EndVRAMReadback(const Common::Rectangle<u32>& copy_rect)
+{
+  const u32 width = copy_rect.GetWidth();
+  const u32 height = copy_rect.GetHeight();
+  const u32 buffer_offset = (copy_rect.top * VRAM_WIDTH + copy_rect.left) * sizeof(u16);
+  const u32 buffer_size = ((height - 1) * VRAM_WIDTH + width) * sizeof(u16);
+
+  // Mapping waits for the transfer, which has usually finished already if it was started in the previous frame.
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, m_vram_readback_buffer_id);
+  const u8* src_ptr =
+    static_cast<const u8*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, buffer_offset, buffer_size, GL_MAP_READ_BIT));
+  if (src_ptr)
+  {
+    for (u32 row = 0; row < height; row++)
+    {
+      std::memcpy(&m_vram_shadow[(copy_rect.top + row) * VRAM_WIDTH + copy_rect.left], src_ptr,
+                  width * sizeof(u16));
+      src_ptr += VRAM_WIDTH * sizeof(u16);
+    }
+
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+  }
+  else
+  {
+    Log_ErrorPrintf("Failed to map VRAM readback buffer");
+  }
+
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
 void GPU_HW_OpenGL::FillVRAM(u32 x, u32 y, u32 width, u32 height, u32 color)
 {
   if ((x + width) > VRAM_WIDTH || (y + height) > VRAM_HEIGHT)
@@ -698,6 +816,7 @@ void GPU_HW_OpenGL::FillVRAM(u32 x, u32 y, u32 width, u32 height, u32 color)
     return;
   }
 
+  FlushPendingVRAMWrites();
   GPU_HW::FillVRAM(x, y, width, height, color);
 
   // scale coordinates
@@ -739,33 +858,7 @@ void GPU_HW_OpenGL::UpdateVRAM(u32 x, u32 y, u32 width, u32 height, const void*
   {
     const Common::Rectangle<u32> bounds = GetVRAMTransferBounds(x, y, width, height);
     GPU_HW::UpdateVRAM(bounds.left, bounds.top, bounds.GetWidth(), bounds.GetHeight(), data);
-
-    const auto map_result = m_texture_stream_buffer->Map(sizeof(u16), num_pixels * sizeof(u16));
-    std::memcpy(map_result.pointer, data, num_pixels * sizeof(u16));
-    m_texture_stream_buffer->Unmap(num_pixels * sizeof(u16));
-    m_texture_stream_buffer->Unbind();
-
-    glDisable(GL_BLEND);
-    glDepthFunc(m_GPUSTAT.check_mask_before_draw ? GL_GEQUAL : GL_ALWAYS);
-
-    m_vram_write_program.Bind();
-    if (m_use_ssbo_for_vram_writes)
-      glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_texture_stream_buffer->GetGLBufferId());
-    else
-      glBindTexture(GL_TEXTURE_BUFFER, m_texture_buffer_r16ui_texture);
-
-    const VRAMWriteUBOData uniforms = GetVRAMWriteUBOData(x, y, width, height, map_result.index_aligned);
-    UploadUniformBuffer(&uniforms, sizeof(uniforms));
-
-    // the viewport should already be set to the full vram, so just adjust the scissor
-    const Common::Rectangle<u32> scaled_bounds = bounds * m_resolution_scale;
-    glScissor(scaled_bounds.left, m_vram_texture.GetHeight() - scaled_bounds.top - scaled_bounds.GetHeight(),
-              scaled_bounds.GetWidth(), scaled_bounds.GetHeight());
-
-    glBindVertexArray(m_attributeless_vao_id);
-    glDrawArrays(GL_TRIANGLES, 0, 3);
-
-    RestoreGraphicsAPIState();
+    QueueVRAMWrite(x, y, width, height, data);
   }
   else
   {
@@ -779,6 +872,8 @@ void GPU_HW_OpenGL::UpdateVRAM(u32 x, u32 y, u32 width, u32 height, const void*
       return;
     }
 
+    // the texture upload doesn't go through the write shader, so anything queued has to land first
+    FlushPendingVRAMWrites();
     GPU_HW::UpdateVRAM(x, y, width, height, data);
 
     const auto map_result = m_texture_stream_buffer->Map(sizeof(u32), num_pixels * sizeof(u32));
@@ -837,13 +932,72 @@ void GPU_HW_OpenGL::UpdateVRAM(u32 x, u32 y, u32 width, u32 height, const void*
   }
 }
 
+void GPU_HW_OpenGL::DrawPendingVRAMWrites()
+{
+  const u32 data_size = static_cast<u32>(m_pending_vram_write_data.size() * sizeof(u16));
+  const auto data_map_result = m_texture_stream_buffer->Map(sizeof(u16), data_size);
+  std::memcpy(data_map_result.pointer, m_pending_vram_write_data.data(), data_size);
+  m_texture_stream_buffer->Unmap(data_size);
+  m_texture_stream_buffer->Unbind();
+
+  // the batch vertices are unmapped at this point, so the writes can share the stream buffer
+  const u32 num_vertices = GetPendingVRAMWriteVertexCount();
+  const u32 vertices_size = num_vertices * sizeof(VRAMWriteVertex);
+  m_vertex_stream_buffer->Bind();
+  const auto vertex_map_result = m_vertex_stream_buffer->Map(sizeof(VRAMWriteVertex), vertices_size);
+  GetPendingVRAMWriteVertices(static_cast<VRAMWriteVertex*>(vertex_map_result.pointer),
+                              data_map_result.index_aligned);
+  m_vertex_stream_buffer->Unmap(vertices_size);
+
+  // the quads cover exactly the written area, so the scissor isn't needed
+  glDisable(GL_SCISSOR_TEST);
+  glDisable(GL_BLEND);
+  glDepthFunc(m_pending_vram_writes_check_mask ? GL_GEQUAL : GL_ALWAYS);
+
+  m_vram_write_program.Bind();
+  if (m_use_ssbo_for_vram_writes)
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, m_texture_stream_buffer->GetGLBufferId());
+  else
+    glBindTexture(GL_TEXTURE_BUFFER, m_texture_buffer_r16ui_texture);
+
+  glBindVertexArray(m_vram_write_vao_id);
+  glDrawArrays(GL_TRIANGLES, vertex_map_result.index_aligned, num_vertices);
+
+  RestoreGraphicsAPIState();
+}
+
+void GPU_HW_OpenGL::DecodeTextureCacheEntries()
+{
+  // the atlas isn't flipped like VRAM, the batch shader reads it back with the same origin
+  m_texture_cache_texture.BindFramebuffer(GL_DRAW_FRAMEBUFFER);
+  glDisable(GL_SCISSOR_TEST);
+  glDisable(GL_BLEND);
+  glDisable(GL_DEPTH_TEST);
+  glDepthMask(GL_FALSE);
+  glBindVertexArray(m_attributeless_vao_id);
+  m_vram_read_texture.Bind();
+  m_texture_cache_decode_program.Bind();
+
+  for (const u32 slot : m_texture_cache_pending_decodes)
+  {
+    const TextureCacheUBOData uniforms = GetTextureCacheUBOData(slot);
+    UploadUniformBuffer(&uniforms, sizeof(uniforms));
+    glViewport(uniforms.u_dst_x, uniforms.u_dst_y, TEXTURE_PAGE_WIDTH, TEXTURE_PAGE_HEIGHT);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+  }
+
+  RestoreGraphicsAPIState();
+}
+
 void GPU_HW_OpenGL::CopyVRAM(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 width, u32 height)
 {
+  FlushPendingVRAMWrites();
+
   if (UseVRAMCopyShader(src_x, src_y, dst_x, dst_y, width, height))
   {
     const Common::Rectangle<u32> src_bounds = GetVRAMTransferBounds(src_x, src_y, width, height);
     const Common::Rectangle<u32> dst_bounds = GetVRAMTransferBounds(dst_x, dst_y, width, height);
-    if (m_vram_dirty_rect.Intersects(src_bounds))
+    if (m_vram_dirty_tiles.Intersects(src_bounds))
       UpdateVRAMReadTexture();
     IncludeVRAMDityRectangle(dst_bounds);
 
@@ -907,28 +1061,42 @@ void GPU_HW_OpenGL::CopyVRAM(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 wid
 
 void GPU_HW_OpenGL::UpdateVRAMReadTexture()
 {
-  const auto scaled_rect = m_vram_dirty_rect * m_resolution_scale;
-  const u32 width = scaled_rect.GetWidth();
-  const u32 height = scaled_rect.GetHeight();
-  const u32 x = scaled_rect.left;
-  const u32 y = m_vram_texture.GetHeight() - scaled_rect.top - height;
+  m_vram_dirty_tiles.GetRectangles(&m_vram_dirty_tile_rects);
 
-  if (GLAD_GL_VERSION_4_3)
+  const bool use_blit = !GLAD_GL_VERSION_4_3 && !GLAD_GL_EXT_copy_image;
+  if (use_blit)
   {
-    glCopyImageSubData(m_vram_texture.GetGLId(), GL_TEXTURE_2D, 0, x, y, 0, m_vram_read_texture.GetGLId(),
-                       GL_TEXTURE_2D, 0, x, y, 0, width, height, 1);
+    m_vram_read_texture.BindFramebuffer(GL_DRAW_FRAMEBUFFER);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_vram_fbo_id);
+    glDisable(GL_SCISSOR_TEST);
   }
-  else if (GLAD_GL_EXT_copy_image)
+
+  for (const Common::Rectangle<u32>& rect : m_vram_dirty_tile_rects)
   {
-    glCopyImageSubDataEXT(m_vram_texture.GetGLId(), GL_TEXTURE_2D, 0, x, y, 0, m_vram_read_texture.GetGLId(),
-                          GL_TEXTURE_2D, 0, x, y, 0, width, height, 1);
+    const auto scaled_rect = rect * m_resolution_scale;
+    const u32 width = scaled_rect.GetWidth();
+    const u32 height = scaled_rect.GetHeight();
+    const u32 x = scaled_rect.left;
+    const u32 y = m_vram_texture.GetHeight() - scaled_rect.top - height;
+
+    if (GLAD_GL_VERSION_4_3)
+    {
+      glCopyImageSubData(m_vram_texture.GetGLId(), GL_TEXTURE_2D, 0, x, y, 0, m_vram_read_texture.GetGLId(),
+                         GL_TEXTURE_2D, 0, x, y, 0, width, height, 1);
+    }
+    else if (GLAD_GL_EXT_copy_image)
+    {
+      glCopyImageSubDataEXT(m_vram_texture.GetGLId(), GL_TEXTURE_2D, 0, x, y, 0, m_vram_read_texture.GetGLId(),
+                            GL_TEXTURE_2D, 0, x, y, 0, width, height, 1);
+    }
+    else
+    {
+      glBlitFramebuffer(x, y, x + width, y + height, x, y, x + width, y + height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+    }
   }
-  else
+
+  if (use_blit)
   {
-    m_vram_read_texture.BindFramebuffer(GL_DRAW_FRAMEBUFFER);
-    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_vram_fbo_id);
-    glDisable(GL_SCISSOR_TEST);
-    glBlitFramebuffer(x, y, x + width, y + height, x, y, x + width, y + height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
     glEnable(GL_SCISSOR_TEST);
     glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_vram_fbo_id);
   }
@@ -938,7 +1106,14 @@ void GPU_HW_OpenGL::UpdateVRAMReadTexture()
 
 void GPU_HW_OpenGL::UpdateDepthBufferFromMaskBit()
 {
-  glDisable(GL_SCISSOR_TEST);
+  FlushPendingVRAMWrites();
+
+  // only the areas which have been written since the last update can have a stale depth value
+  m_vram_depth_dirty_tiles.GetRectangles(&m_vram_dirty_tile_rects);
+  if (m_vram_dirty_tile_rects.empty())
+    return;
+
+  glEnable(GL_SCISSOR_TEST);
   glDisable(GL_BLEND);
   glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
   glDepthFunc(GL_ALWAYS);
@@ -946,11 +1121,20 @@ void GPU_HW_OpenGL::UpdateDepthBufferFromMaskBit()
   m_vram_texture.Bind();
   m_vram_update_depth_program.Bind();
   glBindVertexArray(m_attributeless_vao_id);
-  glDrawArrays(GL_TRIANGLES, 0, 3);
+
+  for (const Common::Rectangle<u32>& rect : m_vram_dirty_tile_rects)
+  {
+    const auto scaled_rect = rect * m_resolution_scale;
+    glScissor(scaled_rect.left, m_vram_texture.GetHeight() - scaled_rect.bottom, scaled_rect.GetWidth(),
+              scaled_rect.GetHeight());
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+  }
 
   glBindVertexArray(m_vao_id);
   glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
-  glEnable(GL_SCISSOR_TEST);
+  SetScissorFromDrawingArea();
+
+  GPU_HW::UpdateDepthBufferFromMaskBit();
 }
 
 std::unique_ptr<GPU> GPU::CreateHardwareOpenGLRenderer()
@@ -25,19 +25,28 @@ public:
 protected:
   void ClearDisplay() override;
   void UpdateDisplay() override;
-  void ReadVRAM(u32 x, u32 y, u32 width, u32 height) override;
   void FillVRAM(u32 x, u32 y, u32 width, u32 height, u32 color) override;
   void UpdateVRAM(u32 x, u32 y, u32 width, u32 height, const void* data) override;
   void CopyVRAM(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 width, u32 height) override;
   void UpdateVRAMReadTexture() override;
+  void DrawPendingVRAMWrites() override;
+  void DecodeTextureCacheEntries() override;
   void UpdateDepthBufferFromMaskBit() override;
   void SetScissorFromDrawingArea() override;
   void MapBatchVertexPointer(u32 required_vertices) override;
   void UnmapBatchVertexPointer(u32 used_vertices) override;
   void UploadUniformBuffer(const void* data, u32 data_size) override;
   void DrawBatchVertices(BatchRenderMode render_mode, u32 base_vertex, u32 num_vertices) override;
+  void BeginVRAMReadback(const Common::Rectangle<u32>& rect) override;
+  void EndVRAMReadback(const Common::Rectangle<u32>& rect) override;
 
 private:
+  enum : u32
+  {
+    // Padding for odd-width reads at the right edge, the encoded texels cover two pixels.
+    VRAM_READBACK_BUFFER_SIZE = VRAM_WIDTH * VRAM_HEIGHT * sizeof(u16) + sizeof(u32)
+  };
+
   struct GLStats
   {
     u32 num_batches;
@@ -70,11 +79,14 @@ private:
   GL::Texture m_vram_read_texture;
   GL::Texture m_vram_encoding_texture;
   GL::Texture m_display_texture;
+  GL::Texture m_texture_cache_texture;
 
   std::unique_ptr<GL::StreamBuffer> m_vertex_stream_buffer;
   GLuint m_vram_fbo_id = 0;
   GLuint m_vao_id = 0;
   GLuint m_attributeless_vao_id = 0;
+  GLuint m_vram_write_vao_id = 0;
+  GLuint m_vram_readback_buffer_id = 0;
 
   std::unique_ptr<GL::StreamBuffer> m_uniform_stream_buffer;
 
@@ -89,6 +101,7 @@ private:
   GL::Program m_vram_write_program;
   GL::Program m_vram_copy_program;
   GL::Program m_vram_update_depth_program;
+  GL::Program m_texture_cache_decode_program;
 
   u32 m_uniform_buffer_alignment = 1;
   u32 m_max_texture_buffer_size = 0;
@@ -6,9 +6,10 @@
 Log_SetChannel(GPU_HW_ShaderGen);
 
 GPU_HW_ShaderGen::GPU_HW_ShaderGen(HostDisplay::RenderAPI render_api, u32 resolution_scale, bool true_color,
-                                   bool scaled_dithering, bool texture_filtering, bool supports_dual_source_blend)
+                                   bool scaled_dithering, bool texture_filtering, bool texture_cache,
+                                   bool supports_dual_source_blend)
   : m_render_api(render_api), m_resolution_scale(resolution_scale), m_true_color(true_color),
-    m_scaled_dithering(scaled_dithering), m_texture_filering(texture_filtering),
+    m_scaled_dithering(scaled_dithering), m_texture_filering(texture_filtering), m_texture_cache(texture_cache),
     m_glsl(render_api != HostDisplay::RenderAPI::D3D11), m_supports_dual_source_blend(supports_dual_source_blend),
     m_use_glsl_interface_blocks(false)
 {
@@ -495,11 +496,7 @@ void GPU_HW_ShaderGen::DeclareFragmentEntryPoint(
 
 void GPU_HW_ShaderGen::WriteBatchUniformBuffer(std::stringstream& ss)
 {
-  DeclareUniformBuffer(ss,
-                       {"uint2 u_texture_window_mask", "uint2 u_texture_window_offset", "float u_src_alpha_factor",
-                        "float u_dst_alpha_factor", "uint u_interlaced_displayed_field",
-                        "bool u_set_mask_while_drawing"},
-                       false);
+  DeclareUniformBuffer(ss, {"uint u_interlaced_displayed_field"}, false);
 }
 
 std::string GPU_HW_ShaderGen::GenerateBatchVertexShader(bool textured, bool upscaled_lines)
@@ -507,21 +504,25 @@ std::string GPU_HW_ShaderGen::GenerateBatchVertexShader(bool textured, bool upsc
   std::stringstream ss;
   WriteHeader(ss);
   DefineMacro(ss, "TEXTURED", textured);
+  DefineMacro(ss, "TEXTURE_CACHE", m_texture_cache);
 
   WriteCommonFunctions(ss);
   WriteBatchUniformBuffer(ss);
 
   ss << "CONSTANT float EPSILON = 0.00001;\n";
+  ss << "CONSTANT uint TEXTURE_CACHE_PAGES_PER_ROW = " << GPU_HW::TEXTURE_CACHE_PAGES_PER_ROW << "u;\n";
 
   const char* output_block_suffix = upscaled_lines ? "VS" : "";
   if (textured)
   {
-    DeclareVertexEntryPoint(ss, {"float4 a_pos", "float4 a_col0", "uint a_texcoord", "uint a_texpage"}, 1, 1,
-                            {{"nointerpolation", "uint4 v_texpage"}}, false, output_block_suffix);
+    DeclareVertexEntryPoint(ss, {"float4 a_pos", "float4 a_col0", "uint a_params", "uint a_texcoord", "uint a_texpage"},
+                            1, 1, {{"nointerpolation", "uint v_params"}, {"nointerpolation", "uint4 v_texpage"}}, false,
+                            output_block_suffix);
   }
   else
   {
-    DeclareVertexEntryPoint(ss, {"float4 a_pos", "float4 a_col0"}, 1, 0, {}, false, output_block_suffix);
+    DeclareVertexEntryPoint(ss, {"float4 a_pos", "float4 a_col0", "uint a_params"}, 1, 0,
+                            {{"nointerpolation", "uint v_params"}}, false, output_block_suffix);
   }
 
   ss << R"(
@@ -554,6 +555,7 @@ std::string GPU_HW_ShaderGen::GenerateBatchVertexShader(bool textured, bool upsc
   v_pos = float4(pos_x * pos_w, pos_y * pos_w, pos_z * pos_w, pos_w);
 
   v_col0 = a_col0;
+  v_params = a_params;
   #if TEXTURED
     // Fudge the texture coordinates by half a pixel in screen-space.
     // This fixes the rounding/interpolation error on NVIDIA GPUs with shared edges between triangles.
@@ -565,6 +567,17 @@ std::string GPU_HW_ShaderGen::GenerateBatchVertexShader(bool textured, bool upsc
     v_texpage.y = ((a_texpage >> 4) & 1u) * 256u * RESOLUTION_SCALE;
     v_texpage.z = ((a_texpage >> 16) & 63u) * 16u * RESOLUTION_SCALE;
     v_texpage.w = ((a_texpage >> 22) & 511u) * RESOLUTION_SCALE;
+
+    #if TEXTURE_CACHE
+      // Already decoded to the texture cache atlas, see GPU_HW::LookupTextureCache().
+      // atlas_x,atlas_y,0xFFFFFFFF,unused
+      if ((a_texpage & 0x80000000u) != 0u)
+      {
+        uint slot = (a_texpage >> 16) & 63u;
+        v_texpage = uint4((slot % TEXTURE_CACHE_PAGES_PER_ROW) * 256u, (slot / TEXTURE_CACHE_PAGES_PER_ROW) * 256u,
+                          0xFFFFFFFFu, 0u);
+      }
+    #endif
   #endif
 }
 )";
@@ -579,6 +592,8 @@ std::string GPU_HW_ShaderGen::GenerateBatchFragmentShader(GPU_HW::BatchRenderMod
   const GPU::TextureMode actual_texture_mode = texture_mode & ~GPU::TextureMode::RawTextureBit;
   const bool raw_texture = (texture_mode & GPU::TextureMode::RawTextureBit) == GPU::TextureMode::RawTextureBit;
   const bool textured = (texture_mode != GPU::TextureMode::Disabled);
+  const bool palette = (actual_texture_mode == GPU::TextureMode::Palette4Bit ||
+                        actual_texture_mode == GPU::TextureMode::Palette8Bit);
   const bool use_dual_source =
     m_supports_dual_source_blend && ((transparency != GPU_HW::BatchRenderMode::TransparencyDisabled &&
                                       transparency != GPU_HW::BatchRenderMode::OnlyOpaque) ||
@@ -590,9 +605,7 @@ std::string GPU_HW_ShaderGen::GenerateBatchFragmentShader(GPU_HW::BatchRenderMod
   DefineMacro(ss, "TRANSPARENCY_ONLY_OPAQUE", transparency == GPU_HW::BatchRenderMode::OnlyOpaque);
   DefineMacro(ss, "TRANSPARENCY_ONLY_TRANSPARENCY", transparency == GPU_HW::BatchRenderMode::OnlyTransparent);
   DefineMacro(ss, "TEXTURED", textured);
-  DefineMacro(ss, "PALETTE",
-              actual_texture_mode == GPU::TextureMode::Palette4Bit ||
-                actual_texture_mode == GPU::TextureMode::Palette8Bit);
+  DefineMacro(ss, "PALETTE", palette);
   DefineMacro(ss, "PALETTE_4_BIT", actual_texture_mode == GPU::TextureMode::Palette4Bit);
   DefineMacro(ss, "PALETTE_8_BIT", actual_texture_mode == GPU::TextureMode::Palette8Bit);
   DefineMacro(ss, "RAW_TEXTURE", raw_texture);
@@ -601,11 +614,14 @@ std::string GPU_HW_ShaderGen::GenerateBatchFragmentShader(GPU_HW::BatchRenderMod
   DefineMacro(ss, "INTERLACING", interlacing);
   DefineMacro(ss, "TRUE_COLOR", m_true_color);
   DefineMacro(ss, "TEXTURE_FILTERING", m_texture_filering);
+  DefineMacro(ss, "TEXTURE_CACHE", m_texture_cache && palette);
   DefineMacro(ss, "USE_DUAL_SOURCE", use_dual_source);
 
   WriteCommonFunctions(ss);
   WriteBatchUniformBuffer(ss);
   DeclareTexture(ss, "samp0", 0);
+  if (m_texture_cache && palette)
+    DeclareTexture(ss, "samp1", 1);
 
   if (m_glsl)
     ss << "CONSTANT int[16] s_dither_values = int[16]( ";
@@ -642,17 +658,18 @@ uint3 ApplyDithering(uint2 coord, uint3 icol)
 #if TEXTURED
 CONSTANT float4 TRANSPARENT_PIXEL_COLOR = float4(0.0, 0.0, 0.0, 0.0);
 
-uint2 ApplyTextureWindow(uint2 coords)
+// texture_window is mask_x,mask_y,offset_x,offset_y
+uint2 ApplyTextureWindow(uint4 texture_window, uint2 coords)
 {
-  uint x = (uint(coords.x) & ~(u_texture_window_mask.x * 8u)) | ((u_texture_window_offset.x & u_texture_window_mask.x) * 8u);
-  uint y = (uint(coords.y) & ~(u_texture_window_mask.y * 8u)) | ((u_texture_window_offset.y & u_texture_window_mask.y) * 8u);
+  uint x = (uint(coords.x) & ~(texture_window.x * 8u)) | ((texture_window.z & texture_window.x) * 8u);
+  uint y = (uint(coords.y) & ~(texture_window.y * 8u)) | ((texture_window.w & texture_window.y) * 8u);
   return uint2(x, y);
 }
 
-uint2 ApplyUpscaledTextureWindow(uint2 coords)
+uint2 ApplyUpscaledTextureWindow(uint4 texture_window, uint2 coords)
 {
-  uint x = (uint(coords.x) & ~(u_texture_window_mask.x * 8u * RESOLUTION_SCALE)) | ((u_texture_window_offset.x & u_texture_window_mask.x) * 8u * RESOLUTION_SCALE);
-  uint y = (uint(coords.y) & ~(u_texture_window_mask.y * 8u * RESOLUTION_SCALE)) | ((u_texture_window_offset.y & u_texture_window_mask.y) * 8u * RESOLUTION_SCALE);
+  uint x = (uint(coords.x) & ~(texture_window.x * 8u * RESOLUTION_SCALE)) | ((texture_window.z & texture_window.x) * 8u * RESOLUTION_SCALE);
+  uint y = (uint(coords.y) & ~(texture_window.y * 8u * RESOLUTION_SCALE)) | ((texture_window.w & texture_window.y) * 8u * RESOLUTION_SCALE);
   return uint2(x, y);
 }
 
@@ -663,7 +680,7 @@ uint2 FloatToIntegerCoords(float2 coords)
   return uint2((RESOLUTION_SCALE == 1u) ? roundEven(coords) : floor(coords));
 }
 
-float4 SampleFromVRAM(uint4 texpage, float2 coords)
+float4 SampleFromVRAM(uint4 texpage, uint4 texture_window, float2 coords)
 {
   #if PALETTE
     // We can't currently use upscaled coordinate for palettes because of how they're packed.
@@ -671,7 +688,12 @@ float4 SampleFromVRAM(uint4 texpage, float2 coords)
     #if !TEXTURE_FILTERING
       coords /= float2(RESOLUTION_SCALE, RESOLUTION_SCALE);
     #endif
-    uint2 icoord = ApplyTextureWindow(FloatToIntegerCoords(coords));
+    uint2 icoord = ApplyTextureWindow(texture_window, FloatToIntegerCoords(coords));
+
+    #if TEXTURE_CACHE
+      if (texpage.z == 0xFFFFFFFFu)
+        return LOAD_TEXTURE(samp1, int2(texpage.xy + (icoord & uint2(255u, 255u))), 0);
+    #endif
 
     uint2 index_coord = icoord;
     #if PALETTE_4_BIT
@@ -701,7 +723,7 @@ float4 SampleFromVRAM(uint4 texpage, float2 coords)
     return LOAD_TEXTURE(samp0, int2(palette_icoord), 0);
   #else
     // Direct texturing. Render-to-texture effects. Use upscaled coordinates.
-    uint2 icoord = ApplyUpscaledTextureWindow(FloatToIntegerCoords(coords));    
+    uint2 icoord = ApplyUpscaledTextureWindow(texture_window, FloatToIntegerCoords(coords));    
     uint2 direct_icoord = uint2(texpage.x + icoord.x, fixYCoord(texpage.y + icoord.y));
     return LOAD_TEXTURE(samp0, int2(direct_icoord), 0);
   #endif
@@ -711,11 +733,12 @@ float4 SampleFromVRAM(uint4 texpage, float2 coords)
 
   if (textured)
   {
-    DeclareFragmentEntryPoint(ss, 1, 1, {{"nointerpolation", "uint4 v_texpage"}}, true, use_dual_source ? 2 : 1, true);
+    DeclareFragmentEntryPoint(ss, 1, 1, {{"nointerpolation", "uint v_params"}, {"nointerpolation", "uint4 v_texpage"}},
+                              true, use_dual_source ? 2 : 1, true);
   }
   else
   {
-    DeclareFragmentEntryPoint(ss, 1, 0, {}, true, use_dual_source ? 2 : 1, true);
+    DeclareFragmentEntryPoint(ss, 1, 0, {{"nointerpolation", "uint v_params"}}, true, use_dual_source ? 2 : 1, true);
   }
 
   ss << R"(
@@ -727,12 +750,20 @@ float4 SampleFromVRAM(uint4 texpage, float2 coords)
   float ialpha;
   float oalpha;
 
+  // Unpack the per-vertex state, see GPU_HW::BatchVertex::PackParams().
+  uint transparency_mode = (v_params >> 20) & 3u;
+  float src_alpha_factor = (transparency_mode == 0u) ? 0.5 : ((transparency_mode == 3u) ? 0.25 : 1.0);
+  float dst_alpha_factor = (transparency_mode == 0u) ? 0.5 : 1.0;
+  bool set_mask_while_drawing = ((v_params >> 22) & 1u) != 0u;
+
   #if INTERLACING
     if ((fixYCoord(uint(v_pos.y)) & 1u) == u_interlaced_displayed_field)
       discard;
   #endif
 
   #if TEXTURED
+    uint4 texture_window = uint4(v_params & 31u, (v_params >> 5) & 31u, (v_params >> 10) & 31u, (v_params >> 15) & 31u);
+
     #if TEXTURE_FILTERING
       // Compute the coordinates of the four texels we will be interpolating between.
       // TODO: Find some way to clamp this to the triangle texture coordinates?
@@ -746,10 +777,10 @@ float4 SampleFromVRAM(uint4 texpage, float2 coords)
                            float4(0.0, 0.0, 0.0, 0.0));
 
       // Load four texels.
-      float4 s00 = SampleFromVRAM(v_texpage, fcoords.xy);
-      float4 s10 = SampleFromVRAM(v_texpage, fcoords.zy);
-      float4 s01 = SampleFromVRAM(v_texpage, fcoords.xw);
-      float4 s11 = SampleFromVRAM(v_texpage, fcoords.zw);
+      float4 s00 = SampleFromVRAM(v_texpage, texture_window, fcoords.xy);
+      float4 s10 = SampleFromVRAM(v_texpage, texture_window, fcoords.zy);
+      float4 s01 = SampleFromVRAM(v_texpage, texture_window, fcoords.xw);
+      float4 s11 = SampleFromVRAM(v_texpage, texture_window, fcoords.zw);
 
       // Compute alpha from how many texels aren't pixel color 0000h.
       float a00 = float(VECTOR_NEQ(s00, TRANSPARENT_PIXEL_COLOR));
@@ -767,7 +798,7 @@ float4 SampleFromVRAM(uint4 texpage, float2 coords)
       texcol.rgb /= float3(ialpha, ialpha, ialpha);
       semitransparent = (texcol.a != 0.0);
     #else
-      float4 texcol = SampleFromVRAM(v_texpage, v_tex0);
+      float4 texcol = SampleFromVRAM(v_texpage, texture_window, v_tex0);
       if (VECTOR_EQ(texcol, TRANSPARENT_PIXEL_COLOR))
         discard;
 
@@ -799,7 +830,7 @@ float4 SampleFromVRAM(uint4 texpage, float2 coords)
     #endif
 
     // Compute output alpha (mask bit)
-    oalpha = float(u_set_mask_while_drawing ? 1 : int(semitransparent));
+    oalpha = float(set_mask_while_drawing ? 1 : int(semitransparent));
   #else
     // All pixels are semitransparent for untextured polygons.
     semitransparent = true;
@@ -815,13 +846,13 @@ float4 SampleFromVRAM(uint4 texpage, float2 coords)
     #endif
 
     // However, the mask bit is cleared if set mask bit is false.
-    oalpha = float(u_set_mask_while_drawing);
+    oalpha = float(set_mask_while_drawing);
   #endif
 
   // Premultiply alpha so we don't need to use a colour output for it.
   float premultiply_alpha = ialpha;
   #if TRANSPARENCY
-    premultiply_alpha = ialpha * (semitransparent ? u_src_alpha_factor : 1.0);
+    premultiply_alpha = ialpha * (semitransparent ? src_alpha_factor : 1.0);
   #endif
 
   float3 color;
@@ -844,9 +875,9 @@ float4 SampleFromVRAM(uint4 texpage, float2 coords)
 
       #if USE_DUAL_SOURCE
         o_col0 = float4(color, oalpha);
-        o_col1 = float4(0.0, 0.0, 0.0, u_dst_alpha_factor / ialpha);
+        o_col1 = float4(0.0, 0.0, 0.0, dst_alpha_factor / ialpha);
       #else
-        o_col0 = float4(color, u_dst_alpha_factor / ialpha);
+        o_col0 = float4(color, dst_alpha_factor / ialpha);
       #endif
 
       o_depth = oalpha * v_pos.z;
@@ -1067,15 +1098,41 @@ uint SampleVRAM(uint2 coords)
   return ss.str();
 }
 
+std::string GPU_HW_ShaderGen::GenerateVRAMWriteVertexShader()
+{
+  std::stringstream ss;
+  WriteHeader(ss);
+  DeclareVertexEntryPoint(ss, {"float2 a_pos", "uint4 a_coords", "uint a_mask_or_bits", "float a_depth_value"}, 0, 0,
+                          {{"nointerpolation", "uint4 v_coords"},
+                           {"nointerpolation", "uint v_mask_or_bits"},
+                           {"nointerpolation", "float v_depth_value"}},
+                          false);
+  ss << R"(
+{
+  // 0..+1023 -> -1..1, same as the batch vertices but without the texcoord offset
+  float pos_x = (a_pos.x / 512.0) - 1.0;
+  float pos_y = (a_pos.y / -256.0) + 1.0;
+
+  // NDC space Y flip in Vulkan.
+#if API_VULKAN
+  pos_y = -pos_y;
+#endif
+
+  v_pos = float4(pos_x, pos_y, 0.0, 1.0);
+  v_coords = a_coords;
+  v_mask_or_bits = a_mask_or_bits;
+  v_depth_value = a_depth_value;
+}
+)";
+
+  return ss.str();
+}
+
 std::string GPU_HW_ShaderGen::GenerateVRAMWriteFragmentShader(bool use_ssbo)
 {
   std::stringstream ss;
   WriteHeader(ss);
   WriteCommonFunctions(ss);
-  DeclareUniformBuffer(ss,
-                       {"uint2 u_base_coords", "uint2 u_end_coords", "uint2 u_size", "uint u_buffer_base_offset",
-                        "uint u_mask_or_bits", "float u_depth_value"},
-                       true);
 
   if (use_ssbo && m_glsl)
   {
@@ -1097,25 +1154,34 @@ std::string GPU_HW_ShaderGen::GenerateVRAMWriteFragmentShader(bool use_ssbo)
     ss << "#define GET_VALUE(buffer_offset) (LOAD_TEXTURE_BUFFER(samp0, int(buffer_offset)).r)\n\n";
   }
 
-  DeclareFragmentEntryPoint(ss, 0, 1, {}, true, 1, true);
+  DeclareFragmentEntryPoint(ss, 0, 0,
+                            {{"nointerpolation", "uint4 v_coords"},
+                             {"nointerpolation", "uint v_mask_or_bits"},
+                             {"nointerpolation", "float v_depth_value"}},
+                            true, 1, true);
   ss << R"(
 {
+  uint2 base_coords = uint2(v_coords.x & 0xFFFFu, v_coords.x >> 16);
+  uint2 end_coords = uint2(v_coords.y & 0xFFFFu, v_coords.y >> 16);
+  uint2 size = uint2(v_coords.z & 0xFFFFu, v_coords.z >> 16);
+  uint buffer_base_offset = v_coords.w;
+
   uint2 coords = uint2(uint(v_pos.x) / RESOLUTION_SCALE, fixYCoord(uint(v_pos.y)) / RESOLUTION_SCALE);
 
   // make sure it's not oversized and out of range
-  if (VECTOR_LT(coords, u_base_coords) && VECTOR_GE(coords, u_end_coords))
+  if (VECTOR_LT(coords, base_coords) && VECTOR_GE(coords, end_coords))
     discard;
 
   // find offset from the start of the row/column
   uint2 offset;
-  offset.x = (coords.x < u_base_coords.x) ? ((VRAM_SIZE.x / RESOLUTION_SCALE) - u_base_coords.x + coords.x) : (coords.x - u_base_coords.x);
-  offset.y = (coords.y < u_base_coords.y) ? ((VRAM_SIZE.y / RESOLUTION_SCALE) - u_base_coords.y + coords.y) : (coords.y - u_base_coords.y);
+  offset.x = (coords.x < base_coords.x) ? ((VRAM_SIZE.x / RESOLUTION_SCALE) - base_coords.x + coords.x) : (coords.x - base_coords.x);
+  offset.y = (coords.y < base_coords.y) ? ((VRAM_SIZE.y / RESOLUTION_SCALE) - base_coords.y + coords.y) : (coords.y - base_coords.y);
 
-  uint buffer_offset = u_buffer_base_offset + (offset.y * u_size.x) + offset.x;
-  uint value = GET_VALUE(buffer_offset) | u_mask_or_bits;
+  uint buffer_offset = buffer_base_offset + (offset.y * size.x) + offset.x;
+  uint value = GET_VALUE(buffer_offset) | v_mask_or_bits;
   
   o_col0 = RGBA5551ToRGBA8(value);
-  o_depth = (o_col0.a == 1.0) ? u_depth_value : 0.0;
+  o_depth = (o_col0.a == 1.0) ? v_depth_value : 0.0;
 })";
 
   return ss.str();
@@ -1173,3 +1239,35 @@ std::string GPU_HW_ShaderGen::GenerateVRAMUpdateDepthFragmentShader()
 
   return ss.str();
 }
+
+std::string GPU_HW_ShaderGen::GenerateTextureCacheDecodeFragmentShader()
+{
+  std::stringstream ss;
+  WriteHeader(ss);
+  WriteCommonFunctions(ss);
+  DeclareUniformBuffer(
+    ss, {"uint2 u_dst_coords", "uint2 u_texpage_coords", "uint2 u_palette_coords", "bool u_palette_8bit"}, true);
+
+  DeclareTexture(ss, "samp0", 0);
+  DeclareFragmentEntryPoint(ss, 0, 1, {}, true, 1);
+  ss << R"(
+{
+  // Same lookup as SampleFromVRAM() in the batch shader, for every texel of the page.
+  uint2 icoord = uint2(v_pos.xy) - u_dst_coords;
+  uint2 index_coord = uint2(icoord.x / (u_palette_8bit ? 2u : 4u), icoord.y);
+  uint2 vicoord = uint2(u_texpage_coords.x + index_coord.x * RESOLUTION_SCALE,
+                        fixYCoord(u_texpage_coords.y + index_coord.y * RESOLUTION_SCALE));
+  uint vram_value = RGBA8ToRGBA5551(LOAD_TEXTURE(samp0, int2(vicoord), 0));
+
+  uint palette_index;
+  if (u_palette_8bit)
+    palette_index = (vram_value >> ((icoord.x & 1u) * 8u)) & 0xFFu;
+  else
+    palette_index = (vram_value >> ((icoord.x & 3u) * 4u)) & 0x0Fu;
+
+  uint2 palette_icoord = uint2(u_palette_coords.x + (palette_index * RESOLUTION_SCALE), fixYCoord(u_palette_coords.y));
+  o_col0 = LOAD_TEXTURE(samp0, int2(palette_icoord), 0);
+})";
+
+  return ss.str();
+}
@@ -1,6 +1,7 @@
 #include "gpu_hw_vulkan.h"
 #include "common/assert.h"
 #include "common/log.h"
+#include "common/parallel_for.h"
 #include "common/scope_guard.h"
 #include "common/vulkan/builders.h"
 #include "common/vulkan/context.h"
@@ -10,6 +11,7 @@
 #include "host_display.h"
 #include "host_interface.h"
 #include "system.h"
+#include <atomic>
 Log_SetChannel(GPU_HW_Vulkan);
 
 GPU_HW_Vulkan::GPU_HW_Vulkan() = default;
@@ -282,6 +284,7 @@ bool GPU_HW_Vulkan::CreatePipelineLayouts()
   dslbuilder.AddBinding(0, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1,
                         VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT);
   dslbuilder.AddBinding(1, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT);
+  dslbuilder.AddBinding(2, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 1, VK_SHADER_STAGE_FRAGMENT_BIT);
   m_batch_descriptor_set_layout = dslbuilder.Create(device);
   if (m_batch_descriptor_set_layout == VK_NULL_HANDLE)
     return false;
@@ -318,7 +321,6 @@ bool GPU_HW_Vulkan::CreatePipelineLayouts()
     return false;
 
   plbuilder.AddDescriptorSet(m_vram_write_descriptor_set_layout);
-  plbuilder.AddPushConstants(VK_SHADER_STAGE_FRAGMENT_BIT, 0, MAX_PUSH_CONSTANTS_SIZE);
   m_vram_write_pipeline_layout = plbuilder.Create(device);
   if (m_vram_write_pipeline_layout == VK_NULL_HANDLE)
     return false;
@@ -375,7 +377,11 @@ bool GPU_HW_Vulkan::CreateFramebuffer()
                                       VK_IMAGE_TILING_OPTIMAL,
                                       VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT) ||
       !m_vram_readback_staging_texture.Create(Vulkan::StagingBuffer::Type::Readback, texture_format, VRAM_WIDTH,
-                                              VRAM_HEIGHT))
+                                              VRAM_HEIGHT) ||
+      (m_texture_cache &&
+       !m_texture_cache_texture.Create(TEXTURE_CACHE_SIZE, TEXTURE_CACHE_SIZE, 1, 1, texture_format, samples,
+                                       VK_IMAGE_VIEW_TYPE_2D, VK_IMAGE_TILING_OPTIMAL,
+                                       VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_SAMPLED_BIT)))
   {
     return false;
   }
@@ -383,15 +389,18 @@ bool GPU_HW_Vulkan::CreateFramebuffer()
   m_vram_render_pass =
     g_vulkan_context->GetRenderPass(texture_format, depth_format, samples, VK_ATTACHMENT_LOAD_OP_LOAD);
   m_vram_update_depth_render_pass =
-    g_vulkan_context->GetRenderPass(VK_FORMAT_UNDEFINED, depth_format, samples, VK_ATTACHMENT_LOAD_OP_DONT_CARE);
+    g_vulkan_context->GetRenderPass(VK_FORMAT_UNDEFINED, depth_format, samples, VK_ATTACHMENT_LOAD_OP_LOAD);
   m_display_render_pass = g_vulkan_context->GetRenderPass(m_display_texture.GetFormat(), VK_FORMAT_UNDEFINED,
                                                           m_display_texture.GetSamples(), VK_ATTACHMENT_LOAD_OP_LOAD);
   m_vram_readback_render_pass =
     g_vulkan_context->GetRenderPass(m_vram_readback_texture.GetFormat(), VK_FORMAT_UNDEFINED,
                                     m_vram_readback_texture.GetSamples(), VK_ATTACHMENT_LOAD_OP_DONT_CARE);
+  m_texture_cache_render_pass =
+    g_vulkan_context->GetRenderPass(texture_format, VK_FORMAT_UNDEFINED, samples, VK_ATTACHMENT_LOAD_OP_LOAD);
 
   if (m_vram_render_pass == VK_NULL_HANDLE || m_vram_update_depth_render_pass == VK_NULL_HANDLE ||
-      m_display_render_pass == VK_NULL_HANDLE || m_vram_readback_render_pass == VK_NULL_HANDLE)
+      m_display_render_pass == VK_NULL_HANDLE || m_vram_readback_render_pass == VK_NULL_HANDLE ||
+      m_texture_cache_render_pass == VK_NULL_HANDLE)
   {
     return false;
   }
@@ -417,10 +426,19 @@ bool GPU_HW_Vulkan::CreateFramebuffer()
     return false;
   }
 
+  if (m_texture_cache)
+  {
+    m_texture_cache_framebuffer = m_texture_cache_texture.CreateFramebuffer(m_texture_cache_render_pass);
+    if (m_texture_cache_framebuffer == VK_NULL_HANDLE)
+      return false;
+  }
+
   VkCommandBuffer cmdbuf = g_vulkan_context->GetCurrentCommandBuffer();
   m_vram_texture.TransitionToLayout(cmdbuf, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
   m_vram_depth_texture.TransitionToLayout(cmdbuf, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL);
   m_vram_read_texture.TransitionToLayout(cmdbuf, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+  if (m_texture_cache)
+    m_texture_cache_texture.TransitionToLayout(cmdbuf, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 
   Vulkan::DescriptorSetUpdateBuilder dsubuilder;
 
@@ -437,6 +455,9 @@ bool GPU_HW_Vulkan::CreateFramebuffer()
                                       m_uniform_stream_buffer.GetBuffer(), 0, sizeof(BatchUBOData));
   dsubuilder.AddCombinedImageSamplerDescriptorWrite(m_batch_descriptor_set, 1, m_vram_read_texture.GetView(),
                                                     m_point_sampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+  dsubuilder.AddCombinedImageSamplerDescriptorWrite(
+    m_batch_descriptor_set, 2, m_texture_cache ? m_texture_cache_texture.GetView() : m_vram_read_texture.GetView(),
+    m_point_sampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
   dsubuilder.AddCombinedImageSamplerDescriptorWrite(m_vram_copy_descriptor_set, 1, m_vram_read_texture.GetView(),
                                                     m_point_sampler, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
   dsubuilder.AddCombinedImageSamplerDescriptorWrite(m_vram_read_descriptor_set, 1, m_vram_texture.GetView(),
@@ -503,12 +524,14 @@ void GPU_HW_Vulkan::DestroyFramebuffer()
   Vulkan::Util::SafeDestroyFramebuffer(m_vram_update_depth_framebuffer);
   Vulkan::Util::SafeDestroyFramebuffer(m_vram_readback_framebuffer);
   Vulkan::Util::SafeDestroyFramebuffer(m_display_framebuffer);
+  Vulkan::Util::SafeDestroyFramebuffer(m_texture_cache_framebuffer);
 
   m_vram_read_texture.Destroy(false);
   m_vram_depth_texture.Destroy(false);
   m_vram_texture.Destroy(false);
   m_vram_readback_texture.Destroy(false);
   m_display_texture.Destroy(false);
+  m_texture_cache_texture.Destroy(false);
   m_vram_readback_staging_texture.Destroy(false);
 }
 
@@ -572,7 +595,7 @@ bool GPU_HW_Vulkan::CompilePipelines()
   VkPipelineCache pipeline_cache = g_vulkan_shader_cache->GetPipelineCache();
 
   GPU_HW_ShaderGen shadergen(m_host_display->GetRenderAPI(), m_resolution_scale, m_true_color, m_scaled_dithering,
-                             m_texture_filtering, m_supports_dual_source_blend);
+                             m_texture_filtering, m_texture_cache, m_supports_dual_source_blend);
 
   // vertex shaders - [textured]
   // fragment shaders - [render_mode][texture_mode][dithering][interlacing]
@@ -583,14 +606,20 @@ bool GPU_HW_Vulkan::CompilePipelines()
     batch_fragment_shaders.enumerate(Vulkan::Util::SafeDestroyShaderModule);
   });
 
-  for (u8 textured = 0; textured < 2; textured++)
+  // The batch permutations are the bulk of the startup cost. Sources are generated here, then compiled (on a shader
+  // cache miss) and turned into modules across all host threads.
+  struct PendingShader
   {
-    const std::string vs = shadergen.GenerateBatchVertexShader(ConvertToBoolUnchecked(textured), false);
-    VkShaderModule shader = g_vulkan_shader_cache->GetVertexShader(vs);
-    if (shader == VK_NULL_HANDLE)
-      return false;
+    std::string source;
+    Vulkan::ShaderCompiler::Type type;
+    VkShaderModule* module;
+  };
+  std::vector<PendingShader> pending_shaders;
 
-    batch_vertex_shaders[textured] = shader;
+  for (u8 textured = 0; textured < 2; textured++)
+  {
+    pending_shaders.push_back({shadergen.GenerateBatchVertexShader(ConvertToBoolUnchecked(textured), false),
+                               Vulkan::ShaderCompiler::Type::Vertex, &batch_vertex_shaders[textured]});
   }
 
   for (u8 render_mode = 0; render_mode < 4; render_mode++)
@@ -601,89 +630,91 @@ bool GPU_HW_Vulkan::CompilePipelines()
       {
         for (u8 interlacing = 0; interlacing < 2; interlacing++)
         {
-          const std::string fs = shadergen.GenerateBatchFragmentShader(
-            static_cast<BatchRenderMode>(render_mode), static_cast<TextureMode>(texture_mode),
-            ConvertToBoolUnchecked(dithering), ConvertToBoolUnchecked(interlacing));
-
-          VkShaderModule shader = g_vulkan_shader_cache->GetFragmentShader(fs);
-          if (shader == VK_NULL_HANDLE)
-            return false;
-
-          batch_fragment_shaders[render_mode][texture_mode][dithering][interlacing] = shader;
+          pending_shaders.push_back({shadergen.GenerateBatchFragmentShader(
+                                       static_cast<BatchRenderMode>(render_mode),
+                                       static_cast<TextureMode>(texture_mode), ConvertToBoolUnchecked(dithering),
+                                       ConvertToBoolUnchecked(interlacing)),
+                                     Vulkan::ShaderCompiler::Type::Fragment,
+                                     &batch_fragment_shaders[render_mode][texture_mode][dithering][interlacing]});
         }
       }
     }
   }
 
-  Vulkan::GraphicsPipelineBuilder gpbuilder;
+  std::atomic_bool compile_failed{false};
+  Common::ParallelFor(static_cast<u32>(pending_shaders.size()), [&pending_shaders, &compile_failed](u32 index) {
+    PendingShader& ps = pending_shaders[index];
+    *ps.module = g_vulkan_shader_cache->GetShaderModule(ps.type, ps.source);
+    if (*ps.module == VK_NULL_HANDLE)
+      compile_failed.store(true);
+  });
+  if (compile_failed.load())
+    return false;
 
-  // [primitive][depth_test][render_mode][texture_mode][transparency_mode][dithering][interlacing]
-  for (u8 depth_test = 0; depth_test < 2; depth_test++)
-  {
-    for (u8 render_mode = 0; render_mode < 4; render_mode++)
+  // [depth_test][render_mode][texture_mode][transparency_mode][dithering][interlacing]
+  // Pipelines are created in parallel too, the pipeline cache is internally synchronized.
+  static constexpr u32 NUM_BATCH_PIPELINES = 2 * 4 * 5 * 9 * 2 * 2;
+  Common::ParallelFor(NUM_BATCH_PIPELINES, [this, device, pipeline_cache, &batch_vertex_shaders,
+                                            &batch_fragment_shaders, &compile_failed](u32 index) {
+    const u8 interlacing = static_cast<u8>(index % 2);
+    const u8 dithering = static_cast<u8>((index / 2) % 2);
+    const u8 texture_mode = static_cast<u8>((index / (2 * 2)) % 9);
+    const u8 transparency_mode = static_cast<u8>((index / (2 * 2 * 9)) % 5);
+    const u8 render_mode = static_cast<u8>((index / (2 * 2 * 9 * 5)) % 4);
+    const u8 depth_test = static_cast<u8>(index / (2 * 2 * 9 * 5 * 4));
+    const bool textured = (static_cast<TextureMode>(texture_mode) != TextureMode::Disabled);
+
+    Vulkan::GraphicsPipelineBuilder gpbuilder;
+    gpbuilder.SetPipelineLayout(m_batch_pipeline_layout);
+    gpbuilder.SetRenderPass(m_vram_render_pass, 0);
+
+    gpbuilder.AddVertexBuffer(0, sizeof(BatchVertex), VK_VERTEX_INPUT_RATE_VERTEX);
+    gpbuilder.AddVertexAttribute(0, 0, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(BatchVertex, x));
+    gpbuilder.AddVertexAttribute(1, 0, VK_FORMAT_R8G8B8A8_UNORM, offsetof(BatchVertex, color));
+    gpbuilder.AddVertexAttribute(2, 0, VK_FORMAT_R32_UINT, offsetof(BatchVertex, params));
+    if (textured)
     {
-      for (u8 transparency_mode = 0; transparency_mode < 5; transparency_mode++)
-      {
-        for (u8 texture_mode = 0; texture_mode < 9; texture_mode++)
-        {
-          for (u8 dithering = 0; dithering < 2; dithering++)
-          {
-            for (u8 interlacing = 0; interlacing < 2; interlacing++)
-            {
-              const bool textured = (static_cast<TextureMode>(texture_mode) != TextureMode::Disabled);
-
-              gpbuilder.SetPipelineLayout(m_batch_pipeline_layout);
-              gpbuilder.SetRenderPass(m_vram_render_pass, 0);
-
-              gpbuilder.AddVertexBuffer(0, sizeof(BatchVertex), VK_VERTEX_INPUT_RATE_VERTEX);
-              gpbuilder.AddVertexAttribute(0, 0, VK_FORMAT_R32G32B32A32_SFLOAT, offsetof(BatchVertex, x));
-              gpbuilder.AddVertexAttribute(1, 0, VK_FORMAT_R8G8B8A8_UNORM, offsetof(BatchVertex, color));
-              if (textured)
-              {
-                gpbuilder.AddVertexAttribute(2, 0, VK_FORMAT_R32_UINT, offsetof(BatchVertex, u));
-                gpbuilder.AddVertexAttribute(3, 0, VK_FORMAT_R32_UINT, offsetof(BatchVertex, texpage));
-              }
-
-              gpbuilder.SetPrimitiveTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
-              gpbuilder.SetVertexShader(batch_vertex_shaders[BoolToUInt8(textured)]);
-              gpbuilder.SetFragmentShader(batch_fragment_shaders[render_mode][texture_mode][dithering][interlacing]);
-
-              gpbuilder.SetRasterizationState(VK_POLYGON_MODE_FILL, VK_CULL_MODE_NONE, VK_FRONT_FACE_CLOCKWISE);
-              gpbuilder.SetDepthState(true, true,
-                                      (depth_test != 0) ? VK_COMPARE_OP_GREATER_OR_EQUAL : VK_COMPARE_OP_ALWAYS);
-              gpbuilder.SetNoBlendingState();
-
-              if ((static_cast<TransparencyMode>(transparency_mode) != TransparencyMode::Disabled &&
-                   (static_cast<BatchRenderMode>(render_mode) != BatchRenderMode::TransparencyDisabled &&
-                    static_cast<BatchRenderMode>(render_mode) != BatchRenderMode::OnlyOpaque)) ||
-                  m_texture_filtering)
-              {
-                gpbuilder.SetBlendAttachment(
-                  0, true, VK_BLEND_FACTOR_ONE,
-                  m_supports_dual_source_blend ? VK_BLEND_FACTOR_SRC1_ALPHA : VK_BLEND_FACTOR_SRC_ALPHA,
-                  (static_cast<TransparencyMode>(transparency_mode) == TransparencyMode::BackgroundMinusForeground) ?
-                    VK_BLEND_OP_REVERSE_SUBTRACT :
-                    VK_BLEND_OP_ADD,
-                  VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD);
-              }
-
-              gpbuilder.SetDynamicViewportAndScissorState();
-
-              VkPipeline pipeline = gpbuilder.Create(device, pipeline_cache);
-              if (pipeline == VK_NULL_HANDLE)
-                return false;
-
-              m_batch_pipelines[depth_test][render_mode][texture_mode][transparency_mode][dithering][interlacing] =
-                pipeline;
-            }
-          }
-        }
-      }
+      gpbuilder.AddVertexAttribute(3, 0, VK_FORMAT_R32_UINT, offsetof(BatchVertex, u));
+      gpbuilder.AddVertexAttribute(4, 0, VK_FORMAT_R32_UINT, offsetof(BatchVertex, texpage));
+    }
+
+    gpbuilder.SetPrimitiveTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
+    gpbuilder.SetVertexShader(batch_vertex_shaders[BoolToUInt8(textured)]);
+    gpbuilder.SetFragmentShader(batch_fragment_shaders[render_mode][texture_mode][dithering][interlacing]);
+
+    gpbuilder.SetRasterizationState(VK_POLYGON_MODE_FILL, VK_CULL_MODE_NONE, VK_FRONT_FACE_CLOCKWISE);
+    gpbuilder.SetDepthState(true, true, (depth_test != 0) ? VK_COMPARE_OP_GREATER_OR_EQUAL : VK_COMPARE_OP_ALWAYS);
+    gpbuilder.SetNoBlendingState();
+
+    if ((static_cast<TransparencyMode>(transparency_mode) != TransparencyMode::Disabled &&
+         (static_cast<BatchRenderMode>(render_mode) != BatchRenderMode::TransparencyDisabled &&
+          static_cast<BatchRenderMode>(render_mode) != BatchRenderMode::OnlyOpaque)) ||
+        m_texture_filtering)
+    {
+      gpbuilder.SetBlendAttachment(
+        0, true, VK_BLEND_FACTOR_ONE,
+        m_supports_dual_source_blend ? VK_BLEND_FACTOR_SRC1_ALPHA : VK_BLEND_FACTOR_SRC_ALPHA,
+        (static_cast<TransparencyMode>(transparency_mode) == TransparencyMode::BackgroundMinusForeground) ?
+          VK_BLEND_OP_REVERSE_SUBTRACT :
+          VK_BLEND_OP_ADD,
+        VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD);
     }
-  }
+
+    gpbuilder.SetDynamicViewportAndScissorState();
+
+    VkPipeline pipeline = gpbuilder.Create(device, pipeline_cache);
+    if (pipeline == VK_NULL_HANDLE)
+      compile_failed.store(true);
+
+    m_batch_pipelines[depth_test][render_mode][texture_mode][transparency_mode][dithering][interlacing] = pipeline;
+  });
+  if (compile_failed.load())
+    return false;
 
   batch_shader_guard.Exit();
 
+  Vulkan::GraphicsPipelineBuilder gpbuilder;
+
   VkShaderModule fullscreen_quad_vertex_shader =
     g_vulkan_shader_cache->GetVertexShader(shadergen.GenerateScreenQuadVertexShader());
   if (fullscreen_quad_vertex_shader == VK_NULL_HANDLE)
@@ -746,28 +777,49 @@ bool GPU_HW_Vulkan::CompilePipelines()
     vkDestroyShaderModule(device, fs, nullptr);
   }
 
-  // VRAM write
+  // VRAM write - drawn as quads from the vertex stream buffer rather than a fullscreen triangle
   {
+    VkShaderModule vs = g_vulkan_shader_cache->GetVertexShader(shadergen.GenerateVRAMWriteVertexShader());
+    if (vs == VK_NULL_HANDLE)
+      return false;
+
     VkShaderModule fs =
       g_vulkan_shader_cache->GetFragmentShader(shadergen.GenerateVRAMWriteFragmentShader(m_use_ssbos_for_vram_writes));
     if (fs == VK_NULL_HANDLE)
+    {
+      vkDestroyShaderModule(device, vs, nullptr);
       return false;
+    }
 
-    gpbuilder.SetPipelineLayout(m_vram_write_pipeline_layout);
-    gpbuilder.SetFragmentShader(fs);
+    Vulkan::GraphicsPipelineBuilder write_gpbuilder;
+    write_gpbuilder.SetPipelineLayout(m_vram_write_pipeline_layout);
+    write_gpbuilder.SetRenderPass(m_vram_render_pass, 0);
+    write_gpbuilder.AddVertexBuffer(0, sizeof(VRAMWriteVertex), VK_VERTEX_INPUT_RATE_VERTEX);
+    write_gpbuilder.AddVertexAttribute(0, 0, VK_FORMAT_R32G32_SFLOAT, offsetof(VRAMWriteVertex, x));
+    write_gpbuilder.AddVertexAttribute(1, 0, VK_FORMAT_R32G32B32A32_UINT, offsetof(VRAMWriteVertex, base_coords));
+    write_gpbuilder.AddVertexAttribute(2, 0, VK_FORMAT_R32_UINT, offsetof(VRAMWriteVertex, mask_or_bits));
+    write_gpbuilder.AddVertexAttribute(3, 0, VK_FORMAT_R32_SFLOAT, offsetof(VRAMWriteVertex, depth_value));
+    write_gpbuilder.SetPrimitiveTopology(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
+    write_gpbuilder.SetNoCullRasterizationState();
+    write_gpbuilder.SetNoBlendingState();
+    write_gpbuilder.SetDynamicViewportAndScissorState();
+    write_gpbuilder.SetVertexShader(vs);
+    write_gpbuilder.SetFragmentShader(fs);
     for (u8 depth_test = 0; depth_test < 2; depth_test++)
     {
-      gpbuilder.SetDepthState((depth_test != 0), true,
-                              (depth_test != 0) ? VK_COMPARE_OP_GREATER_OR_EQUAL : VK_COMPARE_OP_ALWAYS);
-      m_vram_write_pipelines[depth_test] = gpbuilder.Create(device, pipeline_cache, false);
+      write_gpbuilder.SetDepthState((depth_test != 0), true,
+                                    (depth_test != 0) ? VK_COMPARE_OP_GREATER_OR_EQUAL : VK_COMPARE_OP_ALWAYS);
+      m_vram_write_pipelines[depth_test] = write_gpbuilder.Create(device, pipeline_cache, false);
       if (m_vram_write_pipelines[depth_test] == VK_NULL_HANDLE)
       {
         vkDestroyShaderModule(device, fs, nullptr);
+        vkDestroyShaderModule(device, vs, nullptr);
         return false;
       }
     }
 
     vkDestroyShaderModule(device, fs, nullptr);
+    vkDestroyShaderModule(device, vs, nullptr);
   }
 
   // VRAM update depth
@@ -814,6 +866,31 @@ bool GPU_HW_Vulkan::CompilePipelines()
 
   gpbuilder.Clear();
 
+  // Texture cache decode
+  if (m_texture_cache)
+  {
+    VkShaderModule fs =
+      g_vulkan_shader_cache->GetFragmentShader(shadergen.GenerateTextureCacheDecodeFragmentShader());
+    if (fs == VK_NULL_HANDLE)
+      return false;
+
+    gpbuilder.SetRenderPass(m_texture_cache_render_pass, 0);
+    gpbuilder.SetPipelineLayout(m_single_sampler_pipeline_layout);
+    gpbuilder.SetVertexShader(fullscreen_quad_vertex_shader);
+    gpbuilder.SetFragmentShader(fs);
+    gpbuilder.SetNoCullRasterizationState();
+    gpbuilder.SetNoDepthTestState();
+    gpbuilder.SetNoBlendingState();
+    gpbuilder.SetDynamicViewportAndScissorState();
+
+    m_texture_cache_decode_pipeline = gpbuilder.Create(device, pipeline_cache, false);
+    vkDestroyShaderModule(device, fs, nullptr);
+    if (m_texture_cache_decode_pipeline == VK_NULL_HANDLE)
+      return false;
+
+    gpbuilder.Clear();
+  }
+
   // Display
   {
     gpbuilder.SetRenderPass(m_display_render_pass, 0);
@@ -861,6 +938,7 @@ void GPU_HW_Vulkan::DestroyPipelines()
 
   Vulkan::Util::SafeDestroyPipeline(m_vram_readback_pipeline);
   Vulkan::Util::SafeDestroyPipeline(m_vram_update_depth_pipeline);
+  Vulkan::Util::SafeDestroyPipeline(m_texture_cache_decode_pipeline);
 
   m_display_pipelines.enumerate(Vulkan::Util::SafeDestroyPipeline);
 }
@@ -980,12 +1058,11 @@ void GPU_HW_Vulkan::UpdateDisplay()
   }
 }
 
-void GPU_HW_Vulkan::ReadVRAM(u32 x, u32 y, u32 width, u32 height)
+void GPU_HW_Vulkan::BeginVRAMReadback(const Common::Rectangle<u32>& copy_rect)
 {
-  // Get bounds with wrap-around handled.
-  const Common::Rectangle<u32> copy_rect = GetVRAMTransferBounds(x, y, width, height);
-  const u32 encoded_width = (copy_rect.GetWidth() + 1) / 2;
-  const u32 encoded_height = copy_rect.GetHeight();
+  const Common::Rectangle<u32> aligned_rect = GetAlignedVRAMReadbackRect(copy_rect);
+  const u32 encoded_width = aligned_rect.GetWidth() / 2;
+  const u32 encoded_height = aligned_rect.GetHeight();
 
   EndRenderPass();
 
@@ -998,7 +1075,7 @@ void GPU_HW_Vulkan::ReadVRAM(u32 x, u32 y, u32 width, u32 height)
   BeginRenderPass(m_vram_readback_render_pass, m_vram_readback_framebuffer, 0, 0, VRAM_WIDTH, VRAM_HEIGHT);
 
   // Encode the 24-bit texture as 16-bit.
-  const u32 uniforms[4] = {copy_rect.left, copy_rect.top, copy_rect.GetWidth(), copy_rect.GetHeight()};
+  const u32 uniforms[4] = {aligned_rect.left, aligned_rect.top, aligned_rect.GetWidth(), encoded_height};
   vkCmdBindPipeline(cmdbuf, VK_PIPELINE_BIND_POINT_GRAPHICS, m_vram_readback_pipeline);
   vkCmdPushConstants(cmdbuf, m_single_sampler_pipeline_layout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(uniforms),
                      uniforms);
@@ -1012,13 +1089,24 @@ void GPU_HW_Vulkan::ReadVRAM(u32 x, u32 y, u32 width, u32 height)
   m_vram_readback_texture.TransitionToLayout(cmdbuf, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
   m_vram_texture.TransitionToLayout(cmdbuf, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
 
-  // Stage the readback.
+  // Stage the readback, it's submitted along with the rest of the command buffer.
   m_vram_readback_staging_texture.CopyFromTexture(m_vram_readback_texture, 0, 0, 0, 0, 0, 0, encoded_width,
                                                   encoded_height);
 
-  // And copy it into our shadow buffer (will execute command buffer and stall).
+  RestoreGraphicsAPIState();
+}
+
+void GPU_HW_Vulkan::EndVRAMReadback(const Common::Rectangle<u32>& copy_rect)
+{
+  const Common::Rectangle<u32> aligned_rect = GetAlignedVRAMReadbackRect(copy_rect);
+  const u32 encoded_width = aligned_rect.GetWidth() / 2;
+  const u32 encoded_height = aligned_rect.GetHeight();
+
+  // And copy it into our shadow buffer. This executes the command buffer and stalls if the copy is still in the
+  // current one, otherwise it only waits for its fence.
+  EndRenderPass();
   m_vram_readback_staging_texture.ReadTexels(0, 0, encoded_width, encoded_height,
-                                             &m_vram_shadow[copy_rect.top * VRAM_WIDTH + copy_rect.left],
+                                             &m_vram_shadow[aligned_rect.top * VRAM_WIDTH + aligned_rect.left],
                                              VRAM_WIDTH * sizeof(u16));
 
   RestoreGraphicsAPIState();
@@ -1026,6 +1114,8 @@ void GPU_HW_Vulkan::ReadVRAM(u32 x, u32 y, u32 width, u32 height)
 
 void GPU_HW_Vulkan::FillVRAM(u32 x, u32 y, u32 width, u32 height, u32 color)
 {
+  FlushPendingVRAMWrites();
+
   if ((x + width) > VRAM_WIDTH || (y + height) > VRAM_HEIGHT)
   {
     // CPU round trip if oversized for now.
@@ -1061,53 +1151,95 @@ void GPU_HW_Vulkan::UpdateVRAM(u32 x, u32 y, u32 width, u32 height, const void*
 {
   const Common::Rectangle<u32> bounds = GetVRAMTransferBounds(x, y, width, height);
   GPU_HW::UpdateVRAM(bounds.left, bounds.top, bounds.GetWidth(), bounds.GetHeight(), data);
+  QueueVRAMWrite(x, y, width, height, data);
+}
 
-  const u32 data_size = width * height * sizeof(u16);
+void GPU_HW_Vulkan::DrawPendingVRAMWrites()
+{
+  const u32 data_size = static_cast<u32>(m_pending_vram_write_data.size() * sizeof(u16));
   const u32 alignment = std::max<u32>(sizeof(u16), static_cast<u32>(g_vulkan_context->GetTexelBufferAlignment()));
-  if (!m_texture_stream_buffer.ReserveMemory(data_size, alignment))
+  const u32 num_vertices = GetPendingVRAMWriteVertexCount();
+  const u32 vertices_size = num_vertices * sizeof(VRAMWriteVertex);
+  if (!m_texture_stream_buffer.ReserveMemory(data_size, alignment) ||
+      !m_vertex_stream_buffer.ReserveMemory(vertices_size, sizeof(VRAMWriteVertex)))
   {
-    Log_PerfPrintf("Executing command buffer while waiting for %u bytes in stream buffer", data_size);
+    Log_PerfPrintf("Executing command buffer while waiting for %u bytes in stream buffers for VRAM writes",
+                   data_size + vertices_size);
     EndRenderPass();
     g_vulkan_context->ExecuteCommandBuffer(false);
     RestoreGraphicsAPIState();
-    if (!m_texture_stream_buffer.ReserveMemory(data_size, alignment))
+    if (!m_texture_stream_buffer.ReserveMemory(data_size, alignment) ||
+        !m_vertex_stream_buffer.ReserveMemory(vertices_size, sizeof(VRAMWriteVertex)))
     {
-      Panic("Failed to allocate space in stream buffer for VRAM write");
+      Panic("Failed to allocate space in stream buffers for VRAM writes");
       return;
     }
   }
 
   const u32 start_index = m_texture_stream_buffer.GetCurrentOffset() / sizeof(u16);
-  std::memcpy(m_texture_stream_buffer.GetCurrentHostPointer(), data, data_size);
+  std::memcpy(m_texture_stream_buffer.GetCurrentHostPointer(), m_pending_vram_write_data.data(), data_size);
   m_texture_stream_buffer.CommitMemory(data_size);
 
+  // the batch vertices are unmapped at this point, so the writes borrow the vertex buffer which is already bound
+  const u32 base_vertex = m_vertex_stream_buffer.GetCurrentOffset() / sizeof(VRAMWriteVertex);
+  GetPendingVRAMWriteVertices(static_cast<VRAMWriteVertex*>(m_vertex_stream_buffer.GetCurrentHostPointer()),
+                              start_index);
+  m_vertex_stream_buffer.CommitMemory(vertices_size);
+
   BeginVRAMRenderPass();
 
   VkCommandBuffer cmdbuf = g_vulkan_context->GetCurrentCommandBuffer();
-  const VRAMWriteUBOData uniforms = GetVRAMWriteUBOData(x, y, width, height, start_index);
-  vkCmdPushConstants(cmdbuf, m_vram_write_pipeline_layout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(uniforms),
-                     &uniforms);
   vkCmdBindPipeline(cmdbuf, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                    m_vram_write_pipelines[BoolToUInt8(m_GPUSTAT.check_mask_before_draw)]);
+                    m_vram_write_pipelines[BoolToUInt8(m_pending_vram_writes_check_mask)]);
   vkCmdBindDescriptorSets(cmdbuf, VK_PIPELINE_BIND_POINT_GRAPHICS, m_vram_write_pipeline_layout, 0, 1,
                           &m_vram_write_descriptor_set, 0, nullptr);
 
-  // the viewport should already be set to the full vram, so just adjust the scissor
-  const Common::Rectangle<u32> scaled_bounds = bounds * m_resolution_scale;
-  Vulkan::Util::SetScissor(cmdbuf, scaled_bounds.left, scaled_bounds.top, scaled_bounds.GetWidth(),
-                           scaled_bounds.GetHeight());
-  vkCmdDraw(cmdbuf, 3, 1, 0, 0);
+  // the viewport should already be set to the full vram, and the quads cover exactly the written area
+  Vulkan::Util::SetScissor(cmdbuf, 0, 0, m_vram_texture.GetWidth(), m_vram_texture.GetHeight());
+  vkCmdDraw(cmdbuf, num_vertices, 1, base_vertex, 0);
+
+  RestoreGraphicsAPIState();
+}
+
+void GPU_HW_Vulkan::DecodeTextureCacheEntries()
+{
+  EndRenderPass();
+
+  VkCommandBuffer cmdbuf = g_vulkan_context->GetCurrentCommandBuffer();
+  m_texture_cache_texture.TransitionToLayout(cmdbuf, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
+  BeginRenderPass(m_texture_cache_render_pass, m_texture_cache_framebuffer, 0, 0, m_texture_cache_texture.GetWidth(),
+                  m_texture_cache_texture.GetHeight());
+
+  // pages are decoded from the read texture, which is what the batch would otherwise sample
+  vkCmdBindPipeline(cmdbuf, VK_PIPELINE_BIND_POINT_GRAPHICS, m_texture_cache_decode_pipeline);
+  vkCmdBindDescriptorSets(cmdbuf, VK_PIPELINE_BIND_POINT_GRAPHICS, m_single_sampler_pipeline_layout, 0, 1,
+                          &m_vram_copy_descriptor_set, 0, nullptr);
+
+  for (const u32 slot : m_texture_cache_pending_decodes)
+  {
+    const TextureCacheUBOData uniforms(GetTextureCacheUBOData(slot));
+    vkCmdPushConstants(cmdbuf, m_single_sampler_pipeline_layout, VK_SHADER_STAGE_FRAGMENT_BIT, 0, sizeof(uniforms),
+                       &uniforms);
+    Vulkan::Util::SetViewportAndScissor(cmdbuf, uniforms.u_dst_x, uniforms.u_dst_y, TEXTURE_PAGE_WIDTH,
+                                        TEXTURE_PAGE_HEIGHT);
+    vkCmdDraw(cmdbuf, 3, 1, 0, 0);
+  }
+
+  EndRenderPass();
+  m_texture_cache_texture.TransitionToLayout(cmdbuf, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
 
   RestoreGraphicsAPIState();
 }
 
 void GPU_HW_Vulkan::CopyVRAM(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 width, u32 height)
 {
+  FlushPendingVRAMWrites();
+
   if (UseVRAMCopyShader(src_x, src_y, dst_x, dst_y, width, height))
   {
     const Common::Rectangle<u32> src_bounds = GetVRAMTransferBounds(src_x, src_y, width, height);
     const Common::Rectangle<u32> dst_bounds = GetVRAMTransferBounds(dst_x, dst_y, width, height);
-    if (m_vram_dirty_rect.Intersects(src_bounds))
+    if (m_vram_dirty_tiles.Intersects(src_bounds))
       UpdateVRAMReadTexture();
     IncludeVRAMDityRectangle(dst_bounds);
 
@@ -1168,15 +1300,25 @@ void GPU_HW_Vulkan::UpdateVRAMReadTexture()
   m_vram_texture.TransitionToLayout(cmdbuf, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL);
   m_vram_read_texture.TransitionToLayout(cmdbuf, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
 
-  const auto scaled_rect = m_vram_dirty_rect * m_resolution_scale;
-  const VkImageCopy copy{{VK_IMAGE_ASPECT_COLOR_BIT, 0u, 0u, 1u},
-                         {static_cast<s32>(scaled_rect.left), static_cast<s32>(scaled_rect.top), 0},
-                         {VK_IMAGE_ASPECT_COLOR_BIT, 0u, 0u, 1u},
-                         {static_cast<s32>(scaled_rect.left), static_cast<s32>(scaled_rect.top), 0},
-                         {scaled_rect.GetWidth(), scaled_rect.GetHeight(), 1u}};
+  // all dirty areas are copied with a single command
+  m_vram_dirty_tiles.GetRectangles(&m_vram_dirty_tile_rects);
+  m_vram_read_texture_copies.clear();
+  for (const Common::Rectangle<u32>& rect : m_vram_dirty_tile_rects)
+  {
+    const auto scaled_rect = rect * m_resolution_scale;
+    m_vram_read_texture_copies.push_back({{VK_IMAGE_ASPECT_COLOR_BIT, 0u, 0u, 1u},
+                                          {static_cast<s32>(scaled_rect.left), static_cast<s32>(scaled_rect.top), 0},
+                                          {VK_IMAGE_ASPECT_COLOR_BIT, 0u, 0u, 1u},
+                                          {static_cast<s32>(scaled_rect.left), static_cast<s32>(scaled_rect.top), 0},
+                                          {scaled_rect.GetWidth(), scaled_rect.GetHeight(), 1u}});
+  }
 
-  vkCmdCopyImage(cmdbuf, m_vram_texture.GetImage(), m_vram_texture.GetLayout(), m_vram_read_texture.GetImage(),
-                 m_vram_read_texture.GetLayout(), 1u, &copy);
+  if (!m_vram_read_texture_copies.empty())
+  {
+    vkCmdCopyImage(cmdbuf, m_vram_texture.GetImage(), m_vram_texture.GetLayout(), m_vram_read_texture.GetImage(),
+                   m_vram_read_texture.GetLayout(), static_cast<u32>(m_vram_read_texture_copies.size()),
+                   m_vram_read_texture_copies.data());
+  }
 
   m_vram_read_texture.TransitionToLayout(cmdbuf, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
   m_vram_texture.TransitionToLayout(cmdbuf, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
@@ -1186,6 +1328,13 @@ void GPU_HW_Vulkan::UpdateVRAMReadTexture()
 
 void GPU_HW_Vulkan::UpdateDepthBufferFromMaskBit()
 {
+  FlushPendingVRAMWrites();
+
+  // only the areas which have been written since the last update can have a stale depth value
+  m_vram_depth_dirty_tiles.GetRectangles(&m_vram_dirty_tile_rects);
+  if (m_vram_dirty_tile_rects.empty())
+    return;
+
   EndRenderPass();
 
   VkCommandBuffer cmdbuf = g_vulkan_context->GetCurrentCommandBuffer();
@@ -1197,14 +1346,22 @@ void GPU_HW_Vulkan::UpdateDepthBufferFromMaskBit()
   vkCmdBindPipeline(cmdbuf, VK_PIPELINE_BIND_POINT_GRAPHICS, m_vram_update_depth_pipeline);
   vkCmdBindDescriptorSets(cmdbuf, VK_PIPELINE_BIND_POINT_GRAPHICS, m_single_sampler_pipeline_layout, 0, 1,
                           &m_vram_read_descriptor_set, 0, nullptr);
-  Vulkan::Util::SetViewportAndScissor(cmdbuf, 0, 0, m_vram_texture.GetWidth(), m_vram_texture.GetHeight());
-  vkCmdDraw(cmdbuf, 3, 1, 0, 0);
+  Vulkan::Util::SetViewport(cmdbuf, 0, 0, m_vram_texture.GetWidth(), m_vram_texture.GetHeight());
+  for (const Common::Rectangle<u32>& rect : m_vram_dirty_tile_rects)
+  {
+    const auto scaled_rect = rect * m_resolution_scale;
+    Vulkan::Util::SetScissor(cmdbuf, scaled_rect.left, scaled_rect.top, scaled_rect.GetWidth(),
+                             scaled_rect.GetHeight());
+    vkCmdDraw(cmdbuf, 3, 1, 0, 0);
+  }
 
   EndRenderPass();
 
   m_vram_texture.TransitionToLayout(cmdbuf, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL);
 
   RestoreGraphicsAPIState();
+
+  GPU_HW::UpdateDepthBufferFromMaskBit();
 }
 
 std::unique_ptr<GPU> GPU::CreateHardwareVulkanRenderer()
@@ -7,6 +7,7 @@
 #include <array>
 #include <memory>
 #include <tuple>
+#include <vector>
 
 class GPU_HW_Vulkan : public GPU_HW
 {
@@ -24,7 +25,6 @@ public:
 protected:
   void ClearDisplay() override;
   void UpdateDisplay() override;
-  void ReadVRAM(u32 x, u32 y, u32 width, u32 height) override;
   void FillVRAM(u32 x, u32 y, u32 width, u32 height, u32 color) override;
   void UpdateVRAM(u32 x, u32 y, u32 width, u32 height, const void* data) override;
   void CopyVRAM(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 width, u32 height) override;
@@ -35,6 +35,10 @@ protected:
   void UnmapBatchVertexPointer(u32 used_vertices) override;
   void UploadUniformBuffer(const void* data, u32 data_size) override;
   void DrawBatchVertices(BatchRenderMode render_mode, u32 base_vertex, u32 num_vertices) override;
+  void BeginVRAMReadback(const Common::Rectangle<u32>& rect) override;
+  void EndVRAMReadback(const Common::Rectangle<u32>& rect) override;
+  void DrawPendingVRAMWrites() override;
+  void DecodeTextureCacheEntries() override;
 
 private:
   enum : u32
@@ -69,6 +73,7 @@ private:
   VkRenderPass m_vram_update_depth_render_pass = VK_NULL_HANDLE;
   VkRenderPass m_display_render_pass = VK_NULL_HANDLE;
   VkRenderPass m_vram_readback_render_pass = VK_NULL_HANDLE;
+  VkRenderPass m_texture_cache_render_pass = VK_NULL_HANDLE;
 
   VkDescriptorSetLayout m_batch_descriptor_set_layout = VK_NULL_HANDLE;
   VkDescriptorSetLayout m_single_sampler_descriptor_set_layout = VK_NULL_HANDLE;
@@ -85,11 +90,13 @@ private:
   Vulkan::Texture m_vram_readback_texture;
   Vulkan::StagingTexture m_vram_readback_staging_texture;
   Vulkan::Texture m_display_texture;
+  Vulkan::Texture m_texture_cache_texture;
 
   VkFramebuffer m_vram_framebuffer = VK_NULL_HANDLE;
   VkFramebuffer m_vram_update_depth_framebuffer = VK_NULL_HANDLE;
   VkFramebuffer m_vram_readback_framebuffer = VK_NULL_HANDLE;
   VkFramebuffer m_display_framebuffer = VK_NULL_HANDLE;
+  VkFramebuffer m_texture_cache_framebuffer = VK_NULL_HANDLE;
 
   VkSampler m_point_sampler = VK_NULL_HANDLE;
   VkSampler m_linear_sampler = VK_NULL_HANDLE;
@@ -118,9 +125,13 @@ private:
 
   VkPipeline m_vram_readback_pipeline = VK_NULL_HANDLE;
   VkPipeline m_vram_update_depth_pipeline = VK_NULL_HANDLE;
+  VkPipeline m_texture_cache_decode_pipeline = VK_NULL_HANDLE;
 
   // [depth_24][interlace_mode]
   DimensionalArray<VkPipeline, 3, 2> m_display_pipelines{};
 
+  // Reused between read texture updates, one region per dirty tile rectangle.
+  std::vector<VkImageCopy> m_vram_read_texture_copies;
+
   bool m_use_ssbos_for_vram_writes = false;
 };
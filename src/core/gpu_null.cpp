@@ -0,0 +1,37 @@
+#include "gpu_null.h"
+#include "host_display.h"
+
+GPU_Null::GPU_Null() : GPU()
+{
+  m_vram_ptr = m_vram.data();
+}
+
+GPU_Null::~GPU_Null() = default;
+
+bool GPU_Null::IsHardwareRenderer() const
+{
+  return false;
+}
+
+void GPU_Null::Reset()
+{
+  GPU::Reset();
+
+  m_vram.fill(0);
+}
+
+void GPU_Null::UpdateDisplay()
+{
+  m_host_display->ClearDisplayTexture();
+}
+
+void GPU_Null::DispatchRenderCommand()
+{
+  // Same path as a skipped frame, the primitives are timed but never drawn.
+  SkipRenderCommand(true);
+}
+
+std::unique_ptr<GPU> GPU::CreateNullRenderer()
+{
+  return std::make_unique<GPU_Null>();
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include "common/heap_array.h"
+#include "gpu.h"
+
+/// Renderer which only emulates the GPU's state and timing, for measuring the rest of the system. Primitives are
+/// parsed and their drawing time is added to the command ticks, but nothing is rasterized. VRAM fills, uploads and
+/// copies are still applied, so the CPU reads back what it transferred, and nothing is ever shown on the display.
+class GPU_Null final : public GPU
+{
+public:
+  GPU_Null();
+  ~GPU_Null() override;
+
+  bool IsHardwareRenderer() const override;
+
+  void Reset() override;
+
+protected:
+  void UpdateDisplay() override;
+  void DispatchRenderCommand() override;
+
+  HeapArray<u16, VRAM_WIDTH * VRAM_HEIGHT> m_vram;
+};
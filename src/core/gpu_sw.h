@@ -1,5 +1,6 @@
 #pragma once
 #include "gpu.h"
+#include "gpu_sw_backend.h"
 #include <array>
 #include <memory>
 #include <vector>
@@ -17,79 +18,57 @@ public:
   bool Initialize(HostDisplay* host_display) override;
   void Reset() override;
 
-  u16 GetPixel(u32 x, u32 y) const { return m_vram[VRAM_WIDTH * y + x]; }
-  const u16* GetPixelPtr(u32 x, u32 y) const { return &m_vram[VRAM_WIDTH * y + x]; }
-  u16* GetPixelPtr(u32 x, u32 y) { return &m_vram[VRAM_WIDTH * y + x]; }
-  void SetPixel(u32 x, u32 y, u16 value) { m_vram[VRAM_WIDTH * y + x] = value; }
-
-  // this is actually (31 * 255) >> 4) == 494, but to simplify addressing we use the next power of two (512)
-  static constexpr u32 DITHER_LUT_SIZE = 512;
-  using DitherLUT = std::array<std::array<std::array<u8, 512>, DITHER_MATRIX_SIZE>, DITHER_MATRIX_SIZE>;
-  static constexpr DitherLUT ComputeDitherLUT();
+  bool DoState(StateWrapper& sw) override;
+  void UpdateSettings() override;
 
 protected:
-  struct SWVertex
+  //////////////////////////////////////////////////////////////////////////
+  // Scanout
+  //////////////////////////////////////////////////////////////////////////
+  /// What was last converted into a row of the display texture buffer.
+  struct DisplayRowState
   {
-    s32 x, y;
-    u8 color_r, color_g, color_b;
-    u8 texcoord_x, texcoord_y;
-
-    ALWAYS_INLINE void SetPosition(VertexPosition p)
+    u32 vram_version;
+    u16 src_x;
+    u16 src_y;
+    u16 width;
+    bool depth_24bit;
+    bool valid;
+
+    bool operator==(const DisplayRowState& rhs) const
     {
-      x = p.x;
-      y = p.y;
+      return (vram_version == rhs.vram_version && src_x == rhs.src_x && src_y == rhs.src_y && width == rhs.width &&
+              depth_24bit == rhs.depth_24bit && valid == rhs.valid);
     }
-
-    ALWAYS_INLINE void SetColorRGB24(u32 color) { std::tie(color_r, color_g, color_b) = UnpackColorRGB24(color); }
-    ALWAYS_INLINE void SetTexcoord(u16 value) { std::tie(texcoord_x, texcoord_y) = UnpackTexcoord(value); }
   };
 
-  //////////////////////////////////////////////////////////////////////////
-  // Scanout
-  //////////////////////////////////////////////////////////////////////////
-  void CopyOut15Bit(u32 src_x, u32 src_y, u32* dst_ptr, u32 dst_stride, u32 width, u32 height, bool interlaced,
-                    bool interleaved);
-  void CopyOut24Bit(u32 src_x, u32 src_y, u32* dst_ptr, u32 dst_stride, u32 width, u32 height, bool interlaced,
-                    bool interleaved);
+  /// Converts VRAM to the display texture buffer, skipping rows which haven't changed since they were last converted.
+  /// Returns false if nothing changed, otherwise the range of buffer rows which were written.
+  bool CopyOut(u32 src_x, u32 src_y, u32 dst_y, u32 width, u32 height, bool depth_24bit, bool interlaced,
+               bool interleaved, u32* first_dst_row, u32* last_dst_row);
   void ClearDisplay() override;
   void UpdateDisplay() override;
 
   //////////////////////////////////////////////////////////////////////////
-  // Rasterization
+  // Command submission
   //////////////////////////////////////////////////////////////////////////
-
+  void ReadVRAM(u32 x, u32 y, u32 width, u32 height) override;
+  void FillVRAM(u32 x, u32 y, u32 width, u32 height, u32 color) override;
+  void UpdateVRAM(u32 x, u32 y, u32 width, u32 height, const void* data) override;
+  void CopyVRAM(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 width, u32 height) override;
   void DispatchRenderCommand() override;
 
-  static bool IsClockwiseWinding(const SWVertex* v0, const SWVertex* v1, const SWVertex* v2);
-
-  template<bool texture_enable, bool raw_texture_enable, bool transparency_enable, bool dithering_enable>
-  void ShadePixel(u32 x, u32 y, u8 color_r, u8 color_g, u8 color_b, u8 texcoord_x, u8 texcoord_y);
-
-  template<bool shading_enable, bool texture_enable, bool raw_texture_enable, bool transparency_enable,
-           bool dithering_enable>
-  void DrawTriangle(const SWVertex* v0, const SWVertex* v1, const SWVertex* v2);
-
-  using DrawTriangleFunction = void (GPU_SW::*)(const SWVertex* v0, const SWVertex* v1, const SWVertex* v2);
-  DrawTriangleFunction GetDrawTriangleFunction(bool shading_enable, bool texture_enable, bool raw_texture_enable,
-                                               bool transparency_enable, bool dithering_enable);
-
-  template<bool texture_enable, bool raw_texture_enable, bool transparency_enable>
-  void DrawRectangle(s32 origin_x, s32 origin_y, u32 width, u32 height, u8 r, u8 g, u8 b, u8 origin_texcoord_x,
-                     u8 origin_texcoord_y);
-
-  using DrawRectangleFunction = void (GPU_SW::*)(s32 origin_x, s32 origin_y, u32 width, u32 height, u8 r, u8 g, u8 b,
-                                                 u8 origin_texcoord_x, u8 origin_texcoord_y);
-  DrawRectangleFunction GetDrawRectangleFunction(bool texture_enable, bool raw_texture_enable,
-                                                 bool transparency_enable);
-
-  template<bool shading_enable, bool transparency_enable, bool dithering_enable>
-  void DrawLine(const SWVertex* p0, const SWVertex* p1);
+  GPUBackendCommandParameters GetBackendCommandParameters() const;
+  void FillDrawCommand(GPUBackendDrawCommand* cmd, RenderCommand rc) const;
+  void SyncDrawingArea();
 
-  using DrawLineFunction = void (GPU_SW::*)(const SWVertex* p0, const SWVertex* p1);
-  DrawLineFunction GetDrawLineFunction(bool shading_enable, bool transparency_enable, bool dithering_enable);
+  /// Computes command ticks for a triangle. Rejects the same triangles as the backend rasterizer.
+  void AddDrawTriangleTicksForVertices(const GPUBackendVertex* v0, const GPUBackendVertex* v1,
+                                       const GPUBackendVertex* v2, bool shaded, bool textured, bool semitransparent);
 
   std::vector<u32> m_display_texture_buffer;
+  std::array<DisplayRowState, VRAM_HEIGHT> m_display_row_states{};
   std::unique_ptr<HostDisplayTexture> m_display_texture;
 
-  std::array<u16, VRAM_WIDTH * VRAM_HEIGHT> m_vram;
+  GPU_SW_Backend m_backend;
 };
@@ -0,0 +1,1857 @@
+#include "gpu_sw_backend.h"
+#include "common/assert.h"
+#include "common/log.h"
+#include "common/string_util.h"
+#include "common/trace_recorder.h"
+#include <algorithm>
+#include <cstring>
+Log_SetChannel(GPU_SW_Backend);
+
+static constexpr u32 VRAM_WIDTH = GPU::VRAM_WIDTH;
+static constexpr u32 VRAM_HEIGHT = GPU::VRAM_HEIGHT;
+
+/// Rectangles here are inclusive of the right/bottom edge, unlike Common::Rectangle::Intersects().
+static bool AreasOverlap(const Common::Rectangle<u32>& lhs, const Common::Rectangle<u32>& rhs)
+{
+  return (lhs.left <= rhs.right && lhs.right >= rhs.left && lhs.top <= rhs.bottom && lhs.bottom >= rhs.top);
+}
+
+GPU_SW_Backend::GPU_SW_Backend()
+{
+  m_vram.fill(0);
+}
+
+GPU_SW_Backend::~GPU_SW_Backend()
+{
+  // The worker thread has to be stopped before we're destroyed, since it calls back into us.
+  SetUseThread(false);
+  StopRasterizerThreads();
+}
+
+void GPU_SW_Backend::Reset()
+{
+  GPUBackend::Reset();
+
+  m_vram.fill(0);
+  m_drawing_area = {};
+  MarkRowsWritten(0, VRAM_HEIGHT);
+  InvalidateTextureCache();
+}
+
+u32 GPU_SW_Backend::GetDefaultRasterizerThreadCount()
+{
+  // Leave a core each for the CPU and GPU worker threads.
+  const u32 host_threads = std::thread::hardware_concurrency();
+  return (host_threads > 2) ? std::min<u32>(host_threads - 2, 8) : 1;
+}
+
+void GPU_SW_Backend::SetRasterizerThreadCount(u32 count)
+{
+  if (count == 0)
+    count = GetDefaultRasterizerThreadCount();
+  count = std::min<u32>(count, MAX_RASTERIZER_THREADS);
+  if (count == GetRasterizerThreadCount())
+    return;
+
+  // Once synced, the GPU worker is asleep and won't touch the rasterizer threads until we push another command.
+  Sync();
+  StopRasterizerThreads();
+  if (count > 1)
+    StartRasterizerThreads(count);
+}
+
+void GPU_SW_Backend::SetUseTextureCache(bool enable)
+{
+  m_use_texture_cache = enable;
+  InvalidateTextureCache();
+}
+
+void GPU_SW_Backend::HandleCommand(const GPUBackendCommand* cmd)
+{
+  switch (cmd->type)
+  {
+    case GPUBackendCommandType::FillVRAM:
+    {
+      WaitForRasterizerThreads();
+
+      const GPUBackendFillVRAMCommand* ccmd = static_cast<const GPUBackendFillVRAMCommand*>(cmd);
+      FillVRAM(ZeroExtend32(ccmd->x), ZeroExtend32(ccmd->y), ZeroExtend32(ccmd->width), ZeroExtend32(ccmd->height),
+               ccmd->color, ccmd->params);
+      MarkRowsWritten(ZeroExtend32(ccmd->y), ZeroExtend32(ccmd->height));
+      InvalidateTextureCache(ZeroExtend32(ccmd->x), ZeroExtend32(ccmd->y), ZeroExtend32(ccmd->width),
+                             ZeroExtend32(ccmd->height));
+    }
+    break;
+
+    case GPUBackendCommandType::UpdateVRAM:
+    {
+      WaitForRasterizerThreads();
+      const GPUBackendUpdateVRAMCommand* ccmd = static_cast<const GPUBackendUpdateVRAMCommand*>(cmd);
+      UpdateVRAM(ZeroExtend32(ccmd->x), ZeroExtend32(ccmd->y), ZeroExtend32(ccmd->width), ZeroExtend32(ccmd->height),
+                 ccmd->GetData(), ccmd->params);
+      MarkRowsWritten(ZeroExtend32(ccmd->y), ZeroExtend32(ccmd->height));
+      InvalidateTextureCache(ZeroExtend32(ccmd->x), ZeroExtend32(ccmd->y), ZeroExtend32(ccmd->width),
+                             ZeroExtend32(ccmd->height));
+    }
+    break;
+
+    case GPUBackendCommandType::CopyVRAM:
+    {
+      WaitForRasterizerThreads();
+      const GPUBackendCopyVRAMCommand* ccmd = static_cast<const GPUBackendCopyVRAMCommand*>(cmd);
+      CopyVRAM(ZeroExtend32(ccmd->src_x), ZeroExtend32(ccmd->src_y), ZeroExtend32(ccmd->dst_x),
+               ZeroExtend32(ccmd->dst_y), ZeroExtend32(ccmd->width), ZeroExtend32(ccmd->height), ccmd->params);
+      MarkRowsWritten(ZeroExtend32(ccmd->dst_y), ZeroExtend32(ccmd->height));
+      InvalidateTextureCache(ZeroExtend32(ccmd->dst_x), ZeroExtend32(ccmd->dst_y), ZeroExtend32(ccmd->width),
+                             ZeroExtend32(ccmd->height));
+    }
+    break;
+
+    case GPUBackendCommandType::SetDrawingArea:
+    {
+      // The rasterizer threads read the drawing area, so it can only change while they're idle.
+      const Common::Rectangle<u32>& new_area = static_cast<const GPUBackendSetDrawingAreaCommand*>(cmd)->new_area;
+      if (new_area != m_drawing_area)
+      {
+        WaitForRasterizerThreads();
+        m_drawing_area = new_area;
+      }
+    }
+    break;
+
+    case GPUBackendCommandType::DrawPolygon:
+    case GPUBackendCommandType::DrawRectangle:
+    case GPUBackendCommandType::DrawLine:
+    {
+      const GPUBackendDrawCommand* dcmd = static_cast<const GPUBackendDrawCommand*>(cmd);
+      Common::Rectangle<u32> write_area;
+      if (!GetDrawWriteArea(dcmd, &write_area))
+        break;
+
+      if (m_raster_thread_count > 0)
+        QueueDrawCommand(dcmd, write_area);
+      else
+        DrawCommand(dcmd, RasterBand{0, 1}, GetTextureCacheTexels(PrepareTextureCache(dcmd, write_area)));
+
+      MarkRowsWritten(write_area.top, write_area.bottom - write_area.top + 1);
+      InvalidateTextureCache(write_area);
+    }
+    break;
+
+    default:
+      UnreachableCode();
+      break;
+  }
+}
+
+void GPU_SW_Backend::FlushRender()
+{
+  WaitForRasterizerThreads();
+}
+
+GPU_SW_Backend::VRAMTileMask GPU_SW_Backend::GetTileMask(u32 left, u32 top, u32 right, u32 bottom)
+{
+  VRAMTileMask mask;
+  for (u32 tile_y = top / VRAM_TILE_SIZE; tile_y <= bottom / VRAM_TILE_SIZE; tile_y++)
+  {
+    for (u32 tile_x = left / VRAM_TILE_SIZE; tile_x <= right / VRAM_TILE_SIZE; tile_x++)
+      mask.set(tile_y * VRAM_TILES_X + tile_x);
+  }
+
+  return mask;
+}
+
+bool GPU_SW_Backend::GetDrawWriteArea(const GPUBackendDrawCommand* cmd, Common::Rectangle<u32>* area) const
+{
+  s32 min_x, min_y, max_x, max_y;
+  switch (cmd->type)
+  {
+    case GPUBackendCommandType::DrawPolygon:
+    {
+      const GPUBackendDrawPolygonCommand* pcmd = static_cast<const GPUBackendDrawPolygonCommand*>(cmd);
+      min_x = max_x = pcmd->vertices[0].x;
+      min_y = max_y = pcmd->vertices[0].y;
+      for (u32 i = 1; i < pcmd->num_vertices; i++)
+      {
+        min_x = std::min(min_x, pcmd->vertices[i].x);
+        max_x = std::max(max_x, pcmd->vertices[i].x);
+        min_y = std::min(min_y, pcmd->vertices[i].y);
+        max_y = std::max(max_y, pcmd->vertices[i].y);
+      }
+    }
+    break;
+
+    case GPUBackendCommandType::DrawRectangle:
+    {
+      const GPUBackendDrawRectangleCommand* rcmd = static_cast<const GPUBackendDrawRectangleCommand*>(cmd);
+      if (rcmd->width == 0 || rcmd->height == 0)
+        return false;
+
+      min_x = rcmd->x;
+      min_y = rcmd->y;
+      max_x = rcmd->x + static_cast<s32>(ZeroExtend32(rcmd->width)) - 1;
+      max_y = rcmd->y + static_cast<s32>(ZeroExtend32(rcmd->height)) - 1;
+    }
+    break;
+
+    case GPUBackendCommandType::DrawLine:
+    default:
+    {
+      const GPUBackendDrawLineCommand* lcmd = static_cast<const GPUBackendDrawLineCommand*>(cmd);
+      const GPUBackendVertex* vertices = lcmd->GetVertices();
+      min_x = max_x = vertices[0].x;
+      min_y = max_y = vertices[0].y;
+      for (u32 i = 1; i < lcmd->num_vertices; i++)
+      {
+        min_x = std::min(min_x, vertices[i].x);
+        max_x = std::max(max_x, vertices[i].x);
+        min_y = std::min(min_y, vertices[i].y);
+        max_y = std::max(max_y, vertices[i].y);
+      }
+    }
+    break;
+  }
+
+  if (max_x < static_cast<s32>(m_drawing_area.left) || min_x > static_cast<s32>(m_drawing_area.right) ||
+      max_y < static_cast<s32>(m_drawing_area.top) || min_y > static_cast<s32>(m_drawing_area.bottom))
+  {
+    return false;
+  }
+
+  // Span shading can write back (unchanged) pixels up to the end of the last span on each row.
+  *area = Common::Rectangle<u32>(
+    std::max(static_cast<u32>(std::max(min_x, 0)), m_drawing_area.left),
+    std::max(static_cast<u32>(std::max(min_y, 0)), m_drawing_area.top),
+    std::min(std::min(static_cast<u32>(max_x), m_drawing_area.right) + (SPAN_WIDTH - 1), VRAM_WIDTH - 1),
+    std::min(static_cast<u32>(max_y), m_drawing_area.bottom));
+  return true;
+}
+
+u32 GPU_SW_Backend::GetTextureReadAreas(const GPUBackendDrawCommand* cmd, Common::Rectangle<u32> areas[2])
+{
+  // The texture window can only narrow the area sampled, so assume the whole page is read.
+  const u32 page_left = cmd->texture_page_x;
+  const u32 page_top = cmd->texture_page_y;
+  const u32 page_bottom = std::min<u32>(page_top + GPU::TEXTURE_PAGE_HEIGHT - 1, VRAM_HEIGHT - 1);
+  switch (cmd->texture_mode)
+  {
+    case GPU::TextureMode::Palette4Bit:
+    case GPU::TextureMode::Palette8Bit:
+    {
+      const bool is_4bit = (cmd->texture_mode == GPU::TextureMode::Palette4Bit);
+      const u32 page_width = is_4bit ? (GPU::TEXTURE_PAGE_WIDTH / 4) : (GPU::TEXTURE_PAGE_WIDTH / 2);
+      const u32 palette_width = is_4bit ? 16 : 256;
+      areas[0] = Common::Rectangle<u32>(page_left, page_top,
+                                        std::min<u32>(page_left + page_width - 1, VRAM_WIDTH - 1), page_bottom);
+      areas[1] = Common::Rectangle<u32>(cmd->texture_palette_x, cmd->texture_palette_y,
+                                        std::min<u32>(cmd->texture_palette_x + palette_width - 1, VRAM_WIDTH - 1),
+                                        cmd->texture_palette_y);
+      return 2;
+    }
+
+    default:
+      areas[0] = Common::Rectangle<u32>(
+        page_left, page_top, std::min<u32>(page_left + GPU::TEXTURE_PAGE_WIDTH - 1, VRAM_WIDTH - 1), page_bottom);
+      return 1;
+  }
+}
+
+GPU_SW_Backend::VRAMTileMask GPU_SW_Backend::GetDrawReadTiles(const GPUBackendDrawCommand* cmd)
+{
+  if (!cmd->rc.texture_enable || cmd->type == GPUBackendCommandType::DrawLine)
+    return {};
+
+  Common::Rectangle<u32> areas[2];
+  const u32 num_areas = GetTextureReadAreas(cmd, areas);
+
+  VRAMTileMask mask;
+  for (u32 i = 0; i < num_areas; i++)
+    mask |= GetTileMask(areas[i].left, areas[i].top, areas[i].right, areas[i].bottom);
+
+  return mask;
+}
+
+bool GPU_SW_Backend::IsTextureInArea(const GPUBackendDrawCommand* cmd, u32 left, u32 top, u32 right, u32 bottom)
+{
+  Common::Rectangle<u32> areas[2];
+  const u32 num_areas = GetTextureReadAreas(cmd, areas);
+  for (u32 i = 0; i < num_areas; i++)
+  {
+    if (areas[i].left <= right && areas[i].right >= left && areas[i].top <= bottom && areas[i].bottom >= top)
+      return true;
+  }
+
+  return false;
+}
+
+void GPU_SW_Backend::QueueDrawCommand(const GPUBackendDrawCommand* cmd, const Common::Rectangle<u32>& write_area)
+{
+  const VRAMTileMask write_tiles = GetTileMask(write_area.left, write_area.top, write_area.right, write_area.bottom);
+
+  // A primitive which samples from the area it draws to depends on the order its pixels are written in, so it has
+  // to be drawn by a single thread. Same goes for anything too large to fit in the queue.
+  const VRAMTileMask read_tiles = GetDrawReadTiles(cmd);
+  const u32 entry_size = sizeof(u32) + cmd->size;
+  if ((read_tiles & write_tiles).any() || entry_size > RASTER_QUEUE_SIZE)
+  {
+    WaitForRasterizerThreads();
+    DrawCommand(cmd, RasterBand{0, 1}, GetTextureCacheTexels(PrepareTextureCache(cmd, write_area)));
+    return;
+  }
+
+  // Texture reads must see the results of earlier draws (and earlier texture reads must not see later draws), but
+  // the threads drawing those rows could be ahead or behind the thread drawing this primitive.
+  u32 write_ptr = m_raster_queue_write_ptr.load(std::memory_order_relaxed);
+  if ((read_tiles & m_raster_pending_write_tiles).any() || (write_tiles & m_raster_pending_read_tiles).any() ||
+      (write_ptr + entry_size) > RASTER_QUEUE_SIZE)
+  {
+    WaitForRasterizerThreads();
+    write_ptr = 0;
+  }
+
+  const u32 texture_cache_index = PrepareTextureCache(cmd, write_area);
+  if (texture_cache_index != NO_TEXTURE_CACHE_ENTRY)
+    m_texture_cache[texture_cache_index].in_use = true;
+
+  m_raster_pending_write_tiles |= write_tiles;
+  m_raster_pending_read_tiles |= read_tiles;
+
+  // Each draw is preceded by the index of the texture cache entry it samples from.
+  std::memcpy(&m_raster_queue_data[write_ptr], &texture_cache_index, sizeof(texture_cache_index));
+  std::memcpy(&m_raster_queue_data[write_ptr + sizeof(texture_cache_index)], cmd, cmd->size);
+  write_ptr += entry_size;
+  m_raster_queue_write_ptr.store(write_ptr);
+
+  // Sequentially consistent with the threads' sleeping count, see RasterizerThreadLoop().
+  if ((write_ptr - m_raster_queue_wake_ptr) >= RASTER_THRESHOLD_TO_WAKE && m_raster_sleeping_threads.load() > 0)
+  {
+    std::unique_lock<std::mutex> lock(m_raster_mutex);
+    m_raster_wake_cv.notify_all();
+    m_raster_queue_wake_ptr = write_ptr;
+  }
+}
+
+void GPU_SW_Backend::WaitForRasterizerThreads()
+{
+  if (m_raster_queue_write_ptr.load(std::memory_order_relaxed) == 0)
+    return;
+
+  TraceRecorder::ScopedSpan trace_span("WaitForRasterizerThreads");
+  std::unique_lock<std::mutex> lock(m_raster_mutex);
+  m_raster_wake_cv.notify_all();
+
+  const u32 write_ptr = m_raster_queue_write_ptr.load(std::memory_order_relaxed);
+  m_raster_done_cv.wait(lock, [this, write_ptr]() {
+    for (u32 i = 0; i < m_raster_thread_count; i++)
+    {
+      if (m_raster_threads[i].read_ptr.load(std::memory_order_acquire) != write_ptr)
+        return false;
+    }
+    return true;
+  });
+
+  // Everything is idle, so we can start from the beginning of the queue again.
+  for (u32 i = 0; i < m_raster_thread_count; i++)
+    m_raster_threads[i].read_ptr.store(0, std::memory_order_relaxed);
+  m_raster_queue_write_ptr.store(0, std::memory_order_relaxed);
+  m_raster_queue_wake_ptr = 0;
+  m_raster_pending_write_tiles.reset();
+  m_raster_pending_read_tiles.reset();
+  for (TextureCacheEntry& entry : m_texture_cache)
+    entry.in_use = false;
+}
+
+void GPU_SW_Backend::StartRasterizerThreads(u32 count)
+{
+  DebugAssert(m_raster_thread_count == 0 && count <= MAX_RASTERIZER_THREADS);
+  m_raster_queue_write_ptr.store(0);
+  m_raster_queue_wake_ptr = 0;
+  m_raster_pending_write_tiles.reset();
+  m_raster_pending_read_tiles.reset();
+  m_raster_shutdown = false;
+  m_raster_thread_count = count;
+
+  for (u32 i = 0; i < count; i++)
+  {
+    m_raster_threads[i].read_ptr.store(0);
+    m_raster_threads[i].thread = std::thread(&GPU_SW_Backend::RasterizerThreadLoop, this, i);
+  }
+
+  Log_InfoPrintf("Started %u rasterizer threads", count);
+}
+
+void GPU_SW_Backend::StopRasterizerThreads()
+{
+  if (m_raster_thread_count == 0)
+    return;
+
+  WaitForRasterizerThreads();
+
+  {
+    std::unique_lock<std::mutex> lock(m_raster_mutex);
+    m_raster_shutdown = true;
+    m_raster_wake_cv.notify_all();
+  }
+
+  for (u32 i = 0; i < m_raster_thread_count; i++)
+    m_raster_threads[i].thread.join();
+
+  m_raster_thread_count = 0;
+  Log_InfoPrintf("Stopped rasterizer threads");
+}
+
+void GPU_SW_Backend::RasterizerThreadLoop(u32 index)
+{
+  TraceRecorder::SetThreadName(TraceRecorder::InternName(StringUtil::StdStringFromFormat("GPU Rasterizer %u", index)));
+
+  RasterizerThread& thread = m_raster_threads[index];
+  const RasterBand band{index, m_raster_thread_count};
+
+  std::unique_lock<std::mutex> lock(m_raster_mutex);
+  for (;;)
+  {
+    // The pointers are only reset while holding the lock, after every thread has caught up.
+    u32 read_ptr = thread.read_ptr.load(std::memory_order_relaxed);
+    u32 write_ptr = m_raster_queue_write_ptr.load(std::memory_order_acquire);
+    if (read_ptr == write_ptr)
+    {
+      if (m_raster_shutdown)
+        break;
+
+      // Announce that we're going to sleep before checking the queue again, so that either the queueing thread sees
+      // we're asleep and wakes us, or we see its command.
+      m_raster_sleeping_threads.fetch_add(1);
+      if (m_raster_queue_write_ptr.load() == read_ptr)
+      {
+        m_raster_done_cv.notify_all();
+        m_raster_wake_cv.wait(lock);
+      }
+      m_raster_sleeping_threads.fetch_sub(1);
+      continue;
+    }
+
+    lock.unlock();
+
+    {
+      TraceRecorder::ScopedSpan trace_span("RasterizeBand");
+      do
+      {
+        while (read_ptr != write_ptr)
+        {
+          u32 texture_cache_index;
+          std::memcpy(&texture_cache_index, &m_raster_queue_data[read_ptr], sizeof(texture_cache_index));
+          const GPUBackendDrawCommand* cmd =
+            reinterpret_cast<const GPUBackendDrawCommand*>(&m_raster_queue_data[read_ptr + sizeof(u32)]);
+          DrawCommand(cmd, band, GetTextureCacheTexels(texture_cache_index));
+          read_ptr += sizeof(u32) + cmd->size;
+        }
+
+        // Can't be reset from under us, since our read pointer hasn't caught up yet.
+        write_ptr = m_raster_queue_write_ptr.load(std::memory_order_acquire);
+      } while (read_ptr != write_ptr);
+    }
+
+    thread.read_ptr.store(read_ptr, std::memory_order_release);
+    lock.lock();
+  }
+}
+
+u64 GPU_SW_Backend::GetTextureCacheKey(const GPUBackendDrawCommand* cmd)
+{
+  return ZeroExtend64(cmd->texture_page_x) | (ZeroExtend64(cmd->texture_page_y) << 10) |
+         (ZeroExtend64(cmd->texture_palette_x) << 20) | (ZeroExtend64(cmd->texture_palette_y) << 30) |
+         (ZeroExtend64(static_cast<u8>(cmd->texture_mode)) << 40);
+}
+
+u32 GPU_SW_Backend::PrepareTextureCache(const GPUBackendDrawCommand* cmd, const Common::Rectangle<u32>& write_area)
+{
+  // 15-bit textures are a single read either way, so there's nothing to gain from caching them.
+  if (!m_use_texture_cache || !cmd->rc.texture_enable || cmd->type == GPUBackendCommandType::DrawLine ||
+      (cmd->texture_mode != GPU::TextureMode::Palette4Bit && cmd->texture_mode != GPU::TextureMode::Palette8Bit))
+  {
+    return NO_TEXTURE_CACHE_ENTRY;
+  }
+
+  // Primitives which sample from the area they draw to have to see their own writes.
+  if (IsTextureInArea(cmd, write_area.left, write_area.top, write_area.right, write_area.bottom))
+    return NO_TEXTURE_CACHE_ENTRY;
+
+  const u64 key = GetTextureCacheKey(cmd);
+  u32 index = 0;
+  for (u32 i = 0; i < TEXTURE_CACHE_ENTRIES; i++)
+  {
+    if (m_texture_cache[i].key == key)
+    {
+      index = i;
+      break;
+    }
+
+    if (m_texture_cache[i].last_used < m_texture_cache[index].last_used)
+      index = i;
+  }
+
+  // Decoding only pays off when the texture is drawn with more than once, so the first draw just claims an entry and
+  // samples from VRAM. Entries which queued draws are using can't be replaced, and it's not worth waiting for them.
+  TextureCacheEntry& entry = m_texture_cache[index];
+  if (entry.key != key)
+  {
+    if (entry.in_use)
+      return NO_TEXTURE_CACHE_ENTRY;
+
+    Common::Rectangle<u32> areas[2];
+    GetTextureReadAreas(cmd, areas);
+    entry.key = key;
+    entry.last_used = ++m_texture_cache_counter;
+    entry.page_area = areas[0];
+    entry.palette_area = areas[1];
+    entry.valid_blocks.reset();
+    return NO_TEXTURE_CACHE_ENTRY;
+  }
+  entry.last_used = ++m_texture_cache_counter;
+
+  // Work out which texels the primitive can sample. Interpolated texture coordinates never leave the range of the
+  // vertices' coordinates, but rectangles wrap around, and the texture window can map coordinates anywhere.
+  u32 min_u, max_u, min_v, max_v;
+  if (cmd->type == GPUBackendCommandType::DrawPolygon)
+  {
+    const GPUBackendDrawPolygonCommand* pcmd = static_cast<const GPUBackendDrawPolygonCommand*>(cmd);
+    min_u = max_u = pcmd->vertices[0].texcoord_x;
+    min_v = max_v = pcmd->vertices[0].texcoord_y;
+    for (u32 i = 1; i < pcmd->num_vertices; i++)
+    {
+      min_u = std::min<u32>(min_u, pcmd->vertices[i].texcoord_x);
+      max_u = std::max<u32>(max_u, pcmd->vertices[i].texcoord_x);
+      min_v = std::min<u32>(min_v, pcmd->vertices[i].texcoord_y);
+      max_v = std::max<u32>(max_v, pcmd->vertices[i].texcoord_y);
+    }
+  }
+  else
+  {
+    const GPUBackendDrawRectangleCommand* rcmd = static_cast<const GPUBackendDrawRectangleCommand*>(cmd);
+    min_u = rcmd->texcoord_x;
+    max_u = min_u + ZeroExtend32(rcmd->width) - 1;
+    min_v = rcmd->texcoord_y;
+    max_v = min_v + ZeroExtend32(rcmd->height) - 1;
+  }
+
+  if (max_u >= GPU::TEXTURE_PAGE_WIDTH || cmd->texture_window_and_x != 0xFF || cmd->texture_window_or_x != 0)
+  {
+    min_u = 0;
+    max_u = GPU::TEXTURE_PAGE_WIDTH - 1;
+  }
+  if (max_v >= GPU::TEXTURE_PAGE_HEIGHT || cmd->texture_window_and_y != 0xFF || cmd->texture_window_or_y != 0)
+  {
+    min_v = 0;
+    max_v = GPU::TEXTURE_PAGE_HEIGHT - 1;
+  }
+
+  for (u32 v = min_v; v <= max_v; v++)
+  {
+    for (u32 block_x = min_u / TEXTURE_CACHE_BLOCK_WIDTH; block_x <= max_u / TEXTURE_CACHE_BLOCK_WIDTH; block_x++)
+    {
+      if (!entry.valid_blocks.test(v * TEXTURE_CACHE_BLOCKS_X + block_x))
+        DecodeTextureCacheBlock(entry, cmd, block_x, v);
+    }
+  }
+
+  return index;
+}
+
+void GPU_SW_Backend::DecodeTextureCacheBlock(TextureCacheEntry& entry, const GPUBackendDrawCommand* cmd, u32 block_x,
+                                             u32 v)
+{
+  u16* dst = &entry.texels[v * GPU::TEXTURE_PAGE_WIDTH + block_x * TEXTURE_CACHE_BLOCK_WIDTH];
+  for (u32 i = 0; i < TEXTURE_CACHE_BLOCK_WIDTH; i++)
+    dst[i] = GetTexel(cmd, block_x * TEXTURE_CACHE_BLOCK_WIDTH + i, v);
+
+  entry.valid_blocks.set(v * TEXTURE_CACHE_BLOCKS_X + block_x);
+}
+
+void GPU_SW_Backend::InvalidateTextureCache()
+{
+  for (TextureCacheEntry& entry : m_texture_cache)
+  {
+    entry.key = INVALID_TEXTURE_CACHE_KEY;
+    entry.last_used = 0;
+    entry.valid_blocks.reset();
+  }
+}
+
+void GPU_SW_Backend::InvalidateTextureCache(const Common::Rectangle<u32>& area)
+{
+  for (TextureCacheEntry& entry : m_texture_cache)
+  {
+    if (entry.key == INVALID_TEXTURE_CACHE_KEY)
+      continue;
+
+    // A new palette changes every texel, but a write to the page only affects the rows it covers.
+    if (AreasOverlap(entry.palette_area, area))
+    {
+      entry.valid_blocks.reset();
+    }
+    else if (AreasOverlap(entry.page_area, area))
+    {
+      const u32 first_row = std::max(area.top, entry.page_area.top) - entry.page_area.top;
+      const u32 last_row = std::min(area.bottom, entry.page_area.bottom) - entry.page_area.top;
+      for (u32 v = first_row; v <= last_row; v++)
+      {
+        for (u32 block_x = 0; block_x < TEXTURE_CACHE_BLOCKS_X; block_x++)
+          entry.valid_blocks.reset(v * TEXTURE_CACHE_BLOCKS_X + block_x);
+      }
+    }
+  }
+}
+
+void GPU_SW_Backend::InvalidateTextureCache(u32 x, u32 y, u32 width, u32 height)
+{
+  if (width == 0 || height == 0)
+    return;
+
+  // Transfers wrap around, in which case just assume the whole row/column is written.
+  const bool wrap_x = (x + width) > VRAM_WIDTH;
+  const bool wrap_y = (y + height) > VRAM_HEIGHT;
+  InvalidateTextureCache(Common::Rectangle<u32>(wrap_x ? 0 : x, wrap_y ? 0 : y,
+                                                wrap_x ? (VRAM_WIDTH - 1) : (x + width - 1),
+                                                wrap_y ? (VRAM_HEIGHT - 1) : (y + height - 1)));
+}
+
+const u16* GPU_SW_Backend::GetTextureCacheTexels(u32 index) const
+{
+  return (index != NO_TEXTURE_CACHE_ENTRY) ? m_texture_cache[index].texels.data() : nullptr;
+}
+
+void GPU_SW_Backend::FillVRAM(u32 x, u32 y, u32 width, u32 height, u32 color, GPUBackendCommandParameters params)
+{
+  const u16 color16 = GPU::RGBA8888ToRGBA5551(color);
+  if ((x + width) <= VRAM_WIDTH && !params.interlaced_rendering)
+  {
+    for (u32 yoffs = 0; yoffs < height; yoffs++)
+    {
+      const u32 row = (y + yoffs) % VRAM_HEIGHT;
+      std::fill_n(&m_vram[row * VRAM_WIDTH + x], width, color16);
+    }
+  }
+  else if (params.interlaced_rendering)
+  {
+    // Hardware tests show that fills seem to break on the first two lines when the offset matches the displayed field.
+    const u32 active_field = params.active_line_lsb;
+    for (u32 yoffs = 0; yoffs < height; yoffs++)
+    {
+      const u32 row = (y + yoffs) % VRAM_HEIGHT;
+      if ((row & u32(1)) == active_field)
+        continue;
+
+      u16* row_ptr = &m_vram[row * VRAM_WIDTH];
+      for (u32 xoffs = 0; xoffs < width; xoffs++)
+      {
+        const u32 col = (x + xoffs) % VRAM_WIDTH;
+        row_ptr[col] = color16;
+      }
+    }
+  }
+  else
+  {
+    for (u32 yoffs = 0; yoffs < height; yoffs++)
+    {
+      const u32 row = (y + yoffs) % VRAM_HEIGHT;
+      u16* row_ptr = &m_vram[row * VRAM_WIDTH];
+      for (u32 xoffs = 0; xoffs < width; xoffs++)
+      {
+        const u32 col = (x + xoffs) % VRAM_WIDTH;
+        row_ptr[col] = color16;
+      }
+    }
+  }
+}
+
+void GPU_SW_Backend::UpdateVRAM(u32 x, u32 y, u32 width, u32 height, const void* data,
+                                GPUBackendCommandParameters params)
+{
+  // Fast path when the copy is not oversized.
+  if ((x + width) <= VRAM_WIDTH && (y + height) <= VRAM_HEIGHT && !params.set_mask_while_drawing &&
+      !params.check_mask_before_draw)
+  {
+    const u16* src_ptr = static_cast<const u16*>(data);
+    u16* dst_ptr = &m_vram[y * VRAM_WIDTH + x];
+    for (u32 yoffs = 0; yoffs < height; yoffs++)
+    {
+      std::copy_n(src_ptr, width, dst_ptr);
+      src_ptr += width;
+      dst_ptr += VRAM_WIDTH;
+    }
+  }
+  else
+  {
+    // Slow path when we need to handle wrap-around.
+    const u16* src_ptr = static_cast<const u16*>(data);
+    const u16 mask_and = params.GetMaskAND();
+    const u16 mask_or = params.GetMaskOR();
+
+    for (u32 row = 0; row < height;)
+    {
+      u16* dst_row_ptr = &m_vram[((y + row++) % VRAM_HEIGHT) * VRAM_WIDTH];
+      for (u32 col = 0; col < width;)
+      {
+        // TODO: Handle unaligned reads...
+        u16* pixel_ptr = &dst_row_ptr[(x + col++) % VRAM_WIDTH];
+        if (((*pixel_ptr) & mask_and) == 0)
+          *pixel_ptr = *(src_ptr++) | mask_or;
+      }
+    }
+  }
+}
+
+void GPU_SW_Backend::CopyVRAM(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 width, u32 height,
+                              GPUBackendCommandParameters params)
+{
+  // Break up oversized copies. This behavior has not been verified on console.
+  if ((src_x + width) > VRAM_WIDTH || (dst_x + width) > VRAM_WIDTH)
+  {
+    u32 remaining_rows = height;
+    u32 current_src_y = src_y;
+    u32 current_dst_y = dst_y;
+    while (remaining_rows > 0)
+    {
+      const u32 rows_to_copy =
+        std::min<u32>(remaining_rows, std::min<u32>(VRAM_HEIGHT - current_src_y, VRAM_HEIGHT - current_dst_y));
+
+      u32 remaining_columns = width;
+      u32 current_src_x = src_x;
+      u32 current_dst_x = dst_x;
+      while (remaining_columns > 0)
+      {
+        const u32 columns_to_copy =
+          std::min<u32>(remaining_columns, std::min<u32>(VRAM_WIDTH - current_src_x, VRAM_WIDTH - current_dst_x));
+        CopyVRAM(current_src_x, current_src_y, current_dst_x, current_dst_y, columns_to_copy, rows_to_copy, params);
+        current_src_x = (current_src_x + columns_to_copy) % VRAM_WIDTH;
+        current_dst_x = (current_dst_x + columns_to_copy) % VRAM_WIDTH;
+        remaining_columns -= columns_to_copy;
+      }
+
+      current_src_y = (current_src_y + rows_to_copy) % VRAM_HEIGHT;
+      current_dst_y = (current_dst_y + rows_to_copy) % VRAM_HEIGHT;
+      remaining_rows -= rows_to_copy;
+    }
+
+    return;
+  }
+
+  // This doesn't have a fast path, but do we really need one? It's not common.
+  const u16 mask_and = params.GetMaskAND();
+  const u16 mask_or = params.GetMaskOR();
+
+  // Copy in reverse when src_x < dst_x, this is verified on console.
+  if (src_x < dst_x || ((src_x + width - 1) % VRAM_WIDTH) < ((dst_x + width - 1) % VRAM_WIDTH))
+  {
+    for (u32 row = 0; row < height; row++)
+    {
+      const u16* src_row_ptr = &m_vram[((src_y + row) % VRAM_HEIGHT) * VRAM_WIDTH];
+      u16* dst_row_ptr = &m_vram[((dst_y + row) % VRAM_HEIGHT) * VRAM_WIDTH];
+
+      for (s32 col = static_cast<s32>(width - 1); col >= 0; col--)
+      {
+        const u16 src_pixel = src_row_ptr[(src_x + static_cast<u32>(col)) % VRAM_WIDTH];
+        u16* dst_pixel_ptr = &dst_row_ptr[(dst_x + static_cast<u32>(col)) % VRAM_WIDTH];
+        if ((*dst_pixel_ptr & mask_and) == 0)
+          *dst_pixel_ptr = src_pixel | mask_or;
+      }
+    }
+  }
+  else
+  {
+    for (u32 row = 0; row < height; row++)
+    {
+      const u16* src_row_ptr = &m_vram[((src_y + row) % VRAM_HEIGHT) * VRAM_WIDTH];
+      u16* dst_row_ptr = &m_vram[((dst_y + row) % VRAM_HEIGHT) * VRAM_WIDTH];
+
+      for (u32 col = 0; col < width; col++)
+      {
+        const u16 src_pixel = src_row_ptr[(src_x + col) % VRAM_WIDTH];
+        u16* dst_pixel_ptr = &dst_row_ptr[(dst_x + col) % VRAM_WIDTH];
+        if ((*dst_pixel_ptr & mask_and) == 0)
+          *dst_pixel_ptr = src_pixel | mask_or;
+      }
+    }
+  }
+}
+
+void GPU_SW_Backend::MarkRowsWritten(u32 y, u32 height)
+{
+  // Only equality is checked, so it doesn't matter if the version wraps around.
+  const u32 version = ++m_vram_version;
+  for (u32 row = 0; row < std::min<u32>(height, VRAM_HEIGHT); row++)
+    m_vram_row_versions[(y + row) % VRAM_HEIGHT] = version;
+}
+
+void GPU_SW_Backend::DrawCommand(const GPUBackendDrawCommand* cmd, RasterBand band, const u16* texture)
+{
+  switch (cmd->type)
+  {
+    case GPUBackendCommandType::DrawPolygon:
+      HandleDrawPolygonCommand(static_cast<const GPUBackendDrawPolygonCommand*>(cmd), band, texture);
+      break;
+
+    case GPUBackendCommandType::DrawRectangle:
+      HandleDrawRectangleCommand(static_cast<const GPUBackendDrawRectangleCommand*>(cmd), band, texture);
+      break;
+
+    case GPUBackendCommandType::DrawLine:
+      HandleDrawLineCommand(static_cast<const GPUBackendDrawLineCommand*>(cmd), band);
+      break;
+
+    default:
+      UnreachableCode();
+      break;
+  }
+}
+
+void GPU_SW_Backend::HandleDrawPolygonCommand(const GPUBackendDrawPolygonCommand* cmd, RasterBand band,
+                                              const u16* texture)
+{
+  const GPU::RenderCommand rc{cmd->rc.bits};
+  const DrawTriangleFunction DrawFunction = GetDrawTriangleFunction(
+    rc.shading_enable, rc.texture_enable, rc.raw_texture_enable, rc.transparency_enable, cmd->dithering_enable);
+
+  (this->*DrawFunction)(cmd, band, texture, &cmd->vertices[0], &cmd->vertices[1], &cmd->vertices[2]);
+  if (cmd->num_vertices > 3)
+    (this->*DrawFunction)(cmd, band, texture, &cmd->vertices[2], &cmd->vertices[1], &cmd->vertices[3]);
+}
+
+void GPU_SW_Backend::HandleDrawRectangleCommand(const GPUBackendDrawRectangleCommand* cmd, RasterBand band,
+                                                const u16* texture)
+{
+  const GPU::RenderCommand rc{cmd->rc.bits};
+  const DrawRectangleFunction DrawFunction =
+    GetDrawRectangleFunction(rc.texture_enable, rc.raw_texture_enable, rc.transparency_enable);
+
+  (this->*DrawFunction)(cmd, band, texture);
+}
+
+void GPU_SW_Backend::HandleDrawLineCommand(const GPUBackendDrawLineCommand* cmd, RasterBand band)
+{
+  const GPU::RenderCommand rc{cmd->rc.bits};
+  const DrawLineFunction DrawFunction =
+    GetDrawLineFunction(rc.shading_enable, rc.transparency_enable, cmd->dithering_enable);
+
+  const SWVertex* vertices = cmd->GetVertices();
+  for (u32 i = 1; i < cmd->num_vertices; i++)
+    (this->*DrawFunction)(cmd, band, &vertices[i - 1], &vertices[i]);
+}
+
+enum : u32
+{
+  COORD_FRAC_BITS = 32,
+  COLOR_FRAC_BITS = 12
+};
+
+using FixedPointCoord = u64;
+
+constexpr FixedPointCoord IntToFixedCoord(s32 x)
+{
+  return (ZeroExtend64(static_cast<u32>(x)) << COORD_FRAC_BITS) | (ZeroExtend64(1u) << (COORD_FRAC_BITS - 1));
+}
+
+using FixedPointColor = u32;
+
+constexpr FixedPointColor IntToFixedColor(u8 r)
+{
+  return ZeroExtend32(r) << COLOR_FRAC_BITS | (1u << (COLOR_FRAC_BITS - 1));
+}
+
+constexpr u8 FixedColorToInt(FixedPointColor r)
+{
+  return Truncate8(r >> 12);
+}
+
+bool GPU_SW_Backend::IsClockwiseWinding(const SWVertex* v0, const SWVertex* v1, const SWVertex* v2)
+{
+  const s32 abx = v1->x - v0->x;
+  const s32 aby = v1->y - v0->y;
+  const s32 acx = v2->x - v0->x;
+  const s32 acy = v2->y - v0->y;
+  return ((abx * acy) - (aby * acx) < 0);
+}
+
+static constexpr bool IsTopLeftEdge(s32 ex, s32 ey)
+{
+  return (ey < 0 || (ey == 0 && ex < 0));
+}
+
+static constexpr s64 FloorDivide(s64 numerator, s64 denominator)
+{
+  const s64 quotient = numerator / denominator;
+  return ((numerator % denominator) != 0 && ((numerator < 0) != (denominator < 0))) ? (quotient - 1) : quotient;
+}
+
+static constexpr u8 Interpolate(u8 v0, u8 v1, u8 v2, s32 w0, s32 w1, s32 w2, s32 ws, s32 half_ws)
+{
+  const s32 v = w0 * static_cast<s32>(static_cast<u32>(v0)) + w1 * static_cast<s32>(static_cast<u32>(v1)) +
+                w2 * static_cast<s32>(static_cast<u32>(v2));
+  const s32 vd = (v + half_ws) / ws;
+  return (vd < 0) ? 0 : ((vd > 0xFF) ? 0xFF : static_cast<u8>(vd));
+}
+
+/// Tracks floor(numerator / divisor) for a numerator which changes by a constant amount, without dividing each step.
+struct SteppedDivision
+{
+  s32 quotient = 0;
+  s32 remainder = 0;
+  s32 quotient_step = 0;
+  s32 remainder_step = 0;
+  s32 divisor = 1;
+
+  void SetStep(s64 step, s32 divisor_)
+  {
+    divisor = divisor_;
+    quotient_step = static_cast<s32>(FloorDivide(step, divisor));
+    remainder_step = static_cast<s32>(step - static_cast<s64>(quotient_step) * divisor);
+  }
+
+  void SetValue(s64 numerator)
+  {
+    const s64 q = FloorDivide(numerator, divisor);
+    quotient = static_cast<s32>(q);
+    remainder = static_cast<s32>(numerator - q * divisor);
+  }
+
+  ALWAYS_INLINE void Step()
+  {
+    quotient += quotient_step;
+    remainder += remainder_step;
+    if (remainder >= divisor)
+    {
+      remainder -= divisor;
+      quotient++;
+    }
+  }
+};
+
+/// Finds the pixels on each row where an edge function, e + a * (x - min_x), is non-negative. The edge function
+/// changes by b each row, so the boundary can be stepped rather than solved for.
+struct TriangleEdge
+{
+  SteppedDivision boundary;
+  s32 value;
+  s32 value_step;
+  s32 a;
+
+  void Init(s32 e, s32 a_, s32 b)
+  {
+    a = a_;
+    value = e;
+    value_step = b;
+    if (a != 0)
+    {
+      boundary.SetStep(b, std::abs(a));
+      boundary.SetValue(e);
+    }
+  }
+
+  /// Narrows [start, end] (relative to min_x) to the pixels inside the edge on the current row.
+  ALWAYS_INLINE void Clip(s32& start, s32& end) const
+  {
+    if (a > 0)
+      start = std::max(start, -boundary.quotient); // e + a * dx >= 0 -> dx >= ceil(-e / a)
+    else if (a < 0)
+      end = std::min(end, boundary.quotient); // e - |a| * dx >= 0 -> dx <= floor(e / |a|)
+    else if (value < 0)
+      end = -1;
+  }
+
+  ALWAYS_INLINE void Step()
+  {
+    if (a != 0)
+      boundary.Step();
+    else
+      value += value_step;
+  }
+};
+
+/// Interpolates a vertex attribute across a row, the same as rounding (w0 * v0 + w1 * v1 + w2 * v2 + half_ws) / ws.
+/// Inside the triangle the barycentric weights are non-negative and sum to ws, so the result is always 0..255.
+struct TriangleAttribute
+{
+  SteppedDivision value;
+  s32 numerator_step_x;
+
+  void Init(u8 v0, u8 v1, u8 v2, s32 a12, s32 a20, s32 a01, s32 ws)
+  {
+    numerator_step_x = a12 * static_cast<s32>(v0) + a20 * static_cast<s32>(v1) + a01 * static_cast<s32>(v2);
+    value.SetStep(numerator_step_x, ws);
+  }
+
+  ALWAYS_INLINE void SetStart(u8 v0, u8 v1, u8 v2, s32 w0, s32 w1, s32 w2, s32 half_ws)
+  {
+    value.SetValue(static_cast<s64>(w0) * v0 + static_cast<s64>(w1) * v1 + static_cast<s64>(w2) * v2 + half_ws);
+  }
+
+  ALWAYS_INLINE u8 Get() const { return static_cast<u8>(value.quotient); }
+  ALWAYS_INLINE void Step() { value.Step(); }
+};
+
+#if defined(CPU_X64)
+
+/// Steps a TriangleAttribute across spans. The quotient is only kept to 16 bits, which is exact for covered pixels.
+struct SpanAttribute
+{
+  __m128i quotient;
+  __m128i remainder_lo;
+  __m128i remainder_hi;
+  __m128i quotient_step;
+  __m128i remainder_step;
+  __m128i divisor;
+  __m128i divisor_minus_one;
+
+  void Init(const TriangleAttribute& attr)
+  {
+    const s32 ws = attr.value.divisor;
+    const s64 span_numerator_step = static_cast<s64>(attr.numerator_step_x) * GPU_SW_Backend::SPAN_WIDTH;
+    const s64 span_quotient_step = FloorDivide(span_numerator_step, ws);
+    quotient_step = _mm_set1_epi16(static_cast<s16>(span_quotient_step));
+    remainder_step = _mm_set1_epi32(static_cast<s32>(span_numerator_step - span_quotient_step * ws));
+    divisor = _mm_set1_epi32(ws);
+    divisor_minus_one = _mm_set1_epi32(ws - 1);
+  }
+
+  /// Fills the lanes by stepping the attribute, which must be positioned at the start of the span.
+  void SetStart(TriangleAttribute attr)
+  {
+    alignas(16) s16 quotients[GPU_SW_Backend::SPAN_WIDTH];
+    alignas(16) s32 remainders[GPU_SW_Backend::SPAN_WIDTH];
+    for (u32 i = 0; i < GPU_SW_Backend::SPAN_WIDTH; i++)
+    {
+      quotients[i] = static_cast<s16>(attr.value.quotient);
+      remainders[i] = attr.value.remainder;
+      attr.Step();
+    }
+
+    quotient = _mm_load_si128(reinterpret_cast<const __m128i*>(quotients));
+    remainder_lo = _mm_load_si128(reinterpret_cast<const __m128i*>(&remainders[0]));
+    remainder_hi = _mm_load_si128(reinterpret_cast<const __m128i*>(&remainders[4]));
+  }
+
+  ALWAYS_INLINE void Step()
+  {
+    remainder_lo = _mm_add_epi32(remainder_lo, remainder_step);
+    remainder_hi = _mm_add_epi32(remainder_hi, remainder_step);
+    const __m128i carry_lo = _mm_cmpgt_epi32(remainder_lo, divisor_minus_one);
+    const __m128i carry_hi = _mm_cmpgt_epi32(remainder_hi, divisor_minus_one);
+    remainder_lo = _mm_sub_epi32(remainder_lo, _mm_and_si128(carry_lo, divisor));
+    remainder_hi = _mm_sub_epi32(remainder_hi, _mm_and_si128(carry_hi, divisor));
+
+    // carry is -1 where the remainder overflowed
+    quotient = _mm_sub_epi16(_mm_add_epi16(quotient, quotient_step), _mm_packs_epi32(carry_lo, carry_hi));
+  }
+};
+
+#endif
+
+template<bool shading_enable, bool texture_enable, bool raw_texture_enable, bool transparency_enable,
+         bool dithering_enable>
+void GPU_SW_Backend::DrawTriangle(const GPUBackendDrawPolygonCommand* cmd, RasterBand band, const u16* texture,
+                                  const SWVertex* v0, const SWVertex* v1, const SWVertex* v2)
+{
+#define orient2d(ax, ay, bx, by, cx, cy) ((bx - ax) * (cy - ay) - (by - ay) * (cx - ax))
+
+  // ensure the vertices follow a counter-clockwise order
+  if (IsClockwiseWinding(v0, v1, v2))
+    std::swap(v1, v2);
+
+  const s32 px0 = v0->x;
+  const s32 py0 = v0->y;
+  const s32 px1 = v1->x;
+  const s32 py1 = v1->y;
+  const s32 px2 = v2->x;
+  const s32 py2 = v2->y;
+
+  // Barycentric coordinates at minX/minY corner
+  const s32 ws = orient2d(px0, py0, px1, py1, px2, py2);
+  const s32 half_ws = std::max<s32>((ws / 2) - 1, 0);
+  if (ws == 0)
+    return;
+
+  // compute bounding box of triangle
+  s32 min_x = std::min(px0, std::min(px1, px2));
+  s32 max_x = std::max(px0, std::max(px1, px2));
+  s32 min_y = std::min(py0, std::min(py1, py2));
+  s32 max_y = std::max(py0, std::max(py1, py2));
+
+  // reject triangles which cover the whole vram area
+  if (static_cast<u32>(max_x - min_x) > GPU::MAX_PRIMITIVE_WIDTH ||
+      static_cast<u32>(max_y - min_y) > GPU::MAX_PRIMITIVE_HEIGHT)
+  {
+    return;
+  }
+
+  // clip to drawing area
+  min_x = std::clamp(min_x, static_cast<s32>(m_drawing_area.left), static_cast<s32>(m_drawing_area.right));
+  max_x = std::clamp(max_x, static_cast<s32>(m_drawing_area.left), static_cast<s32>(m_drawing_area.right));
+  min_y = std::clamp(min_y, static_cast<s32>(m_drawing_area.top), static_cast<s32>(m_drawing_area.bottom));
+  max_y = std::clamp(max_y, static_cast<s32>(m_drawing_area.top), static_cast<s32>(m_drawing_area.bottom));
+
+  // compute per-pixel increments
+  const s32 a01 = py0 - py1, b01 = px1 - px0;
+  const s32 a12 = py1 - py2, b12 = px2 - px1;
+  const s32 a20 = py2 - py0, b20 = px0 - px2;
+
+  // top-left edge rule
+  const s32 w0_bias = 0 - s32(IsTopLeftEdge(b12, a12));
+  const s32 w1_bias = 0 - s32(IsTopLeftEdge(b20, a20));
+  const s32 w2_bias = 0 - s32(IsTopLeftEdge(b01, a01));
+
+  // compute base barycentric coordinates
+  s32 w0 = orient2d(px1, py1, px2, py2, min_x, min_y);
+  s32 w1 = orient2d(px2, py2, px0, py0, min_x, min_y);
+  s32 w2 = orient2d(px0, py0, px1, py1, min_x, min_y);
+
+  if (!m_use_edge_walking)
+  {
+    // Test every pixel in the bounding box and interpolate each one separately, as a reference for the edge walk.
+    for (s32 y = min_y; y <= max_y; y++, w0 += b12, w1 += b20, w2 += b01)
+    {
+      if (!band.ContainsRow(static_cast<u32>(y)))
+        continue;
+
+      s32 row_w0 = w0;
+      s32 row_w1 = w1;
+      s32 row_w2 = w2;
+      for (s32 x = min_x; x <= max_x; x++, row_w0 += a12, row_w1 += a20, row_w2 += a01)
+      {
+        if (((row_w0 + w0_bias) | (row_w1 + w1_bias) | (row_w2 + w2_bias)) < 0)
+          continue;
+
+        const u8 r = shading_enable ?
+                       Interpolate(v0->color_r, v1->color_r, v2->color_r, row_w0, row_w1, row_w2, ws, half_ws) :
+                       v0->color_r;
+        const u8 g = shading_enable ?
+                       Interpolate(v0->color_g, v1->color_g, v2->color_g, row_w0, row_w1, row_w2, ws, half_ws) :
+                       v0->color_g;
+        const u8 b = shading_enable ?
+                       Interpolate(v0->color_b, v1->color_b, v2->color_b, row_w0, row_w1, row_w2, ws, half_ws) :
+                       v0->color_b;
+        const u8 texcoord_x =
+          Interpolate(v0->texcoord_x, v1->texcoord_x, v2->texcoord_x, row_w0, row_w1, row_w2, ws, half_ws);
+        const u8 texcoord_y =
+          Interpolate(v0->texcoord_y, v1->texcoord_y, v2->texcoord_y, row_w0, row_w1, row_w2, ws, half_ws);
+
+        ShadePixel<texture_enable, raw_texture_enable, transparency_enable, dithering_enable>(
+          cmd, texture, static_cast<u32>(x), static_cast<u32>(y), r, g, b, texcoord_x, texcoord_y);
+      }
+    }
+
+    return;
+  }
+
+  // Rather than testing every pixel in the bounding box, walk the edges to find the covered span on each row. A pixel
+  // is covered when all of the biased edge functions are non-negative, so this gives exactly the same coverage.
+  TriangleEdge edge0, edge1, edge2;
+  edge0.Init(w0 + w0_bias, a12, b12);
+  edge1.Init(w1 + w1_bias, a20, b20);
+  edge2.Init(w2 + w2_bias, a01, b01);
+
+  TriangleAttribute attr_r, attr_g, attr_b, attr_u, attr_v;
+  if constexpr (shading_enable)
+  {
+    attr_r.Init(v0->color_r, v1->color_r, v2->color_r, a12, a20, a01, ws);
+    attr_g.Init(v0->color_g, v1->color_g, v2->color_g, a12, a20, a01, ws);
+    attr_b.Init(v0->color_b, v1->color_b, v2->color_b, a12, a20, a01, ws);
+  }
+  if constexpr (texture_enable)
+  {
+    attr_u.Init(v0->texcoord_x, v1->texcoord_x, v2->texcoord_x, a12, a20, a01, ws);
+    attr_v.Init(v0->texcoord_y, v1->texcoord_y, v2->texcoord_y, a12, a20, a01, ws);
+  }
+
+#if defined(CPU_X64)
+  // Primitives which sample from the area they draw to depend on the order pixels are written in.
+  const bool use_vector_shading =
+    m_use_vector_shading &&
+    (!texture_enable || !IsTextureInArea(cmd, static_cast<u32>(min_x), static_cast<u32>(min_y),
+                                         static_cast<u32>(max_x) + (SPAN_WIDTH - 1), static_cast<u32>(max_y)));
+
+  const __m128i lane_index = _mm_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7);
+  SpanAttribute span_r, span_g, span_b, span_u, span_v;
+  if constexpr (shading_enable)
+  {
+    span_r.Init(attr_r);
+    span_g.Init(attr_g);
+    span_b.Init(attr_b);
+  }
+  if constexpr (texture_enable)
+  {
+    span_u.Init(attr_u);
+    span_v.Init(attr_v);
+  }
+#endif
+
+  for (s32 y = min_y; y <= max_y;
+       y++, w0 += b12, w1 += b20, w2 += b01, edge0.Step(), edge1.Step(), edge2.Step())
+  {
+    if (!band.ContainsRow(static_cast<u32>(y)))
+      continue;
+
+    s32 start_dx = 0;
+    s32 end_dx = max_x - min_x;
+    edge0.Clip(start_dx, end_dx);
+    edge1.Clip(start_dx, end_dx);
+    edge2.Clip(start_dx, end_dx);
+    if (start_dx > end_dx)
+      continue;
+
+    const s32 start_x = min_x + start_dx;
+    const s32 end_x = min_x + end_dx;
+
+    // barycentric coordinates at the first covered pixel
+    const s32 sw0 = w0 + a12 * start_dx;
+    const s32 sw1 = w1 + a20 * start_dx;
+    const s32 sw2 = w2 + a01 * start_dx;
+    if constexpr (shading_enable)
+    {
+      attr_r.SetStart(v0->color_r, v1->color_r, v2->color_r, sw0, sw1, sw2, half_ws);
+      attr_g.SetStart(v0->color_g, v1->color_g, v2->color_g, sw0, sw1, sw2, half_ws);
+      attr_b.SetStart(v0->color_b, v1->color_b, v2->color_b, sw0, sw1, sw2, half_ws);
+    }
+    if constexpr (texture_enable)
+    {
+      attr_u.SetStart(v0->texcoord_x, v1->texcoord_x, v2->texcoord_x, sw0, sw1, sw2, half_ws);
+      attr_v.SetStart(v0->texcoord_y, v1->texcoord_y, v2->texcoord_y, sw0, sw1, sw2, half_ws);
+    }
+
+#if defined(CPU_X64)
+    if (use_vector_shading)
+    {
+      if constexpr (shading_enable)
+      {
+        span_r.SetStart(attr_r);
+        span_g.SetStart(attr_g);
+        span_b.SetStart(attr_b);
+      }
+      if constexpr (texture_enable)
+      {
+        span_u.SetStart(attr_u);
+        span_v.SetStart(attr_v);
+      }
+
+      for (s32 x = start_x; x <= end_x; x += SPAN_WIDTH)
+      {
+        const __m128i mask = _mm_cmplt_epi16(lane_index, _mm_set1_epi16(static_cast<s16>(end_x - x + 1)));
+        ShadeSpan<texture_enable, raw_texture_enable, transparency_enable, dithering_enable>(
+          cmd, texture, static_cast<u32>(x), static_cast<u32>(y), mask,
+          shading_enable ? span_r.quotient : _mm_set1_epi16(v0->color_r),
+          shading_enable ? span_g.quotient : _mm_set1_epi16(v0->color_g),
+          shading_enable ? span_b.quotient : _mm_set1_epi16(v0->color_b),
+          texture_enable ? span_u.quotient : _mm_setzero_si128(),
+          texture_enable ? span_v.quotient : _mm_setzero_si128());
+
+        if constexpr (shading_enable)
+        {
+          span_r.Step();
+          span_g.Step();
+          span_b.Step();
+        }
+        if constexpr (texture_enable)
+        {
+          span_u.Step();
+          span_v.Step();
+        }
+      }
+
+      continue;
+    }
+#endif
+
+    for (s32 x = start_x; x <= end_x; x++)
+    {
+      ShadePixel<texture_enable, raw_texture_enable, transparency_enable, dithering_enable>(
+        cmd, texture, static_cast<u32>(x), static_cast<u32>(y), shading_enable ? attr_r.Get() : v0->color_r,
+        shading_enable ? attr_g.Get() : v0->color_g, shading_enable ? attr_b.Get() : v0->color_b,
+        texture_enable ? attr_u.Get() : 0, texture_enable ? attr_v.Get() : 0);
+
+      if constexpr (shading_enable)
+      {
+        attr_r.Step();
+        attr_g.Step();
+        attr_b.Step();
+      }
+      if constexpr (texture_enable)
+      {
+        attr_u.Step();
+        attr_v.Step();
+      }
+    }
+  }
+
+#undef orient2d
+}
+
+GPU_SW_Backend::DrawTriangleFunction GPU_SW_Backend::GetDrawTriangleFunction(bool shading_enable, bool texture_enable,
+                                                                             bool raw_texture_enable,
+                                                                             bool transparency_enable,
+                                                                             bool dithering_enable)
+{
+#define F(SHADING, TEXTURE, RAW_TEXTURE, TRANSPARENCY, DITHERING)                                                      \
+  &GPU_SW_Backend::DrawTriangle<SHADING, TEXTURE, RAW_TEXTURE, TRANSPARENCY, DITHERING>
+
+  static constexpr DrawTriangleFunction funcs[2][2][2][2][2] = {
+    {{{{F(false, false, false, false, false), F(false, false, false, false, true)},
+       {F(false, false, false, true, false), F(false, false, false, true, true)}},
+      {{F(false, false, true, false, false), F(false, false, true, false, true)},
+       {F(false, false, true, true, false), F(false, false, true, true, true)}}},
+     {{{F(false, true, false, false, false), F(false, true, false, false, true)},
+       {F(false, true, false, true, false), F(false, true, false, true, true)}},
+      {{F(false, true, true, false, false), F(false, true, true, false, true)},
+       {F(false, true, true, true, false), F(false, true, true, true, true)}}}},
+    {{{{F(true, false, false, false, false), F(true, false, false, false, true)},
+       {F(true, false, false, true, false), F(true, false, false, true, true)}},
+      {{F(true, false, true, false, false), F(true, false, true, false, true)},
+       {F(true, false, true, true, false), F(true, false, true, true, true)}}},
+     {{{F(true, true, false, false, false), F(true, true, false, false, true)},
+       {F(true, true, false, true, false), F(true, true, false, true, true)}},
+      {{F(true, true, true, false, false), F(true, true, true, false, true)},
+       {F(true, true, true, true, false), F(true, true, true, true, true)}}}}};
+
+#undef F
+
+  return funcs[u8(shading_enable)][u8(texture_enable)][u8(raw_texture_enable)][u8(transparency_enable)]
+              [u8(dithering_enable)];
+}
+
+template<bool texture_enable, bool raw_texture_enable, bool transparency_enable>
+void GPU_SW_Backend::DrawRectangle(const GPUBackendDrawRectangleCommand* cmd, RasterBand band, const u16* texture)
+{
+  const s32 start_x = cmd->x;
+  const s32 start_y = cmd->y;
+  const u32 width = ZeroExtend32(cmd->width);
+  const u32 height = ZeroExtend32(cmd->height);
+
+#if defined(CPU_X64)
+  const s32 left = std::max(start_x, static_cast<s32>(m_drawing_area.left));
+  const s32 right = std::min(start_x + static_cast<s32>(width) - 1, static_cast<s32>(m_drawing_area.right));
+  const s32 top = std::max(start_y, static_cast<s32>(m_drawing_area.top));
+  const s32 bottom = std::min(start_y + static_cast<s32>(height) - 1, static_cast<s32>(m_drawing_area.bottom));
+  if (left > right || top > bottom)
+    return;
+
+  if (m_use_vector_shading &&
+      (!texture_enable || !IsTextureInArea(cmd, static_cast<u32>(left), static_cast<u32>(top),
+                                           static_cast<u32>(right) + (SPAN_WIDTH - 1), static_cast<u32>(bottom))))
+  {
+    const __m128i lane_index = _mm_setr_epi16(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m128i color_r = _mm_set1_epi16(cmd->color_r);
+    const __m128i color_g = _mm_set1_epi16(cmd->color_g);
+    const __m128i color_b = _mm_set1_epi16(cmd->color_b);
+
+    for (s32 y = top; y <= bottom; y++)
+    {
+      if (!band.ContainsRow(static_cast<u32>(y)))
+        continue;
+
+      const __m128i texcoord_y =
+        _mm_set1_epi16(Truncate8(ZeroExtend32(cmd->texcoord_y) + static_cast<u32>(y - start_y)));
+      for (s32 x = left; x <= right; x += SPAN_WIDTH)
+      {
+        const __m128i mask = _mm_cmplt_epi16(lane_index, _mm_set1_epi16(static_cast<s16>(right - x + 1)));
+        const __m128i texcoord_x = _mm_and_si128(
+          _mm_add_epi16(_mm_set1_epi16(static_cast<s16>(ZeroExtend32(cmd->texcoord_x) + static_cast<u32>(x - start_x))),
+                        lane_index),
+          _mm_set1_epi16(0xFF));
+
+        ShadeSpan<texture_enable, raw_texture_enable, transparency_enable, false>(
+          cmd, texture, static_cast<u32>(x), static_cast<u32>(y), mask, color_r, color_g, color_b, texcoord_x,
+          texcoord_y);
+      }
+    }
+
+    return;
+  }
+#endif
+
+  for (u32 offset_y = 0; offset_y < height; offset_y++)
+  {
+    const s32 y = start_y + static_cast<s32>(offset_y);
+    if (y < static_cast<s32>(m_drawing_area.top) || y > static_cast<s32>(m_drawing_area.bottom) ||
+        !band.ContainsRow(static_cast<u32>(y)))
+    {
+      continue;
+    }
+
+    const u8 texcoord_y = Truncate8(ZeroExtend32(cmd->texcoord_y) + offset_y);
+
+    for (u32 offset_x = 0; offset_x < width; offset_x++)
+    {
+      const s32 x = start_x + static_cast<s32>(offset_x);
+      if (x < static_cast<s32>(m_drawing_area.left) || x > static_cast<s32>(m_drawing_area.right))
+        continue;
+
+      const u8 texcoord_x = Truncate8(ZeroExtend32(cmd->texcoord_x) + offset_x);
+
+      ShadePixel<texture_enable, raw_texture_enable, transparency_enable, false>(
+        cmd, texture, static_cast<u32>(x), static_cast<u32>(y), cmd->color_r, cmd->color_g, cmd->color_b,
+        texcoord_x, texcoord_y);
+    }
+  }
+}
+
+constexpr GPU_SW_Backend::DitherLUT GPU_SW_Backend::ComputeDitherLUT()
+{
+  DitherLUT lut = {};
+  for (u32 i = 0; i < GPU::DITHER_MATRIX_SIZE; i++)
+  {
+    for (u32 j = 0; j < GPU::DITHER_MATRIX_SIZE; j++)
+    {
+      for (s32 value = 0; value < DITHER_LUT_SIZE; value++)
+      {
+        const s32 dithered_value = (value + GPU::DITHER_MATRIX[i][j]) >> 3;
+        lut[i][j][value] = static_cast<u8>((dithered_value < 0) ? 0 : ((dithered_value > 31) ? 31 : dithered_value));
+      }
+    }
+  }
+  return lut;
+}
+
+static constexpr GPU_SW_Backend::DitherLUT s_dither_lut = GPU_SW_Backend::ComputeDitherLUT();
+
+u16 GPU_SW_Backend::GetTexel(const GPUBackendDrawCommand* cmd, u32 texcoord_x, u32 texcoord_y) const
+{
+  switch (cmd->texture_mode)
+  {
+    case GPU::TextureMode::Palette4Bit:
+    {
+      const u16 palette_value = GetPixel(std::min<u32>(cmd->texture_page_x + (texcoord_x / 4), VRAM_WIDTH - 1),
+                                         std::min<u32>(cmd->texture_page_y + texcoord_y, VRAM_HEIGHT - 1));
+      const u16 palette_index = (palette_value >> ((texcoord_x % 4) * 4)) & 0x0Fu;
+      return GetPixel(std::min<u32>(cmd->texture_palette_x + ZeroExtend32(palette_index), VRAM_WIDTH - 1),
+                      cmd->texture_palette_y);
+    }
+
+    case GPU::TextureMode::Palette8Bit:
+    {
+      const u16 palette_value = GetPixel(std::min<u32>(cmd->texture_page_x + (texcoord_x / 2), VRAM_WIDTH - 1),
+                                         std::min<u32>(cmd->texture_page_y + texcoord_y, VRAM_HEIGHT - 1));
+      const u16 palette_index = (palette_value >> ((texcoord_x % 2) * 8)) & 0xFFu;
+      return GetPixel(std::min<u32>(cmd->texture_palette_x + ZeroExtend32(palette_index), VRAM_WIDTH - 1),
+                      cmd->texture_palette_y);
+    }
+
+    default:
+      return GetPixel(std::min<u32>(cmd->texture_page_x + texcoord_x, VRAM_WIDTH - 1),
+                      std::min<u32>(cmd->texture_page_y + texcoord_y, VRAM_HEIGHT - 1));
+  }
+}
+
+template<bool texture_enable, bool raw_texture_enable, bool transparency_enable, bool dithering_enable>
+void GPU_SW_Backend::ShadePixel(const GPUBackendDrawCommand* cmd, const u16* texture, u32 x, u32 y, u8 color_r,
+                                u8 color_g, u8 color_b, u8 texcoord_x, u8 texcoord_y)
+{
+  VRAMPixel color;
+  bool transparent;
+  if constexpr (texture_enable)
+  {
+    // Apply texture window
+    texcoord_x = (texcoord_x & cmd->texture_window_and_x) | cmd->texture_window_or_x;
+    texcoord_y = (texcoord_y & cmd->texture_window_and_y) | cmd->texture_window_or_y;
+
+    VRAMPixel texture_color;
+    texture_color.bits =
+      texture ? texture[ZeroExtend32(texcoord_y) * GPU::TEXTURE_PAGE_WIDTH + ZeroExtend32(texcoord_x)] :
+                GetTexel(cmd, texcoord_x, texcoord_y);
+
+    if (texture_color.bits == 0)
+      return;
+
+    transparent = texture_color.c;
+
+    if constexpr (raw_texture_enable)
+    {
+      color.bits = texture_color.bits;
+    }
+    else
+    {
+      const u32 dither_y = (dithering_enable) ? (y & 3u) : 2u;
+      const u32 dither_x = (dithering_enable) ? (x & 3u) : 3u;
+
+      color.bits = (ZeroExtend16(s_dither_lut[dither_y][dither_x][(u16(texture_color.r) * u16(color_r)) >> 4]) << 0) |
+                   (ZeroExtend16(s_dither_lut[dither_y][dither_x][(u16(texture_color.g) * u16(color_g)) >> 4]) << 5) |
+                   (ZeroExtend16(s_dither_lut[dither_y][dither_x][(u16(texture_color.b) * u16(color_b)) >> 4]) << 10) |
+                   (texture_color.bits & 0x8000u);
+    }
+  }
+  else
+  {
+    transparent = true;
+
+    const u32 dither_y = (dithering_enable) ? (y & 3u) : 2u;
+    const u32 dither_x = (dithering_enable) ? (x & 3u) : 3u;
+
+    color.bits = (ZeroExtend16(s_dither_lut[dither_y][dither_x][color_r]) << 0) |
+                 (ZeroExtend16(s_dither_lut[dither_y][dither_x][color_g]) << 5) |
+                 (ZeroExtend16(s_dither_lut[dither_y][dither_x][color_b]) << 10);
+  }
+
+  const VRAMPixel bg_color{GetPixel(static_cast<u32>(x), static_cast<u32>(y))};
+  if constexpr (transparency_enable)
+  {
+    if (transparent)
+    {
+#define BLEND_AVERAGE(bg, fg) Truncate8(std::min<u32>((ZeroExtend32(bg) / 2) + (ZeroExtend32(fg) / 2), 0x1F))
+#define BLEND_ADD(bg, fg) Truncate8(std::min<u32>(ZeroExtend32(bg) + ZeroExtend32(fg), 0x1F))
+#define BLEND_SUBTRACT(bg, fg) Truncate8((bg > fg) ? ((bg) - (fg)) : 0)
+#define BLEND_QUARTER(bg, fg) Truncate8(std::min<u32>(ZeroExtend32(bg) + ZeroExtend32(fg / 4), 0x1F))
+
+#define BLEND_RGB(func)                                                                                                \
+  color.Set(func(bg_color.r.GetValue(), color.r.GetValue()), func(bg_color.g.GetValue(), color.g.GetValue()),          \
+            func(bg_color.b.GetValue(), color.b.GetValue()), color.c.GetValue())
+
+      switch (cmd->transparency_mode)
+      {
+        case GPU::TransparencyMode::HalfBackgroundPlusHalfForeground:
+          BLEND_RGB(BLEND_AVERAGE);
+          break;
+        case GPU::TransparencyMode::BackgroundPlusForeground:
+          BLEND_RGB(BLEND_ADD);
+          break;
+        case GPU::TransparencyMode::BackgroundMinusForeground:
+          BLEND_RGB(BLEND_SUBTRACT);
+          break;
+        case GPU::TransparencyMode::BackgroundPlusQuarterForeground:
+          BLEND_RGB(BLEND_QUARTER);
+          break;
+        default:
+          break;
+      }
+
+#undef BLEND_RGB
+
+#undef BLEND_QUARTER
+#undef BLEND_SUBTRACT
+#undef BLEND_ADD
+#undef BLEND_AVERAGE
+    }
+  }
+  else
+  {
+    UNREFERENCED_VARIABLE(transparent);
+  }
+
+  const u16 mask_and = cmd->params.GetMaskAND();
+  if ((bg_color.bits & mask_and) != 0)
+    return;
+
+  if (cmd->params.interlaced_rendering && cmd->params.active_line_lsb == (static_cast<u32>(y) & 1u))
+    return;
+
+  SetPixel(static_cast<u32>(x), static_cast<u32>(y), color.bits | cmd->params.GetMaskOR());
+}
+
+#if defined(CPU_X64)
+
+/// Dither offsets for 8 consecutive pixels, indexed by row and the column of the first pixel (both modulo 4).
+struct SpanDitherTable
+{
+  alignas(16) s16 offsets[GPU::DITHER_MATRIX_SIZE][GPU::DITHER_MATRIX_SIZE][GPU_SW_Backend::SPAN_WIDTH];
+};
+
+static constexpr SpanDitherTable ComputeSpanDitherTable()
+{
+  SpanDitherTable table = {};
+  for (u32 y = 0; y < GPU::DITHER_MATRIX_SIZE; y++)
+  {
+    for (u32 x = 0; x < GPU::DITHER_MATRIX_SIZE; x++)
+    {
+      for (u32 i = 0; i < GPU_SW_Backend::SPAN_WIDTH; i++)
+        table.offsets[y][x][i] = static_cast<s16>(GPU::DITHER_MATRIX[y][(x + i) % GPU::DITHER_MATRIX_SIZE]);
+    }
+  }
+  return table;
+}
+
+static constexpr SpanDitherTable s_span_dither_table = ComputeSpanDitherTable();
+
+/// Same as indexing s_dither_lut with an offset from the dither matrix, for values below DITHER_LUT_SIZE.
+ALWAYS_INLINE static __m128i DitherSpanComponent(__m128i value, __m128i dither_offsets)
+{
+  const __m128i dithered = _mm_srai_epi16(_mm_add_epi16(value, dither_offsets), 3);
+  return _mm_min_epi16(_mm_max_epi16(dithered, _mm_setzero_si128()), _mm_set1_epi16(0x1F));
+}
+
+template<bool texture_enable, bool raw_texture_enable, bool transparency_enable, bool dithering_enable>
+void GPU_SW_Backend::ShadeSpan(const GPUBackendDrawCommand* cmd, const u16* texture, u32 x, u32 y, __m128i mask,
+                               __m128i color_r, __m128i color_g, __m128i color_b, __m128i texcoord_x,
+                               __m128i texcoord_y)
+{
+  if (cmd->params.interlaced_rendering && cmd->params.active_line_lsb == (y & 1u))
+    return;
+
+  // Spans which would run off the end of the row are rare enough to not be worth a partial load/store path.
+  if ((x + SPAN_WIDTH) > VRAM_WIDTH)
+  {
+    alignas(16) u16 mask_values[SPAN_WIDTH], r_values[SPAN_WIDTH], g_values[SPAN_WIDTH], b_values[SPAN_WIDTH],
+      u_values[SPAN_WIDTH], v_values[SPAN_WIDTH];
+    _mm_store_si128(reinterpret_cast<__m128i*>(mask_values), mask);
+    _mm_store_si128(reinterpret_cast<__m128i*>(r_values), color_r);
+    _mm_store_si128(reinterpret_cast<__m128i*>(g_values), color_g);
+    _mm_store_si128(reinterpret_cast<__m128i*>(b_values), color_b);
+    _mm_store_si128(reinterpret_cast<__m128i*>(u_values), texcoord_x);
+    _mm_store_si128(reinterpret_cast<__m128i*>(v_values), texcoord_y);
+    for (u32 i = 0; i < SPAN_WIDTH && (x + i) < VRAM_WIDTH; i++)
+    {
+      if (mask_values[i] != 0)
+      {
+        ShadePixel<texture_enable, raw_texture_enable, transparency_enable, dithering_enable>(
+          cmd, texture, x + i, y, Truncate8(r_values[i]), Truncate8(g_values[i]), Truncate8(b_values[i]),
+          Truncate8(u_values[i]), Truncate8(v_values[i]));
+      }
+    }
+
+    return;
+  }
+
+  const __m128i dither_offsets =
+    dithering_enable ?
+      _mm_load_si128(reinterpret_cast<const __m128i*>(s_span_dither_table.offsets[y & 3u][x & 3u])) :
+      _mm_set1_epi16(static_cast<s16>(GPU::DITHER_MATRIX[2][3]));
+  const __m128i component_mask = _mm_set1_epi16(0x1F);
+
+  __m128i color;
+  __m128i transparent;
+  if constexpr (texture_enable)
+  {
+    // Apply texture window
+    texcoord_x = _mm_or_si128(_mm_and_si128(texcoord_x, _mm_set1_epi16(cmd->texture_window_and_x)),
+                              _mm_set1_epi16(cmd->texture_window_or_x));
+    texcoord_y = _mm_or_si128(_mm_and_si128(texcoord_y, _mm_set1_epi16(cmd->texture_window_and_y)),
+                              _mm_set1_epi16(cmd->texture_window_or_y));
+
+    // No gathers in SSE2, so fetch the texels for the lanes which are drawn one by one.
+    alignas(16) u16 u_values[SPAN_WIDTH], v_values[SPAN_WIDTH], texels[SPAN_WIDTH];
+    _mm_store_si128(reinterpret_cast<__m128i*>(u_values), texcoord_x);
+    _mm_store_si128(reinterpret_cast<__m128i*>(v_values), texcoord_y);
+    const u32 lane_bits = static_cast<u32>(_mm_movemask_epi8(mask));
+    for (u32 i = 0; i < SPAN_WIDTH; i++)
+    {
+      if (!(lane_bits & (1u << (i * 2))))
+      {
+        texels[i] = 0;
+        continue;
+      }
+
+      texels[i] = texture ? texture[ZeroExtend32(v_values[i]) * GPU::TEXTURE_PAGE_WIDTH + u_values[i]] :
+                            GetTexel(cmd, u_values[i], v_values[i]);
+    }
+
+    // Fully transparent texels aren't drawn.
+    const __m128i texture_color = _mm_load_si128(reinterpret_cast<const __m128i*>(texels));
+    mask = _mm_andnot_si128(_mm_cmpeq_epi16(texture_color, _mm_setzero_si128()), mask);
+    transparent = _mm_srai_epi16(texture_color, 15);
+
+    if constexpr (raw_texture_enable)
+    {
+      color = texture_color;
+    }
+    else
+    {
+      const __m128i texture_r = _mm_and_si128(texture_color, component_mask);
+      const __m128i texture_g = _mm_and_si128(_mm_srli_epi16(texture_color, 5), component_mask);
+      const __m128i texture_b = _mm_and_si128(_mm_srli_epi16(texture_color, 10), component_mask);
+      const __m128i r = DitherSpanComponent(_mm_srli_epi16(_mm_mullo_epi16(texture_r, color_r), 4), dither_offsets);
+      const __m128i g = DitherSpanComponent(_mm_srli_epi16(_mm_mullo_epi16(texture_g, color_g), 4), dither_offsets);
+      const __m128i b = DitherSpanComponent(_mm_srli_epi16(_mm_mullo_epi16(texture_b, color_b), 4), dither_offsets);
+      color = _mm_or_si128(_mm_or_si128(r, _mm_slli_epi16(g, 5)),
+                           _mm_or_si128(_mm_slli_epi16(b, 10), _mm_and_si128(texture_color, _mm_set1_epi16(-0x8000))));
+    }
+  }
+  else
+  {
+    transparent = _mm_set1_epi16(-1);
+
+    const __m128i r = DitherSpanComponent(color_r, dither_offsets);
+    const __m128i g = DitherSpanComponent(color_g, dither_offsets);
+    const __m128i b = DitherSpanComponent(color_b, dither_offsets);
+    color = _mm_or_si128(r, _mm_or_si128(_mm_slli_epi16(g, 5), _mm_slli_epi16(b, 10)));
+  }
+
+  u16* const vram_ptr = GetPixelPtr(x, y);
+  const __m128i bg_color = _mm_loadu_si128(reinterpret_cast<const __m128i*>(vram_ptr));
+  if constexpr (transparency_enable)
+  {
+    const __m128i bg_r = _mm_and_si128(bg_color, component_mask);
+    const __m128i bg_g = _mm_and_si128(_mm_srli_epi16(bg_color, 5), component_mask);
+    const __m128i bg_b = _mm_and_si128(_mm_srli_epi16(bg_color, 10), component_mask);
+    const __m128i fg_r = _mm_and_si128(color, component_mask);
+    const __m128i fg_g = _mm_and_si128(_mm_srli_epi16(color, 5), component_mask);
+    const __m128i fg_b = _mm_and_si128(_mm_srli_epi16(color, 10), component_mask);
+
+    __m128i r, g, b;
+    switch (cmd->transparency_mode)
+    {
+      case GPU::TransparencyMode::HalfBackgroundPlusHalfForeground:
+        r = _mm_min_epi16(_mm_add_epi16(_mm_srli_epi16(bg_r, 1), _mm_srli_epi16(fg_r, 1)), component_mask);
+        g = _mm_min_epi16(_mm_add_epi16(_mm_srli_epi16(bg_g, 1), _mm_srli_epi16(fg_g, 1)), component_mask);
+        b = _mm_min_epi16(_mm_add_epi16(_mm_srli_epi16(bg_b, 1), _mm_srli_epi16(fg_b, 1)), component_mask);
+        break;
+      case GPU::TransparencyMode::BackgroundPlusForeground:
+        r = _mm_min_epi16(_mm_add_epi16(bg_r, fg_r), component_mask);
+        g = _mm_min_epi16(_mm_add_epi16(bg_g, fg_g), component_mask);
+        b = _mm_min_epi16(_mm_add_epi16(bg_b, fg_b), component_mask);
+        break;
+      case GPU::TransparencyMode::BackgroundMinusForeground:
+        r = _mm_max_epi16(_mm_sub_epi16(bg_r, fg_r), _mm_setzero_si128());
+        g = _mm_max_epi16(_mm_sub_epi16(bg_g, fg_g), _mm_setzero_si128());
+        b = _mm_max_epi16(_mm_sub_epi16(bg_b, fg_b), _mm_setzero_si128());
+        break;
+      case GPU::TransparencyMode::BackgroundPlusQuarterForeground:
+      default:
+        r = _mm_min_epi16(_mm_add_epi16(bg_r, _mm_srli_epi16(fg_r, 2)), component_mask);
+        g = _mm_min_epi16(_mm_add_epi16(bg_g, _mm_srli_epi16(fg_g, 2)), component_mask);
+        b = _mm_min_epi16(_mm_add_epi16(bg_b, _mm_srli_epi16(fg_b, 2)), component_mask);
+        break;
+    }
+
+    const __m128i blended =
+      _mm_or_si128(_mm_or_si128(r, _mm_slli_epi16(g, 5)),
+                   _mm_or_si128(_mm_slli_epi16(b, 10), _mm_and_si128(color, _mm_set1_epi16(-0x8000))));
+    color = _mm_or_si128(_mm_and_si128(transparent, blended), _mm_andnot_si128(transparent, color));
+  }
+  else
+  {
+    UNREFERENCED_VARIABLE(transparent);
+  }
+
+  // Pixels with the mask bit set are left alone when checking is enabled.
+  const __m128i mask_and = _mm_set1_epi16(static_cast<s16>(cmd->params.GetMaskAND()));
+  mask = _mm_and_si128(mask, _mm_cmpeq_epi16(_mm_and_si128(bg_color, mask_and), _mm_setzero_si128()));
+
+  color = _mm_or_si128(color, _mm_set1_epi16(static_cast<s16>(cmd->params.GetMaskOR())));
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(vram_ptr),
+                   _mm_or_si128(_mm_and_si128(mask, color), _mm_andnot_si128(mask, bg_color)));
+}
+
+#endif
+
+constexpr FixedPointCoord GetLineCoordStep(s32 delta, s32 k)
+{
+  s64 delta_fp = static_cast<s64>(ZeroExtend64(static_cast<u32>(delta)) << 32);
+  if (delta_fp < 0)
+    delta_fp -= s64(k - 1);
+  if (delta_fp > 0)
+    delta_fp += s64(k - 1);
+
+  return static_cast<FixedPointCoord>(delta_fp / k);
+}
+
+constexpr s32 FixedToIntCoord(FixedPointCoord x)
+{
+  return static_cast<s32>(Truncate32(x >> COORD_FRAC_BITS));
+}
+
+constexpr FixedPointColor GetLineColorStep(s32 delta, s32 k)
+{
+  return static_cast<s32>(static_cast<u32>(delta) << COLOR_FRAC_BITS) / k;
+}
+
+template<bool shading_enable, bool transparency_enable, bool dithering_enable>
+void GPU_SW_Backend::DrawLine(const GPUBackendDrawLineCommand* cmd, RasterBand band, const SWVertex* p0,
+                              const SWVertex* p1)
+{
+  // Algorithm based on Mednafen.
+  if (p0->x > p1->x)
+    std::swap(p0, p1);
+
+  const s32 dx = p1->x - p0->x;
+  const s32 dy = p1->y - p0->y;
+  const s32 k = std::max(std::abs(dx), std::abs(dy));
+
+  FixedPointCoord step_x, step_y;
+  FixedPointColor step_r, step_g, step_b;
+  if (k > 0)
+  {
+    step_x = GetLineCoordStep(dx, k);
+    step_y = GetLineCoordStep(dy, k);
+
+    if constexpr (shading_enable)
+    {
+      step_r = GetLineColorStep(s32(ZeroExtend32(p1->color_r)) - s32(ZeroExtend32(p0->color_r)), k);
+      step_g = GetLineColorStep(s32(ZeroExtend32(p1->color_g)) - s32(ZeroExtend32(p0->color_g)), k);
+      step_b = GetLineColorStep(s32(ZeroExtend32(p1->color_b)) - s32(ZeroExtend32(p0->color_b)), k);
+    }
+    else
+    {
+      step_r = 0;
+      step_g = 0;
+      step_b = 0;
+    }
+  }
+  else
+  {
+    step_x = 0;
+    step_y = 0;
+    step_r = 0;
+    step_g = 0;
+    step_b = 0;
+  }
+
+  FixedPointCoord current_x = IntToFixedCoord(p0->x);
+  FixedPointCoord current_y = IntToFixedCoord(p0->y);
+  FixedPointColor current_r = IntToFixedColor(p0->color_r);
+  FixedPointColor current_g = IntToFixedColor(p0->color_g);
+  FixedPointColor current_b = IntToFixedColor(p0->color_b);
+
+  for (s32 i = 0; i <= k; i++)
+  {
+    // The drawing offset has already been applied to the vertices, which is equivalent to adding it here since the
+    // step does not depend on the starting position.
+    const s32 x = FixedToIntCoord(current_x);
+    const s32 y = FixedToIntCoord(current_y);
+
+    const u8 r = shading_enable ? FixedColorToInt(current_r) : p0->color_r;
+    const u8 g = shading_enable ? FixedColorToInt(current_g) : p0->color_g;
+    const u8 b = shading_enable ? FixedColorToInt(current_b) : p0->color_b;
+
+    if (x >= static_cast<s32>(m_drawing_area.left) && x <= static_cast<s32>(m_drawing_area.right) &&
+        y >= static_cast<s32>(m_drawing_area.top) && y <= static_cast<s32>(m_drawing_area.bottom) &&
+        band.ContainsRow(static_cast<u32>(y)))
+    {
+      ShadePixel<false, false, transparency_enable, dithering_enable>(cmd, nullptr, static_cast<u32>(x),
+                                                                      static_cast<u32>(y), r, g, b, 0, 0);
+    }
+
+    current_x += step_x;
+    current_y += step_y;
+
+    if constexpr (shading_enable)
+    {
+      current_r += step_r;
+      current_g += step_g;
+      current_b += step_b;
+    }
+  }
+}
+
+GPU_SW_Backend::DrawLineFunction GPU_SW_Backend::GetDrawLineFunction(bool shading_enable, bool transparency_enable,
+                                                                     bool dithering_enable)
+{
+#define F(SHADING, TRANSPARENCY, DITHERING) &GPU_SW_Backend::DrawLine<SHADING, TRANSPARENCY, DITHERING>
+
+  static constexpr DrawLineFunction funcs[2][2][2] = {
+    {{F(false, false, false), F(false, false, true)}, {F(false, true, false), F(false, true, true)}},
+    {{F(true, false, false), F(true, false, true)}, {F(true, true, false), F(true, true, true)}}};
+
+#undef F
+
+  return funcs[u8(shading_enable)][u8(transparency_enable)][u8(dithering_enable)];
+}
+
+GPU_SW_Backend::DrawRectangleFunction GPU_SW_Backend::GetDrawRectangleFunction(bool texture_enable,
+                                                                               bool raw_texture_enable,
+                                                                               bool transparency_enable)
+{
+#define F(TEXTURE, RAW_TEXTURE, TRANSPARENCY) &GPU_SW_Backend::DrawRectangle<TEXTURE, RAW_TEXTURE, TRANSPARENCY>
+
+  static constexpr DrawRectangleFunction funcs[2][2][2] = {
+    {{F(false, false, false), F(false, false, true)}, {F(false, true, false), F(false, true, true)}},
+    {{F(true, false, false), F(true, false, true)}, {F(true, true, false), F(true, true, true)}}};
+
+#undef F
+
+  return funcs[u8(texture_enable)][u8(raw_texture_enable)][u8(transparency_enable)];
+}
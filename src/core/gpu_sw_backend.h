@@ -0,0 +1,242 @@
+#pragma once
+#include "common/cpu_detect.h"
+#include "gpu.h"
+#include "gpu_backend.h"
+#include <array>
+#include <atomic>
+#include <bitset>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#if defined(CPU_X64)
+#include <emmintrin.h>
+#endif
+
+/// Software rasterizer. Owns VRAM, which must only be accessed from the CPU thread after a Sync().
+class GPU_SW_Backend final : public GPUBackend
+{
+public:
+  GPU_SW_Backend();
+  ~GPU_SW_Backend() override;
+
+  void Reset() override;
+
+  static constexpr u32 MAX_RASTERIZER_THREADS = 16;
+
+  /// Number of pixels shaded at once by the vector path.
+  static constexpr u32 SPAN_WIDTH = 8;
+
+  /// Returns the number of rasterizer threads to use when the count is left on automatic.
+  static u32 GetDefaultRasterizerThreadCount();
+
+  /// Sets the number of threads which draw primitives in parallel. 0 picks a count for the host, 1 draws inline.
+  void SetRasterizerThreadCount(u32 count);
+  u32 GetRasterizerThreadCount() const { return std::max<u32>(m_raster_thread_count, 1); }
+
+  /// Shades spans of pixels with SIMD where supported. Only useful to turn off for checking the output against the
+  /// scalar path, and must only be changed after a Sync().
+  void SetUseVectorShading(bool enable) { m_use_vector_shading = enable; }
+
+  /// Finds the pixels covered by triangles by walking their edges, rather than testing every pixel in the bounding
+  /// box. Only useful to turn off for checking the output against the original rasterizer, and must only be changed
+  /// after a Sync().
+  void SetUseEdgeWalking(bool enable) { m_use_edge_walking = enable; }
+
+  /// Samples palette textures from a cache of decoded texels rather than looking up the palette for every pixel.
+  /// Must only be changed after a Sync().
+  void SetUseTextureCache(bool enable);
+
+  /// Discards all decoded textures. Must be called after VRAM is modified directly, e.g. by loading a save state.
+  void InvalidateTextureCache();
+
+  /// Every row of VRAM gets a new version number when something writes to it, so the CPU thread can tell which rows
+  /// changed between frames. Must only be read after a Sync().
+  const u32* GetVRAMRowVersions() const { return m_vram_row_versions.data(); }
+
+  u16* GetVRAM() { return m_vram.data(); }
+  const u16* GetVRAM() const { return m_vram.data(); }
+
+  u16 GetPixel(u32 x, u32 y) const { return m_vram[GPU::VRAM_WIDTH * y + x]; }
+  const u16* GetPixelPtr(u32 x, u32 y) const { return &m_vram[GPU::VRAM_WIDTH * y + x]; }
+  u16* GetPixelPtr(u32 x, u32 y) { return &m_vram[GPU::VRAM_WIDTH * y + x]; }
+  void SetPixel(u32 x, u32 y, u16 value) { m_vram[GPU::VRAM_WIDTH * y + x] = value; }
+
+  // this is actually (31 * 255) >> 4) == 494, but to simplify addressing we use the next power of two (512)
+  static constexpr u32 DITHER_LUT_SIZE = 512;
+  using DitherLUT =
+    std::array<std::array<std::array<u8, 512>, GPU::DITHER_MATRIX_SIZE>, GPU::DITHER_MATRIX_SIZE>;
+  static constexpr DitherLUT ComputeDitherLUT();
+
+protected:
+  using SWVertex = GPUBackendVertex;
+  using VRAMPixel = GPU::VRAMPixel;
+
+  enum : u32
+  {
+    RASTER_BAND_HEIGHT = 8,
+    RASTER_QUEUE_SIZE = 1024 * 1024,
+    RASTER_THRESHOLD_TO_WAKE = 512,
+    VRAM_TILE_SIZE = 64,
+    VRAM_TILES_X = GPU::VRAM_WIDTH / VRAM_TILE_SIZE,
+    VRAM_TILES_Y = GPU::VRAM_HEIGHT / VRAM_TILE_SIZE,
+    TEXTURE_CACHE_ENTRIES = 16,
+    TEXTURE_CACHE_BLOCK_WIDTH = 32,
+    TEXTURE_CACHE_BLOCKS_X = GPU::TEXTURE_PAGE_WIDTH / TEXTURE_CACHE_BLOCK_WIDTH,
+    NO_TEXTURE_CACHE_ENTRY = 0xFFFFFFFFu
+  };
+
+  /// Rows drawn by one rasterizer thread. VRAM is split into horizontal bands, which are interleaved between threads,
+  /// so each pixel is only ever written by one thread and draw order is preserved per pixel.
+  struct RasterBand
+  {
+    u32 index;
+    u32 count;
+
+    ALWAYS_INLINE bool ContainsRow(u32 y) const { return (count == 1 || ((y / RASTER_BAND_HEIGHT) % count) == index); }
+  };
+
+  /// One bit per 64x64 block of VRAM, used to find primitives which sample from areas other threads are drawing to.
+  using VRAMTileMask = std::bitset<VRAM_TILES_X * VRAM_TILES_Y>;
+
+  struct RasterizerThread
+  {
+    std::thread thread;
+    std::atomic<u32> read_ptr{0};
+  };
+
+  static constexpr u64 INVALID_TEXTURE_CACHE_KEY = ~static_cast<u64>(0);
+
+  /// A texture page decoded through a palette, as 256x256 16-bit texels. Texels are decoded in blocks of 32x1 as
+  /// draws need them, since most draws only sample a small part of the page.
+  struct TextureCacheEntry
+  {
+    u64 key = INVALID_TEXTURE_CACHE_KEY;
+    u32 last_used = 0;
+    bool in_use = false; // referenced by draws still in the rasterizer queue
+    Common::Rectangle<u32> page_area;
+    Common::Rectangle<u32> palette_area;
+    std::bitset<GPU::TEXTURE_PAGE_HEIGHT * TEXTURE_CACHE_BLOCKS_X> valid_blocks;
+    HeapArray<u16, GPU::TEXTURE_PAGE_WIDTH * GPU::TEXTURE_PAGE_HEIGHT> texels;
+  };
+
+  void HandleCommand(const GPUBackendCommand* cmd) override;
+  void FlushRender() override;
+
+  //////////////////////////////////////////////////////////////////////////
+  // Rasterizer threads
+  //////////////////////////////////////////////////////////////////////////
+  static VRAMTileMask GetTileMask(u32 left, u32 top, u32 right, u32 bottom);
+  bool GetDrawWriteArea(const GPUBackendDrawCommand* cmd, Common::Rectangle<u32>* area) const;
+  static VRAMTileMask GetDrawReadTiles(const GPUBackendDrawCommand* cmd);
+  static u32 GetTextureReadAreas(const GPUBackendDrawCommand* cmd, Common::Rectangle<u32> areas[2]);
+  static bool IsTextureInArea(const GPUBackendDrawCommand* cmd, u32 left, u32 top, u32 right, u32 bottom);
+
+  void QueueDrawCommand(const GPUBackendDrawCommand* cmd, const Common::Rectangle<u32>& write_area);
+  void WaitForRasterizerThreads();
+  void StartRasterizerThreads(u32 count);
+  void StopRasterizerThreads();
+  void RasterizerThreadLoop(u32 index);
+
+  //////////////////////////////////////////////////////////////////////////
+  // Texture cache
+  //////////////////////////////////////////////////////////////////////////
+  static u64 GetTextureCacheKey(const GPUBackendDrawCommand* cmd);
+
+  /// Decodes the parts of the texture the draw samples from, and returns the cache entry, or NO_TEXTURE_CACHE_ENTRY if
+  /// the draw has to sample from VRAM.
+  u32 PrepareTextureCache(const GPUBackendDrawCommand* cmd, const Common::Rectangle<u32>& write_area);
+  void DecodeTextureCacheBlock(TextureCacheEntry& entry, const GPUBackendDrawCommand* cmd, u32 block_x, u32 v);
+  void InvalidateTextureCache(const Common::Rectangle<u32>& area);
+  void InvalidateTextureCache(u32 x, u32 y, u32 width, u32 height);
+  const u16* GetTextureCacheTexels(u32 index) const;
+
+  //////////////////////////////////////////////////////////////////////////
+  // Transfers
+  //////////////////////////////////////////////////////////////////////////
+  void FillVRAM(u32 x, u32 y, u32 width, u32 height, u32 color, GPUBackendCommandParameters params);
+  void UpdateVRAM(u32 x, u32 y, u32 width, u32 height, const void* data, GPUBackendCommandParameters params);
+  void CopyVRAM(u32 src_x, u32 src_y, u32 dst_x, u32 dst_y, u32 width, u32 height,
+                GPUBackendCommandParameters params);
+  void MarkRowsWritten(u32 y, u32 height);
+
+  //////////////////////////////////////////////////////////////////////////
+  // Rasterization
+  //////////////////////////////////////////////////////////////////////////
+  /// texture is the decoded texture from the cache, or null to sample from VRAM.
+  void DrawCommand(const GPUBackendDrawCommand* cmd, RasterBand band, const u16* texture);
+  void HandleDrawPolygonCommand(const GPUBackendDrawPolygonCommand* cmd, RasterBand band, const u16* texture);
+  void HandleDrawRectangleCommand(const GPUBackendDrawRectangleCommand* cmd, RasterBand band, const u16* texture);
+  void HandleDrawLineCommand(const GPUBackendDrawLineCommand* cmd, RasterBand band);
+
+  static bool IsClockwiseWinding(const SWVertex* v0, const SWVertex* v1, const SWVertex* v2);
+
+  /// Reads a texel from VRAM, looking it up in the palette if needed.
+  u16 GetTexel(const GPUBackendDrawCommand* cmd, u32 texcoord_x, u32 texcoord_y) const;
+
+  template<bool texture_enable, bool raw_texture_enable, bool transparency_enable, bool dithering_enable>
+  void ShadePixel(const GPUBackendDrawCommand* cmd, const u16* texture, u32 x, u32 y, u8 color_r, u8 color_g,
+                  u8 color_b, u8 texcoord_x, u8 texcoord_y);
+
+#if defined(CPU_X64)
+  /// Shades SPAN_WIDTH pixels starting at x, for each lane set in mask. Colors and texture coordinates are in the
+  /// low 8 bits of each 16-bit lane.
+  template<bool texture_enable, bool raw_texture_enable, bool transparency_enable, bool dithering_enable>
+  void ShadeSpan(const GPUBackendDrawCommand* cmd, const u16* texture, u32 x, u32 y, __m128i mask, __m128i color_r,
+                 __m128i color_g, __m128i color_b, __m128i texcoord_x, __m128i texcoord_y);
+#endif
+
+  template<bool shading_enable, bool texture_enable, bool raw_texture_enable, bool transparency_enable,
+           bool dithering_enable>
+  void DrawTriangle(const GPUBackendDrawPolygonCommand* cmd, RasterBand band, const u16* texture, const SWVertex* v0,
+                    const SWVertex* v1, const SWVertex* v2);
+
+  using DrawTriangleFunction = void (GPU_SW_Backend::*)(const GPUBackendDrawPolygonCommand* cmd, RasterBand band,
+                                                        const u16* texture, const SWVertex* v0, const SWVertex* v1,
+                                                        const SWVertex* v2);
+  DrawTriangleFunction GetDrawTriangleFunction(bool shading_enable, bool texture_enable, bool raw_texture_enable,
+                                               bool transparency_enable, bool dithering_enable);
+
+  template<bool texture_enable, bool raw_texture_enable, bool transparency_enable>
+  void DrawRectangle(const GPUBackendDrawRectangleCommand* cmd, RasterBand band, const u16* texture);
+
+  using DrawRectangleFunction = void (GPU_SW_Backend::*)(const GPUBackendDrawRectangleCommand* cmd, RasterBand band,
+                                                         const u16* texture);
+  DrawRectangleFunction GetDrawRectangleFunction(bool texture_enable, bool raw_texture_enable,
+                                                 bool transparency_enable);
+
+  template<bool shading_enable, bool transparency_enable, bool dithering_enable>
+  void DrawLine(const GPUBackendDrawLineCommand* cmd, RasterBand band, const SWVertex* p0, const SWVertex* p1);
+
+  using DrawLineFunction = void (GPU_SW_Backend::*)(const GPUBackendDrawLineCommand* cmd, RasterBand band,
+                                                    const SWVertex* p0, const SWVertex* p1);
+  DrawLineFunction GetDrawLineFunction(bool shading_enable, bool transparency_enable, bool dithering_enable);
+
+  Common::Rectangle<u32> m_drawing_area{};
+  bool m_use_vector_shading = true;
+  bool m_use_edge_walking = true;
+  bool m_use_texture_cache = true;
+
+  std::array<u16, GPU::VRAM_WIDTH * GPU::VRAM_HEIGHT> m_vram;
+  std::array<u32, GPU::VRAM_HEIGHT> m_vram_row_versions{};
+  u32 m_vram_version = 0;
+
+  // Draw commands are copied to a second queue which every rasterizer thread walks independently. The queue is only
+  // reset once all threads have caught up, which is also the point where VRAM is consistent.
+  HeapArray<u8, RASTER_QUEUE_SIZE> m_raster_queue_data;
+  std::atomic<u32> m_raster_queue_write_ptr{0};
+  u32 m_raster_queue_wake_ptr = 0;
+  VRAMTileMask m_raster_pending_write_tiles;
+  VRAMTileMask m_raster_pending_read_tiles;
+
+  std::array<RasterizerThread, MAX_RASTERIZER_THREADS> m_raster_threads;
+  u32 m_raster_thread_count = 0;
+  std::mutex m_raster_mutex;
+  std::condition_variable m_raster_wake_cv;
+  std::condition_variable m_raster_done_cv;
+  std::atomic<u32> m_raster_sleeping_threads{0};
+  bool m_raster_shutdown = false;
+
+  std::array<TextureCacheEntry, TEXTURE_CACHE_ENTRIES> m_texture_cache;
+  u32 m_texture_cache_counter = 0;
+};
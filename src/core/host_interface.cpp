@@ -1,5 +1,6 @@
 #include "host_interface.h"
 #include "bios.h"
+#include "bios_hle.h"
 #include "cdrom.h"
 #include "common/audio_stream.h"
 #include "common/byte_stream.h"
@@ -358,13 +359,19 @@ void HostInterface::SetDefaultSettings(SettingsInterface& si)
   si.SetBoolValue("Main", "LoadDevicesFromSaveStates", false);
 
   si.SetStringValue("CPU", "ExecutionMode", Settings::GetCPUExecutionModeName(Settings::DEFAULT_CPU_EXECUTION_MODE));
+  si.SetBoolValue("CPU", "BIOSHLE", false);
+  si.SetStringValue("CPU", "BIOSHLEFunctions", Settings::DEFAULT_CPU_BIOS_HLE_FUNCTIONS);
+  si.SetBoolValue("CPU", "PrecompileProfiledBlocks", true);
 
   si.SetStringValue("GPU", "Renderer", Settings::GetRendererName(Settings::DEFAULT_GPU_RENDERER));
   si.SetIntValue("GPU", "ResolutionScale", 1);
   si.SetBoolValue("GPU", "UseDebugDevice", false);
+  si.SetBoolValue("GPU", "UseThread", true);
+  si.SetIntValue("GPU", "SoftwareThreads", 0);
   si.SetBoolValue("GPU", "TrueColor", false);
   si.SetBoolValue("GPU", "ScaledDithering", true);
   si.SetBoolValue("GPU", "TextureFiltering", false);
+  si.SetBoolValue("GPU", "TextureCache", false);
   si.SetBoolValue("GPU", "DisableInterlacing", false);
   si.SetBoolValue("GPU", "ForceNTSCTimings", false);
   si.SetBoolValue("GPU", "WidescreenHack", false);
@@ -384,6 +391,8 @@ void HostInterface::SetDefaultSettings(SettingsInterface& si)
   si.SetBoolValue("Display", "ShowSpeed", false);
   si.SetBoolValue("Display", "Fullscreen", false);
   si.SetBoolValue("Display", "VSync", true);
+  si.SetBoolValue("Display", "AutoFrameSkip", false);
+  si.SetIntValue("Display", "MaxFrameSkip", 2);
 
   si.SetBoolValue("CDROM", "ReadThread", true);
   si.SetBoolValue("CDROM", "RegionCheck", true);
@@ -418,11 +427,14 @@ void HostInterface::SetDefaultSettings(SettingsInterface& si)
   si.SetBoolValue("Debug", "ShowVRAM", false);
   si.SetBoolValue("Debug", "DumpCPUToVRAMCopies", false);
   si.SetBoolValue("Debug", "DumpVRAMToCPUCopies", false);
+  si.SetBoolValue("Debug", "ValidateRecompiler", false);
   si.SetBoolValue("Debug", "ShowGPUState", false);
   si.SetBoolValue("Debug", "ShowCDROMState", false);
   si.SetBoolValue("Debug", "ShowSPUState", false);
   si.SetBoolValue("Debug", "ShowTimersState", false);
   si.SetBoolValue("Debug", "ShowMDECState", false);
+  si.SetBoolValue("Debug", "ShowFrameProfiler", false);
+  si.SetBoolValue("Debug", "ShowIOAccessStatistics", false);
 
   si.SetIntValue("Hacks", "DMAMaxSliceTicks", static_cast<int>(Settings::DEFAULT_DMA_MAX_SLICE_TICKS));
   si.SetIntValue("Hacks", "DMAHaltTicks", static_cast<int>(Settings::DEFAULT_DMA_HALT_TICKS));
@@ -474,14 +486,23 @@ void HostInterface::CheckForSettingsChanges(const Settings& old_settings)
       CPU::CodeCache::SetUseRecompiler(g_settings.cpu_execution_mode == CPUExecutionMode::Recompiler);
     }
 
+    if (g_settings.cpu_bios_hle != old_settings.cpu_bios_hle ||
+        g_settings.cpu_bios_hle_functions != old_settings.cpu_bios_hle_functions)
+    {
+      BIOS::HLE::UpdateSettings();
+    }
+
     m_audio_stream->SetOutputVolume(g_settings.audio_output_muted ? 0 : g_settings.audio_output_volume);
 
     if (g_settings.gpu_resolution_scale != old_settings.gpu_resolution_scale ||
         g_settings.gpu_fifo_size != old_settings.gpu_fifo_size ||
         g_settings.gpu_max_run_ahead != old_settings.gpu_max_run_ahead ||
+        g_settings.gpu_use_thread != old_settings.gpu_use_thread ||
+        g_settings.gpu_sw_threads != old_settings.gpu_sw_threads ||
         g_settings.gpu_true_color != old_settings.gpu_true_color ||
         g_settings.gpu_scaled_dithering != old_settings.gpu_scaled_dithering ||
         g_settings.gpu_texture_filtering != old_settings.gpu_texture_filtering ||
+        g_settings.gpu_texture_cache != old_settings.gpu_texture_cache ||
         g_settings.gpu_disable_interlacing != old_settings.gpu_disable_interlacing ||
         g_settings.gpu_force_ntsc_timings != old_settings.gpu_force_ntsc_timings ||
         g_settings.display_crop_mode != old_settings.display_crop_mode ||
@@ -640,8 +661,11 @@ float HostInterface::GetFloatSettingValue(const char* section, const char* key,
 
 void HostInterface::ToggleSoftwareRendering()
 {
-  if (System::IsShutdown() || g_settings.gpu_renderer == GPURenderer::Software)
+  if (System::IsShutdown() || g_settings.gpu_renderer == GPURenderer::Software ||
+      g_settings.gpu_renderer == GPURenderer::Null)
+  {
     return;
+  }
 
   const GPURenderer new_renderer = g_gpu->IsHardwareRenderer() ? GPURenderer::Software : g_settings.gpu_renderer;
 
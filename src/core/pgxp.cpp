@@ -20,10 +20,13 @@
 
 #include "pgxp.h"
 #include "settings.h"
+#include <array>
 #include <cmath>
+#include <memory>
 
 namespace PGXP {
 // pgxp_types.h
+// Kept small, as one of these shadows every word of RAM which is written with a precise value.
 typedef struct PGXP_value_Tag
 {
   float x;
@@ -35,12 +38,7 @@ typedef struct PGXP_value_Tag
     unsigned char compFlags[4];
     unsigned short halfFlags[2];
   };
-  unsigned int count;
   unsigned int value;
-
-  unsigned short gFlags;
-  unsigned char lFlags;
-  unsigned char hFlags;
 } PGXP_value;
 
 // pgxp_value.h
@@ -89,8 +87,7 @@ typedef enum
 #define VALID_ALL (VALID_0 | VALID_1 | VALID_2 | VALID_3)
 #define INV_VALID_ALL (ALL ^ VALID_ALL)
 
-static const PGXP_value PGXP_value_invalid_address = {0.f, 0.f, 0.f, {0}, 0, 0, INVALID_ADDRESS, 0, 0};
-static const PGXP_value PGXP_value_zero = {0.f, 0.f, 0.f, {0}, 0, VALID_ALL, 0, 0, 0};
+static const PGXP_value PGXP_value_invalid_address = {0.f, 0.f, 0.f, {0}, 0};
 
 static void Validate(PGXP_value* pV, u32 psxV);
 static void MaskValidate(PGXP_value* pV, u32 psxV, u32 mask, u32 validMask);
@@ -113,7 +110,8 @@ typedef union
 // pgxp_mem.h
 static u32 PGXP_ConvertAddress(u32 addr);
 static PGXP_value* GetPtr(u32 addr);
-static PGXP_value* ReadMem(u32 addr);
+static PGXP_value* GetWritePtr(u32 addr, bool allocate);
+static const PGXP_value* ReadMem(u32 addr);
 
 static void ValidateAndCopyMem(PGXP_value* dest, u32 addr, u32 value);
 static void ValidateAndCopyMem16(PGXP_value* dest, u32 addr, u32 value, int sign);
@@ -152,15 +150,26 @@ void MaskValidate(PGXP_value* pV, u32 psxV, u32 mask, u32 validMask)
 
 // pgxp_mem.c
 static void PGXP_InitMem();
-static PGXP_value Mem[3 * 2048 * 1024 / 4]; // mirror 2MB in 32-bit words * 3
 static const u32 UserMemOffset = 0;
 static const u32 ScratchOffset = 2048 * 1024 / 4;
 static const u32 RegisterOffset = 2 * 2048 * 1024 / 4;
 static const u32 InvalidAddress = 3 * 2048 * 1024 / 4;
 
+// Shadow memory mirrors 2MB in 32-bit words * 3, split into pages of 4KB of PSX memory. Pages are only allocated when a
+// value with at least one valid component is written to them, which in practice is only where the GTE output is
+// stored. Words in pages which haven't been allocated read as zero, with no valid components.
+static const u32 MemPageShift = 10;
+static const u32 MemPageSize = 1u << MemPageShift;
+static const u32 MemPageCount = InvalidAddress / MemPageSize;
+static std::array<std::unique_ptr<PGXP_value[]>, MemPageCount> MemPages;
+
+// Returned for words in pages which haven't been allocated. Validating only clears flags, so this stays zero.
+static PGXP_value EmptyMem;
+
 void PGXP_InitMem()
 {
-  memset(Mem, 0, sizeof(Mem));
+  for (std::unique_ptr<PGXP_value[]>& page : MemPages)
+    page.reset();
 }
 
 u32 PGXP_ConvertAddress(u32 addr)
@@ -209,13 +218,33 @@ u32 PGXP_ConvertAddress(u32 addr)
 PGXP_value* GetPtr(u32 addr)
 {
   addr = PGXP_ConvertAddress(addr);
+  if (addr == InvalidAddress)
+    return NULL;
 
-  if (addr != InvalidAddress)
-    return &Mem[addr];
-  return NULL;
+  PGXP_value* page = MemPages[addr >> MemPageShift].get();
+  return page ? &page[addr & (MemPageSize - 1)] : &EmptyMem;
 }
 
-PGXP_value* ReadMem(u32 addr)
+PGXP_value* GetWritePtr(u32 addr, bool allocate)
+{
+  addr = PGXP_ConvertAddress(addr);
+  if (addr == InvalidAddress)
+    return NULL;
+
+  // writing a value with no valid components to an empty page doesn't change what it reads as
+  std::unique_ptr<PGXP_value[]>& page = MemPages[addr >> MemPageShift];
+  if (!page)
+  {
+    if (!allocate)
+      return NULL;
+
+    page = std::make_unique<PGXP_value[]>(MemPageSize);
+  }
+
+  return &page[addr & (MemPageSize - 1)];
+}
+
+const PGXP_value* ReadMem(u32 addr)
 {
   return GetPtr(addr);
 }
@@ -263,13 +292,11 @@ void ValidateAndCopyMem16(PGXP_value* dest, u32 addr, u32 value, int sign)
     if ((addr % 4) == 2)
     {
       dest->x = dest->y;
-      dest->lFlags = dest->hFlags;
       dest->compFlags[0] = dest->compFlags[1];
     }
 
     // truncate value
     dest->y = (dest->x < 0) ? -1.f * sign : 0.f; // 0.f;
-    dest->hFlags = 0;
     dest->value = value;
     dest->compFlags[1] = VALID; // iCB: High word is valid, just 0
     return;
@@ -280,7 +307,7 @@ void ValidateAndCopyMem16(PGXP_value* dest, u32 addr, u32 value, int sign)
 
 void WriteMem(PGXP_value* value, u32 addr)
 {
-  PGXP_value* pMem = GetPtr(addr);
+  PGXP_value* pMem = GetWritePtr(addr, value->flags != 0);
 
   if (pMem)
     *pMem = *value;
@@ -288,7 +315,7 @@ void WriteMem(PGXP_value* value, u32 addr)
 
 void WriteMem16(PGXP_value* src, u32 addr)
 {
-  PGXP_value* dest = GetPtr(addr);
+  PGXP_value* dest = GetWritePtr(addr, src->flags != 0);
   psx_value* pVal = NULL;
 
   if (dest)
@@ -298,14 +325,12 @@ void WriteMem16(PGXP_value* src, u32 addr)
     if ((addr % 4) == 2)
     {
       dest->y = src->x;
-      dest->hFlags = src->lFlags;
       dest->compFlags[1] = src->compFlags[0];
       pVal->w.h = (u16)src->value;
     }
     else
     {
       dest->x = src->x;
-      dest->lFlags = src->lFlags;
       dest->compFlags[0] = src->compFlags[0];
       pVal->w.l = (u16)src->value;
     }
@@ -316,9 +341,6 @@ void WriteMem16(PGXP_value* src, u32 addr)
       dest->z = src->z;
       dest->compFlags[2] = src->compFlags[2];
     }
-
-    // dest->valid = dest->valid && src->valid;
-    dest->gFlags |= src->gFlags; // inherit flags from both values (?)
   }
 }
 
@@ -390,7 +412,6 @@ void PGXP_InitGTE()
 
 void GTE_PushSXYZ2f(float _x, float _y, float _z, unsigned int _v)
 {
-  static unsigned int uCount = 0;
   low_value temp;
   // push values down FIFO
   SXY0 = SXY1;
@@ -401,7 +422,6 @@ void GTE_PushSXYZ2f(float _x, float _y, float _z, unsigned int _v)
   SXY2.z = _z;
   SXY2.value = _v;
   SXY2.flags = VALID_ALL;
-  SXY2.count = uCount++;
 
   // cache value in GPU plugin
   temp.word = _v;
@@ -411,7 +431,7 @@ void GTE_PushSXYZ2f(float _x, float _y, float _z, unsigned int _v)
     PGXP_CacheVertex(0, 0, NULL);
 
 #ifdef GTE_LOG
-  GTE_LOG("PGXP_PUSH (%f, %f) %u %u|", SXY2.x, SXY2.y, SXY2.flags, SXY2.count);
+  GTE_LOG("PGXP_PUSH (%f, %f) %u|", SXY2.x, SXY2.y, SXY2.flags);
 #endif
 }
 
@@ -546,29 +566,12 @@ const unsigned int mode_write = 1;
 const unsigned int mode_read = 2;
 const unsigned int mode_fail = 3;
 
-PGXP_value vertexCache[0x800 * 2][0x800 * 2];
+// Only allocated on first use, as most games don't need it.
+static const u32 vertexCacheSize = 0x800 * 2;
+static std::unique_ptr<PGXP_value[]> vertexCache;
 
-unsigned int baseID = 0;
-unsigned int lastID = 0;
 unsigned int cacheMode = 0;
 
-unsigned int IsSessionID(unsigned int vertID)
-{
-  // No wrapping
-  if (lastID >= baseID)
-    return (vertID >= baseID);
-
-  // If vertID is >= baseID it is pre-wrap and in session
-  if (vertID >= baseID)
-    return 1;
-
-  // vertID is < baseID, If it is <= lastID it is post-wrap and in session
-  if (vertID <= lastID)
-    return 1;
-
-  return 0;
-}
-
 void PGXP_CacheVertex(short sx, short sy, const PGXP_value* _pVertex)
 {
   const PGXP_value* pNewVertex = (const PGXP_value*)_pVertex;
@@ -585,36 +588,18 @@ void PGXP_CacheVertex(short sx, short sy, const PGXP_value* _pVertex)
     if (cacheMode != mode_write)
     {
       // Initialise cache on first use
-      if (cacheMode == mode_init)
-        memset(vertexCache, 0x00, sizeof(vertexCache));
+      if (!vertexCache)
+        vertexCache = std::make_unique<PGXP_value[]>(vertexCacheSize * vertexCacheSize);
 
       // First vertex of write session (frame?)
       cacheMode = mode_write;
-      baseID = pNewVertex->count;
     }
 
-    lastID = pNewVertex->count;
-
     if (sx >= -0x800 && sx <= 0x7ff && sy >= -0x800 && sy <= 0x7ff)
     {
-      pOldVertex = &vertexCache[sy + 0x800][sx + 0x800];
-
-      // To avoid ambiguity there can only be one valid entry per-session
-      if (0) //(IsSessionID(pOldVertex->count) && (pOldVertex->value == pNewVertex->value))
-      {
-        // check to ensure this isn't identical
-        if ((fabsf(pOldVertex->x - pNewVertex->x) > 0.1f) || (fabsf(pOldVertex->y - pNewVertex->y) > 0.1f) ||
-            (fabsf(pOldVertex->z - pNewVertex->z) > 0.1f))
-        {
-          *pOldVertex = *pNewVertex;
-          pOldVertex->gFlags = 5;
-          return;
-        }
-      }
-
-      // Write vertex into cache
+      // Write vertex into cache, pushed vertices always have all components valid
+      pOldVertex = &vertexCache[(sy + 0x800) * vertexCacheSize + (sx + 0x800)];
       *pOldVertex = *pNewVertex;
-      pOldVertex->gFlags = 1;
     }
   }
 }
@@ -629,8 +614,8 @@ PGXP_value* PGXP_GetCachedVertex(short sx, short sy)
         return NULL;
 
       // Initialise cache on first use
-      if (cacheMode == mode_init)
-        memset(vertexCache, 0x00, sizeof(vertexCache));
+      if (!vertexCache)
+        vertexCache = std::make_unique<PGXP_value[]>(vertexCacheSize * vertexCacheSize);
 
       // First vertex of read session (frame?)
       cacheMode = mode_read;
@@ -639,7 +624,7 @@ PGXP_value* PGXP_GetCachedVertex(short sx, short sy)
     if (sx >= -0x800 && sx <= 0x7ff && sy >= -0x800 && sy <= 0x7ff)
     {
       // Return pointer to cache entry
-      return &vertexCache[sy + 0x800][sx + 0x800];
+      return &vertexCache[(sy + 0x800) * vertexCacheSize + (sx + 0x800)];
     }
   }
 
@@ -673,7 +658,7 @@ bool GetPreciseVertex(u32 addr, u32 value, int x, int y, int xOffs, int yOffs, f
 
     // Look in cache for valid vertex
     vert = PGXP_GetCachedVertex(psx_x, psx_y);
-    if ((vert) && /*(IsSessionID(vert->count)) &&*/ (vert->gFlags == 1))
+    if (vert && ((vert->flags & VALID_01) == VALID_01))
     {
       // a value is found, it is from the current session and is unambiguous (there was only one value recorded at that
       // position)
@@ -715,24 +700,16 @@ void PGXP_InitCPU()
 static void InvalidLoad(u32 addr, u32 code, u32 value)
 {
   u32 reg = ((code >> 16) & 0x1F); // The rt part of the instruction register
-  PGXP_value* pD = NULL;
+  const PGXP_value* pD = NULL;
   PGXP_value p;
 
   p.x = p.y = -1337; // default values
 
   // p.valid = 0;
-  // p.count = value;
   pD = ReadMem(addr);
 
   if (pD)
-  {
-    p.count = addr;
     p = *pD;
-  }
-  else
-  {
-    p.count = value;
-  }
 
   p.flags = 0;
 
@@ -743,8 +720,7 @@ static void InvalidLoad(u32 addr, u32 code, u32 value)
 // invalidate memory address (invalid 8 bit write)
 static void InvalidStore(u32 addr, u32 code, u32 value)
 {
-  u32 reg = ((code >> 16) & 0x1F); // The rt part of the instruction register
-  PGXP_value* pD = NULL;
+  const PGXP_value* pD = NULL;
   PGXP_value p;
 
   pD = ReadMem(addr);
@@ -755,7 +731,6 @@ static void InvalidStore(u32 addr, u32 code, u32 value)
     p = *pD;
 
   p.flags = 0;
-  p.count = (reg * 1000) + value;
 
   // invalidate memory
   WriteMem(&p, addr);
@@ -89,15 +89,21 @@ void Settings::Load(SettingsInterface& si)
     ParseCPUExecutionMode(
       si.GetStringValue("CPU", "ExecutionMode", GetCPUExecutionModeName(DEFAULT_CPU_EXECUTION_MODE)).c_str())
       .value_or(DEFAULT_CPU_EXECUTION_MODE);
+  cpu_bios_hle = si.GetBoolValue("CPU", "BIOSHLE", false);
+  cpu_bios_hle_functions = si.GetStringValue("CPU", "BIOSHLEFunctions", DEFAULT_CPU_BIOS_HLE_FUNCTIONS);
+  cpu_precompile_profiled_blocks = si.GetBoolValue("CPU", "PrecompileProfiledBlocks", true);
 
   gpu_renderer = ParseRendererName(si.GetStringValue("GPU", "Renderer", GetRendererName(DEFAULT_GPU_RENDERER)).c_str())
                    .value_or(DEFAULT_GPU_RENDERER);
   gpu_adapter = si.GetStringValue("GPU", "Adapter", "");
   gpu_resolution_scale = static_cast<u32>(si.GetIntValue("GPU", "ResolutionScale", 1));
   gpu_use_debug_device = si.GetBoolValue("GPU", "UseDebugDevice", false);
+  gpu_use_thread = si.GetBoolValue("GPU", "UseThread", true);
+  gpu_sw_threads = static_cast<u32>(si.GetIntValue("GPU", "SoftwareThreads", 0));
   gpu_true_color = si.GetBoolValue("GPU", "TrueColor", true);
   gpu_scaled_dithering = si.GetBoolValue("GPU", "ScaledDithering", false);
   gpu_texture_filtering = si.GetBoolValue("GPU", "TextureFiltering", false);
+  gpu_texture_cache = si.GetBoolValue("GPU", "TextureCache", false);
   gpu_disable_interlacing = si.GetBoolValue("GPU", "DisableInterlacing", false);
   gpu_force_ntsc_timings = si.GetBoolValue("GPU", "ForceNTSCTimings", false);
   gpu_widescreen_hack = si.GetBoolValue("GPU", "WidescreenHack", false);
@@ -121,6 +127,8 @@ void Settings::Load(SettingsInterface& si)
   display_show_vps = si.GetBoolValue("Display", "ShowVPS", false);
   display_show_speed = si.GetBoolValue("Display", "ShowSpeed", false);
   video_sync_enabled = si.GetBoolValue("Display", "VSync", true);
+  display_auto_frame_skip = si.GetBoolValue("Display", "AutoFrameSkip", false);
+  display_max_frame_skip = static_cast<u32>(si.GetIntValue("Display", "MaxFrameSkip", 2));
 
   cdrom_read_thread = si.GetBoolValue("CDROM", "ReadThread", true);
   cdrom_region_check = si.GetBoolValue("CDROM", "RegionCheck", true);
@@ -175,11 +183,14 @@ void Settings::Load(SettingsInterface& si)
   debugging.show_vram = si.GetBoolValue("Debug", "ShowVRAM");
   debugging.dump_cpu_to_vram_copies = si.GetBoolValue("Debug", "DumpCPUToVRAMCopies");
   debugging.dump_vram_to_cpu_copies = si.GetBoolValue("Debug", "DumpVRAMToCPUCopies");
+  debugging.validate_recompiler = si.GetBoolValue("Debug", "ValidateRecompiler");
   debugging.show_gpu_state = si.GetBoolValue("Debug", "ShowGPUState");
   debugging.show_cdrom_state = si.GetBoolValue("Debug", "ShowCDROMState");
   debugging.show_spu_state = si.GetBoolValue("Debug", "ShowSPUState");
   debugging.show_timers_state = si.GetBoolValue("Debug", "ShowTimersState");
   debugging.show_mdec_state = si.GetBoolValue("Debug", "ShowMDECState");
+  debugging.show_frame_profiler = si.GetBoolValue("Debug", "ShowFrameProfiler");
+  debugging.show_io_access_statistics = si.GetBoolValue("Debug", "ShowIOAccessStatistics");
 }
 
 void Settings::Save(SettingsInterface& si) const
@@ -196,14 +207,20 @@ void Settings::Save(SettingsInterface& si) const
   si.SetBoolValue("Main", "LoadDevicesFromSaveStates", load_devices_from_save_states);
 
   si.SetStringValue("CPU", "ExecutionMode", GetCPUExecutionModeName(cpu_execution_mode));
+  si.SetBoolValue("CPU", "BIOSHLE", cpu_bios_hle);
+  si.SetStringValue("CPU", "BIOSHLEFunctions", cpu_bios_hle_functions.c_str());
+  si.SetBoolValue("CPU", "PrecompileProfiledBlocks", cpu_precompile_profiled_blocks);
 
   si.SetStringValue("GPU", "Renderer", GetRendererName(gpu_renderer));
   si.SetStringValue("GPU", "Adapter", gpu_adapter.c_str());
   si.SetIntValue("GPU", "ResolutionScale", static_cast<long>(gpu_resolution_scale));
   si.SetBoolValue("GPU", "UseDebugDevice", gpu_use_debug_device);
+  si.SetBoolValue("GPU", "UseThread", gpu_use_thread);
+  si.SetIntValue("GPU", "SoftwareThreads", static_cast<long>(gpu_sw_threads));
   si.SetBoolValue("GPU", "TrueColor", gpu_true_color);
   si.SetBoolValue("GPU", "ScaledDithering", gpu_scaled_dithering);
   si.SetBoolValue("GPU", "TextureFiltering", gpu_texture_filtering);
+  si.SetBoolValue("GPU", "TextureCache", gpu_texture_cache);
   si.SetBoolValue("GPU", "DisableInterlacing", gpu_disable_interlacing);
   si.SetBoolValue("GPU", "ForceNTSCTimings", gpu_force_ntsc_timings);
   si.SetBoolValue("GPU", "WidescreenHack", gpu_widescreen_hack);
@@ -221,6 +238,8 @@ void Settings::Save(SettingsInterface& si) const
   si.SetBoolValue("Display", "ShowVPS", display_show_vps);
   si.SetBoolValue("Display", "ShowSpeed", display_show_speed);
   si.SetBoolValue("Display", "VSync", video_sync_enabled);
+  si.SetBoolValue("Display", "AutoFrameSkip", display_auto_frame_skip);
+  si.SetIntValue("Display", "MaxFrameSkip", static_cast<long>(display_max_frame_skip));
 
   si.SetBoolValue("CDROM", "ReadThread", cdrom_read_thread);
   si.SetBoolValue("CDROM", "RegionCheck", cdrom_region_check);
@@ -267,11 +286,14 @@ void Settings::Save(SettingsInterface& si) const
   si.SetBoolValue("Debug", "ShowVRAM", debugging.show_vram);
   si.SetBoolValue("Debug", "DumpCPUToVRAMCopies", debugging.dump_cpu_to_vram_copies);
   si.SetBoolValue("Debug", "DumpVRAMToCPUCopies", debugging.dump_vram_to_cpu_copies);
+  si.SetBoolValue("Debug", "ValidateRecompiler", debugging.validate_recompiler);
   si.SetBoolValue("Debug", "ShowGPUState", debugging.show_gpu_state);
   si.SetBoolValue("Debug", "ShowCDROMState", debugging.show_cdrom_state);
   si.SetBoolValue("Debug", "ShowSPUState", debugging.show_spu_state);
   si.SetBoolValue("Debug", "ShowTimersState", debugging.show_timers_state);
   si.SetBoolValue("Debug", "ShowMDECState", debugging.show_mdec_state);
+  si.SetBoolValue("Debug", "ShowFrameProfiler", debugging.show_frame_profiler);
+  si.SetBoolValue("Debug", "ShowIOAccessStatistics", debugging.show_io_access_statistics);
 }
 
 static std::array<const char*, LOGLEVEL_COUNT> s_log_level_names = {
@@ -387,16 +409,16 @@ const char* Settings::GetCPUExecutionModeDisplayName(CPUExecutionMode mode)
   return s_cpu_execution_mode_display_names[static_cast<u8>(mode)];
 }
 
-static std::array<const char*, 4> s_gpu_renderer_names = {{
+static std::array<const char*, 5> s_gpu_renderer_names = {{
 #ifdef WIN32
   "D3D11",
 #endif
-  "Vulkan", "OpenGL", "Software"}};
-static std::array<const char*, 4> s_gpu_renderer_display_names = {{
+  "Vulkan", "OpenGL", "Software", "Null"}};
+static std::array<const char*, 5> s_gpu_renderer_display_names = {{
 #ifdef WIN32
   "Hardware (D3D11)",
 #endif
-  "Hardware (Vulkan)", "Hardware (OpenGL)", "Software"}};
+  "Hardware (Vulkan)", "Hardware (OpenGL)", "Software", "Null (No Rendering)"}};
 
 std::optional<GPURenderer> Settings::ParseRendererName(const char* str)
 {
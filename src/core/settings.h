@@ -68,6 +68,9 @@ struct Settings
   ConsoleRegion region = ConsoleRegion::Auto;
 
   CPUExecutionMode cpu_execution_mode = CPUExecutionMode::Interpreter;
+  bool cpu_bios_hle = false;
+  std::string cpu_bios_hle_functions;
+  bool cpu_precompile_profiled_blocks = true;
 
   float emulation_speed = 1.0f;
   bool speed_limiter_enabled = true;
@@ -82,9 +85,12 @@ struct Settings
   std::string gpu_adapter;
   u32 gpu_resolution_scale = 1;
   bool gpu_use_debug_device = false;
+  bool gpu_use_thread = true;
+  u32 gpu_sw_threads = 0;
   bool gpu_true_color = true;
   bool gpu_scaled_dithering = false;
   bool gpu_texture_filtering = false;
+  bool gpu_texture_cache = false;
   bool gpu_disable_interlacing = false;
   bool gpu_force_ntsc_timings = false;
   bool gpu_widescreen_hack = false;
@@ -101,6 +107,8 @@ struct Settings
   bool display_show_vps = false;
   bool display_show_speed = false;
   bool video_sync_enabled = true;
+  bool display_auto_frame_skip = false;
+  u32 display_max_frame_skip = 2;
 
   bool cdrom_read_thread = true;
   bool cdrom_region_check = true;
@@ -124,6 +132,7 @@ struct Settings
     bool show_vram = false;
     bool dump_cpu_to_vram_copies = false;
     bool dump_vram_to_cpu_copies = false;
+    bool validate_recompiler = false;
 
     // Mutable because the imgui window can close itself.
     mutable bool show_gpu_state = false;
@@ -131,6 +140,8 @@ struct Settings
     mutable bool show_spu_state = false;
     mutable bool show_timers_state = false;
     mutable bool show_mdec_state = false;
+    mutable bool show_frame_profiler = false;
+    mutable bool show_io_access_statistics = false;
   } debugging;
 
   // TODO: Controllers, memory cards, etc.
@@ -215,6 +226,8 @@ struct Settings
 #endif
   static constexpr ConsoleRegion DEFAULT_CONSOLE_REGION = ConsoleRegion::Auto;
   static constexpr CPUExecutionMode DEFAULT_CPU_EXECUTION_MODE = CPUExecutionMode::Recompiler;
+  static constexpr const char* DEFAULT_CPU_BIOS_HLE_FUNCTIONS =
+    "strcmp,strcpy,strlen,toupper,tolower,bzero,memcpy,memset,rand,srand";
   static constexpr AudioBackend DEFAULT_AUDIO_BACKEND = AudioBackend::Cubeb;
   static constexpr DisplayCropMode DEFAULT_DISPLAY_CROP_MODE = DisplayCropMode::Overscan;
   static constexpr DisplayAspectRatio DEFAULT_DISPLAY_ASPECT_RATIO = DisplayAspectRatio::R4_3;
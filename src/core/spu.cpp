@@ -5,6 +5,7 @@
 #include "common/state_wrapper.h"
 #include "common/wav_writer.h"
 #include "dma.h"
+#include "frame_profiler.h"
 #include "host_interface.h"
 #include "interrupt_controller.h"
 #include "system.h"
@@ -19,11 +20,14 @@ SPU::~SPU() = default;
 
 void SPU::Initialize()
 {
-  m_tick_event = TimingEvents::CreateTimingEvent("SPU Sample", SYSCLK_TICKS_PER_SPU_TICK, SYSCLK_TICKS_PER_SPU_TICK,
-                                                 std::bind(&SPU::Execute, this, std::placeholders::_1), false);
-  m_transfer_event =
-    TimingEvents::CreateTimingEvent("SPU Transfer", TRANSFER_TICKS_PER_HALFWORD, TRANSFER_TICKS_PER_HALFWORD,
-                                    std::bind(&SPU::ExecuteTransfer, this, std::placeholders::_1), false);
+  m_tick_event = TimingEvents::CreateTimingEvent(
+    "SPU Sample", SYSCLK_TICKS_PER_SPU_TICK, SYSCLK_TICKS_PER_SPU_TICK,
+    [](void* param, TickCount ticks, TickCount ticks_late) { static_cast<SPU*>(param)->Execute(ticks); },
+    this, false);
+  m_transfer_event = TimingEvents::CreateTimingEvent(
+    "SPU Transfer", TRANSFER_TICKS_PER_HALFWORD, TRANSFER_TICKS_PER_HALFWORD,
+    [](void* param, TickCount ticks, TickCount ticks_late) { static_cast<SPU*>(param)->ExecuteTransfer(ticks); },
+    this, false);
 
   Reset();
 }
@@ -678,6 +682,7 @@ void SPU::IncrementCaptureBufferPosition()
 
 void SPU::Execute(TickCount ticks)
 {
+  FrameProfiler::ScopedTimer profile_timer(FrameProfiler::SLOT_SPU);
   u32 remaining_frames = static_cast<u32>((ticks + m_ticks_carry) / SYSCLK_TICKS_PER_SPU_TICK);
   m_ticks_carry = (ticks + m_ticks_carry) % SYSCLK_TICKS_PER_SPU_TICK;
 
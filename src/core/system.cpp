@@ -1,5 +1,6 @@
 #include "system.h"
 #include "bios.h"
+#include "bios_hle.h"
 #include "bus.h"
 #include "cdrom.h"
 #include "common/audio_stream.h"
@@ -7,10 +8,13 @@
 #include "common/log.h"
 #include "common/state_wrapper.h"
 #include "common/string_util.h"
+#include "common/trace_recorder.h"
 #include "controller.h"
 #include "cpu_code_cache.h"
 #include "cpu_core.h"
+#include "cpu_validator.h"
 #include "dma.h"
+#include "frame_profiler.h"
 #include "game_list.h"
 #include "gpu.h"
 #include "gte.h"
@@ -61,7 +65,7 @@ static bool SetExpansionROM(const char* filename);
 static std::unique_ptr<CDImage> OpenCDImage(const char* path, bool force_preload);
 
 static bool DoLoadState(ByteStream* stream, bool force_software_renderer);
-static bool DoState(StateWrapper& sw);
+static bool DoState(StateWrapper& sw, bool flush_code_cache = true);
 static bool CreateGPU(GPURenderer renderer);
 
 static bool Initialize(bool force_software_renderer);
@@ -95,6 +99,11 @@ static float s_average_frame_time = 0.0f;
 static u32 s_last_frame_number = 0;
 static u32 s_last_internal_frame_number = 0;
 static u32 s_last_global_tick_counter = 0;
+static float s_skipped_fps = 0.0f;
+static u32 s_skipped_frame_count = 0;
+static u32 s_consecutive_skipped_frames = 0;
+static bool s_skip_next_frame = false;
+static bool s_frame_skipped = false;
 static Common::Timer s_fps_timer;
 static Common::Timer s_frame_timer;
 
@@ -186,6 +195,14 @@ float GetVPS()
 {
   return s_vps;
 }
+float GetSkippedFPS()
+{
+  return s_skipped_fps;
+}
+bool WasFrameSkipped()
+{
+  return s_frame_skipped;
+}
 float GetEmulationSpeed()
 {
   return s_speed;
@@ -273,6 +290,7 @@ bool Boot(const SystemBootParameters& params)
   Assert(m_media_playlist.empty());
   s_state = State::Starting;
   s_region = g_settings.region;
+  TraceRecorder::SetThreadName("Emulation");
 
   if (params.state_stream)
     return DoLoadState(params.state_stream.get(), params.force_software_renderer);
@@ -439,6 +457,11 @@ bool Initialize(bool force_software_renderer)
   s_last_frame_number = 0;
   s_last_internal_frame_number = 0;
   s_last_global_tick_counter = 0;
+  s_skipped_fps = 0.0f;
+  s_skipped_frame_count = 0;
+  s_consecutive_skipped_frames = 0;
+  s_skip_next_frame = false;
+  s_frame_skipped = false;
   s_fps_timer.Reset();
   s_frame_timer.Reset();
 
@@ -446,6 +469,8 @@ bool Initialize(bool force_software_renderer)
 
   CPU::Initialize();
   CPU::CodeCache::Initialize(g_settings.cpu_execution_mode == CPUExecutionMode::Recompiler);
+  CPU::Validator::Initialize();
+  BIOS::HLE::Initialize();
   Bus::Initialize();
 
   if (!CreateGPU(force_software_renderer ? GPURenderer::Software : g_settings.gpu_renderer))
@@ -480,6 +505,9 @@ void Shutdown()
   g_gpu.reset();
   g_interrupt_controller.Shutdown();
   g_dma.Shutdown();
+  BIOS::HLE::Shutdown();
+  CPU::Validator::Shutdown();
+  CPU::CodeCache::SaveProfile();
   CPU::CodeCache::Shutdown();
   Bus::Shutdown();
   CPU::Shutdown();
@@ -509,6 +537,10 @@ bool CreateGPU(GPURenderer renderer)
       break;
 #endif
 
+    case GPURenderer::Null:
+      g_gpu = GPU::CreateNullRenderer();
+      break;
+
     case GPURenderer::Software:
     default:
       g_gpu = GPU::CreateSoftwareRenderer();
@@ -529,7 +561,7 @@ bool CreateGPU(GPURenderer renderer)
   return true;
 }
 
-bool DoState(StateWrapper& sw)
+bool DoState(StateWrapper& sw, bool flush_code_cache)
 {
   if (!sw.DoMarker("System"))
     return false;
@@ -545,7 +577,7 @@ bool DoState(StateWrapper& sw)
   if (!sw.DoMarker("CPU") || !CPU::DoState(sw))
     return false;
 
-  if (sw.IsReading())
+  if (sw.IsReading() && flush_code_cache)
     CPU::CodeCache::Flush();
 
   if (!sw.DoMarker("Bus") || !Bus::DoState(sw))
@@ -787,20 +819,65 @@ bool SaveState(ByteStream* state, u32 screenshot_size /* = 128 */)
   return true;
 }
 
+bool SaveRawState(ByteStream* state)
+{
+  if (IsShutdown())
+    return false;
+
+  StateWrapper sw(state, StateWrapper::Mode::Write);
+  return DoState(sw, false);
+}
+
+bool LoadRawState(ByteStream* state)
+{
+  if (IsShutdown())
+    return false;
+
+  StateWrapper sw(state, StateWrapper::Mode::Read);
+  return DoState(sw, false);
+}
+
 void RunFrame()
 {
+  TraceRecorder::ScopedSpan trace_span("Frame");
+
   s_frame_timer.Reset();
 
+  // The GPU can refuse to skip, e.g. when the game reads back its framebuffers.
+  g_gpu->SetSkipRendering(s_skip_next_frame);
+  s_frame_skipped = g_gpu->IsSkippingRendering();
+  s_skip_next_frame = false;
+  if (s_frame_skipped)
+  {
+    s_skipped_frame_count++;
+    s_consecutive_skipped_frames++;
+  }
+  else
+  {
+    s_consecutive_skipped_frames = 0;
+  }
+
   g_gpu->RestoreGraphicsAPIState();
 
-  if (g_settings.cpu_execution_mode == CPUExecutionMode::Interpreter)
-    CPU::Execute();
-  else
-    CPU::CodeCache::Execute();
+  {
+    FrameProfiler::ScopedTimer profile_timer(FrameProfiler::SLOT_CPU);
+    if (g_settings.cpu_execution_mode == CPUExecutionMode::Interpreter)
+      CPU::Execute();
+    else if (g_settings.debugging.validate_recompiler && g_settings.IsUsingRecompiler())
+      CPU::Validator::RunFrame();
+    else
+      CPU::CodeCache::Execute();
+  }
+
+  if (g_settings.IsUsingCodeCache())
+    CPU::CodeCache::PrecompileProfiledBlocks();
 
   // Generate any pending samples from the SPU before sleeping, this way we reduce the chances of underruns.
   g_spu.GeneratePendingSamples();
 
+  if (g_settings.debugging.show_io_access_statistics)
+    Bus::UpdateIOAccessStatistics();
+
   g_gpu->ResetGraphicsAPIState();
 }
 
@@ -818,6 +895,8 @@ void UpdateThrottlePeriod()
 
 void Throttle()
 {
+  FrameProfiler::ScopedTimer profile_timer(FrameProfiler::SLOT_THROTTLE);
+
   // Allow variance of up to 40ms either way.
   constexpr s64 MAX_VARIANCE_TIME = INT64_C(40000000);
 
@@ -827,6 +906,11 @@ void Throttle()
   // Use unsigned for defined overflow/wrap-around.
   const u64 time = static_cast<u64>(s_throttle_timer.GetTimeNanoseconds());
   const s64 sleep_time = static_cast<s64>(s_last_throttle_time - time);
+
+  // Behind schedule, so don't render the next frame, but always show one every few frames.
+  s_skip_next_frame = g_settings.display_auto_frame_skip && sleep_time < 0 &&
+                      s_consecutive_skipped_frames < g_settings.display_max_frame_skip;
+
   if (sleep_time < -MAX_VARIANCE_TIME)
   {
 #ifndef _DEBUG
@@ -857,6 +941,8 @@ void Throttle()
 
 void UpdatePerformanceCounters()
 {
+  FrameProfiler::EndFrame();
+
   const float frame_time = static_cast<float>(s_frame_timer.GetTimeMilliseconds());
   s_average_frame_time_accumulator += frame_time;
   s_worst_frame_time_accumulator = std::max(s_worst_frame_time_accumulator, frame_time);
@@ -877,6 +963,8 @@ void UpdatePerformanceCounters()
   s_last_frame_number = s_frame_number;
   s_fps = static_cast<float>(s_internal_frame_number - s_last_internal_frame_number) / time;
   s_last_internal_frame_number = s_internal_frame_number;
+  s_skipped_fps = static_cast<float>(s_skipped_frame_count) / time;
+  s_skipped_frame_count = 0;
   s_speed = static_cast<float>(static_cast<double>(global_tick_counter - s_last_global_tick_counter) /
                                (static_cast<double>(MASTER_CLOCK) * time)) *
             100.0f;
@@ -891,6 +979,7 @@ void ResetPerformanceCounters()
   s_last_frame_number = s_frame_number;
   s_last_internal_frame_number = s_internal_frame_number;
   s_last_global_tick_counter = TimingEvents::GetGlobalTickCounter();
+  s_skipped_frame_count = 0;
   s_average_frame_time_accumulator = 0.0f;
   s_worst_frame_time_accumulator = 0.0f;
   s_fps_timer.Reset();
@@ -1198,6 +1287,7 @@ void RemoveMedia()
 
 void UpdateRunningGame(const char* path, CDImage* image)
 {
+  const std::string old_game_code = std::move(s_running_game_code);
   s_running_game_path.clear();
   s_running_game_code.clear();
   s_running_game_title.clear();
@@ -1208,6 +1298,12 @@ void UpdateRunningGame(const char* path, CDImage* image)
     g_host_interface->GetGameInfo(path, image, &s_running_game_code, &s_running_game_title);
   }
 
+  if (s_running_game_code != old_game_code)
+  {
+    CPU::CodeCache::SaveProfile();
+    CPU::CodeCache::LoadProfile(s_running_game_code);
+  }
+
   g_host_interface->OnRunningGameChanged();
 }
 
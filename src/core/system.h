@@ -68,6 +68,10 @@ const std::string& GetRunningTitle();
 
 float GetFPS();
 float GetVPS();
+float GetSkippedFPS();
+
+/// Returns true if the last frame wasn't rendered by automatic frame skipping, and shouldn't be presented.
+bool WasFrameSkipped();
 float GetEmulationSpeed();
 float GetAverageFrameTime();
 float GetWorstFrameTime();
@@ -80,6 +84,12 @@ void Shutdown();
 bool LoadState(ByteStream* state);
 bool SaveState(ByteStream* state, u32 screenshot_size = 128);
 
+/// Saves/loads the machine state without a header, media or screenshot, for rewinding within a session.
+/// Must be called from within RunFrame(). The code cache is not flushed on load, the caller is responsible for
+/// invalidating any modified code.
+bool SaveRawState(ByteStream* state);
+bool LoadRawState(ByteStream* state);
+
 /// Recreates the GPU component, saving/loading the state so it is preserved. Call when the GPU renderer changes.
 bool RecreateGPU(GPURenderer renderer);
 
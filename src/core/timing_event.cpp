@@ -1,18 +1,69 @@
 #include "timing_event.h"
 #include "common/assert.h"
+#include "common/file_system.h"
 #include "common/log.h"
+#include "common/trace_recorder.h"
 #include "common/state_wrapper.h"
 #include "cpu_core.h"
+#include "frame_profiler.h"
 #include "system.h"
+#include <cstring>
 Log_SetChannel(TimingEvents);
 
 namespace TimingEvents {
 
+enum class TraceOp : u8
+{
+  Define,
+  RunEvents,
+  CallbackBegin,
+  CallbackEnd,
+  Schedule,
+  Activate,
+  Deactivate,
+  Reset,
+  InvokeEarly,
+  SetInterval,
+  SetPeriod,
+  Destroy
+};
+
+struct TraceEntry
+{
+  TraceOp op;
+  u8 flags;
+  u16 padding;
+  u32 event_id;
+  TickCount pending_ticks;
+  TickCount args[4];
+};
+static_assert(sizeof(TraceEntry) == 28, "TraceEntry is packed");
+
+struct TraceHeader
+{
+  u32 magic;
+  u32 version;
+  u32 num_entries;
+  u32 global_tick_counter;
+  u32 last_event_run_time;
+};
+
+static constexpr u32 TRACE_MAGIC = 0x52544554; // TETR
+static constexpr u32 TRACE_VERSION = 1;
+static constexpr u32 MAX_TRACE_ENTRIES = 8 * 1024 * 1024;
+
+// Active events, stored as a binary min-heap on downcount. Each event knows its own position in the heap.
 static std::vector<TimingEvent*> s_events;
 static u32 s_global_tick_counter = 0;
 static u32 s_last_event_run_time = 0;
 static bool s_running_events = false;
-static bool s_events_need_sorting = false;
+
+static u32 s_next_trace_id = 0;
+static bool s_trace_recording = false;
+static std::vector<TraceEntry> s_trace;
+static std::vector<bool> s_trace_defined;
+static u32 s_trace_start_global_tick_counter = 0;
+static u32 s_trace_start_last_event_run_time = 0;
 
 u32 GetGlobalTickCounter()
 {
@@ -36,10 +87,10 @@ void Shutdown()
 }
 
 std::unique_ptr<TimingEvent> CreateTimingEvent(std::string name, TickCount period, TickCount interval,
-                                               TimingEventCallback callback, bool activate)
+                                               TimingEventCallback callback, void* callback_param, bool activate)
 {
   std::unique_ptr<TimingEvent> event =
-    std::make_unique<TimingEvent>(std::move(name), period, interval, std::move(callback));
+    std::make_unique<TimingEvent>(std::move(name), period, interval, callback, callback_param);
   if (activate)
     event->Activate();
 
@@ -52,45 +103,107 @@ void UpdateCPUDowncount()
     CPU::g_state.downcount = s_events[0]->GetDowncount();
 }
 
-static bool CompareEvents(const TimingEvent* lhs, const TimingEvent* rhs)
+ALWAYS_INLINE static void SetHeapSlot(u32 index, TimingEvent* event)
 {
-  return lhs->GetDowncount() > rhs->GetDowncount();
+  s_events[index] = event;
+  event->m_heap_index = index;
 }
 
-static void AddActiveEvent(TimingEvent* event)
+static void SiftUp(u32 index)
 {
-  s_events.push_back(event);
-  if (!s_running_events)
+  TimingEvent* event = s_events[index];
+  while (index > 0)
   {
-    std::push_heap(s_events.begin(), s_events.end(), CompareEvents);
-    UpdateCPUDowncount();
+    const u32 parent = (index - 1) / 2;
+    if (s_events[parent]->m_downcount <= event->m_downcount)
+      break;
+
+    SetHeapSlot(index, s_events[parent]);
+    index = parent;
   }
-  else
+
+  SetHeapSlot(index, event);
+}
+
+static void SiftDown(u32 index)
+{
+  const u32 count = static_cast<u32>(s_events.size());
+  TimingEvent* event = s_events[index];
+  for (;;)
   {
-    s_events_need_sorting = true;
+    u32 child = index * 2 + 1;
+    if (child >= count)
+      break;
+
+    if ((child + 1) < count && s_events[child + 1]->m_downcount < s_events[child]->m_downcount)
+      child++;
+
+    if (event->m_downcount <= s_events[child]->m_downcount)
+      break;
+
+    SetHeapSlot(index, s_events[child]);
+    index = child;
   }
+
+  SetHeapSlot(index, event);
+}
+
+static void UpdateEventPosition(TimingEvent* event)
+{
+  const u32 index = event->m_heap_index;
+  if (index > 0 && event->m_downcount < s_events[(index - 1) / 2]->m_downcount)
+    SiftUp(index);
+  else
+    SiftDown(index);
+}
+
+static void RebuildHeap()
+{
+  const u32 count = static_cast<u32>(s_events.size());
+  for (u32 i = 0; i < count; i++)
+    s_events[i]->m_heap_index = i;
+  for (u32 i = count / 2; i > 0; i--)
+    SiftDown(i - 1);
+}
+
+static void AddActiveEvent(TimingEvent* event)
+{
+  const u32 index = static_cast<u32>(s_events.size());
+  s_events.push_back(event);
+  event->m_heap_index = index;
+  SiftUp(index);
+
+  if (!s_running_events)
+    UpdateCPUDowncount();
 }
 
 static void RemoveActiveEvent(TimingEvent* event)
 {
-  auto iter = std::find_if(s_events.begin(), s_events.end(), [event](const auto& it) { return event == it; });
-  if (iter == s_events.end())
+  const u32 index = event->m_heap_index;
+  if (index >= s_events.size() || s_events[index] != event)
   {
     Panic("Attempt to remove inactive event");
     return;
   }
 
-  s_events.erase(iter);
-  if (!s_running_events)
-  {
-    std::make_heap(s_events.begin(), s_events.end(), CompareEvents);
-    if (!s_events.empty())
-      UpdateCPUDowncount();
-  }
-  else
+  // Move the last event into the hole, then restore the heap property around it.
+  TimingEvent* last = s_events.back();
+  s_events.pop_back();
+  if (last != event)
   {
-    s_events_need_sorting = true;
+    SetHeapSlot(index, last);
+    UpdateEventPosition(last);
   }
+
+  if (!s_running_events && !s_events.empty())
+    UpdateCPUDowncount();
+}
+
+static void RescheduleEvent(TimingEvent* event)
+{
+  UpdateEventPosition(event);
+  if (!s_running_events)
+    UpdateCPUDowncount();
 }
 
 static TimingEvent* FindActiveEvent(const char* name)
@@ -101,23 +214,70 @@ static TimingEvent* FindActiveEvent(const char* name)
   return (iter != s_events.end()) ? *iter : nullptr;
 }
 
-static void SortEvents()
+static void AddTraceEntry(TraceOp op, u32 event_id, u8 flags = 0, TickCount arg0 = 0, TickCount arg1 = 0,
+                          TickCount arg2 = 0, TickCount arg3 = 0)
 {
-  if (!s_running_events)
-  {
-    std::make_heap(s_events.begin(), s_events.end(), CompareEvents);
-    UpdateCPUDowncount();
-  }
-  else
+  if (s_trace.size() >= MAX_TRACE_ENTRIES)
+    return;
+
+  TraceEntry entry;
+  entry.op = op;
+  entry.flags = flags;
+  entry.padding = 0;
+  entry.event_id = event_id;
+  entry.pending_ticks = CPU::GetPendingTicks();
+  entry.args[0] = arg0;
+  entry.args[1] = arg1;
+  entry.args[2] = arg2;
+  entry.args[3] = arg3;
+  s_trace.push_back(entry);
+
+  if (s_trace.size() == MAX_TRACE_ENTRIES)
+    Log_WarningPrintf("Timing event trace is full, further operations will not be recorded.");
+}
+
+static void DefineTraceEvent(const TimingEvent* event)
+{
+  if (event->m_trace_id >= s_trace_defined.size())
+    s_trace_defined.resize(event->m_trace_id + 1);
+  else if (s_trace_defined[event->m_trace_id])
+    return;
+
+  s_trace_defined[event->m_trace_id] = true;
+  AddTraceEntry(TraceOp::Define, event->m_trace_id, event->m_active ? 1 : 0, event->m_period, event->m_interval,
+                event->m_downcount, event->m_time_since_last_run);
+}
+
+static void TraceEvent(TraceOp op, const TimingEvent* event, TickCount arg0 = 0, TickCount arg1 = 0)
+{
+  DefineTraceEvent(event);
+  AddTraceEntry(op, event->m_trace_id, 0, arg0, arg1);
+}
+
+static void InvokeCallback(TimingEvent* event, TickCount ticks, TickCount ticks_late)
+{
+  FrameProfiler::ScopedTimer profile_timer(event->m_profile_slot);
+  TraceRecorder::ScopedSpan trace_span(event->m_span_name);
+  if (!s_trace_recording)
   {
-    s_events_need_sorting = true;
+    event->m_callback(event->m_callback_param, ticks, ticks_late);
+    return;
   }
+
+  TraceEvent(TraceOp::CallbackBegin, event, ticks, ticks_late);
+  event->m_callback(event->m_callback_param, ticks, ticks_late);
+  AddTraceEntry(TraceOp::CallbackEnd, event->m_trace_id);
 }
 
 void RunEvents()
 {
   DebugAssert(!s_running_events && !s_events.empty());
 
+  TraceRecorder::ScopedSpan trace_span("RunEvents");
+
+  if (s_trace_recording)
+    AddTraceEntry(TraceOp::RunEvents, 0, 0, static_cast<TickCount>(s_global_tick_counter));
+
   s_running_events = true;
 
   TickCount pending_ticks = (s_global_tick_counter + CPU::GetPendingTicks()) - s_last_event_run_time;
@@ -128,7 +288,7 @@ void RunEvents()
     s_global_tick_counter += static_cast<u32>(time);
     pending_ticks -= time;
 
-    // Apply downcount to all events.
+    // Apply downcount to all events. This does not change their relative order.
     // This will result in a negative downcount for those events which are late.
     for (TimingEvent* evt : s_events)
     {
@@ -140,7 +300,6 @@ void RunEvents()
     while (s_events.front()->m_downcount <= 0)
     {
       TimingEvent* evt = s_events.front();
-      std::pop_heap(s_events.begin(), s_events.end(), CompareEvents);
 
       // Factor late time into the time for the next invocation.
       const TickCount ticks_late = -evt->m_downcount;
@@ -148,22 +307,12 @@ void RunEvents()
       evt->m_downcount += evt->m_interval;
       evt->m_time_since_last_run = 0;
 
-      // The cycles_late is only an indicator, it doesn't modify the cycles to execute.
-      evt->m_callback(ticks_to_execute, ticks_late);
+      // Place it in the appropriate position in the queue before running the callback, so that the callback is
+      // free to reschedule or deactivate this or any other event.
+      SiftDown(0);
 
-      // Place it in the appropriate position in the queue.
-      if (s_events_need_sorting)
-      {
-        // Another event may have been changed by this event, or the interval/downcount changed.
-        std::make_heap(s_events.begin(), s_events.end(), CompareEvents);
-        s_events_need_sorting = false;
-      }
-      else
-      {
-        // Keep the event list in a heap. The event we just serviced will be in the last place,
-        // so we can use push_here instead of make_heap, which should be faster.
-        std::push_heap(s_events.begin(), s_events.end(), CompareEvents);
-      }
+      // The cycles_late is only an indicator, it doesn't modify the cycles to execute.
+      InvokeCallback(evt, ticks_to_execute, ticks_late);
     }
   }
 
@@ -176,6 +325,13 @@ bool DoState(StateWrapper& sw, u32 global_tick_counter)
 {
   if (sw.IsReading())
   {
+    if (s_trace_recording)
+    {
+      // Event times are about to jump, the rest of the trace would not replay.
+      Log_WarningPrintf("Loading state, timing event trace will end here.");
+      s_trace_recording = false;
+    }
+
     s_global_tick_counter = global_tick_counter;
 
     // Load timestamps for the clock events.
@@ -202,7 +358,7 @@ bool DoState(StateWrapper& sw, u32 global_tick_counter)
         continue;
       }
 
-      // Using reschedule is safe here since we call sort afterwards.
+      // Modifying the downcount directly is safe here since we rebuild the heap afterwards.
       event->m_downcount = downcount;
       event->m_time_since_last_run = time_since_last_run;
       event->m_period = period;
@@ -212,7 +368,8 @@ bool DoState(StateWrapper& sw, u32 global_tick_counter)
     sw.Do(&s_last_event_run_time);
 
     Log_DevPrintf("Loaded %u events from save state.", event_count);
-    SortEvents();
+    RebuildHeap();
+    UpdateCPUDowncount();
   }
   else
   {
@@ -236,16 +393,263 @@ bool DoState(StateWrapper& sw, u32 global_tick_counter)
   return !sw.HasError();
 }
 
+bool IsRecordingTrace()
+{
+  return s_trace_recording;
+}
+
+void StartTraceRecording()
+{
+  s_trace.clear();
+  s_trace_defined.clear();
+  s_trace_start_global_tick_counter = s_global_tick_counter;
+  s_trace_start_last_event_run_time = s_last_event_run_time;
+  s_trace_recording = true;
+
+  // Define the active events in heap order, so the replay starts with an identical heap layout.
+  for (const TimingEvent* event : s_events)
+    DefineTraceEvent(event);
+
+  Log_InfoPrintf("Started recording timing event trace with %zu active events.", s_events.size());
+}
+
+bool StopTraceRecording(const char* filename)
+{
+  if (!s_trace_recording && s_trace.empty())
+    return false;
+
+  s_trace_recording = false;
+
+  TraceHeader header;
+  header.magic = TRACE_MAGIC;
+  header.version = TRACE_VERSION;
+  header.num_entries = static_cast<u32>(s_trace.size());
+  header.global_tick_counter = s_trace_start_global_tick_counter;
+  header.last_event_run_time = s_trace_start_last_event_run_time;
+
+  std::vector<u8> data(sizeof(header) + sizeof(TraceEntry) * s_trace.size());
+  std::memcpy(data.data(), &header, sizeof(header));
+  if (!s_trace.empty())
+    std::memcpy(data.data() + sizeof(header), s_trace.data(), sizeof(TraceEntry) * s_trace.size());
+
+  const u32 num_entries = header.num_entries;
+  s_trace = {};
+  s_trace_defined = {};
+
+  if (!FileSystem::WriteBinaryFile(filename, data.data(), data.size()))
+  {
+    Log_ErrorPrintf("Failed to write timing event trace to '%s'", filename);
+    return false;
+  }
+
+  Log_InfoPrintf("Wrote %u timing event trace entries to '%s'", num_entries, filename);
+  return true;
+}
+
+namespace {
+struct ReplayState;
+
+struct ReplayEvent
+{
+  ReplayState* state;
+  u32 id;
+  std::unique_ptr<TimingEvent> event;
+};
+
+struct ReplayState
+{
+  const TraceEntry* entries;
+  u32 num_entries;
+  u32 position;
+  std::vector<std::unique_ptr<ReplayEvent>> events;
+  TraceReplayStats* stats;
+};
+} // namespace
+
+static void ReplayOperations(ReplayState& state, bool in_callback);
+
+static void ReplayCallback(void* param, TickCount ticks, TickCount ticks_late)
+{
+  ReplayEvent* revent = static_cast<ReplayEvent*>(param);
+  ReplayState& state = *revent->state;
+  state.stats->num_callbacks++;
+  if (state.stats->diverged || state.position == state.num_entries)
+    return;
+
+  const TraceEntry& entry = state.entries[state.position];
+  if (entry.op != TraceOp::CallbackBegin || entry.event_id != revent->id || entry.args[0] != ticks ||
+      entry.args[1] != ticks_late)
+  {
+    state.stats->diverged = true;
+    return;
+  }
+
+  state.position++;
+  ReplayOperations(state, true);
+}
+
+static TimingEvent* GetReplayEvent(ReplayState& state, u32 id)
+{
+  return (id < state.events.size() && state.events[id]) ? state.events[id]->event.get() : nullptr;
+}
+
+static void ReplayOperations(ReplayState& state, bool in_callback)
+{
+  while (state.position < state.num_entries && !state.stats->diverged)
+  {
+    const TraceEntry& entry = state.entries[state.position++];
+    state.stats->num_operations++;
+
+    CPU::g_state.pending_ticks = entry.pending_ticks;
+
+    if (entry.op == TraceOp::Define)
+    {
+      if (entry.event_id >= state.events.size())
+        state.events.resize(entry.event_id + 1);
+
+      auto revent = std::make_unique<ReplayEvent>();
+      revent->state = &state;
+      revent->id = entry.event_id;
+      revent->event = std::make_unique<TimingEvent>(std::string(), entry.args[0], entry.args[1], ReplayCallback,
+                                                    revent.get());
+
+      TimingEvent* event = revent->event.get();
+      event->m_downcount = entry.args[2];
+      event->m_time_since_last_run = entry.args[3];
+      if (entry.flags != 0)
+      {
+        event->m_active = true;
+        AddActiveEvent(event);
+      }
+
+      state.events[entry.event_id] = std::move(revent);
+      continue;
+    }
+    else if (entry.op == TraceOp::RunEvents)
+    {
+      state.stats->num_run_events++;
+      if (static_cast<TickCount>(s_global_tick_counter) != entry.args[0] || s_events.empty())
+      {
+        state.stats->diverged = true;
+        return;
+      }
+
+      RunEvents();
+      continue;
+    }
+    else if (entry.op == TraceOp::CallbackEnd)
+    {
+      if (!in_callback)
+        state.stats->diverged = true;
+
+      return;
+    }
+
+    TimingEvent* event = GetReplayEvent(state, entry.event_id);
+    if (!event)
+    {
+      state.stats->diverged = true;
+      return;
+    }
+
+    switch (entry.op)
+    {
+      case TraceOp::Schedule:
+        event->Schedule(entry.args[0]);
+        break;
+
+      case TraceOp::Activate:
+        event->Activate();
+        break;
+
+      case TraceOp::Deactivate:
+        event->Deactivate();
+        break;
+
+      case TraceOp::Reset:
+        event->Reset();
+        break;
+
+      case TraceOp::InvokeEarly:
+        event->InvokeEarly(entry.args[0] != 0);
+        break;
+
+      case TraceOp::SetInterval:
+        event->SetInterval(entry.args[0]);
+        break;
+
+      case TraceOp::SetPeriod:
+        event->SetPeriod(entry.args[0]);
+        break;
+
+      case TraceOp::Destroy:
+        state.events[entry.event_id].reset();
+        break;
+
+      default:
+        // A callback which did not fire during replay.
+        state.stats->diverged = true;
+        return;
+    }
+  }
+}
+
+bool ReplayTrace(const u8* data, u32 size, TraceReplayStats* stats)
+{
+  Assert(s_events.empty() && !s_trace_recording);
+
+  TraceHeader header;
+  if (size < sizeof(header))
+    return false;
+
+  std::memcpy(&header, data, sizeof(header));
+  if (header.magic != TRACE_MAGIC || header.version != TRACE_VERSION ||
+      (size - sizeof(header)) / sizeof(TraceEntry) < header.num_entries)
+  {
+    return false;
+  }
+
+  std::vector<TraceEntry> entries(header.num_entries);
+  if (header.num_entries > 0)
+    std::memcpy(entries.data(), data + sizeof(header), sizeof(TraceEntry) * header.num_entries);
+
+  std::memset(stats, 0, sizeof(*stats));
+
+  const u32 old_global_tick_counter = s_global_tick_counter;
+  const u32 old_last_event_run_time = s_last_event_run_time;
+  s_global_tick_counter = header.global_tick_counter;
+  s_last_event_run_time = header.last_event_run_time;
+
+  ReplayState state;
+  state.entries = entries.data();
+  state.num_entries = header.num_entries;
+  state.position = 0;
+  state.stats = stats;
+  ReplayOperations(state, false);
+
+  state.events.clear();
+  CPU::ResetPendingTicks();
+  s_global_tick_counter = old_global_tick_counter;
+  s_last_event_run_time = old_last_event_run_time;
+  return true;
+}
+
 } // namespace TimingEvents
 
-TimingEvent::TimingEvent(std::string name, TickCount period, TickCount interval, TimingEventCallback callback)
-  : m_downcount(interval), m_time_since_last_run(0), m_period(period), m_interval(interval),
-    m_callback(std::move(callback)), m_name(std::move(name)), m_active(false)
+TimingEvent::TimingEvent(std::string name, TickCount period, TickCount interval, TimingEventCallback callback,
+                         void* callback_param)
+  : m_downcount(interval), m_time_since_last_run(0), m_period(period), m_interval(interval), m_callback(callback),
+    m_callback_param(callback_param), m_heap_index(0), m_trace_id(TimingEvents::s_next_trace_id++),
+    m_profile_slot(FrameProfiler::RegisterSlot(name.c_str())), m_span_name(TraceRecorder::InternName(name)),
+    m_name(std::move(name)), m_active(false)
 {
 }
 
 TimingEvent::~TimingEvent()
 {
+  if (TimingEvents::s_trace_recording)
+    TimingEvents::TraceEvent(TimingEvents::TraceOp::Destroy, this);
+
   if (m_active)
     TimingEvents::RemoveActiveEvent(this);
 }
@@ -262,6 +666,9 @@ TickCount TimingEvent::GetTicksUntilNextExecution() const
 
 void TimingEvent::Schedule(TickCount ticks)
 {
+  if (TimingEvents::s_trace_recording)
+    TimingEvents::TraceEvent(TimingEvents::TraceOp::Schedule, this, ticks);
+
   const TickCount pending_ticks = CPU::GetPendingTicks();
   m_downcount = pending_ticks + ticks;
 
@@ -275,8 +682,8 @@ void TimingEvent::Schedule(TickCount ticks)
   else
   {
     // Event is already active, so we leave the time since last run alone, and just modify the downcount.
-    // If this is a call from an IO handler for example, re-sort the event queue.
-    TimingEvents::SortEvents();
+    // If this is a call from an IO handler for example, move the event to its new position in the queue.
+    TimingEvents::RescheduleEvent(this);
   }
 }
 
@@ -293,14 +700,33 @@ void TimingEvent::SetPeriodAndSchedule(TickCount ticks)
   Schedule(ticks);
 }
 
+void TimingEvent::SetInterval(TickCount interval)
+{
+  if (TimingEvents::s_trace_recording)
+    TimingEvents::TraceEvent(TimingEvents::TraceOp::SetInterval, this, interval);
+
+  m_interval = interval;
+}
+
+void TimingEvent::SetPeriod(TickCount period)
+{
+  if (TimingEvents::s_trace_recording)
+    TimingEvents::TraceEvent(TimingEvents::TraceOp::SetPeriod, this, period);
+
+  m_period = period;
+}
+
 void TimingEvent::Reset()
 {
   if (!m_active)
     return;
 
+  if (TimingEvents::s_trace_recording)
+    TimingEvents::TraceEvent(TimingEvents::TraceOp::Reset, this);
+
   m_downcount = m_interval;
   m_time_since_last_run = 0;
-  TimingEvents::SortEvents();
+  TimingEvents::RescheduleEvent(this);
 }
 
 void TimingEvent::InvokeEarly(bool force /* = false */)
@@ -308,6 +734,9 @@ void TimingEvent::InvokeEarly(bool force /* = false */)
   if (!m_active)
     return;
 
+  if (TimingEvents::s_trace_recording)
+    TimingEvents::TraceEvent(TimingEvents::TraceOp::InvokeEarly, this, force ? 1 : 0);
+
   const TickCount pending_ticks = CPU::GetPendingTicks();
   const TickCount ticks_to_execute = m_time_since_last_run + pending_ticks;
   if (!force && ticks_to_execute < m_period)
@@ -315,10 +744,10 @@ void TimingEvent::InvokeEarly(bool force /* = false */)
 
   m_downcount = pending_ticks + m_interval;
   m_time_since_last_run -= ticks_to_execute;
-  m_callback(ticks_to_execute, 0);
 
-  // Since we've changed the downcount, we need to re-sort the events.
-  TimingEvents::SortEvents();
+  // Since we've changed the downcount, move the event before the callback can reschedule it.
+  TimingEvents::RescheduleEvent(this);
+  TimingEvents::InvokeCallback(this, ticks_to_execute, 0);
 }
 
 void TimingEvent::Activate()
@@ -326,6 +755,9 @@ void TimingEvent::Activate()
   if (m_active)
     return;
 
+  if (TimingEvents::s_trace_recording)
+    TimingEvents::TraceEvent(TimingEvents::TraceOp::Activate, this);
+
   // leave the downcount intact
   const TickCount pending_ticks = CPU::GetPendingTicks();
   m_downcount += pending_ticks;
@@ -340,6 +772,9 @@ void TimingEvent::Deactivate()
   if (!m_active)
     return;
 
+  if (TimingEvents::s_trace_recording)
+    TimingEvents::TraceEvent(TimingEvents::TraceOp::Deactivate, this);
+
   const TickCount pending_ticks = CPU::GetPendingTicks();
   m_downcount -= pending_ticks;
   m_time_since_last_run += pending_ticks;
@@ -1,5 +1,4 @@
 #pragma once
-#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -8,13 +7,15 @@
 
 class StateWrapper;
 
-// Event callback type. Second parameter is the number of cycles the event was executed "late".
-using TimingEventCallback = std::function<void(TickCount ticks, TickCount ticks_late)>;
+// Event callback type. First parameter is the object which owns the event, the last parameter is the number of
+// cycles the event was executed "late".
+using TimingEventCallback = void (*)(void* param, TickCount ticks, TickCount ticks_late);
 
 class TimingEvent
 {
 public:
-  TimingEvent(std::string name, TickCount period, TickCount interval, TimingEventCallback callback);
+  TimingEvent(std::string name, TickCount period, TickCount interval, TimingEventCallback callback,
+              void* callback_param);
   ~TimingEvent();
 
   const std::string& GetName() const { return m_name; }
@@ -53,8 +54,8 @@ public:
   }
 
   // Directly alters the interval of the event.
-  void SetInterval(TickCount interval) { m_interval = interval; }
-  void SetPeriod(TickCount period) { m_period = period; }
+  void SetInterval(TickCount interval);
+  void SetPeriod(TickCount period);
 
   TickCount m_downcount;
   TickCount m_time_since_last_run;
@@ -62,6 +63,20 @@ public:
   TickCount m_interval;
 
   TimingEventCallback m_callback;
+  void* m_callback_param;
+
+  // Position in the active event heap, valid when active.
+  u32 m_heap_index;
+
+  // Index used when recording/replaying traces.
+  u32 m_trace_id;
+
+  // Frame profiler slot the callback's time is charged to.
+  u32 m_profile_slot;
+
+  // Interned copy of the name, used for trace spans.
+  const char* m_span_name;
+
   std::string m_name;
   bool m_active;
 };
@@ -76,7 +91,7 @@ void Shutdown();
 
 /// Creates a new event.
 std::unique_ptr<TimingEvent> CreateTimingEvent(std::string name, TickCount period, TickCount interval,
-                                               TimingEventCallback callback, bool activate);
+                                               TimingEventCallback callback, void* callback_param, bool activate);
 
 /// Serialization.
 bool DoState(StateWrapper& sw, u32 global_tick_counter);
@@ -85,6 +100,20 @@ void RunEvents();
 
 void UpdateCPUDowncount();
 
+/// Records every scheduling operation to a trace, which can be replayed by the timing event benchmark.
+bool IsRecordingTrace();
+void StartTraceRecording();
+bool StopTraceRecording(const char* filename);
+
+struct TraceReplayStats
+{
+  u32 num_operations;
+  u32 num_run_events;
+  u32 num_callbacks;
+  bool diverged; // callback order did not match the recording
+};
 
+/// Replays a recorded trace against dummy events. Must not be called while the system is running.
+bool ReplayTrace(const u8* data, u32 size, TraceReplayStats* stats);
 
-} // namespace TimingEventManager
\ No newline at end of file
+} // namespace TimingEvents
\ No newline at end of file
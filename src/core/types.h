@@ -56,6 +56,7 @@ enum class GPURenderer : u8
   HardwareVulkan,
   HardwareOpenGL,
   Software,
+  Null,
   Count
 };
 
@@ -0,0 +1,352 @@
+#include "common/assert.h"
+#include "common/audio_stream.h"
+#include "common/log.h"
+#include "common/md5_digest.h"
+#include "common/string_util.h"
+#include "common/timer.h"
+#include "common/vulkan/context.h"
+#include "core/dma.h"
+#include "core/gpu.h"
+#include "core/gpu_dump.h"
+#include "core/host_display.h"
+#include "core/host_interface.h"
+#include "core/interrupt_controller.h"
+#include "core/settings.h"
+#include "core/timers.h"
+#include "core/timing_event.h"
+#include "frontend-common/headless_host_display.h"
+#include "frontend-common/opengl_host_display.h"
+#include "frontend-common/vulkan_host_display.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#ifdef WIN32
+#include "frontend-common/d3d11_host_display.h"
+#endif
+
+// Replays a GPU dump recorded with the "Toggle GPU Dump Recording" hotkey through one of the renderers, as fast as
+// possible and without a window. Reports the time taken by each frame, and hashes of the final VRAM and displayed area
+// so the output of different renderers or builds can be compared.
+
+namespace {
+
+class ReplayHostInterface final : public HostInterface
+{
+public:
+  std::string GetStringSettingValue(const char* section, const char* key, const char* default_value = "") override
+  {
+    return default_value;
+  }
+
+  bool AcquireHostDisplay() override { return false; }
+  void ReleaseHostDisplay() override {}
+  std::unique_ptr<AudioStream> CreateAudioStream(AudioBackend backend) override { return {}; }
+};
+
+struct Options
+{
+  const char* filename = nullptr;
+  const char* csv_filename = nullptr;
+  GPURenderer renderer = GPURenderer::Software;
+  u32 resolution_scale = 1;
+  u32 software_threads = 0;
+  u32 max_frames = 0;
+  bool verbose = false;
+};
+
+} // namespace
+
+static void PrintUsage(const char* progname)
+{
+  std::fprintf(stderr, "Usage: %s [options] <dump file>\n", progname);
+  std::fprintf(stderr, "  -renderer <name>: Software (default), OpenGL, Vulkan");
+#ifdef WIN32
+  std::fprintf(stderr, ", D3D11");
+#endif
+  std::fprintf(stderr, ", Null\n");
+  std::fprintf(stderr, "  -scale <n>: Resolution scale for the hardware renderers.\n");
+  std::fprintf(stderr, "  -threads <n>: Rasterizer threads for the software renderer, 0 for automatic.\n");
+  std::fprintf(stderr, "  -frames <n>: Stop after this many frames.\n");
+  std::fprintf(stderr, "  -csv <file>: Write the time taken by each frame to a CSV file.\n");
+  std::fprintf(stderr, "  -verbose: Show log messages.\n");
+}
+
+static bool ParseOptions(int argc, char* argv[], Options* options)
+{
+  for (int i = 1; i < argc; i++)
+  {
+    const bool has_value = (i + 1) < argc;
+    if (std::strcmp(argv[i], "-renderer") == 0 && has_value)
+    {
+      std::optional<GPURenderer> renderer = Settings::ParseRendererName(argv[++i]);
+      if (!renderer.has_value())
+      {
+        std::fprintf(stderr, "Unknown renderer '%s'\n", argv[i]);
+        return false;
+      }
+      options->renderer = renderer.value();
+    }
+    else if (std::strcmp(argv[i], "-scale") == 0 && has_value)
+    {
+      options->resolution_scale = static_cast<u32>(std::max(std::atoi(argv[++i]), 1));
+    }
+    else if (std::strcmp(argv[i], "-threads") == 0 && has_value)
+    {
+      options->software_threads = static_cast<u32>(std::max(std::atoi(argv[++i]), 0));
+    }
+    else if (std::strcmp(argv[i], "-frames") == 0 && has_value)
+    {
+      options->max_frames = static_cast<u32>(std::max(std::atoi(argv[++i]), 0));
+    }
+    else if (std::strcmp(argv[i], "-csv") == 0 && has_value)
+    {
+      options->csv_filename = argv[++i];
+    }
+    else if (std::strcmp(argv[i], "-verbose") == 0)
+    {
+      options->verbose = true;
+    }
+    else if (argv[i][0] != '-' && !options->filename)
+    {
+      options->filename = argv[i];
+    }
+    else
+    {
+      std::fprintf(stderr, "Unknown option '%s'\n", argv[i]);
+      return false;
+    }
+  }
+
+  return (options->filename != nullptr);
+}
+
+static std::unique_ptr<HostDisplay> CreateHostDisplay(GPURenderer renderer)
+{
+  std::unique_ptr<HostDisplay> display;
+  switch (renderer)
+  {
+    case GPURenderer::HardwareVulkan:
+      display = std::make_unique<FrontendCommon::VulkanHostDisplay>();
+      break;
+
+    case GPURenderer::HardwareOpenGL:
+      display = std::make_unique<FrontendCommon::OpenGLHostDisplay>();
+      break;
+
+#ifdef WIN32
+    case GPURenderer::HardwareD3D11:
+      display = std::make_unique<FrontendCommon::D3D11HostDisplay>();
+      break;
+#endif
+
+    case GPURenderer::Software:
+    case GPURenderer::Null:
+    default:
+      display = std::make_unique<FrontendCommon::HeadlessHostDisplay>();
+      break;
+  }
+
+  // Hardware renderers draw to offscreen targets, so no window is needed.
+  const WindowInfo wi;
+  if (!display->CreateRenderDevice(wi, g_settings.gpu_adapter, false) ||
+      !display->InitializeRenderDevice(std::string_view(), false))
+  {
+    std::fprintf(stderr, "Failed to create a headless %s device\n", Settings::GetRendererName(renderer));
+    return {};
+  }
+
+  return display;
+}
+
+static std::unique_ptr<GPU> CreateGPU(GPURenderer renderer)
+{
+  switch (renderer)
+  {
+    case GPURenderer::HardwareVulkan:
+      return GPU::CreateHardwareVulkanRenderer();
+
+    case GPURenderer::HardwareOpenGL:
+      return GPU::CreateHardwareOpenGLRenderer();
+
+#ifdef WIN32
+    case GPURenderer::HardwareD3D11:
+      return GPU::CreateHardwareD3D11Renderer();
+#endif
+
+    case GPURenderer::Null:
+      return GPU::CreateNullRenderer();
+
+    case GPURenderer::Software:
+    default:
+      return GPU::CreateSoftwareRenderer();
+  }
+}
+
+/// Waits for the hardware renderers to finish the frame, so the frame times include the GPU's work.
+static void FinishFrame(HostDisplay* display)
+{
+  switch (display->GetRenderAPI())
+  {
+    case HostDisplay::RenderAPI::Vulkan:
+      g_gpu->ResetGraphicsAPIState();
+      g_vulkan_context->ExecuteCommandBuffer(true);
+      g_gpu->RestoreGraphicsAPIState();
+      break;
+
+    case HostDisplay::RenderAPI::OpenGL:
+    case HostDisplay::RenderAPI::OpenGLES:
+      glFinish();
+      break;
+
+    default:
+      // The software renderer has already synchronized with its worker threads to scan out the frame.
+      break;
+  }
+}
+
+static std::string FormatDigest(MD5Digest& digest)
+{
+  u8 hash[16];
+  digest.Final(hash);
+
+  std::string str;
+  for (u32 i = 0; i < sizeof(hash); i++)
+    str += StringUtil::StdStringFromFormat("%02x", hash[i]);
+  return str;
+}
+
+static void PrintHashes()
+{
+  const u16* vram = g_gpu->ReadbackVRAM();
+
+  MD5Digest vram_digest;
+  vram_digest.Update(vram, GPU::VRAM_WIDTH * GPU::VRAM_HEIGHT * sizeof(u16));
+
+  // The displayed area can wrap around the edges of VRAM.
+  const Common::Rectangle<u32> area = g_gpu->GetDisplayVRAMArea();
+  MD5Digest display_digest;
+  for (u32 y = area.top; y < area.bottom; y++)
+  {
+    const u16* row = &vram[(y % GPU::VRAM_HEIGHT) * GPU::VRAM_WIDTH];
+    for (u32 x = area.left; x < area.right; x++)
+      display_digest.Update(&row[x % GPU::VRAM_WIDTH], sizeof(u16));
+  }
+
+  std::printf("VRAM hash: %s\n", FormatDigest(vram_digest).c_str());
+  std::printf("Display hash: %s (%ux%u at %u,%u)\n", FormatDigest(display_digest).c_str(), area.GetWidth(),
+              area.GetHeight(), area.left, area.top);
+}
+
+static void PrintFrameTimes(std::vector<double> frame_times)
+{
+  if (frame_times.empty())
+  {
+    std::printf("No frames were replayed.\n");
+    return;
+  }
+
+  double total_time = 0.0;
+  for (const double time : frame_times)
+    total_time += time;
+
+  std::sort(frame_times.begin(), frame_times.end());
+  const size_t count = frame_times.size();
+  const double average_time = total_time / static_cast<double>(count);
+  std::printf("%zu frames in %.2f ms, %.1f frames per second\n", count, total_time,
+              1000.0 * static_cast<double>(count) / total_time);
+  std::printf("Frame time: average %.3f ms, min %.3f ms, median %.3f ms, 99th percentile %.3f ms, max %.3f ms\n",
+              average_time, frame_times.front(), frame_times[count / 2], frame_times[(count * 99) / 100],
+              frame_times.back());
+}
+
+static bool Replay(GPUDump::Player* player, HostDisplay* display, const Options& options)
+{
+  std::FILE* csv_file = nullptr;
+  if (options.csv_filename)
+  {
+    csv_file = std::fopen(options.csv_filename, "w");
+    if (!csv_file)
+    {
+      std::fprintf(stderr, "Failed to open '%s'\n", options.csv_filename);
+      return false;
+    }
+    std::fprintf(csv_file, "Frame,Packets,Time (ms)\n");
+  }
+
+  std::vector<double> frame_times;
+  while ((options.max_frames == 0 || frame_times.size() < options.max_frames) && player->ReadFrame())
+  {
+    Common::Timer timer;
+    player->ExecuteFrame(g_gpu.get());
+    FinishFrame(display);
+
+    const double time = timer.GetTimeMilliseconds();
+    frame_times.push_back(time);
+    if (csv_file)
+      std::fprintf(csv_file, "%u,%u,%.4f\n", player->GetFrameNumber(), player->GetFramePacketCount(), time);
+  }
+
+  if (csv_file)
+    std::fclose(csv_file);
+
+  PrintFrameTimes(std::move(frame_times));
+  PrintHashes();
+  return true;
+}
+
+int main(int argc, char* argv[])
+{
+  Options options;
+  if (!ParseOptions(argc, argv, &options))
+  {
+    PrintUsage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  Log::SetConsoleOutputParams(true, nullptr, options.verbose ? LOGLEVEL_INFO : LOGLEVEL_WARNING);
+
+  std::unique_ptr<GPUDump::Player> player = GPUDump::Player::Open(options.filename);
+  if (!player)
+    return EXIT_FAILURE;
+
+  ReplayHostInterface host_interface;
+  g_settings.gpu_renderer = options.renderer;
+  g_settings.gpu_resolution_scale = options.resolution_scale;
+  g_settings.gpu_sw_threads = options.software_threads;
+
+  std::unique_ptr<HostDisplay> display = CreateHostDisplay(options.renderer);
+  if (!display)
+    return EXIT_FAILURE;
+
+  // Only the parts of the system which the GPU talks to are needed.
+  TimingEvents::Initialize();
+  g_interrupt_controller.Initialize();
+  g_dma.Initialize();
+  g_timers.Initialize();
+
+  bool result = false;
+  g_gpu = CreateGPU(options.renderer);
+  if (g_gpu->Initialize(display.get()))
+  {
+    g_gpu->Reset();
+    if (player->LoadInitialState(g_gpu.get()))
+      result = Replay(player.get(), display.get(), options);
+    else
+      std::fprintf(stderr, "Failed to load the initial GPU state from '%s'\n", options.filename);
+  }
+  else
+  {
+    std::fprintf(stderr, "Failed to initialize the %s renderer\n", Settings::GetRendererName(options.renderer));
+  }
+
+  g_gpu.reset();
+  g_timers.Shutdown();
+  g_dma.Shutdown();
+  g_interrupt_controller.Shutdown();
+  TimingEvents::Shutdown();
+  display->DestroyRenderDevice();
+  return result ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -397,6 +397,16 @@ static std::array<retro_core_option_definition, 27> s_option_definitions = {{
    "OpenGL"
 #endif
   },
+  {"GPU.UseThread",
+   "Threaded Software Renderer",
+   "Rasterizes on a worker thread when using the software renderer, so drawing runs in parallel with CPU emulation.",
+   {{"true", "Enabled"}, {"false", "Disabled"}},
+   "true"},
+  {"GPU.SoftwareThreads",
+   "Software Rasterizer Threads",
+   "Number of threads the software renderer splits drawing between.",
+   {{"0", "Automatic"}, {"1", "1"}, {"2", "2"}, {"4", "4"}, {"8", "8"}},
+   "0"},
   {"GPU.ResolutionScale",
    "Internal Resolution Scale",
    "Scales internal VRAM resolution by the specified multiplier. Larger values are slower. Some games require "
@@ -20,6 +20,8 @@ GPUSettingsWidget::GPUSettingsWidget(QtHostInterface* host_interface, QWidget* p
                                                &Settings::ParseRendererName, &Settings::GetRendererName,
                                                Settings::DEFAULT_GPU_RENDERER);
   SettingWidgetBinder::BindWidgetToBoolSetting(m_host_interface, m_ui.useDebugDevice, "GPU", "UseDebugDevice");
+  SettingWidgetBinder::BindWidgetToBoolSetting(m_host_interface, m_ui.useThread, "GPU", "UseThread");
+  SettingWidgetBinder::BindWidgetToIntSetting(m_host_interface, m_ui.softwareThreads, "GPU", "SoftwareThreads");
   SettingWidgetBinder::BindWidgetToEnumSetting(m_host_interface, m_ui.displayAspectRatio, "Display", "AspectRatio",
                                                &Settings::ParseDisplayAspectRatio, &Settings::GetDisplayAspectRatioName,
                                                Settings::DEFAULT_DISPLAY_ASPECT_RATIO);
@@ -31,6 +33,7 @@ GPUSettingsWidget::GPUSettingsWidget(QtHostInterface* host_interface, QWidget* p
   SettingWidgetBinder::BindWidgetToBoolSetting(m_host_interface, m_ui.displayIntegerScaling, "Display",
                                                "IntegerScaling");
   SettingWidgetBinder::BindWidgetToBoolSetting(m_host_interface, m_ui.vsync, "Display", "VSync");
+  SettingWidgetBinder::BindWidgetToBoolSetting(m_host_interface, m_ui.autoFrameSkip, "Display", "AutoFrameSkip");
   SettingWidgetBinder::BindWidgetToIntSetting(m_host_interface, m_ui.resolutionScale, "GPU", "ResolutionScale");
   SettingWidgetBinder::BindWidgetToBoolSetting(m_host_interface, m_ui.trueColor, "GPU", "TrueColor");
   SettingWidgetBinder::BindWidgetToBoolSetting(m_host_interface, m_ui.scaledDithering, "GPU", "ScaledDithering");
@@ -39,6 +42,7 @@ GPUSettingsWidget::GPUSettingsWidget(QtHostInterface* host_interface, QWidget* p
   SettingWidgetBinder::BindWidgetToBoolSetting(m_host_interface, m_ui.linearTextureFiltering, "GPU",
                                                "TextureFiltering");
   SettingWidgetBinder::BindWidgetToBoolSetting(m_host_interface, m_ui.widescreenHack, "GPU", "WidescreenHack");
+  SettingWidgetBinder::BindWidgetToBoolSetting(m_host_interface, m_ui.textureCache, "GPU", "TextureCache");
 
   SettingWidgetBinder::BindWidgetToBoolSetting(m_host_interface, m_ui.pgxpEnable, "GPU", "PGXPEnable", false);
   SettingWidgetBinder::BindWidgetToBoolSetting(m_host_interface, m_ui.pgxpCulling, "GPU", "PGXPCulling", true);
@@ -73,6 +77,14 @@ GPUSettingsWidget::GPUSettingsWidget(QtHostInterface* host_interface, QWidget* p
   dialog->registerWidgetHelp(m_ui.useDebugDevice, tr("Use Debug Device"), tr("Unchecked"),
                              tr("Enables the usage of debug devices and shaders for rendering APIs which support them. "
                                 "Should only be used when debugging the emulator."));
+  dialog->registerWidgetHelp(
+    m_ui.useThread, tr("Threaded Software Renderer"), tr("Checked"),
+    tr("Uses a second thread for drawing in the software renderer, so rasterization runs in parallel with the "
+       "emulated CPU. Has no effect on the hardware renderers."));
+  dialog->registerWidgetHelp(
+    m_ui.softwareThreads, tr("Rasterizer Threads"), tr("Automatic"),
+    tr("Number of threads the software renderer splits drawing between. Each thread draws its own set of lines, so "
+       "large scenes are drawn faster. Automatic picks a count based on the number of CPU cores."));
   dialog->registerWidgetHelp(
     m_ui.displayAspectRatio, tr("Aspect Ratio"), QStringLiteral("4:3"),
     tr("Changes the aspect ratio used to display the console's output to the screen. The default "
@@ -102,6 +114,10 @@ GPUSettingsWidget::GPUSettingsWidget(QtHostInterface* host_interface, QWidget* p
     tr("Enables synchronization with the host display when possible. Enabling this option will "
        "provide better frame pacing and smoother motion with fewer duplicated frames. VSync is "
        "automatically disabled when it is not possible (e.g. running at non-100% speed)."));
+  dialog->registerWidgetHelp(
+    m_ui.autoFrameSkip, tr("Automatic Frame Skipping"), tr("Unchecked"),
+    tr("Skips rendering frames when the system is too slow to run at full speed. Emulation is not affected, but "
+       "fewer frames are shown. Disabled automatically in games which read back their framebuffers."));
   dialog->registerWidgetHelp(
     m_ui.resolutionScale, tr("Resolution Scale"), "1x",
     tr("Enables the upscaling of 3D objects rendered to the console's framebuffer. Only applies "
@@ -130,6 +146,11 @@ GPUSettingsWidget::GPUSettingsWidget(QtHostInterface* host_interface, QWidget* p
        "filtering. Will have a greater effect on higher resolution scales. Currently this option "
        "produces artifacts around objects in many games and needs further work. Only applies to the hardware "
        "renderers."));
+  dialog->registerWidgetHelp(
+    m_ui.textureCache, tr("Palette Texture Cache"), tr("Unchecked"),
+    tr("Keeps decoded copies of frequently used 4-bit and 8-bit paletted texture pages, so they don't have to be "
+       "looked up through the palette for every pixel. Can improve performance at high resolution scales. Only "
+       "applies to the hardware renderers."));
   dialog->registerWidgetHelp(
     m_ui.widescreenHack, tr("Widescreen Hack"), tr("Unchecked"),
     tr("Scales vertex positions in screen-space to a widescreen aspect ratio, essentially "
@@ -660,6 +660,10 @@ void MainWindow::connectSignals()
                                                "ShowTimersState");
   SettingWidgetBinder::BindWidgetToBoolSetting(m_host_interface, m_ui.actionDebugShowMDECState, "Debug",
                                                "ShowMDECState");
+  SettingWidgetBinder::BindWidgetToBoolSetting(m_host_interface, m_ui.actionDebugShowFrameProfiler, "Debug",
+                                               "ShowFrameProfiler");
+  SettingWidgetBinder::BindWidgetToBoolSetting(m_host_interface, m_ui.actionDebugShowIOAccessStatistics, "Debug",
+                                               "ShowIOAccessStatistics");
 
   addThemeToMenu(tr("Default"), QStringLiteral("default"));
   addThemeToMenu(tr("DarkFusion"), QStringLiteral("darkfusion"));
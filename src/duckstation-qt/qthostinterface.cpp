@@ -5,6 +5,7 @@
 #include "common/log.h"
 #include "common/string_util.h"
 #include "core/controller.h"
+#include "core/frame_profiler.h"
 #include "core/game_list.h"
 #include "core/gpu.h"
 #include "core/system.h"
@@ -1105,8 +1106,13 @@ void QtHostInterface::threadEntryPoint()
 
 void QtHostInterface::renderDisplay()
 {
+  // Frames dropped by frame skipping aren't presented, the last one stays on screen.
+  if (System::IsRunning() && System::WasFrameSkipped())
+    return;
+
   DrawImGuiWindows();
 
+  FrameProfiler::ScopedTimer profile_timer(FrameProfiler::SLOT_PRESENT);
   m_display->Render();
   ImGui::NewFrame();
 }
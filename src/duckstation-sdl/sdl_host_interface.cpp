@@ -5,6 +5,7 @@
 #include "common/log.h"
 #include "common/string_util.h"
 #include "core/controller.h"
+#include "core/frame_profiler.h"
 #include "core/gpu.h"
 #include "core/host_display.h"
 #include "core/system.h"
@@ -880,6 +881,7 @@ void SDLHostInterface::DrawQuickSettingsMenu()
   settings_changed |= ImGui::MenuItem("True (24-Bit) Color", nullptr, &m_settings_copy.gpu_true_color);
   settings_changed |= ImGui::MenuItem("Scaled Dithering", nullptr, &m_settings_copy.gpu_scaled_dithering);
   settings_changed |= ImGui::MenuItem("Texture Filtering", nullptr, &m_settings_copy.gpu_texture_filtering);
+  settings_changed |= ImGui::MenuItem("Palette Texture Cache", nullptr, &m_settings_copy.gpu_texture_cache);
   settings_changed |= ImGui::MenuItem("Disable Interlacing", nullptr, &m_settings_copy.gpu_disable_interlacing);
   settings_changed |= ImGui::MenuItem("Widescreen Hack", nullptr, &m_settings_copy.gpu_widescreen_hack);
   settings_changed |= ImGui::MenuItem("Display Linear Filtering", nullptr, &m_settings_copy.display_linear_filtering);
@@ -939,6 +941,8 @@ void SDLHostInterface::DrawDebugMenu()
   settings_changed |= ImGui::MenuItem("Show SPU State", nullptr, &debug_settings.show_spu_state);
   settings_changed |= ImGui::MenuItem("Show Timers State", nullptr, &debug_settings.show_timers_state);
   settings_changed |= ImGui::MenuItem("Show MDEC State", nullptr, &debug_settings.show_mdec_state);
+  settings_changed |= ImGui::MenuItem("Show Frame Profiler", nullptr, &debug_settings.show_frame_profiler);
+  settings_changed |= ImGui::MenuItem("Show I/O Access Statistics", nullptr, &debug_settings.show_io_access_statistics);
 
   if (settings_changed)
   {
@@ -952,6 +956,8 @@ void SDLHostInterface::DrawDebugMenu()
     debug_settings_copy.show_spu_state = debug_settings.show_spu_state;
     debug_settings_copy.show_timers_state = debug_settings.show_timers_state;
     debug_settings_copy.show_mdec_state = debug_settings.show_mdec_state;
+    debug_settings_copy.show_frame_profiler = debug_settings.show_frame_profiler;
+    debug_settings_copy.show_io_access_statistics = debug_settings.show_io_access_statistics;
     RunLater([this]() { SaveAndUpdateSettings(); });
   }
 }
@@ -1291,9 +1297,32 @@ void SDLHostInterface::DrawSettingsWindow()
         }
 
         settings_changed |= ImGui::Checkbox("Use Debug Device", &m_settings_copy.gpu_use_debug_device);
+        settings_changed |= ImGui::Checkbox("Threaded Software Renderer", &m_settings_copy.gpu_use_thread);
+
+        ImGui::Text("Rasterizer Threads:");
+        ImGui::SameLine(indent);
+
+        int gpu_sw_threads = static_cast<int>(m_settings_copy.gpu_sw_threads);
+        if (ImGui::SliderInt("##gpu_sw_threads", &gpu_sw_threads, 0, 16, (gpu_sw_threads == 0) ? "Automatic" : "%d"))
+        {
+          m_settings_copy.gpu_sw_threads = static_cast<u32>(gpu_sw_threads);
+          settings_changed = true;
+        }
+
         settings_changed |= ImGui::Checkbox("Linear Filtering", &m_settings_copy.display_linear_filtering);
         settings_changed |= ImGui::Checkbox("Integer Scaling", &m_settings_copy.display_integer_scaling);
         settings_changed |= ImGui::Checkbox("VSync", &m_settings_copy.video_sync_enabled);
+        settings_changed |= ImGui::Checkbox("Automatic Frame Skip", &m_settings_copy.display_auto_frame_skip);
+
+        ImGui::Text("Max Skipped Frames:");
+        ImGui::SameLine(indent);
+
+        int max_frame_skip = static_cast<int>(m_settings_copy.display_max_frame_skip);
+        if (ImGui::SliderInt("##max_frame_skip", &max_frame_skip, 1, 9))
+        {
+          m_settings_copy.display_max_frame_skip = static_cast<u32>(max_frame_skip);
+          settings_changed = true;
+        }
       }
 
       ImGui::NewLine();
@@ -1332,6 +1361,7 @@ void SDLHostInterface::DrawSettingsWindow()
 
         settings_changed |= ImGui::Checkbox("True 24-bit Color (disables dithering)", &m_settings_copy.gpu_true_color);
         settings_changed |= ImGui::Checkbox("Texture Filtering", &m_settings_copy.gpu_texture_filtering);
+        settings_changed |= ImGui::Checkbox("Palette Texture Cache", &m_settings_copy.gpu_texture_cache);
         settings_changed |= ImGui::Checkbox("Disable Interlacing", &m_settings_copy.gpu_disable_interlacing);
         settings_changed |= ImGui::Checkbox("Force NTSC Timings", &m_settings_copy.gpu_force_ntsc_timings);
         settings_changed |= ImGui::Checkbox("Widescreen Hack", &m_settings_copy.gpu_widescreen_hack);
@@ -1527,11 +1557,19 @@ void SDLHostInterface::Run()
 
     // rendering
     {
-      DrawImGuiWindows();
+      // frames dropped by frame skipping aren't presented, the last one stays on screen
+      if (!System::IsRunning() || !System::WasFrameSkipped())
+      {
+        DrawImGuiWindows();
 
-      m_display->Render();
-      ImGui_ImplSDL2_NewFrame(m_window);
-      ImGui::NewFrame();
+        {
+          FrameProfiler::ScopedTimer profile_timer(FrameProfiler::SLOT_PRESENT);
+          m_display->Render();
+        }
+
+        ImGui_ImplSDL2_NewFrame(m_window);
+        ImGui::NewFrame();
+      }
 
       if (System::IsRunning())
       {
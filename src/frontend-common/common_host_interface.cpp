@@ -5,11 +5,14 @@
 #include "common/file_system.h"
 #include "common/log.h"
 #include "common/string_util.h"
+#include "common/trace_recorder.h"
 #include "controller_interface.h"
+#include "core/bus.h"
 #include "core/cdrom.h"
 #include "core/controller.h"
 #include "core/cpu_code_cache.h"
 #include "core/dma.h"
+#include "core/frame_profiler.h"
 #include "core/game_list.h"
 #include "core/gpu.h"
 #include "core/host_display.h"
@@ -19,6 +22,7 @@
 #include "core/spu.h"
 #include "core/system.h"
 #include "core/timers.h"
+#include "core/timing_event.h"
 #include "imgui.h"
 #include "ini_settings_interface.h"
 #include "save_state_selector_ui.h"
@@ -727,7 +731,7 @@ void CommonHostInterface::DrawFPSWindow()
     return;
 
   const ImVec2 window_size =
-    ImVec2(175.0f * ImGui::GetIO().DisplayFramebufferScale.x, 16.0f * ImGui::GetIO().DisplayFramebufferScale.y);
+    ImVec2(225.0f * ImGui::GetIO().DisplayFramebufferScale.x, 16.0f * ImGui::GetIO().DisplayFramebufferScale.y);
   ImGui::SetNextWindowPos(ImVec2(ImGui::GetIO().DisplaySize.x - window_size.x, 0.0f), ImGuiCond_Always);
   ImGui::SetNextWindowSize(window_size);
 
@@ -783,6 +787,17 @@ void CommonHostInterface::DrawFPSWindow()
     else
       ImGui::TextColored(ImVec4(0.4f, 1.0f, 0.4f, 1.0f), "%u%%", rounded_speed);
   }
+  if (g_settings.display_auto_frame_skip && System::GetSkippedFPS() > 0.0f)
+  {
+    if (!first)
+    {
+      ImGui::SameLine();
+      ImGui::Text("/");
+      ImGui::SameLine();
+    }
+
+    ImGui::TextColored(ImVec4(1.0f, 1.0f, 0.4f, 1.0f), "%.0f skip", System::GetSkippedFPS());
+  }
 
   ImGui::End();
 }
@@ -860,6 +875,10 @@ void CommonHostInterface::DrawDebugWindows()
     g_spu.DrawDebugStateWindow();
   if (g_settings.debugging.show_mdec_state)
     g_mdec.DrawDebugStateWindow();
+  if (g_settings.debugging.show_frame_profiler)
+    FrameProfiler::DrawWindow();
+  if (g_settings.debugging.show_io_access_statistics)
+    Bus::DrawIOAccessStatisticsWindow();
 }
 
 void CommonHostInterface::DoFrameStep()
@@ -1287,6 +1306,30 @@ void CommonHostInterface::RegisterGeneralHotkeys()
       DoFrameStep();
     }
   });
+
+  RegisterHotkey(StaticString("General"), StaticString("ToggleFrameTimeLog"), StaticString("Toggle Frame Time Log"),
+                 [this](bool pressed) {
+                   if (!pressed)
+                     ToggleFrameTimeLog();
+                 });
+
+  RegisterHotkey(StaticString("General"), StaticString("ToggleTraceRecording"), StaticString("Toggle Trace Recording"),
+                 [this](bool pressed) {
+                   if (!pressed)
+                     ToggleTraceRecording();
+                 });
+
+  RegisterHotkey(StaticString("General"), StaticString("ToggleTimingEventTrace"),
+                 StaticString("Toggle Timing Event Trace"), [this](bool pressed) {
+                   if (!pressed)
+                     ToggleTimingEventTrace();
+                 });
+
+  RegisterHotkey(StaticString("General"), StaticString("ToggleGPUDumpRecording"),
+                 StaticString("Toggle GPU Dump Recording"), [this](bool pressed) {
+                   if (!pressed)
+                     ToggleGPUDumpRecording();
+                 });
 }
 
 void CommonHostInterface::RegisterGraphicsHotkeys()
@@ -1974,6 +2017,80 @@ void CommonHostInterface::StopDumpingAudio()
   AddOSDMessage("Stopped dumping audio.", 5.0f);
 }
 
+void CommonHostInterface::ToggleFrameTimeLog()
+{
+  if (FrameProfiler::IsLoggingCSV())
+  {
+    FrameProfiler::StopCSVLog();
+    AddOSDMessage("Stopped logging frame times.", 5.0f);
+    return;
+  }
+
+  const std::string filename =
+    GetUserDirectoryRelativePath("dump/frame_times_%s.csv", GetTimestampStringForFileName().GetCharArray());
+  if (FrameProfiler::StartCSVLog(filename.c_str()))
+    AddFormattedOSDMessage(5.0f, "Logging frame times to '%s'.", filename.c_str());
+  else
+    AddFormattedOSDMessage(10.0f, "Failed to open frame time log '%s'.", filename.c_str());
+}
+
+void CommonHostInterface::ToggleTraceRecording()
+{
+  if (!TraceRecorder::IsRecording())
+  {
+    TraceRecorder::Start();
+    AddOSDMessage("Started trace recording.", 5.0f);
+    return;
+  }
+
+  const std::string filename =
+    GetUserDirectoryRelativePath("dump/trace_%s.json", GetTimestampStringForFileName().GetCharArray());
+  if (TraceRecorder::StopAndWrite(filename.c_str()))
+    AddFormattedOSDMessage(5.0f, "Saved trace to '%s'.", filename.c_str());
+  else
+    AddFormattedOSDMessage(10.0f, "Failed to save trace to '%s'.", filename.c_str());
+}
+
+void CommonHostInterface::ToggleTimingEventTrace()
+{
+  if (System::IsShutdown())
+    return;
+
+  if (!TimingEvents::IsRecordingTrace())
+  {
+    TimingEvents::StartTraceRecording();
+    AddOSDMessage("Started recording timing event trace.", 5.0f);
+    return;
+  }
+
+  const std::string filename =
+    GetUserDirectoryRelativePath("dump/timing_events_%s.trace", GetTimestampStringForFileName().GetCharArray());
+  if (TimingEvents::StopTraceRecording(filename.c_str()))
+    AddFormattedOSDMessage(5.0f, "Saved timing event trace to '%s'.", filename.c_str());
+  else
+    AddFormattedOSDMessage(10.0f, "Failed to save timing event trace to '%s'.", filename.c_str());
+}
+
+void CommonHostInterface::ToggleGPUDumpRecording()
+{
+  if (System::IsShutdown())
+    return;
+
+  if (g_gpu->IsRecordingDump())
+  {
+    g_gpu->StopDumpRecording();
+    AddOSDMessage("Stopped recording GPU dump.", 5.0f);
+    return;
+  }
+
+  const std::string filename =
+    GetUserDirectoryRelativePath("dump/gpu_%s.gpudump", GetTimestampStringForFileName().GetCharArray());
+  if (g_gpu->StartDumpRecording(filename.c_str()))
+    AddFormattedOSDMessage(5.0f, "Recording GPU dump to '%s'.", filename.c_str());
+  else
+    AddFormattedOSDMessage(10.0f, "Failed to start recording GPU dump to '%s'.", filename.c_str());
+}
+
 bool CommonHostInterface::SaveScreenshot(const char* filename /* = nullptr */, bool full_resolution /* = true */,
                                          bool apply_aspect_ratio /* = true */)
 {
@@ -146,6 +146,18 @@ public:
   /// Stops dumping audio to file if it has been started.
   void StopDumpingAudio();
 
+  /// Starts or stops logging per-subsystem frame times to a CSV file.
+  void ToggleFrameTimeLog();
+
+  /// Starts or stops recording a Chrome trace of emulator activity on all threads.
+  void ToggleTraceRecording();
+
+  /// Starts or stops recording a timing event trace, for replaying in the timing event benchmark.
+  void ToggleTimingEventTrace();
+
+  /// Starts or stops recording a GPU dump, for replaying with duckstation-gpu-replay.
+  void ToggleGPUDumpRecording();
+
   /// Saves a screenshot to the specified file. IF no file name is provided, one will be generated automatically.
   bool SaveScreenshot(const char* filename = nullptr, bool full_resolution = true, bool apply_aspect_ratio = true);
 
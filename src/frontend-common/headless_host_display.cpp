@@ -0,0 +1,134 @@
+#include "headless_host_display.h"
+#include "imgui.h"
+
+namespace FrontendCommon {
+
+class HeadlessHostDisplayTexture final : public HostDisplayTexture
+{
+public:
+  HeadlessHostDisplayTexture(u32 width, u32 height) : m_width(width), m_height(height) {}
+  ~HeadlessHostDisplayTexture() override = default;
+
+  void* GetHandle() const override { return const_cast<HeadlessHostDisplayTexture*>(this); }
+  u32 GetWidth() const override { return m_width; }
+  u32 GetHeight() const override { return m_height; }
+
+private:
+  u32 m_width;
+  u32 m_height;
+};
+
+HeadlessHostDisplay::HeadlessHostDisplay() = default;
+
+HeadlessHostDisplay::~HeadlessHostDisplay() = default;
+
+HostDisplay::RenderAPI HeadlessHostDisplay::GetRenderAPI() const
+{
+  return RenderAPI::None;
+}
+
+void* HeadlessHostDisplay::GetRenderDevice() const
+{
+  return nullptr;
+}
+
+void* HeadlessHostDisplay::GetRenderContext() const
+{
+  return nullptr;
+}
+
+bool HeadlessHostDisplay::HasRenderDevice() const
+{
+  return m_has_device;
+}
+
+bool HeadlessHostDisplay::HasRenderSurface() const
+{
+  return false;
+}
+
+bool HeadlessHostDisplay::CreateRenderDevice(const WindowInfo& wi, std::string_view adapter_name, bool debug_device)
+{
+  m_window_info = wi;
+  m_has_device = true;
+  return true;
+}
+
+bool HeadlessHostDisplay::InitializeRenderDevice(std::string_view shader_cache_directory, bool debug_device)
+{
+  if (ImGui::GetCurrentContext())
+  {
+    // The font atlas has to be built before a frame can be started, even though it's never drawn.
+    unsigned char* pixels;
+    int width, height;
+    ImGui::GetIO().Fonts->GetTexDataAsRGBA32(&pixels, &width, &height);
+    ImGui::GetIO().DisplaySize.x = static_cast<float>(m_window_info.surface_width);
+    ImGui::GetIO().DisplaySize.y = static_cast<float>(m_window_info.surface_height);
+  }
+
+  return true;
+}
+
+void HeadlessHostDisplay::DestroyRenderDevice()
+{
+  ClearSoftwareCursor();
+  m_has_device = false;
+}
+
+bool HeadlessHostDisplay::MakeRenderContextCurrent()
+{
+  return true;
+}
+
+bool HeadlessHostDisplay::DoneRenderContextCurrent()
+{
+  return true;
+}
+
+bool HeadlessHostDisplay::ChangeRenderWindow(const WindowInfo& new_wi)
+{
+  m_window_info = new_wi;
+  return true;
+}
+
+void HeadlessHostDisplay::ResizeRenderWindow(s32 new_window_width, s32 new_window_height)
+{
+  m_window_info.surface_width = static_cast<u32>(new_window_width);
+  m_window_info.surface_height = static_cast<u32>(new_window_height);
+}
+
+void HeadlessHostDisplay::DestroyRenderSurface()
+{
+  m_window_info = {};
+}
+
+std::unique_ptr<HostDisplayTexture> HeadlessHostDisplay::CreateTexture(u32 width, u32 height, const void* data,
+                                                                       u32 data_stride, bool dynamic)
+{
+  return std::make_unique<HeadlessHostDisplayTexture>(width, height);
+}
+
+void HeadlessHostDisplay::UpdateTexture(HostDisplayTexture* texture, u32 x, u32 y, u32 width, u32 height,
+                                        const void* data, u32 data_stride)
+{
+}
+
+bool HeadlessHostDisplay::DownloadTexture(const void* texture_handle, u32 x, u32 y, u32 width, u32 height,
+                                          void* out_data, u32 out_data_stride)
+{
+  // Nothing is kept, so there's nothing to read back.
+  return false;
+}
+
+void HeadlessHostDisplay::SetVSync(bool enabled) {}
+
+bool HeadlessHostDisplay::Render()
+{
+  // Ends the frame started by the frontend, the draw data is thrown away.
+  if (ImGui::GetCurrentContext())
+    ImGui::Render();
+
+  return true;
+}
+
+} // namespace FrontendCommon
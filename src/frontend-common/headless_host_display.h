@@ -0,0 +1,49 @@
+#pragma once
+#include "common/window_info.h"
+#include "core/host_display.h"
+#include <memory>
+
+namespace FrontendCommon {
+
+/// Display which doesn't need a window or a graphics device, and discards every frame. Used with the software and
+/// null renderers for benchmarking and automated runs on machines without a display.
+class HeadlessHostDisplay final : public HostDisplay
+{
+public:
+  HeadlessHostDisplay();
+  ~HeadlessHostDisplay() override;
+
+  RenderAPI GetRenderAPI() const override;
+  void* GetRenderDevice() const override;
+  void* GetRenderContext() const override;
+
+  bool HasRenderDevice() const override;
+  bool HasRenderSurface() const override;
+
+  bool CreateRenderDevice(const WindowInfo& wi, std::string_view adapter_name, bool debug_device) override;
+  bool InitializeRenderDevice(std::string_view shader_cache_directory, bool debug_device) override;
+  void DestroyRenderDevice() override;
+
+  bool MakeRenderContextCurrent() override;
+  bool DoneRenderContextCurrent() override;
+
+  bool ChangeRenderWindow(const WindowInfo& new_wi) override;
+  void ResizeRenderWindow(s32 new_window_width, s32 new_window_height) override;
+  void DestroyRenderSurface() override;
+
+  std::unique_ptr<HostDisplayTexture> CreateTexture(u32 width, u32 height, const void* data, u32 data_stride,
+                                                    bool dynamic) override;
+  void UpdateTexture(HostDisplayTexture* texture, u32 x, u32 y, u32 width, u32 height, const void* data,
+                     u32 data_stride) override;
+  bool DownloadTexture(const void* texture_handle, u32 x, u32 y, u32 width, u32 height, void* out_data,
+                       u32 out_data_stride) override;
+
+  void SetVSync(bool enabled) override;
+
+  bool Render() override;
+
+private:
+  bool m_has_device = false;
+};
+
+} // namespace FrontendCommon
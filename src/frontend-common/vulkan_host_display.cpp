@@ -268,6 +268,13 @@ bool VulkanHostDisplay::HasRenderSurface() const
 
 VkRenderPass VulkanHostDisplay::GetRenderPassForDisplay() const
 {
+  // Without a swap chain nothing is presented, but the display pipelines still need a compatible render pass.
+  if (!m_swap_chain)
+  {
+    return g_vulkan_context->GetRenderPass(VK_FORMAT_R8G8B8A8_UNORM, VK_FORMAT_UNDEFINED, VK_SAMPLE_COUNT_1_BIT,
+                                          VK_ATTACHMENT_LOAD_OP_CLEAR);
+  }
+
   return m_swap_chain->GetClearRenderPass();
 }
 